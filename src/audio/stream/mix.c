@@ -0,0 +1,56 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "mix.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	#define HAVE_MIX_VEC4
+	typedef float vf32 __attribute__((vector_size(4 * sizeof(float))));
+	#define LOAD(src) ({ vf32 _v; memcpy(&_v, (src), sizeof(_v)); _v; })
+	#define STORE(dst, v) ({ vf32 _v = (v); memcpy((dst), &_v, sizeof(_v)); })
+#endif
+
+void audio_mix_f32(size_t num_samples, float *restrict dst, const float *restrict src, float gain) {
+	size_t i = 0;
+
+#if defined(HAVE_MIX_VEC4)
+	const vf32 vgain = { gain, gain, gain, gain };
+
+	for(; i + 4 <= num_samples; i += 4) {
+		STORE(dst + i, LOAD(dst + i) + LOAD(src + i) * vgain);
+	}
+#endif
+
+	for(; i < num_samples; ++i) {
+		dst[i] += src[i] * gain;
+	}
+}
+
+void audio_fade_stereo_f32(uint num_frames, float *restrict frames, float gain, float step) {
+	uint i = 0;
+
+#if defined(HAVE_MIX_VEC4)
+	// Two stereo frames per vector; the frame index is converted to float just like in the scalar
+	// loop, which is exact for any realistic buffer size.
+	const vf32 vgain = { gain, gain, gain, gain };
+	const vf32 vstep = { step, step, step, step };
+	vf32 vidx = { 0, 0, 1, 1 };
+
+	for(; i + 2 <= num_frames; i += 2) {
+		float *p = frames + 2 * i;
+		STORE(p, LOAD(p) * (vgain + vstep * vidx));
+		vidx += 2;
+	}
+#endif
+
+	for(; i < num_frames; ++i) {
+		float g = gain + step * i;
+		frames[2 * i] *= g;
+		frames[2 * i + 1] *= g;
+	}
+}
@@ -0,0 +1,23 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+/*
+ * Mixing kernels for float32 PCM. These are vectorized where SSE2 or NEON is available and
+ * produce results bit-identical to the plain scalar loops.
+ */
+
+// dst[i] += src[i] * gain
+void audio_mix_f32(size_t num_samples, float *restrict dst, const float *restrict src, float gain)
+	attr_nonnull_all;
+
+// Scales interleaved stereo frame i by (gain + step * i)
+void audio_fade_stereo_f32(uint num_frames, float *restrict frames, float gain, float step)
+	attr_nonnull_all;
@@ -7,6 +7,8 @@
  */
 
 #include "player.h"
+
+#include "mix.h"
 #include "util.h"
 
 // #define SPAM(...) log_debug(__VA_ARGS__)
@@ -79,6 +81,7 @@ void splayer_shutdown(StreamPlayer *plr) {
 	}
 
 	mem_free(plr->channels);
+	mem_free(plr->staging_buffer);
 }
 
 static inline void splayer_stream_ended(StreamPlayer *plr, int chan) {
@@ -86,7 +89,8 @@ static inline void splayer_stream_ended(StreamPlayer *plr, int chan) {
 	splayer_halt(plr, chan);
 }
 
-static size_t splayer_process_channel(StreamPlayer *plr, int chan, size_t bufsize, void *buffer) {
+// decode_buffer must be at least bufsize bytes large; it's only used if the stream needs conversion
+static size_t splayer_process_channel(StreamPlayer *plr, int chan, size_t bufsize, void *buffer, uint8_t *decode_buffer) {
 	AudioStreamReadFlags rflags = 0;
 	StreamPlayerChannel *pchan = plr->channels + chan;
 
@@ -107,7 +111,6 @@ static size_t splayer_process_channel(StreamPlayer *plr, int chan, size_t bufsiz
 		// convert/resample
 
 		do {
-			uint8_t staging_buffer[bufsize];
 			ssize_t read = SDL_GetAudioStreamData(pipe, buf, buf_end - buf);
 
 			if(UNLIKELY(read < 0)) {
@@ -121,7 +124,7 @@ static size_t splayer_process_channel(StreamPlayer *plr, int chan, size_t bufsiz
 				break;
 			}
 
-			read = astream_read_into_sdl_stream(astream, pipe, sizeof(staging_buffer), staging_buffer, rflags);
+			read = astream_read_into_sdl_stream(astream, pipe, bufsize, decode_buffer, rflags);
 
 			if(read <= 0) {
 				SDL_FlushAudioStream(pipe);
@@ -148,6 +151,59 @@ static size_t splayer_process_channel(StreamPlayer *plr, int chan, size_t bufsiz
 	return bufsize - (buf_end - buf);
 }
 
+/*
+ * In-memory streams that already are in the output format (crystalized SFX) can be mixed straight
+ * from their shared PCM buffer, unless a fade is in progress, which has to scale a private copy.
+ */
+static bool splayer_can_mix_direct(StreamPlayerChannel *pchan) {
+	return
+		!pchan->paused &&
+		pchan->stream &&
+		!pchan->pipe &&
+		!pchan->fade.num_steps &&
+		astream_can_map(pchan->stream);
+}
+
+static void splayer_mix_channel_direct(StreamPlayer *plr, int chan, size_t bufsize, sample_t *out, float gain) {
+	StreamPlayerChannel *pchan = plr->channels + chan;
+	AudioStreamReadFlags rflags = pchan->looping ? ASTREAM_READ_LOOP : 0;
+	float chan_gain = gain * pchan->gain * pchan->fade.gain;
+	size_t ofs = 0;
+
+	while(ofs < bufsize) {
+		const void *data;
+		ssize_t mapped = astream_map(pchan->stream, bufsize - ofs, &data, rflags);
+
+		if(mapped <= 0) {
+			if(mapped == 0) {
+				splayer_stream_ended(plr, chan);
+			}
+
+			break;
+		}
+
+		assert(mapped % sizeof(struct stereo_frame) == 0);
+
+		// Muted channels only need their cursor advanced
+		if(chan_gain != 0) {
+			audio_mix_f32(mapped / sizeof(sample_t), out + ofs / sizeof(sample_t), data, chan_gain);
+		}
+
+		ofs += mapped;
+	}
+}
+
+static uint8_t *splayer_staging_buffer(StreamPlayer *plr, size_t size) {
+	if(UNLIKELY(plr->staging_buffer_size < size)) {
+		// Normally only happens once, unless the device changes its buffer size
+		mem_free(plr->staging_buffer);
+		plr->staging_buffer = mem_alloc(size);
+		plr->staging_buffer_size = size;
+	}
+
+	return plr->staging_buffer;
+}
+
 void splayer_process(StreamPlayer *plr, size_t bufsize, void *vbuffer) {
 	if(plr->paused) {
 		return;
@@ -157,10 +213,18 @@ void splayer_process(StreamPlayer *plr, size_t bufsize, void *vbuffer) {
 	int num_channels = plr->num_channels;
 	union audio_buffer out_buffer = { vbuffer };
 
+	// First half receives channel output, second half is scratch space for format conversion
+	uint8_t *staging_buffer_bytes = splayer_staging_buffer(plr, 2 * bufsize);
+	union audio_buffer staging_buffer = { staging_buffer_bytes };
+
 	for(int i = 0; i < num_channels; ++i) {
-		uint8_t staging_buffer_bytes[bufsize];
-		union audio_buffer staging_buffer = { staging_buffer_bytes };
-		size_t chan_bytes = splayer_process_channel(plr, i, sizeof(staging_buffer_bytes), staging_buffer_bytes);
+		if(splayer_can_mix_direct(plr->channels + i)) {
+			splayer_mix_channel_direct(plr, i, bufsize, out_buffer.samples, gain);
+			continue;
+		}
+
+		size_t chan_bytes = splayer_process_channel(
+			plr, i, bufsize, staging_buffer_bytes, staging_buffer_bytes + bufsize);
 
 		if(chan_bytes) {
 			assert(chan_bytes <= bufsize);
@@ -171,6 +235,10 @@ void splayer_process(StreamPlayer *plr, size_t bufsize, void *vbuffer) {
 			uint num_staging_frames = chan_bytes / sizeof(struct stereo_frame);
 			uint fade_steps = pchan->fade.num_steps;
 
+			// Muted channels still have to be read to keep their streams advancing, but there is
+			// no point in scaling or mixing their samples.
+			bool muted = chan_gain == 0;
+
 			if(fade_steps) {
 				float fade_step = pchan->fade.step;
 				float fade_gain = pchan->fade.gain;
@@ -179,10 +247,8 @@ void splayer_process(StreamPlayer *plr, size_t bufsize, void *vbuffer) {
 					fade_steps = num_staging_frames;
 				}
 
-				for(uint i = 0; i < fade_steps; ++i) {
-					float g = fade_gain + fade_step * i;
-					staging_buffer.frames[i].l *= g;
-					staging_buffer.frames[i].r *= g;
+				if(!muted) {
+					audio_fade_stereo_f32(fade_steps, staging_buffer.samples, fade_gain, fade_step);
 				}
 
 				if((pchan->fade.num_steps -= fade_steps) == 0) {
@@ -202,10 +268,12 @@ void splayer_process(StreamPlayer *plr, size_t bufsize, void *vbuffer) {
 				chan_gain *= pchan->fade.gain;
 			}
 
-			for(uint i = 0; i < num_staging_frames; ++i) {
-				out_buffer.frames[i].l += staging_buffer.frames[i].l * chan_gain;
-				out_buffer.frames[i].r += staging_buffer.frames[i].r * chan_gain;
+			if(muted || chan_gain == 0) {
+				continue;
 			}
+
+			audio_mix_f32(
+				num_staging_frames * 2, out_buffer.samples, staging_buffer.samples, chan_gain);
 		}
 	}
 }
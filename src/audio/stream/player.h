@@ -35,6 +35,8 @@ struct StreamPlayer {
 	StreamPlayerChannel *channels;
 	LIST_ANCHOR(StreamPlayerChannel) channel_history;
 	AudioStreamSpec dst_spec;
+	uint8_t *staging_buffer;
+	size_t staging_buffer_size;
 	float gain;
 	int num_channels;
 	bool paused;
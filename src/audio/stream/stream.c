@@ -98,6 +98,31 @@ ssize_t astream_read(AudioStream *stream, size_t bufsize, void *buffer, AudioStr
 	return PROC(stream, read)(stream, bufsize, buffer);
 }
 
+ssize_t astream_map(AudioStream *stream, size_t bufsize, const void **data, AudioStreamReadFlags flags) {
+	assert(!(flags & ASTREAM_READ_MAX_FILL));
+
+	ssize_t mapped = PROC(stream, map)(stream, bufsize, data);
+
+	if(UNLIKELY(mapped == 0) && (flags & ASTREAM_READ_LOOP)) {
+		ssize_t loop_start = stream->loop_start;
+		if(loop_start < 0) {
+			loop_start = 0;
+		}
+
+		if(UNLIKELY(astream_seek(stream, loop_start) < 0)) {
+			return -1;
+		}
+
+		return PROC(stream, map)(stream, bufsize, data);
+	}
+
+	return mapped;
+}
+
+bool astream_can_map(AudioStream *stream) {
+	return PROCS(stream).map;
+}
+
 ssize_t astream_read_into_sdl_stream(AudioStream *stream, SDL_AudioStream *sdlstream, size_t bufsize, void *buffer, AudioStreamReadFlags flags) {
 	char *buf = buffer;
 	ssize_t read_size = astream_read(stream, bufsize, buf, flags);
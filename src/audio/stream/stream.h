@@ -23,6 +23,8 @@ typedef enum AudioStreamMetaTag {
 
 struct AudioStreamProcs {
 	ssize_t (*read)(AudioStream *s, size_t bufsize, void *buffer);
+	// Optional; like read, but returns a pointer into memory owned by the stream instead of copying
+	ssize_t (*map)(AudioStream *s, size_t bufsize, const void **data);
 	ssize_t (*tell)(AudioStream *s);
 	ssize_t (*seek)(AudioStream *s, size_t pos);
 	const char *(*meta)(AudioStream *s, AudioStreamMetaTag tag);
@@ -53,6 +55,8 @@ typedef enum AudioStreamReadFlags {
 bool astream_open(AudioStream *stream, SDL_IOStream *rwops, const char *filename) attr_nonnull_all;
 void astream_close(AudioStream *stream) attr_nonnull_all;
 ssize_t astream_read(AudioStream *stream, size_t bufsize, void *buffer, AudioStreamReadFlags flags) attr_nonnull_all;
+ssize_t astream_map(AudioStream *stream, size_t bufsize, const void **data, AudioStreamReadFlags flags) attr_nonnull_all;
+bool astream_can_map(AudioStream *stream) attr_nonnull_all;
 ssize_t astream_read_into_sdl_stream(AudioStream *stream, SDL_AudioStream *sdlstream, size_t bufsize, void *buffer, AudioStreamReadFlags flags) attr_nonnull_all;
 ssize_t astream_seek(AudioStream *stream, size_t pos) attr_nonnull_all;
 ssize_t astream_tell(AudioStream *stream) attr_nonnull_all;
@@ -11,7 +11,7 @@
 #include "log.h"
 #include "util.h"
 
-static ssize_t astream_pcm_read(AudioStream *stream, size_t buffer_size, void *buffer) {
+static ssize_t astream_pcm_map(AudioStream *stream, size_t buffer_size, const void **data) {
 	PCMStreamContext *ctx = NOT_NULL(stream->opaque);
 
 	assume(ctx->pos <= ctx->end);
@@ -22,9 +22,18 @@ static ssize_t astream_pcm_read(AudioStream *stream, size_t buffer_size, void *b
 		read_size = (buffer_size / frame_size) * frame_size;
 	}
 
+	*data = ctx->pos;
+	ctx->pos += read_size;
+
+	return read_size;
+}
+
+static ssize_t astream_pcm_read(AudioStream *stream, size_t buffer_size, void *buffer) {
+	const void *data;
+	ssize_t read_size = astream_pcm_map(stream, buffer_size, &data);
+
 	if(read_size > 0) {
-		memcpy(buffer, ctx->pos, read_size);
-		ctx->pos += read_size;
+		memcpy(buffer, data, read_size);
 	}
 
 	return read_size;
@@ -66,6 +75,7 @@ static void astream_pcm_static_close(AudioStream *stream) {
 static AudioStreamProcs astream_pcm_procs = {
 	.free = astream_pcm_free,
 	.read = astream_pcm_read,
+	.map = astream_pcm_map,
 	.seek = astream_pcm_seek,
 	.tell = astream_pcm_tell,
 };
@@ -73,6 +83,7 @@ static AudioStreamProcs astream_pcm_procs = {
 static AudioStreamProcs astream_pcm_static_procs = {
 	.free = astream_pcm_static_close,
 	.read = astream_pcm_read,
+	.map = astream_pcm_map,
 	.seek = astream_pcm_seek,
 	.tell = astream_pcm_tell,
 };
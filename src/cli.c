@@ -31,6 +31,12 @@ enum {
 	OPT_REREPLAY,
 	OPT_POPCACHE,
 	OPT_UNLOCKALL,
+	OPT_BENCHMARK_REPLAY,
+	OPT_BENCHMARK_RUNS,
+	OPT_BENCHMARK_REPORT,
+	OPT_BENCHMARK_STAGE,
+	OPT_BENCHMARK_FRAMES,
+	OPT_VERIFY_REPLAYS,
 };
 
 static void print_help(struct TsOption* opts) {
@@ -70,7 +76,13 @@ int cli_args(int argc, char **argv, CLIAction *a) {
 	struct TsOption taisei_opts[] = {
 		{{"replay",             required_argument,  0, 'r'},            "Play a replay from FILE", "FILE"},
 		{{"verify-replay",      required_argument,  0, 'R'},            "Play a replay from FILE in headless mode, crash as soon as it desyncs unless --rereplay is used", "FILE"},
+		{{"verify-replays",     required_argument,  0, OPT_VERIFY_REPLAYS}, "Verify all replays in DIR in parallel headless worker processes and report the results", "DIR"},
 		{{"rereplay",           required_argument,  0, OPT_REREPLAY},   "Re-record replay into OUTFILE; specify input with -r or -R", "OUTFILE"},
+		{{"benchmark-replay",   required_argument,  0, OPT_BENCHMARK_REPLAY}, "Play a replay from FILE in headless mode several times and report logic performance", "FILE"},
+		{{"benchmark-stage",    required_argument,  0, OPT_BENCHMARK_STAGE}, "Play stage ID without input in headless mode several times and report performance", "ID"},
+		{{"benchmark-runs",     required_argument,  0, OPT_BENCHMARK_RUNS}, "Number of runs for --benchmark-replay or --benchmark-stage (default 3)", "N"},
+		{{"benchmark-frames",   required_argument,  0, OPT_BENCHMARK_FRAMES}, "Stop each benchmark run after N logic frames (default 1800 for --benchmark-stage)", "N"},
+		{{"benchmark-report",   required_argument,  0, OPT_BENCHMARK_REPORT}, "Write the benchmark report to OUTFILE (.json or .csv, - for stdout)", "OUTFILE"},
 #ifdef DEBUG
 		{{"play",               no_argument,        0, 'p'},            "Play a specific stage"},
 		{{"sid",                required_argument,  0, 'i'},            "Select stage by ID", "ID"},
@@ -151,6 +163,39 @@ int cli_args(int argc, char **argv, CLIAction *a) {
 		case 'R':
 			a->type = CLI_VerifyReplay;
 			stralloc(&a->filename, optarg);
+			break;
+		case OPT_VERIFY_REPLAYS:
+			a->type = CLI_VerifyReplays;
+			stralloc(&a->filename, optarg);
+			break;
+		case OPT_BENCHMARK_REPLAY:
+			a->type = CLI_BenchmarkReplay;
+			stralloc(&a->filename, optarg);
+			break;
+		case OPT_BENCHMARK_RUNS:
+			a->benchmark_runs = strtol(optarg, &endptr, 10);
+
+			if(!*optarg || *endptr || a->benchmark_runs < 1) {
+				log_fatal("Invalid number of benchmark runs '%s'", optarg);
+			}
+
+			break;
+		case OPT_BENCHMARK_REPORT:
+			stralloc(&a->benchmark_report, optarg);
+			break;
+		case OPT_BENCHMARK_STAGE:
+			a->type = CLI_BenchmarkStage;
+			stageid = strtol(optarg, &endptr, 16);
+			if(!*optarg || endptr == optarg)
+				log_fatal("Stage id '%s' is not a number", optarg);
+			break;
+		case OPT_BENCHMARK_FRAMES:
+			a->benchmark_frames = strtol(optarg, &endptr, 10);
+
+			if(!*optarg || *endptr || a->benchmark_frames < 1) {
+				log_fatal("Invalid number of benchmark frames '%s'", optarg);
+			}
+
 			break;
 		case OPT_REREPLAY:
 			stralloc(&a->out_replay, optarg);
@@ -270,6 +315,8 @@ int cli_args(int argc, char **argv, CLIAction *a) {
 		switch(a->type) {
 			case CLI_PlayReplay:
 			case CLI_VerifyReplay:
+			case CLI_BenchmarkReplay:
+			case CLI_BenchmarkStage:
 			case CLI_SelectStage:
 				if(stageinfo_get_by_id(stageid) == NULL) {
 					log_fatal("Invalid stage id: %X", stageid);
@@ -300,6 +347,22 @@ int cli_args(int argc, char **argv, CLIAction *a) {
 		log_fatal("--rereplay requires --replay or --verify-replay");
 	}
 
+	if(a->type == CLI_BenchmarkStage && !stageid) {
+		log_fatal("Stage benchmark mode, but no stage id was given");
+	}
+
+	if(a->type == CLI_BenchmarkReplay || a->type == CLI_BenchmarkStage) {
+		if(!a->benchmark_runs) {
+			a->benchmark_runs = 3;
+		}
+
+		if(!a->benchmark_frames && a->type == CLI_BenchmarkStage) {
+			a->benchmark_frames = 1800;
+		}
+	} else if(a->benchmark_runs || a->benchmark_frames || a->benchmark_report) {
+		log_warn("--benchmark-runs, --benchmark-frames and --benchmark-report require --benchmark-replay or --benchmark-stage");
+	}
+
 	return 0;
 }
 
@@ -308,4 +371,6 @@ void free_cli_action(CLIAction *a) {
 	a->filename = NULL;
 	mem_free(a->out_replay);
 	a->out_replay = NULL;
+	mem_free(a->benchmark_report);
+	a->benchmark_report = NULL;
 }
@@ -15,6 +15,9 @@ typedef enum {
 	CLI_RunNormally = 0,
 	CLI_PlayReplay,
 	CLI_VerifyReplay,
+	CLI_VerifyReplays,
+	CLI_BenchmarkReplay,
+	CLI_BenchmarkStage,
 	CLI_SelectStage,
 	CLI_DumpStages,
 	CLI_DumpVFSTree,
@@ -28,11 +31,14 @@ typedef struct CLIAction CLIAction;
 struct CLIAction {
 	char *filename;
 	char *out_replay;
+	char *benchmark_report;
 	PlayerMode *plrmode;
 	CLIActionType type;
 	int stageid;
 	int diff;
 	int frameskip;
+	int benchmark_runs;
+	int benchmark_frames;
 	CutsceneID cutscene;
 	bool force_intro;
 	bool unlock_all;
@@ -0,0 +1,255 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "collision_grid.h"
+
+#include "boss.h"
+#include "coroutine/cotask.h"
+#include "dynarray.h"
+#include "enemy.h"
+#include "global.h"
+#include "util/env.h"
+
+#define GRID_CELL_SIZE 64
+// ceil(VIEWPORT_W / GRID_CELL_SIZE), ceil(VIEWPORT_H / GRID_CELL_SIZE)
+#define GRID_COLS 8
+#define GRID_ROWS 9
+#define GRID_NUM_CELLS (GRID_COLS * GRID_ROWS)
+
+// Extra space around binned bounding boxes, so that rounding errors can't make us miss a hit.
+#define GRID_BBOX_PADDING 1.0
+
+#define BOSS_HIT_RADIUS 42
+
+typedef struct GridSpan {
+	Enemy *enemy;
+	uint8_t x0, y0, x1, y1;
+} GridSpan;
+
+static struct {
+	CollisionGridMode mode;
+	bool in_pass;
+	bool valid;
+	uint32_t built_at_resume_count;
+
+	Boss *boss;
+	GridSpan boss_span;
+
+	// CSR layout: entries of cell i are entries[cell_start[i] .. cell_start[i + 1]), in list order.
+	uint cell_start[GRID_NUM_CELLS + 1];
+	uint cell_cursor[GRID_NUM_CELLS];
+	DYNAMIC_ARRAY(Enemy*) entries;
+	DYNAMIC_ARRAY(GridSpan) spans;
+} grid;
+
+void collision_grid_init(void) {
+	grid.mode = env_get("TAISEI_COLLISION_GRID", COLGRID_MODE_ENABLED);
+
+	if((uint)grid.mode > COLGRID_MODE_VERIFY) {
+		log_warn("Bad TAISEI_COLLISION_GRID value %i, using default", grid.mode);
+		grid.mode = COLGRID_MODE_ENABLED;
+	}
+
+	grid.in_pass = false;
+	grid.valid = false;
+}
+
+void collision_grid_shutdown(void) {
+	dynarray_free_data(&grid.entries);
+	dynarray_free_data(&grid.spans);
+	grid.in_pass = false;
+	grid.valid = false;
+}
+
+void collision_grid_set_mode(CollisionGridMode mode) {
+	assert((uint)mode <= COLGRID_MODE_VERIFY);
+	grid.mode = mode;
+	grid.valid = false;
+}
+
+CollisionGridMode collision_grid_get_mode(void) {
+	return grid.mode;
+}
+
+void collision_grid_begin_pass(void) {
+	assert(!grid.in_pass);
+	grid.in_pass = true;
+	grid.valid = false;
+}
+
+void collision_grid_end_pass(void) {
+	assert(grid.in_pass);
+	grid.in_pass = false;
+	grid.valid = false;
+}
+
+static inline bool enemy_hit_test(Enemy *e, cmplx pos) {
+	return
+		!(e->flags & EFLAG_NO_HIT) &&
+		cabs2(e->pos - pos) < e->hit_radius * e->hit_radius;
+}
+
+static inline bool boss_hit_test(Boss *boss, cmplx pos) {
+	return
+		boss &&
+		boss_is_vulnerable(boss) &&
+		cabs2(boss->pos - pos) < BOSS_HIT_RADIUS * BOSS_HIT_RADIUS;
+}
+
+static EntityInterface *find_target_linear(cmplx pos) {
+	for(Enemy *e = global.enemies.first; e; e = e->next) {
+		if(enemy_hit_test(e, pos)) {
+			return &e->ent;
+		}
+	}
+
+	if(boss_hit_test(global.boss, pos)) {
+		return &global.boss->ent;
+	}
+
+	return NULL;
+}
+
+static inline int grid_coord(double v, int num_cells) {
+	double c = floor(v * (1.0 / GRID_CELL_SIZE));
+
+	// NOTE: also handles NaN
+	if(!(c > 0)) {
+		return 0;
+	}
+
+	if(c >= num_cells - 1) {
+		return num_cells - 1;
+	}
+
+	return (int)c;
+}
+
+static inline int grid_cell(cmplx pos) {
+	return grid_coord(im(pos), GRID_ROWS) * GRID_COLS + grid_coord(re(pos), GRID_COLS);
+}
+
+static GridSpan grid_span(cmplx center, double radius) {
+	double ext = fabs(radius) + GRID_BBOX_PADDING;
+
+	return (GridSpan) {
+		.x0 = grid_coord(re(center) - ext, GRID_COLS),
+		.y0 = grid_coord(im(center) - ext, GRID_ROWS),
+		.x1 = grid_coord(re(center) + ext, GRID_COLS),
+		.y1 = grid_coord(im(center) + ext, GRID_ROWS),
+	};
+}
+
+static inline bool grid_span_contains(const GridSpan *s, int cell) {
+	int x = cell % GRID_COLS;
+	int y = cell / GRID_COLS;
+	return x >= s->x0 && x <= s->x1 && y >= s->y0 && y <= s->y1;
+}
+
+static void grid_build(void) {
+	memset(grid.cell_start, 0, sizeof(grid.cell_start));
+	grid.spans.num_elements = 0;
+
+	for(Enemy *e = global.enemies.first; e; e = e->next) {
+		// Only task code can clear EFLAG_NO_HIT, and we rebuild after any task runs.
+		if(e->flags & EFLAG_NO_HIT) {
+			continue;
+		}
+
+		// Can never pass the hit test (this also filters out NaNs).
+		if(!(e->hit_radius * e->hit_radius > 0)) {
+			continue;
+		}
+
+		GridSpan *s = dynarray_append(&grid.spans);
+		*s = grid_span(e->pos, e->hit_radius);
+		s->enemy = e;
+
+		for(int y = s->y0; y <= s->y1; ++y) {
+			for(int x = s->x0; x <= s->x1; ++x) {
+				++grid.cell_start[y * GRID_COLS + x + 1];
+			}
+		}
+	}
+
+	for(int i = 0; i < GRID_NUM_CELLS; ++i) {
+		grid.cell_start[i + 1] += grid.cell_start[i];
+		grid.cell_cursor[i] = grid.cell_start[i];
+	}
+
+	uint num_entries = grid.cell_start[GRID_NUM_CELLS];
+	dynarray_ensure_capacity(&grid.entries, num_entries);
+	grid.entries.num_elements = num_entries;
+
+	dynarray_foreach_elem(&grid.spans, GridSpan *s, {
+		for(int y = s->y0; y <= s->y1; ++y) {
+			for(int x = s->x0; x <= s->x1; ++x) {
+				grid.entries.data[grid.cell_cursor[y * GRID_COLS + x]++] = s->enemy;
+			}
+		}
+	});
+
+	grid.boss = global.boss;
+
+	if(grid.boss) {
+		grid.boss_span = grid_span(grid.boss->pos, BOSS_HIT_RADIUS);
+	}
+
+	grid.built_at_resume_count = cotask_get_resume_count();
+	grid.valid = true;
+}
+
+static EntityInterface *find_target_grid(cmplx pos) {
+	if(
+		!grid.valid ||
+		grid.built_at_resume_count != cotask_get_resume_count() ||
+		grid.boss != global.boss
+	) {
+		grid_build();
+	}
+
+	int cell = grid_cell(pos);
+	Enemy **entries = grid.entries.data;
+
+	for(uint i = grid.cell_start[cell]; i < grid.cell_start[cell + 1]; ++i) {
+		if(enemy_hit_test(entries[i], pos)) {
+			return &entries[i]->ent;
+		}
+	}
+
+	if(
+		grid.boss &&
+		grid_span_contains(&grid.boss_span, cell) &&
+		boss_hit_test(grid.boss, pos)
+	) {
+		return &grid.boss->ent;
+	}
+
+	return NULL;
+}
+
+EntityInterface *collision_grid_find_shot_target(cmplx pos) {
+	if(!grid.in_pass || grid.mode == COLGRID_MODE_DISABLED) {
+		return find_target_linear(pos);
+	}
+
+	EntityInterface *target = find_target_grid(pos);
+
+	if(UNLIKELY(grid.mode == COLGRID_MODE_VERIFY)) {
+		EntityInterface *expected = find_target_linear(pos);
+
+		if(target != expected) {
+			log_fatal(
+				"Collision grid mismatch at %f%+fi on frame %i: got %p, expected %p",
+				re(pos), im(pos), global.frames, (void*)target, (void*)expected
+			);
+		}
+	}
+
+	return target;
+}
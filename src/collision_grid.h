@@ -0,0 +1,41 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "entity.h"
+
+/*
+ * Broadphase for player shots vs. enemies and the boss.
+ *
+ * Targets are binned into a uniform grid over the viewport. The grid is built lazily on the
+ * first query of a pass (see collision_grid_begin_pass()), and rebuilt whenever any coroutine
+ * task has been resumed since the last build, because task code may spawn, move, or delete
+ * enemies at any time. Query results are always identical to a linear scan over
+ * global.enemies (in list order) followed by the boss check.
+ */
+
+typedef enum CollisionGridMode {
+	COLGRID_MODE_DISABLED,  // always do the linear scan
+	COLGRID_MODE_ENABLED,   // use the grid during passes
+	COLGRID_MODE_VERIFY,    // use the grid and cross-check every query against the linear scan
+} CollisionGridMode;
+
+void collision_grid_init(void);
+void collision_grid_shutdown(void);
+
+void collision_grid_set_mode(CollisionGridMode mode);
+CollisionGridMode collision_grid_get_mode(void);
+
+// Outside of a pass, queries always fall back to the linear scan.
+void collision_grid_begin_pass(void);
+void collision_grid_end_pass(void);
+
+// Returns the first enemy (or the boss) that a player shot at pos collides with, or NULL.
+EntityInterface *collision_grid_find_shot_target(cmplx pos);
@@ -23,12 +23,12 @@ DECLARE_EXTERN_TASK(
 	{ cmplx *pos; ItemCounts items; }
 );
 
-DECLARE_EXTERN_TASK(
+DECLARE_EXTERN_TASK_SMALL_STACK(
 	common_move,
 	{ cmplx *pos; MoveParams move_params; BoxedEntity ent; }
 );
 
-DECLARE_EXTERN_TASK(
+DECLARE_EXTERN_TASK_SMALL_STACK(
 	common_move_ext,
 	{ cmplx *pos; MoveParams *move_params; BoxedEntity ent; }
 );
@@ -43,8 +43,9 @@ void coroutines_draw_stats(void) {
 	tp.pos.y += ls;
 
 #ifdef CO_TASK_STATS_STACK
-	snprintf(buf, sizeof(buf), "Peak stack: %zukb    Tasks: %4zu / %4zu ",
-		STAT_VAL(peak_stack_usage) / 1024,
+	snprintf(buf, sizeof(buf), "Peak stack: %zu/%zukb    Tasks: %4zu / %4zu ",
+		STAT_VAL(peak_stack_usage[CO_STACK_DEFAULT]) / 1024,
+		STAT_VAL(peak_stack_usage[CO_STACK_SMALL]) / 1024,
 		STAT_VAL(num_tasks_in_use),
 		STAT_VAL(num_tasks_allocated)
 	);
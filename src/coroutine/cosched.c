@@ -15,9 +15,9 @@ void cosched_init(CoSched *sched) {
 	*sched = (typeof(*sched)) {};
 }
 
-CoTask *_cosched_new_task(CoSched *sched, CoTaskFunc func, void *arg, size_t arg_size, bool is_subtask, CoTaskDebugInfo debug) {
+CoTask *_cosched_new_task(CoSched *sched, CoTaskFunc func, void *arg, size_t arg_size, bool is_subtask, CoStackClass stack_class, CoTaskDebugInfo debug) {
 	assume(sched != NULL);
-	CoTask *task = cotask_new_internal(cotask_entry);
+	CoTask *task = cotask_new_internal(cotask_entry, stack_class);
 	task->name = debug.label;
 
 #ifdef CO_TASK_DEBUG
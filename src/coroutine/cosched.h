@@ -18,10 +18,10 @@ struct CoSched {
 };
 
 void cosched_init(CoSched *sched);
-CoTask *_cosched_new_task(CoSched *sched, CoTaskFunc func, void *arg, size_t arg_size, bool is_subtask, CoTaskDebugInfo debug);  // creates and runs the task, schedules it for resume on cosched_run_tasks if it's still alive
-#define cosched_new_task(sched, func, arg, arg_size, debug_label) \
-	_cosched_new_task(sched, func, arg, arg_size, false, COTASK_DEBUG_INFO(debug_label))
-#define cosched_new_subtask(sched, func, arg, arg_size, debug_label) \
-	_cosched_new_task(sched, func, arg, arg_size, true, COTASK_DEBUG_INFO(debug_label))
+CoTask *_cosched_new_task(CoSched *sched, CoTaskFunc func, void *arg, size_t arg_size, bool is_subtask, CoStackClass stack_class, CoTaskDebugInfo debug);  // creates and runs the task, schedules it for resume on cosched_run_tasks if it's still alive
+#define cosched_new_task(sched, func, arg, arg_size, stack_class, debug_label) \
+	_cosched_new_task(sched, func, arg, arg_size, false, stack_class, COTASK_DEBUG_INFO(debug_label))
+#define cosched_new_subtask(sched, func, arg, arg_size, stack_class, debug_label) \
+	_cosched_new_task(sched, func, arg, arg_size, true, stack_class, COTASK_DEBUG_INFO(debug_label))
 uint cosched_run_tasks(CoSched *sched);  // returns number of tasks ran
 void cosched_finish(CoSched *sched);
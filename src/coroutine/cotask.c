@@ -12,8 +12,17 @@
 #include "log.h"
 #include "thread.h"
 
-static CoTaskList task_pool;
+// Finished tasks are kept for reuse along with their stacks, separately for each stack class
+static struct {
+	CoTaskList free_tasks;
+	CoTaskPoolStats stats;
+} task_pools[CO_NUM_STACK_CLASSES] = {
+	[CO_STACK_DEFAULT].stats.stack_size = CO_STACK_SIZE,
+	[CO_STACK_SMALL].stats.stack_size = CO_STACK_SIZE_SMALL,
+};
+
 static koishi_coroutine_t *co_main;
+static uint32_t resume_count;
 
 #ifdef CO_TASK_DEBUG
 size_t _cotask_debug_event_id;
@@ -25,6 +34,13 @@ CoTaskStats cotask_stats;
 
 #ifdef CO_TASK_STATS_STACK
 
+static const char *const stack_class_names[] = {
+	[CO_STACK_DEFAULT] = "default",
+	[CO_STACK_SMALL] = "small",
+};
+
+static_assert(ARRAY_SIZE(stack_class_names) == CO_NUM_STACK_CLASSES);
+
 /*
  * Crude and simple method to estimate stack usage per task: at init time, fill
  * the entire stack with a known 32-bit pattern (the "canary"). The canary is
@@ -133,15 +149,43 @@ static void estimate_stack_usage(CoTask *task) {
 	size_t usage = (uintptr_t)(first_segment + num_segments - p_canary) * sizeof(canary) + STACK_BUFFER_UPPER;
 	double percentage = usage / (double)real_stack_size;
 
-	if(usage > STAT_VAL(peak_stack_usage)) {
+	if(usage > STAT_VAL(peak_stack_usage[task->stack_class])) {
+		// Leave the same headroom as for the default size: double the usage, rounded up
+		size_t wanted = topow2_u64(usage) * 2;
+		CoStackClass recommended = CO_NUM_STACK_CLASSES;
+
+		for(CoStackClass c = 0; c < CO_NUM_STACK_CLASSES; ++c) {
+			size_t size = task_pools[c].stats.stack_size;
+
+			if(size >= wanted && (
+				recommended == CO_NUM_STACK_CLASSES || size < task_pools[recommended].stats.stack_size
+			)) {
+				recommended = c;
+			}
+		}
+
 		TASK_DEBUG(">>> %s <<<", task->debug_label);
-		log_debug("New peak stack usage: %zu out of %zu (%.02f%%); recommended CO_STACK_SIZE >= %zu",
-			usage,
-			real_stack_size,
-			percentage * 100,
-			(size_t)(topow2_u64(usage) * 2)
-		);
-		STAT_VAL_SET(peak_stack_usage, usage);
+
+		if(recommended < CO_NUM_STACK_CLASSES) {
+			log_debug("New peak stack usage in %s class: %zu out of %zu (%.02f%%); recommended class: %s",
+				stack_class_names[task->stack_class],
+				usage,
+				real_stack_size,
+				percentage * 100,
+				stack_class_names[recommended]
+			);
+		} else {
+			log_debug("New peak stack usage in %s class: %zu out of %zu (%.02f%%); "
+				"no class is large enough, recommended CO_STACK_SIZE >= %zu",
+				stack_class_names[task->stack_class],
+				usage,
+				real_stack_size,
+				percentage * 100,
+				wanted
+			);
+		}
+
+		STAT_VAL_SET(peak_stack_usage[task->stack_class], usage);
 	}
 }
 
@@ -158,12 +202,22 @@ void cotask_global_init(void) {
 }
 
 void cotask_global_shutdown(void) {
-	for(CoTask *task; (task = alist_pop(&task_pool));) {
-		koishi_deinit(&task->ko);
-		mem_free(task);
+	for(uint i = 0; i < ARRAY_SIZE(task_pools); ++i) {
+		auto pool = &task_pools[i];
+
+		for(CoTask *task; (task = alist_pop(&pool->free_tasks));) {
+			koishi_deinit(&task->ko);
+			mem_free(task);
+			--pool->stats.num_allocated;
+		}
 	}
 }
 
+CoTaskPoolStats cotask_get_pool_stats(CoStackClass stack_class) {
+	assert((uint)stack_class < ARRAY_SIZE(task_pools));
+	return task_pools[stack_class].stats;
+}
+
 attr_nonnull_all attr_returns_nonnull
 INLINE CoTask *cotask_from_koishi_coroutine(koishi_coroutine_t *co) {
 	return CASTPTR_ASSUME_ALIGNED((char*)co - offsetof(CoTask, ko), CoTask);
@@ -196,11 +250,15 @@ CoTask *cotask_unbox_notnull(BoxedTask box) {
 	return NULL;
 }
 
-CoTask *cotask_new_internal(koishi_entrypoint_t entry_point) {
+CoTask *cotask_new_internal(koishi_entrypoint_t entry_point, CoStackClass stack_class) {
+	assert((uint)stack_class < ARRAY_SIZE(task_pools));
+	auto pool = &task_pools[stack_class];
+
 	CoTask *task;
 	STAT_VAL_ADD(num_tasks_in_use, 1);
+	++pool->stats.num_used;
 
-	if((task = alist_pop(&task_pool))) {
+	if((task = alist_pop(&pool->free_tasks))) {
 		koishi_recycle(&task->ko, entry_point);
 		TASK_DEBUG(
 			"Recycled task %p, entry=%p (%zu tasks allocated / %zu in use)",
@@ -209,8 +267,10 @@ CoTask *cotask_new_internal(koishi_entrypoint_t entry_point) {
 		);
 	} else {
 		task = ALLOC(typeof(*task));
-		koishi_init(&task->ko, CO_STACK_SIZE, entry_point);
+		task->stack_class = stack_class;
+		koishi_init(&task->ko, pool->stats.stack_size, entry_point);
 		STAT_VAL_ADD(num_tasks_allocated, 1);
+		++pool->stats.num_allocated;
 		TASK_DEBUG(
 			"Created new task %p, entry=%p (%zu tasks allocated / %zu in use)",
 			(void*)task, *(void**)&entry_point,
@@ -236,11 +296,16 @@ void *cotask_resume_internal(CoTask *task, void *arg) {
 	TASK_DEBUG_EVENT(ev);
 	TASK_DEBUG("[%zu] Resuming task %s", ev, task->debug_label);
 	STAT_VAL_ADD(num_switches_this_frame, 1);
+	++resume_count;
 	arg = koishi_resume(&task->ko, arg);
 	TASK_DEBUG("[%zu] koishi_resume returned (%s)", ev, task->debug_label);
 	return arg;
 }
 
+uint32_t cotask_get_resume_count(void) {
+	return resume_count;
+}
+
 static void cancel_task_events(CoTaskData *task_data) {
 	// HACK: This allows an entity-bound task to wait for its own "finished"
 	// event. Can be useful to do some cleanup without spawning a separate task
@@ -391,7 +456,10 @@ void cotask_free(CoTask *task) {
 	estimate_stack_usage(task);
 
 	task->unique_id = 0;
-	alist_push(&task_pool, task);
+
+	auto pool = &task_pools[task->stack_class];
+	alist_push(&pool->free_tasks, task);
+	--pool->stats.num_used;
 
 	STAT_VAL_ADD(num_tasks_in_use, -1);
 
@@ -476,7 +544,7 @@ static void cotask_force_cancel(CoTask *task) {
 	// CoTaskData, since we don't need any of the 'advanced' features for this.
 	// This also means we don't need to cotask_finalize it.
 
-	CoTask *cancel_task = cotask_new_internal(cotask_cancel_in_safe_context);
+	CoTask *cancel_task = cotask_new_internal(cotask_cancel_in_safe_context, CO_STACK_DEFAULT);
 
 	// This is basically just koishi_resume + some logging when built with CO_TASK_DEBUG.
 	// We can't use normal cotask_resume here, since we don't have CoTaskData.
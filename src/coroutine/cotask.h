@@ -27,6 +27,20 @@ typedef enum CoStatus {
 	CO_STATUS_DEAD      = KOISHI_DEAD,
 } CoStatus;
 
+// Stacks are pooled separately per class. Small stacks are meant for trivial tasks that get
+// spawned in large numbers, like per-bullet movement loops; see TASK_SMALL_STACK.
+typedef enum CoStackClass {
+	CO_STACK_DEFAULT,
+	CO_STACK_SMALL,
+	CO_NUM_STACK_CLASSES,
+} CoStackClass;
+
+typedef struct CoTaskPoolStats {
+	size_t stack_size;
+	uint num_used;
+	uint num_allocated;
+} CoTaskPoolStats;
+
 typedef struct BoxedTask {
 	alignas(alignof(void*)) uintptr_t ptr;
 	uint32_t unique_id;
@@ -74,5 +88,11 @@ void cotask_host_events(CoTask *task, uint num_events, CoEvent events[num_events
 CoSched *cotask_get_sched(CoTask *task);
 const char *cotask_get_name(CoTask *task) attr_nonnull(1);
 
+// Incremented every time any task is resumed (including cancellation finalizers).
+// If this value didn't change, then no task code could have run in the meantime.
+uint32_t cotask_get_resume_count(void);
+
+CoTaskPoolStats cotask_get_pool_stats(CoStackClass stack_class);
+
 BoxedTask cotask_box(CoTask *task);
 CoTask *cotask_unbox(BoxedTask box);
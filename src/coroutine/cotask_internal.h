@@ -13,8 +13,10 @@
 
 #ifdef __EMSCRIPTEN__
 	#define CO_STACK_SIZE (64 * 1024)
+	#define CO_STACK_SIZE_SMALL (16 * 1024)
 #else
 	#define CO_STACK_SIZE (256 * 1024)
+	#define CO_STACK_SIZE_SMALL (32 * 1024)
 #endif
 
 #ifdef CO_TASK_DEBUG
@@ -57,6 +59,7 @@ struct CoTask {
 	CoTaskData *data;
 
 	uint32_t unique_id;
+	CoStackClass stack_class;
 	const char *name;
 
 	char _end[0];
@@ -71,7 +74,7 @@ typedef struct CoTaskStats {
 	size_t num_tasks_allocated;
 	size_t num_tasks_in_use;
 	size_t num_switches_this_frame;
-	size_t peak_stack_usage;
+	size_t peak_stack_usage[CO_NUM_STACK_CLASSES];
 } CoTaskStats;
 extern CoTaskStats cotask_stats;
 
@@ -154,7 +157,7 @@ typedef struct CoTaskInitData {
 void cotask_global_init(void);
 void cotask_global_shutdown(void);
 
-CoTask *cotask_new_internal(koishi_entrypoint_t entry_point);
+CoTask *cotask_new_internal(koishi_entrypoint_t entry_point, CoStackClass stack_class);
 void *cotask_resume_internal(CoTask *task, void *arg);
 CoTask *cotask_unbox_notnull(BoxedTask box);
 void cotask_force_finish(CoTask *task);
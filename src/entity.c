@@ -10,9 +10,14 @@
 
 #include "dynarray.h"
 #include "global.h"
+#include "profiler.h"
 #include "renderer/api.h"
 #include "util.h"
 
+// If this many neighbours are out of order in the sorted part of the array (due to draw layer
+// changes), fall back to a full sort instead of fixing them up one by one.
+#define ENT_SORT_MAX_INVERSIONS 64
+
 typedef struct EntityDrawHook EntityDrawHook;
 typedef LIST_ANCHOR(EntityDrawHook) EntityDrawHookList;
 
@@ -22,9 +27,17 @@ struct EntityDrawHook {
 	void *arg;
 };
 
+typedef DYNAMIC_ARRAY(EntityInterface*) EntityPtrArray;
+
 static struct {
-	DYNAMIC_ARRAY(EntityInterface*) registered;
+	// Kept in draw order across frames. Unregistered entities leave NULL holes behind, which
+	// are compacted away lazily; newly registered ones are appended to the unsorted tail.
+	EntityPtrArray registered;
+	EntityPtrArray merge_buffer;
+	uint num_sorted;
+	uint num_removed;
 	uint32_t total_spawns;
+	bool drawing;
 
 	struct {
 		EntityDrawHookList pre_draw;
@@ -64,11 +77,14 @@ void ent_init(void) {
 }
 
 void ent_shutdown(void) {
-	if(entities.registered.num_elements) {
-		log_fatal_if_debug("%u entities were not properly unregistered, this is a bug!", entities.registered.num_elements);
+	uint num_alive = entities.registered.num_elements - entities.num_removed;
+
+	if(num_alive) {
+		log_fatal_if_debug("%u entities were not properly unregistered, this is a bug!", num_alive);
 	}
 
 	dynarray_free_data(&entities.registered);
+	dynarray_free_data(&entities.merge_buffer);
 
 	assert(entities.hooks.post_draw.first == NULL);
 	assert(entities.hooks.pre_draw.first == NULL);
@@ -83,15 +99,46 @@ void ent_register(EntityInterface *ent, EntityType type) {
 	dynarray_append(&entities.registered, ent);
 }
 
+static void ent_compact(void) {
+	EntityInterface **data = entities.registered.data;
+	uint num_elements = entities.registered.num_elements;
+	uint num_sorted = 0;
+	uint j = 0;
+
+	for(uint i = 0; i < num_elements; ++i) {
+		EntityInterface *ent = data[i];
+
+		if(ent) {
+			if(i < entities.num_sorted) {
+				++num_sorted;
+			}
+
+			data[ent->index = j++] = ent;
+		}
+	}
+
+	entities.registered.num_elements = j;
+	entities.num_sorted = num_sorted;
+	entities.num_removed = 0;
+}
+
 void ent_unregister(EntityInterface *ent) {
 	ent->spawn_id = 0;
 
-	// Fast non-order-preserving removal by moving the last element into the removed element's position.
+	// Leave a hole to preserve the draw order; holes are compacted away in bulk.
 
 	assert(ent->index < entities.registered.num_elements);
 	assert(dynarray_get(&entities.registered, ent->index) == ent);
-	EntityInterface *sub = entities.registered.data[--entities.registered.num_elements];
-	entities.registered.data[sub->index = ent->index] = sub;
+	entities.registered.data[ent->index] = NULL;
+
+	// Don't let the holes pile up if nothing is being drawn (e.g. headless replay playback).
+	// Indices must stay stable while ent_draw() iterates, though.
+	if(
+		++entities.num_removed > entities.registered.num_elements / 2 &&
+		!entities.drawing
+	) {
+		ent_compact();
+	}
 }
 
 static int ent_cmp(const void *ptr1, const void *ptr2) {
@@ -108,43 +155,124 @@ static int ent_cmp(const void *ptr1, const void *ptr2) {
 	return r;
 }
 
+static void ent_merge_tail(void) {
+	EntityInterface **data = entities.registered.data;
+	uint num_elements = entities.registered.num_elements;
+	uint mid = entities.num_sorted;
+
+	dynarray_ensure_capacity(&entities.merge_buffer, num_elements);
+	EntityInterface **out = entities.merge_buffer.data;
+	uint a = 0, b = mid, o = 0;
+
+	while(a < mid && b < num_elements) {
+		out[o++] = ent_cmp(data + b, data + a) < 0 ? data[b++] : data[a++];
+	}
+
+	memcpy(out + o, data + a, (mid - a) * sizeof(*data));
+	o += mid - a;
+	memcpy(out + o, data + b, (num_elements - b) * sizeof(*data));
+
+	entities.merge_buffer.num_elements = num_elements;
+	SWAP(entities.registered, entities.merge_buffer);
+	entities.merge_buffer.num_elements = 0;
+}
+
+static void ent_sort(void) {
+	// Draw order hardly changes between frames, so instead of sorting everything from scratch,
+	// fix up the few entities that changed their draw layers, then merge in the new arrivals.
+
+	if(entities.num_removed) {
+		ent_compact();
+	}
+
+	EntityInterface **data = entities.registered.data;
+	uint num_elements = entities.registered.num_elements;
+	uint num_sorted = entities.num_sorted;
+	uint inversions = 0;
+
+	for(uint i = 1; i < num_sorted; ++i) {
+		if(ent_cmp(data + i - 1, data + i) > 0 && ++inversions > ENT_SORT_MAX_INVERSIONS) {
+			break;
+		}
+	}
+
+	if(inversions > ENT_SORT_MAX_INVERSIONS) {
+		qsort(data, num_sorted, sizeof(*data), ent_cmp);
+	} else if(inversions > 0) {
+		for(uint i = 1; i < num_sorted; ++i) {
+			EntityInterface *ent = data[i];
+			uint j = i;
+
+			for(; j > 0 && ent_cmp(data + j - 1, &ent) > 0; --j) {
+				data[j] = data[j - 1];
+			}
+
+			data[j] = ent;
+		}
+	}
+
+	if(num_sorted < num_elements) {
+		qsort(data + num_sorted, num_elements - num_sorted, sizeof(*data), ent_cmp);
+
+		if(num_sorted > 0 && ent_cmp(data + num_sorted - 1, data + num_sorted) > 0) {
+			ent_merge_tail();
+		}
+	}
+
+	data = entities.registered.data;
+
+	for(uint i = 0; i < num_elements; ++i) {
+		data[i]->index = i;
+	}
+
+	entities.num_sorted = num_elements;
+}
+
 static inline bool ent_is_drawable(EntityInterface *ent) {
 	return (ent->draw_layer & ~LAYER_LOW_MASK) > LAYER_NODRAW && ent->draw_func;
 }
 
 void ent_draw(EntityPredicate predicate) {
+	PROFILE_BEGIN(ent_draw);
 	call_hooks(&entities.hooks.pre_draw, NULL);
-	dynarray_qsort(&entities.registered, ent_cmp);
+	ent_sort();
+
+	// One state scope for the whole pass; rolling it back after each entity is much cheaper
+	// than a push/pop pair when the entity didn't touch any state.
+	entities.drawing = true;
+	r_state_push();
+
+	// NOTE: entities may be unregistered from draw callbacks, leaving holes behind.
 
 	if(predicate) {
-		dynarray_foreach(&entities.registered, int i, EntityInterface **pent, {
+		dynarray_foreach_elem(&entities.registered, EntityInterface **pent, {
 			EntityInterface *ent = *pent;
-			ent->index = i;
 
-			if(ent_is_drawable(ent) && predicate(ent)) {
+			if(ent && ent_is_drawable(ent) && predicate(ent)) {
 				call_hooks(&entities.hooks.pre_draw, ent);
-				r_state_push();
 				ent->draw_func(ent);
-				r_state_pop();
+				r_state_rollback();
 				call_hooks(&entities.hooks.post_draw, ent);
 			}
 		});
 	} else {
-		dynarray_foreach(&entities.registered, int i, EntityInterface **pent, {
+		dynarray_foreach_elem(&entities.registered, EntityInterface **pent, {
 			EntityInterface *ent = *pent;
-			ent->index = i;
 
-			if(ent_is_drawable(ent)) {
+			if(ent && ent_is_drawable(ent)) {
 				call_hooks(&entities.hooks.pre_draw, ent);
-				r_state_push();
 				ent->draw_func(ent);
-				r_state_pop();
+				r_state_rollback();
 				call_hooks(&entities.hooks.post_draw, ent);
 			}
 		});
 	}
 
+	r_state_pop();
+	entities.drawing = false;
+
 	call_hooks(&entities.hooks.post_draw, NULL);
+	PROFILE_END(ent_draw);
 }
 
 DamageResult ent_damage(EntityInterface *ent, const DamageInfo *damage) {
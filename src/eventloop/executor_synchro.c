@@ -91,7 +91,11 @@ void eventloop_run(void) {
 			}
 		}
 
-		if((uncapped_rendering || !(frame_num % get_effective_frameskip())) && !global.is_replay_verification) {
+		// Benchmarks render to the null backend, to measure the cost of draw submission
+		if(
+			(uncapped_rendering || !(frame_num % get_effective_frameskip())) &&
+			(!global.is_replay_verification || global.is_benchmark)
+		) {
 			run_render_frame(frame);
 		}
 
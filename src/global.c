@@ -22,9 +22,14 @@ void init_global(CLIAction *cli) {
 
 	global.frameskip = cli->frameskip;
 
-	if(cli->type == CLI_VerifyReplay) {
+	if(
+		cli->type == CLI_VerifyReplay ||
+		cli->type == CLI_BenchmarkReplay ||
+		cli->type == CLI_BenchmarkStage
+	) {
 		global.is_headless = true;
 		global.is_replay_verification = true;
+		global.is_benchmark = (cli->type != CLI_VerifyReplay);
 		global.frameskip = 1;
 	} else if(global.frameskip) {
 		log_warn("FPS limiter disabled. Gotta go fast! (frameskip = %i)", global.frameskip);
@@ -99,6 +99,7 @@ typedef struct {
 	uint is_practice_mode : 1;
 	uint is_headless : 1;
 	uint is_replay_verification : 1;
+	uint is_benchmark : 1;
 	uint is_kiosk_mode : 1;
 } Global;
 
@@ -441,7 +441,7 @@ static void laserdraw_pass1_render(void) {
 		BLENDFACTOR_SRC_ALPHA, BLENDFACTOR_DST_ALPHA, BLENDOP_MIN
 	));
 	r_shader_ptr(ldraw.shaders.sdf_generate);
-	r_uniform_float("sdf_range", LASER_SDF_RANGE);
+	r_uniform_float(R_UNIFORM("sdf_range"), LASER_SDF_RANGE);
 	r_mat_proj_push_ortho(PACKING_SPACE_SIZE_W, PACKING_SPACE_SIZE_H);
 	r_draw_model_ptr(&ldraw.pass1.quad, ldraw.render_state.pass1_num_segments, 0);
 	r_mat_proj_pop();
@@ -453,8 +453,8 @@ static void laserdraw_pass2_render(void) {
 	r_state_push();
 	r_shader_ptr(ldraw.shaders.sdf_apply);
 	Texture *tex = r_framebuffer_get_attachment(ldraw.fb.sdf, FRAMEBUFFER_ATTACH_COLOR0);
-	r_uniform_sampler("tex", tex);
-	r_uniform_vec2("texsize", PACKING_SPACE_SIZE_W, PACKING_SPACE_SIZE_H);
+	r_uniform_sampler(R_UNIFORM("tex"), tex);
+	r_uniform_vec2(R_UNIFORM("texsize"), PACKING_SPACE_SIZE_W, PACKING_SPACE_SIZE_H);
 	r_blend(BLEND_PREMUL_ALPHA);
 	r_draw_model_ptr(&ldraw.pass2.quad, ldraw.render_state.pass2_num_lasers, 0);
 	r_state_pop();
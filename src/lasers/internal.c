@@ -13,8 +13,12 @@ LaserInternalData lintern;
 void laserintern_init(void) {
 	assert(lintern.segments.num_elements == 0);
 	dynarray_ensure_capacity(&lintern.segments, 2048);
+	dynarray_ensure_capacity(&lintern.prev_segments, 2048);
+	dynarray_ensure_capacity(&lintern.segment_blocks, 2048 / LASER_SEGMENT_BLOCK_SIZE);
 }
 
 void laserintern_shutdown(void) {
 	dynarray_free_data(&lintern.segments);
+	dynarray_free_data(&lintern.prev_segments);
+	dynarray_free_data(&lintern.segment_blocks);
 }
@@ -13,7 +13,10 @@
 #include "dynarray.h"
 
 typedef struct LaserInternalData {
-	DYNAMIC_ARRAY(LaserSegment) segments;
+	// Segments of the current frame, and of the previous one for reuse by unchanged lasers
+	DYNAMIC_ARRAY(LaserSegment) segments, prev_segments;
+	// Bounding boxes of consecutive runs of LASER_SEGMENT_BLOCK_SIZE segments
+	DYNAMIC_ARRAY(LaserBBox) segment_blocks;
 } LaserInternalData;
 
 extern LaserInternalData lintern;
@@ -22,5 +25,7 @@ extern LaserInternalData lintern;
 // negated lowest distance threshold value in the sdf_apply shader
 #define LASER_SDF_RANGE 4.01f
 
+#define LASER_SEGMENT_BLOCK_SIZE 8
+
 void laserintern_init(void);
 void laserintern_shutdown(void);
@@ -371,10 +371,103 @@ static void construct_segments(
 	}
 }
 
+static bool laser_update_cache_key(Laser *l, const LaserSamplingParams *sp) {
+	// Returns true if the key is unchanged since the last quantization, i.e. the previous
+	// frame's segments can be reused as is.
+
+	auto key = &l->_internal.cache_key;
+
+	bool unchanged = (
+		l->_internal.cache_valid &&
+		key->pos == l->pos &&
+		key->num_samples == sp->num_samples &&
+		key->time_shift == sp->time_shift &&
+		key->time_step == sp->time_step &&
+		key->timespan == l->timespan &&
+		key->width == l->width &&
+		key->width_exponent == l->width_exponent &&
+		!memcmp(&key->rule, &l->rule, sizeof(l->rule))
+	);
+
+	if(!unchanged) {
+		*key = (LaserSegmentCacheKey) {
+			.rule = l->rule,
+			.pos = l->pos,
+			.num_samples = sp->num_samples,
+			.time_shift = sp->time_shift,
+			.time_step = sp->time_step,
+			.timespan = l->timespan,
+			.width = l->width,
+			.width_exponent = l->width_exponent,
+		};
+	}
+
+	return unchanged;
+}
+
+static void reuse_segments(int prev_ofs, int num_segments) {
+	if(num_segments < 1) {
+		return;
+	}
+
+	int ofs = lintern.segments.num_elements;
+	dynarray_ensure_capacity(&lintern.segments, ofs + num_segments);
+	memcpy(
+		lintern.segments.data + ofs,
+		dynarray_get_ptr(&lintern.prev_segments, prev_ofs),
+		sizeof(*lintern.segments.data) * num_segments
+	);
+	lintern.segments.num_elements += num_segments;
+}
+
+static void build_segment_blocks(Laser *l) {
+	// Bounding boxes over runs of consecutive segments. Since the segments follow the laser's
+	// curve, these are tight enough to skip most of a long laser in collision tests.
+
+	int nsegs = l->_internal.num_segments;
+	l->_internal.blocks_ofs = lintern.segment_blocks.num_elements;
+
+	if(nsegs < 1) {
+		return;
+	}
+
+	LaserSegment *segs = dynarray_get_ptr(&lintern.segments, l->_internal.segments_ofs);
+
+	for(int first = 0; first < nsegs; first += LASER_SEGMENT_BLOCK_SIZE) {
+		int end = min(first + LASER_SEGMENT_BLOCK_SIZE, nsegs);
+		float x0 = re(segs[first].pos.a), x1 = x0;
+		float y0 = im(segs[first].pos.a), y1 = y0;
+		// Lower bound of the collision capsule radius in laser_collision()
+		float radius = 2;
+
+		for(int i = first; i < end; ++i) {
+			LaserSegment *seg = segs + i;
+			x0 = min(x0, min(re(seg->pos.a), re(seg->pos.b)));
+			y0 = min(y0, min(im(seg->pos.a), im(seg->pos.b)));
+			x1 = max(x1, max(re(seg->pos.a), re(seg->pos.b)));
+			y1 = max(y1, max(im(seg->pos.a), im(seg->pos.b)));
+			// width.a <= width.b, see add_segment()
+			radius = max(radius, seg->width.b * 0.5f);
+		}
+
+		// Extra pixel to absorb float rounding; these boxes must never be too small
+		float margin = radius + 1;
+
+		dynarray_append(&lintern.segment_blocks, {
+			.top_left     = { .x = x0 - margin, .y = y0 - margin },
+			.bottom_right = { .x = x1 + margin, .y = y1 + margin },
+		});
+	}
+}
+
 attr_hot
 static int quantize_laser(Laser *l) {
 	// Break the laser curve into small line segments, simplify and cull them,
 	// compute the bounding box.
+	// If nothing the segments depend on has changed since the last frame, copy them instead.
+
+	int prev_ofs = l->_internal.segments_ofs;
+	int prev_num_segments = l->_internal.num_segments;
 
 	l->_internal.segments_ofs = lintern.segments.num_elements;
 	l->_internal.num_segments = 0;
@@ -384,11 +477,24 @@ static int quantize_laser(Laser *l) {
 	if(!laser_prepare_sampling_params(l, 0.5f, &sp)) {
 		l->_internal.bbox.top_left.as_cmplx = 0;
 		l->_internal.bbox.bottom_right.as_cmplx = 0;
+		l->_internal.blocks_ofs = lintern.segment_blocks.num_elements;
+		l->_internal.cache_valid = false;
 		return 0;
 	}
 
 	assert(sp.num_samples > 0);
 
+	bool cache_hit = laser_update_cache_key(l, &sp);
+	l->_internal.cache_valid = !l->stateful_rule;
+
+	if(cache_hit) {
+		// The bounding box is still valid as well
+		reuse_segments(prev_ofs, prev_num_segments);
+		l->_internal.num_segments = prev_num_segments;
+		build_segment_blocks(l);
+		return l->_internal.num_segments;
+	}
+
 	float viewmargin = LASER_SDF_RANGE + l->width * 0.5f;
 	FloatRect viewbounds = { .extent = VIEWPORT_SIZE };
 	viewbounds.w += viewmargin * 2.0f;
@@ -430,6 +536,7 @@ static int quantize_laser(Laser *l) {
 	bbox->bottom_right.as_cmplx += aabb_margin * (1.0f + I);
 
 	l->_internal.num_segments = lintern.segments.num_elements - l->_internal.segments_ofs;
+	build_segment_blocks(l);
 	return l->_internal.num_segments;
 }
 
@@ -611,7 +718,10 @@ void process_lasers(void) {
 	bool stage_cleared = stage_is_cleared();
 	Player *plr = &global.plr;
 
+	// Last frame's segments are kept around for lasers that haven't changed since
+	SWAP(lintern.segments, lintern.prev_segments);
 	lintern.segments.num_elements = 0;
+	lintern.segment_blocks.num_elements = 0;
 
 	/*
 	 * NOTE: it's important to have two loops here, because something triggered from ent_damage()
@@ -647,13 +757,25 @@ void process_lasers(void) {
 	}
 }
 
-static inline Rect laser_bbox_rect(Laser *l) {
+static inline Rect bbox_to_rect(const LaserBBox *bbox) {
 	return (Rect) {
-		l->_internal.bbox.top_left.as_cmplx,
-		l->_internal.bbox.bottom_right.as_cmplx
+		bbox->top_left.as_cmplx,
+		bbox->bottom_right.as_cmplx
 	};
 }
 
+static inline Rect laser_bbox_rect(Laser *l) {
+	return bbox_to_rect(&l->_internal.bbox);
+}
+
+static inline LaserBBox *laser_segment_blocks(Laser *l) {
+	return dynarray_get_ptr(&lintern.segment_blocks, l->_internal.blocks_ofs);
+}
+
+static inline int laser_num_segment_blocks(Laser *l) {
+	return (l->_internal.num_segments + LASER_SEGMENT_BLOCK_SIZE - 1) / LASER_SEGMENT_BLOCK_SIZE;
+}
+
 static bool laser_collision(Laser *l, Player *plr) {
 	if(!laser_is_active(l)) {
 		return false;
@@ -684,6 +806,8 @@ static bool laser_collision(Laser *l, Player *plr) {
 	}
 
 	LaserSegment *segs = dynarray_get_ptr(&lintern.segments, l->_internal.segments_ofs);
+	LaserBBox *blocks = laser_segment_blocks(l);
+	int num_blocks = laser_num_segment_blocks(l);
 
 	LineSegment plrmotion;
 	cmplx plrpos = plr->pos;
@@ -695,35 +819,57 @@ static bool laser_collision(Laser *l, Player *plr) {
 		plrmotion.b = plrpos;
 	}
 
-	for(int i = 0; i < num_segs; ++i) {
-		LaserSegment *lseg = segs + i;
-		LineSegment s = { lseg->pos.a, lseg->pos.b };
+	// Any segment that can hit or graze the player is in a block that overlaps this.
+	// Skipping the other blocks doesn't change the outcome: they are farther than graze_maxdist.
+	Rect query = { plrpos, plrpos };
 
-		if(player_moved && lineseg_lineseg_intersection(plrmotion, s, NULL)) {
-			// Prevent phasing through laser beams
-			return true;
+	if(player_moved) {
+		query.top_left = CMPLX(min(re(plrmotion.a), re(plrpos)), min(im(plrmotion.a), im(plrpos)));
+		query.bottom_right = CMPLX(max(re(plrmotion.a), re(plrpos)), max(im(plrmotion.a), im(plrpos)));
+	}
+
+	if(graze) {
+		query.top_left -= graze_maxdist * (1 + I);
+		query.bottom_right += graze_maxdist * (1 + I);
+	}
+
+	for(int b = 0; b < num_blocks; ++b) {
+		if(!rect_rect_intersect(bbox_to_rect(blocks + b), query, true, true)) {
+			continue;
 		}
 
-		UnevenCapsule c = {
-			.pos = s,
-			.radius.a = max(lseg->width.a * 0.5 - 4, 2),
-			.radius.b = max(lseg->width.b * 0.5 - 4, 2),
-		};
+		int blk_end = min((b + 1) * LASER_SEGMENT_BLOCK_SIZE, num_segs);
 
-		double d = ucapsule_dist_from_point(plrpos, c);
+		for(int i = b * LASER_SEGMENT_BLOCK_SIZE; i < blk_end; ++i) {
+			LaserSegment *lseg = segs + i;
+			LineSegment s = { lseg->pos.a, lseg->pos.b };
 
-		if(d < 0) {
-			return true;
-		}
+			if(player_moved && lineseg_lineseg_intersection(plrmotion, s, NULL)) {
+				// Prevent phasing through laser beams
+				return true;
+			}
 
-		if(graze && d < graze_dist) {
-			double f = lineseg_closest_factor(c.pos, plrpos);
-			graze_pos = clerp(c.pos.a, c.pos.b, f);
-			cmplx v = cnormalize(plrpos - graze_pos);
-			graze_pos += 0.5 * clerp(lseg->width.a, lseg->width.b, f) * v;
-			graze_dist = d;
-		}
+			UnevenCapsule c = {
+				.pos = s,
+				.radius.a = max(lseg->width.a * 0.5 - 4, 2),
+				.radius.b = max(lseg->width.b * 0.5 - 4, 2),
+			};
+
+			double d = ucapsule_dist_from_point(plrpos, c);
+
+			if(d < 0) {
+				return true;
+			}
+
+			if(graze && d < graze_dist) {
+				double f = lineseg_closest_factor(c.pos, plrpos);
+				graze_pos = clerp(c.pos.a, c.pos.b, f);
+				cmplx v = cnormalize(plrpos - graze_pos);
+				graze_pos += 0.5 * clerp(lseg->width.a, lseg->width.b, f) * v;
+				graze_dist = d;
+			}
 
+		}
 	}
 
 	if(graze_dist < graze_maxdist) {
@@ -754,13 +900,23 @@ bool laser_intersects_ellipse(Laser *l, Ellipse ellipse) {
 	}
 
 	LaserSegment *segs = dynarray_get_ptr(&lintern.segments, l->_internal.segments_ofs);
+	LaserBBox *blocks = laser_segment_blocks(l);
+	int num_blocks = laser_num_segment_blocks(l);
 
-	for(int i = 0; i < num_segs; ++i) {
-		LaserSegment *lseg = segs + i;
-		LineSegment s = { lseg->pos.a, lseg->pos.b };
+	for(int b = 0; b < num_blocks; ++b) {
+		if(!rect_rect_intersect(e_bbox, bbox_to_rect(blocks + b), true, true)) {
+			continue;
+		}
 
-		if(lineseg_ellipse_intersect(s, ellipse)) {
-			return true;
+		int blk_end = min((b + 1) * LASER_SEGMENT_BLOCK_SIZE, num_segs);
+
+		for(int i = b * LASER_SEGMENT_BLOCK_SIZE; i < blk_end; ++i) {
+			LaserSegment *lseg = segs + i;
+			LineSegment s = { lseg->pos.a, lseg->pos.b };
+
+			if(lineseg_ellipse_intersect(s, ellipse)) {
+				return true;
+			}
 		}
 	}
 
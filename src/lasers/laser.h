@@ -13,6 +13,7 @@
 #include "coroutine/taskdsl.h"
 #include "entity.h"
 
+// Should depend only on p->pos, t, and ruledata; otherwise, set Laser.stateful_rule
 typedef cmplx LaserRuleFunc(Laser *p, real t, void *ruledata);
 
 typedef struct LaserRule {
@@ -26,6 +27,18 @@ typedef struct LaserBBox {
 	FloatOffset top_left, bottom_right;
 } LaserBBox;
 
+// Everything the segments of a laser are derived from; see quantize_laser()
+typedef struct LaserSegmentCacheKey {
+	LaserRule rule;
+	cmplx pos;
+	uint num_samples;
+	float time_shift;
+	float time_step;
+	float timespan;
+	float width;
+	float width_exponent;
+} LaserSegmentCacheKey;
+
 DEFINE_ENTITY_TYPE(Laser, {
 	cmplx pos;
 	LaserRule rule;
@@ -33,7 +46,10 @@ DEFINE_ENTITY_TYPE(Laser, {
 	struct {
 		int segments_ofs;
 		int num_segments;
+		int blocks_ofs;
 		LaserBBox bbox;
+		LaserSegmentCacheKey cache_key;
+		bool cache_valid;
 	} _internal;
 
 	Color color;
@@ -50,6 +66,8 @@ DEFINE_ENTITY_TYPE(Laser, {
 
 	uchar unclearable : 1;
 	uchar collision_active : 1;
+	// Set if the rule depends on anything besides pos, its data, and t; disables segment caching
+	uchar stateful_rule : 1;
 });
 
 void lasers_init(void);
@@ -159,6 +159,9 @@ TASK(laser_dynamic, {
 		laser_rule_dynamic(THIS_TASK, &td)
 	));
 
+	// Samples from the position history, which changes every frame
+	l->stateful_rule = true;
+
 	if(LIKELY(ARGS.out_move)) {
 		*ARGS.out_move = &td.move;
 	}
@@ -21,13 +21,17 @@
 #include "memory/scratch.h"
 #include "menu/mainmenu.h"
 #include "menu/savereplay.h"
+#include "profiler.h"
 #include "progress.h"
 #include "renderer/common/models.h"
 #include "renderer/common/sprite_batch.h"
 #include "i18n/i18n.h"
+#include "replay/benchmark.h"
 #include "replay/demoplayer.h"
 #include "replay/struct.h"
 #include "replay/tsrtool.h"
+#include "replay/verify.h"
+#include "resource/font.h"
 #include "rwops/rwops_stdiofp.h"
 #include "stage.h"
 #include "stageobjects.h"
@@ -77,6 +81,7 @@ static void taisei_shutdown(void) {
 	stage_objpools_shutdown();
 	gamemode_shutdown();
 	taskmgr_global_shutdown();
+	profiler_shutdown();
 	audio_shutdown();
 	r_models_shutdown();
 	r_sprite_batch_shutdown();
@@ -223,6 +228,7 @@ static void main_post_vfsinit(CallChainResult ccr);
 static void main_mainmenu(CallChainResult ccr);
 static void main_singlestg(MainContext *mctx) attr_unused;
 static void main_replay(MainContext *mctx);
+static void main_benchmark_stage(MainContext *mctx);
 static noreturn void main_vfstree(CallChainResult ccr);
 
 static void cleanup_replay(Replay **rpy) {
@@ -300,6 +306,10 @@ int main(int argc, char **argv) {
 		main_quit(ctx, 0);
 	}
 
+	if(ctx->cli.type == CLI_VerifyReplays) {
+		main_quit(ctx, replay_verify_batch(argv[0], ctx->cli.filename));
+	}
+
 	if(ctx->cli.type == CLI_DumpStages) {
 		int n = stageinfo_get_num_stages();
 		for(int i = 0; i < n; ++i) {
@@ -312,7 +322,11 @@ int main(int argc, char **argv) {
 		main_quit(ctx, 0);
 	}
 
-	if(ctx->cli.type == CLI_PlayReplay || ctx->cli.type == CLI_VerifyReplay) {
+	if(
+		ctx->cli.type == CLI_PlayReplay ||
+		ctx->cli.type == CLI_VerifyReplay ||
+		ctx->cli.type == CLI_BenchmarkReplay
+	) {
 		ctx->replay_in = alloc_replay();
 
 		if(!replay_load_syspath(ctx->replay_in, ctx->cli.filename, REPLAY_READ_ALL)) {
@@ -329,6 +343,12 @@ int main(int argc, char **argv) {
 			ctx->headless = true;
 		}
 
+		if(ctx->cli.type == CLI_BenchmarkReplay) {
+			ctx->headless = true;
+			replay_benchmark_init(
+				ctx->cli.filename, ctx->cli.benchmark_report, ctx->cli.benchmark_runs, ctx->cli.benchmark_frames);
+		}
+
 		if(ctx->cli.out_replay != NULL) {
 			ctx->replay_out_stream = SDL_IOFromFile(ctx->cli.out_replay, "wb");
 
@@ -338,6 +358,16 @@ int main(int argc, char **argv) {
 
 			ctx->replay_out = alloc_replay();
 		}
+	} else if(ctx->cli.type == CLI_BenchmarkStage) {
+		StageInfo *stg = NOT_NULL(stageinfo_get_by_id(ctx->cli.stageid));
+		char title[STAGE_MAX_TITLE_SIZE];
+		char name[STAGE_MAX_TITLE_SIZE + 64];
+		stagetitle_format_localized(&stg->title, sizeof(title), title);
+		snprintf(name, sizeof(name), "%X (%s: %s)", stg->id, title, stg->subtitle ? stg->subtitle : "");
+
+		ctx->headless = true;
+		replay_benchmark_init_stage(
+			name, ctx->cli.benchmark_report, ctx->cli.benchmark_runs, ctx->cli.benchmark_frames);
 	} else if(ctx->cli.type == CLI_DumpVFSTree) {
 		vfs_setup(CALLCHAIN(main_vfstree, ctx));
 		return 0; // NO main_quit here! vfs_setup may be asynchronous.
@@ -354,10 +384,20 @@ static void main_post_vfsinit(CallChainResult ccr) {
 	MainContext *ctx = ccr.ctx;
 
 	if(ctx->headless) {
+		const char *renderer = env_get("TAISEI_HEADLESS_RENDERER", "");
+
 		env_set("SDL_AUDIODRIVER", "dummy", true);
-		env_set("SDL_VIDEODRIVER", "dummy", true);
 		env_set("TAISEI_AUDIO_BACKEND", "null", true);
-		env_set("TAISEI_RENDERER", "null", true);
+
+		if(*renderer) {
+			// Really draw, into a window that is never shown; mostly useful with TAISEI_FRAMEDUMP.
+			SDL_SetHintWithPriority(SDL_HINT_VIDEO_DRIVER, "offscreen", SDL_HINT_OVERRIDE);
+			env_set("TAISEI_RENDERER", renderer, true);
+		} else {
+			env_set("SDL_VIDEODRIVER", "dummy", true);
+			// The trace renderer doesn't display anything either, so it may be used headless.
+			env_set("TAISEI_RENDERER", strcmp(env_get("TAISEI_RENDERER", ""), "trace") ? "null" : "trace", true);
+		}
 	} else {
 		init_log_file();
 	}
@@ -374,6 +414,7 @@ static void main_post_vfsinit(CallChainResult ccr) {
 	taskmgr_global_init();
 	gamemode_init();
 	time_init();
+	profiler_init();
 	init_global(&ctx->cli);
 	events_init();
 
@@ -427,15 +468,25 @@ static void main_post_vfsinit(CallChainResult ccr) {
 	CallChain cc_mainmenu = CALLCHAIN(main_mainmenu, ctx);
 
 	if(ctx->cli.type == CLI_QuitLate) {
+		fonts_prewarm_glyph_caches();
 		run_call_chain(&cc_cleanup, NULL);
 		return;
 	}
 
-	if(ctx->cli.type == CLI_PlayReplay || ctx->cli.type == CLI_VerifyReplay) {
+	if(
+		ctx->cli.type == CLI_PlayReplay ||
+		ctx->cli.type == CLI_VerifyReplay ||
+		ctx->cli.type == CLI_BenchmarkReplay
+	) {
 		main_replay(ctx);
 		return;
 	}
 
+	if(ctx->cli.type == CLI_BenchmarkStage) {
+		main_benchmark_stage(ctx);
+		return;
+	}
+
 	if(ctx->cli.type == CLI_Credits) {
 		credits_enter(cc_cleanup);
 		eventloop_run();
@@ -558,13 +609,66 @@ static void main_singlestg(MainContext *mctx) {
 	eventloop_run();
 }
 
+static void main_benchmark_replay_next_run(CallChainResult ccr) {
+	MainContext *mctx = ccr.ctx;
+
+	if(replay_benchmark_end_run()) {
+		replay_play(mctx->replay_in, mctx->replay_idx, false, CALLCHAIN(main_benchmark_replay_next_run, mctx));
+		return;
+	}
+
+	int status = replay_benchmark_report() ? 0 : 1;
+	replay_benchmark_shutdown();
+	main_quit(mctx, status);
+}
+
 static void main_replay(MainContext *mctx) {
 	if(mctx->replay_out) {
 		replay_state_init_record(&global.replay.output, mctx->replay_out);
 		stralloc(&mctx->replay_out->playername, mctx->replay_in->playername);
 	}
 
-	replay_play(mctx->replay_in, mctx->replay_idx, false, CALLCHAIN(main_cleanup, mctx));
+	CallChain next = CALLCHAIN(main_cleanup, mctx);
+
+	if(replay_benchmark_is_active()) {
+		next = CALLCHAIN(main_benchmark_replay_next_run, mctx);
+	}
+
+	replay_play(mctx->replay_in, mctx->replay_idx, false, next);
+	eventloop_run();
+}
+
+static void main_benchmark_stage_run(MainContext *mctx);
+
+static void main_benchmark_stage_next_run(CallChainResult ccr) {
+	MainContext *mctx = ccr.ctx;
+
+	if(replay_benchmark_end_run()) {
+		main_benchmark_stage_run(mctx);
+		return;
+	}
+
+	int status = replay_benchmark_report() ? 0 : 1;
+	replay_benchmark_shutdown();
+	main_quit(mctx, status);
+}
+
+static void main_benchmark_stage_run(MainContext *mctx) {
+	StageInfo *stg = NOT_NULL(stageinfo_get_by_id(mctx->cli.stageid));
+
+	global.gameover = 0;
+	global.diff = stg->difficulty ? stg->difficulty : D_Normal;
+	player_init(&global.plr);
+	stats_init(&global.plr.stats);
+
+	// Nobody is playing; the stage must not end early because the player died
+	global.plr.iddqd = true;
+
+	stage_enter(stg, &mctx->rg, CALLCHAIN(main_benchmark_stage_next_run, mctx));
+}
+
+static void main_benchmark_stage(MainContext *mctx) {
+	main_benchmark_stage_run(mctx);
 	eventloop_run();
 }
 
@@ -15,6 +15,7 @@
 #include "menu.h"
 #include "renderer/api.h"
 #include "resource/font.h"
+#include "stage.h"
 #include "stagedraw.h"
 #include "submenus.h"
 #include "util/graphics.h"
@@ -146,6 +147,13 @@ static void skip_stage(MenuData *m, void *arg) {
 	menu_action_close(m, arg);
 }
 
+#define REPLAY_SEEK_STEP (30 * FPS)
+
+static void seek_replay(MenuData *m, void *arg) {
+	stage_replay_seek(global.frames + (intptr_t)arg);
+	menu_action_close(m, arg);
+}
+
 MenuData *create_ingame_menu_replay(void) {
 	MenuData *m = alloc_menu();
 
@@ -160,6 +168,8 @@ MenuData *create_ingame_menu_replay(void) {
 	});
 	add_menu_entry(m, N_("Options"), menu_action_enter_options, NULL)->transition = TransFadeBlack;
 	add_menu_entry(m, N_("Continue Watching"), menu_action_close, NULL);
+	add_menu_entry(m, N_("Rewind 30 Seconds"), seek_replay, (void*)(intptr_t)-REPLAY_SEEK_STEP)->transition = TransFadeBlack;
+	add_menu_entry(m, N_("Skip 30 Seconds"), seek_replay, (void*)(intptr_t)REPLAY_SEEK_STEP);
 	add_menu_entry(m, N_("Restart the Stage"), restart_game, NULL)->transition = TransFadeBlack;
 	add_menu_entry(m, N_("Skip the Stage"), skip_stage, NULL)->transition = TransFadeBlack;
 	add_menu_entry(m, N_("Stop Watching"), return_to_title, NULL)->transition = TransFadeBlack;
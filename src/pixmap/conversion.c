@@ -6,10 +6,13 @@
  * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
  */
 
+#include "conversion_fast.h"
 #include "log.h"
 #include "pixmap.h"
+#include "taskmanager.h"
+#include "util/miscmath.h"
 
-// NOTE: this is pretty stupid and not at all optimized, patches welcome
+// NOTE: these generic conversions are slow; the common cases are handled in conversion_fast.c
 
 #define _CONV_FUNCNAME	convert_u8_to_u8
 #define _CONV_IN_MAX	UINT8_MAX
@@ -125,15 +128,6 @@
 
 #define DEPTH_FLOAT_BIT (1 << 10)
 
-typedef void (*convfunc_t)(
-	size_t in_elements,
-	size_t out_elements,
-	size_t num_pixels,
-	void *vbuf_in,
-	void *vbuf_out,
-	int swizzle[4]
-);
-
 #define CONV(in, in_depth, out, out_depth) { convert_##in##_to_##out, in_depth, out_depth }
 
 struct conversion_def {
@@ -166,10 +160,72 @@ struct conversion_def conversion_table[] = {
 	{}
 };
 
-static struct conversion_def* find_conversion(uint depth_in, uint depth_out) {
+// Pixels per parallel_for chunk; large textures get split across the task manager's workers.
+#define CONVERSION_GRAIN (1 << 16)
+
+typedef struct ConversionJob {
+	convfunc_t func;
+	size_t in_elements;
+	size_t out_elements;
+	size_t in_pixel_size;
+	size_t out_pixel_size;
+	char *buf_in;
+	char *buf_out;
+	int *swizzle;
+} ConversionJob;
+
+static void conversion_job_range(size_t begin, size_t end, void *arg) {
+	ConversionJob *job = arg;
+	job->func(
+		job->in_elements,
+		job->out_elements,
+		end - begin,
+		job->buf_in + begin * job->in_pixel_size,
+		job->buf_out + begin * job->out_pixel_size,
+		job->swizzle
+	);
+}
+
+static void run_conversion(ConversionJob *job, size_t num_pixels) {
+	if(num_pixels > 0) {
+		taskmgr_parallel_for(num_pixels, CONVERSION_GRAIN, conversion_job_range, job);
+	}
+}
+
+static convfunc_t find_fast_conversion(
+	uint depth_in, uint depth_out, uint in_elements, uint out_elements, bool swizzle
+) {
+	if(depth_in == 8 && depth_out == 8 && out_elements == 4) {
+		return convert_u8_to_u8x4_fast;
+	}
+
+	if(swizzle || in_elements != out_elements) {
+		return NULL;
+	}
+
+	if(depth_in == 8 && depth_out == (32 | DEPTH_FLOAT_BIT)) {
+		return convert_u8_to_f32_fast;
+	}
+
+	if(depth_in == 16 && depth_out == 8) {
+		return convert_u16_to_u8_fast;
+	}
+
+	return NULL;
+}
+
+static convfunc_t find_conversion(
+	uint depth_in, uint depth_out, uint in_elements, uint out_elements, bool swizzle
+) {
+	convfunc_t fast = find_fast_conversion(depth_in, depth_out, in_elements, out_elements, swizzle);
+
+	if(fast) {
+		return fast;
+	}
+
 	for(struct conversion_def *cv = conversion_table; cv->func; ++cv) {
 		if(cv->depth_in == depth_in && cv->depth_out == depth_out) {
-			return cv;
+			return cv->func;
 		}
 	}
 
@@ -214,19 +270,24 @@ void pixmap_convert(const Pixmap *src, Pixmap *dst, PixmapFormat format) {
 
 	dst->format = format;
 
-	struct conversion_def *cv = find_conversion(
+	uint in_elements = PIXMAP_FORMAT_LAYOUT(src->format);
+	uint out_elements = PIXMAP_FORMAT_LAYOUT(dst->format);
+
+	convfunc_t func = find_conversion(
 		PIXMAP_FORMAT_DEPTH(src->format) | (PIXMAP_FORMAT_IS_FLOAT(src->format) * DEPTH_FLOAT_BIT),
-		PIXMAP_FORMAT_DEPTH(dst->format) | (PIXMAP_FORMAT_IS_FLOAT(dst->format) * DEPTH_FLOAT_BIT)
+		PIXMAP_FORMAT_DEPTH(dst->format) | (PIXMAP_FORMAT_IS_FLOAT(dst->format) * DEPTH_FLOAT_BIT),
+		in_elements, out_elements, false
 	);
 
-	cv->func(
-		PIXMAP_FORMAT_LAYOUT(src->format),
-		PIXMAP_FORMAT_LAYOUT(dst->format),
-		num_pixels,
-		src->data.untyped,
-		dst->data.untyped,
-		NULL
-	);
+	run_conversion(&(ConversionJob) {
+		.func = func,
+		.in_elements = in_elements,
+		.out_elements = out_elements,
+		.in_pixel_size = PIXMAP_FORMAT_PIXEL_SIZE(src->format),
+		.out_pixel_size = pixel_size,
+		.buf_in = src->data.untyped,
+		.buf_out = dst->data.untyped,
+	}, num_pixels);
 }
 
 static int swizzle_idx(char s) {
@@ -250,21 +311,25 @@ void pixmap_swizzle_inplace(Pixmap *px, SwizzleMask swizzle) {
 	}
 
 	uint cvt_id = pixmap_format_depth(px->format) | (pixmap_format_is_float(px->format) * DEPTH_FLOAT_BIT);
-	struct conversion_def *cv = find_conversion(cvt_id, cvt_id);
-
-	cv->func(
-		channels,
-		channels,
-		px->width * px->height,
-		px->data.untyped,
-		px->data.untyped,
-		(int[]) {
+	convfunc_t func = find_conversion(cvt_id, cvt_id, channels, channels, true);
+
+	size_t pixel_size = PIXMAP_FORMAT_PIXEL_SIZE(px->format);
+
+	run_conversion(&(ConversionJob) {
+		.func = func,
+		.in_elements = channels,
+		.out_elements = channels,
+		.in_pixel_size = pixel_size,
+		.out_pixel_size = pixel_size,
+		.buf_in = px->data.untyped,
+		.buf_out = px->data.untyped,
+		.swizzle = (int[]) {
 			swizzle_idx(swizzle.r),
 			swizzle_idx(swizzle.g),
 			swizzle_idx(swizzle.b),
 			swizzle_idx(swizzle.a),
-		}
-	);
+		},
+	}, (size_t)px->width * px->height);
 }
 
 void pixmap_convert_alloc(const Pixmap *src, Pixmap *dst, PixmapFormat format) {
@@ -287,6 +352,45 @@ void pixmap_convert_inplace_realloc(Pixmap *src, PixmapFormat format) {
 	*src = tmp;
 }
 
+// Rows per parallel_for chunk for the flip functions
+#define FLIP_GRAIN 64
+
+typedef struct FlipJob {
+	char *dst;
+	const char *src;
+	size_t rows;
+	size_t row_length;
+} FlipJob;
+
+static void flip_job_range(size_t begin, size_t end, void *arg) {
+	FlipJob *job = arg;
+
+	for(size_t row = begin; row < end; ++row) {
+		memcpy(
+			job->dst + (job->rows - row - 1) * job->row_length,
+			job->src + row * job->row_length,
+			job->row_length
+		);
+	}
+}
+
+static void flip_inplace_job_range(size_t begin, size_t end, void *arg) {
+	FlipJob *job = arg;
+	char swap_buffer[4096];
+
+	for(size_t row = begin; row < end; ++row) {
+		char *a = job->dst + row * job->row_length;
+		char *b = job->dst + (job->rows - row - 1) * job->row_length;
+
+		for(size_t ofs = 0; ofs < job->row_length; ofs += sizeof(swap_buffer)) {
+			size_t n = min(sizeof(swap_buffer), job->row_length - ofs);
+			memcpy(swap_buffer, a + ofs, n);
+			memcpy(a + ofs, b + ofs, n);
+			memcpy(b + ofs, swap_buffer, n);
+		}
+	}
+}
+
 void pixmap_flip_y(const Pixmap *src, Pixmap *dst) {
 	assert(dst->data.untyped != NULL);
 	pixmap_copy_meta(src, dst);
@@ -294,16 +398,16 @@ void pixmap_flip_y(const Pixmap *src, Pixmap *dst) {
 	size_t rows = src->height;
 	size_t row_length = src->width * PIXMAP_FORMAT_PIXEL_SIZE(src->format);
 
-	if(UNLIKELY(row_length == 0)) {
+	if(UNLIKELY(row_length == 0 || rows == 0)) {
 		return;
 	}
 
-	char *cdst = dst->data.untyped;
-	const char *csrc = src->data.untyped;
-
-	for(size_t row = 0, irow = rows - 1; row < rows; ++row, --irow) {
-		memcpy(cdst + irow * row_length, csrc + row * row_length, row_length);
-	}
+	taskmgr_parallel_for(rows, FLIP_GRAIN, flip_job_range, &(FlipJob) {
+		.dst = dst->data.untyped,
+		.src = src->data.untyped,
+		.rows = rows,
+		.row_length = row_length,
+	});
 }
 
 void pixmap_flip_y_alloc(const Pixmap *src, Pixmap *dst) {
@@ -315,16 +419,13 @@ void pixmap_flip_y_inplace(Pixmap *src) {
 	size_t rows = src->height;
 	size_t row_length = src->width * PIXMAP_FORMAT_PIXEL_SIZE(src->format);
 
-	if(UNLIKELY(row_length == 0)) {
+	if(UNLIKELY(row_length == 0 || rows < 2)) {
 		return;
 	}
 
-	char *data = src->data.untyped;
-	char swap_buffer[row_length];
-
-	for(size_t row = 0; row < rows / 2; ++row) {
-		memcpy(swap_buffer, data + row * row_length, row_length);
-		memcpy(data + row * row_length, data + (rows - row - 1) * row_length, row_length);
-		memcpy(data + (rows - row - 1) * row_length, swap_buffer, row_length);
-	}
+	taskmgr_parallel_for(rows / 2, FLIP_GRAIN, flip_inplace_job_range, &(FlipJob) {
+		.dst = src->data.untyped,
+		.rows = rows,
+		.row_length = row_length,
+	});
 }
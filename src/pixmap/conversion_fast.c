@@ -0,0 +1,217 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "conversion_fast.h"
+
+#include <SDL3/SDL_cpuinfo.h>
+
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+	#include <tmmintrin.h>
+	#define HAVE_SHUFFLE_SSSE3
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define HAVE_SHUFFLE_NEON
+#endif
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	#define HAVE_VEC
+#endif
+
+// BEGIN U8 SHUFFLE
+
+// Shuffle index that produces a zero byte (same meaning for pshufb and tbl)
+#define SHUF_ZERO 0x80
+
+/*
+ * Byte shuffle for 4 output pixels at a time: out[i] = in[idx[i]] | or_mask[i]. Missing channels
+ * and the '0'/'1' swizzle constants come out of the mask, just like the generic swizzle_buf.
+ */
+typedef struct ShuffleU8x4 {
+	uint8_t idx[16];
+	uint8_t or_mask[16];
+} ShuffleU8x4;
+
+static void shuffle_init(ShuffleU8x4 *shuf, uint in_elements, const int swizzle[4]) {
+	for(uint j = 0; j < 4; ++j) {
+		int s = swizzle ? swizzle[j] : (int)j;
+		uint8_t idx = SHUF_ZERO;
+		uint8_t or_mask = 0;
+
+		if(s < (int)in_elements) {
+			idx = s;
+		} else if(s == 3 || s == 5) {
+			// alpha defaults to opaque; 5 is the '1' constant
+			or_mask = UINT8_MAX;
+		}
+
+		for(uint k = 0; k < 4; ++k) {
+			shuf->idx[4 * k + j] = idx == SHUF_ZERO ? SHUF_ZERO : k * in_elements + idx;
+			shuf->or_mask[4 * k + j] = or_mask;
+		}
+	}
+}
+
+// Each step consumes 4 input pixels but loads 16 bytes, hence the loop condition.
+
+#if defined(HAVE_SHUFFLE_SSSE3)
+__attribute__((target("ssse3")))
+static size_t shuffle_u8x4_ssse3(
+	size_t num_pixels, uint in_elements, const uint8_t *in, uint8_t *out, const ShuffleU8x4 *shuf
+) {
+	__m128i idx = _mm_loadu_si128((const __m128i*)shuf->idx);
+	__m128i or_mask = _mm_loadu_si128((const __m128i*)shuf->or_mask);
+	size_t in_size = num_pixels * in_elements;
+	size_t i = 0;
+
+	for(; i * in_elements + 16 <= in_size; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(in + i * in_elements));
+		v = _mm_or_si128(_mm_shuffle_epi8(v, idx), or_mask);
+		_mm_storeu_si128((__m128i*)(out + 4 * i), v);
+	}
+
+	return i;
+}
+#endif
+
+#if defined(HAVE_SHUFFLE_NEON)
+static size_t shuffle_u8x4_neon(
+	size_t num_pixels, uint in_elements, const uint8_t *in, uint8_t *out, const ShuffleU8x4 *shuf
+) {
+	uint8x16_t idx = vld1q_u8(shuf->idx);
+	uint8x16_t or_mask = vld1q_u8(shuf->or_mask);
+	size_t in_size = num_pixels * in_elements;
+	size_t i = 0;
+
+	for(; i * in_elements + 16 <= in_size; i += 4) {
+		uint8x16_t v = vld1q_u8(in + i * in_elements);
+		vst1q_u8(out + 4 * i, vorrq_u8(vqtbl1q_u8(v, idx), or_mask));
+	}
+
+	return i;
+}
+#endif
+
+static void shuffle_u8x4_scalar(
+	size_t first, size_t num_pixels, uint in_elements, const uint8_t *in, uint8_t *out,
+	const ShuffleU8x4 *shuf
+) {
+	for(size_t i = first; i < num_pixels; ++i) {
+		// in and out may alias, so read the whole pixel first
+		uint8_t px[4] = {};
+		memcpy(px, in + i * in_elements, in_elements);
+
+		for(uint j = 0; j < 4; ++j) {
+			uint8_t idx = shuf->idx[j];
+			out[4 * i + j] = (idx == SHUF_ZERO ? 0 : px[idx]) | shuf->or_mask[j];
+		}
+	}
+}
+
+void convert_u8_to_u8x4_fast(
+	size_t in_elements, size_t out_elements, size_t num_pixels,
+	void *vbuf_in, void *vbuf_out, int swizzle[4]
+) {
+	assert(in_elements >= 1 && in_elements <= 4);
+	assert(out_elements == 4);
+
+	ShuffleU8x4 shuf;
+	shuffle_init(&shuf, in_elements, swizzle);
+	size_t i = 0;
+
+#if defined(HAVE_SHUFFLE_SSSE3)
+	static int have_ssse3 = -1;
+
+	if(UNLIKELY(have_ssse3 < 0)) {
+		// SDL can't query SSSE3 by itself, but every SSE4.1 CPU has it
+		have_ssse3 = SDL_HasSSE41();
+	}
+
+	if(have_ssse3) {
+		i = shuffle_u8x4_ssse3(num_pixels, in_elements, vbuf_in, vbuf_out, &shuf);
+	}
+#elif defined(HAVE_SHUFFLE_NEON)
+	i = shuffle_u8x4_neon(num_pixels, in_elements, vbuf_in, vbuf_out, &shuf);
+#endif
+
+	shuffle_u8x4_scalar(i, num_pixels, in_elements, vbuf_in, vbuf_out, &shuf);
+}
+
+// END U8 SHUFFLE
+
+// BEGIN ELEMENTWISE
+
+// These treat the buffers as flat arrays of channel values, since no channels are moved around.
+
+void convert_u8_to_f32_fast(
+	size_t in_elements, size_t out_elements, size_t num_pixels,
+	void *vbuf_in, void *vbuf_out, int swizzle[4]
+) {
+	assert(in_elements == out_elements);
+	assert(swizzle == NULL);
+
+	const uint8_t *restrict in = vbuf_in;
+	float *restrict out = vbuf_out;
+	size_t n = num_pixels * in_elements;
+	size_t i = 0;
+
+#if defined(HAVE_VEC)
+	typedef uint8_t vu8x16 __attribute__((vector_size(16)));
+	typedef float vf32x16 __attribute__((vector_size(16 * sizeof(float))));
+
+	const vf32x16 scale = (vf32x16) { } + (1.0f / (float)UINT8_MAX);
+
+	for(; i + 16 <= n; i += 16) {
+		vu8x16 v;
+		memcpy(&v, in + i, sizeof(v));
+		vf32x16 f = __builtin_convertvector(v, vf32x16) * scale;
+		memcpy(out + i, &f, sizeof(f));
+	}
+#endif
+
+	for(; i < n; ++i) {
+		out[i] = in[i] * (1.0f / (float)UINT8_MAX);
+	}
+}
+
+void convert_u16_to_u8_fast(
+	size_t in_elements, size_t out_elements, size_t num_pixels,
+	void *vbuf_in, void *vbuf_out, int swizzle[4]
+) {
+	assert(in_elements == out_elements);
+	assert(swizzle == NULL);
+
+	const uint16_t *restrict in = vbuf_in;
+	uint8_t *restrict out = vbuf_out;
+	size_t n = num_pixels * in_elements;
+	size_t i = 0;
+	const float scale = (float)UINT8_MAX / (float)UINT16_MAX;
+
+#if defined(HAVE_VEC)
+	typedef uint16_t vu16x8 __attribute__((vector_size(8 * sizeof(uint16_t))));
+	typedef uint8_t vu8x8 __attribute__((vector_size(8)));
+	typedef int32_t vi32x8 __attribute__((vector_size(8 * sizeof(int32_t))));
+	typedef float vf32x8 __attribute__((vector_size(8 * sizeof(float))));
+
+	for(; i + 8 <= n; i += 8) {
+		vu16x8 v;
+		memcpy(&v, in + i, sizeof(v));
+
+		// Truncating x + 0.5 is the same as roundf(x) for every x = v * scale here; the
+		// pixmap_conversion test checks all inputs.
+		vf32x8 f = __builtin_convertvector(v, vf32x8) * scale + 0.5f;
+		vu8x8 b = __builtin_convertvector(__builtin_convertvector(f, vi32x8), vu8x8);
+		memcpy(out + i, &b, sizeof(b));
+	}
+#endif
+
+	for(; i < n; ++i) {
+		out[i] = (uint8_t)roundf(in[i] * scale);
+	}
+}
+
+// END ELEMENTWISE
@@ -0,0 +1,39 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+/*
+ * Specialized kernels for the conversions that texture loading hits the most. They share the
+ * signature of the generic ones from pixmap_conversion.inc.h and produce exactly the same output.
+ */
+
+typedef void (*convfunc_t)(
+	size_t in_elements,
+	size_t out_elements,
+	size_t num_pixels,
+	void *vbuf_in,
+	void *vbuf_out,
+	int swizzle[4]
+);
+
+// 8-bit, any number of input channels to 4 output channels, optionally swizzled (may be in-place)
+void convert_u8_to_u8x4_fast(
+	size_t in_elements, size_t out_elements, size_t num_pixels,
+	void *vbuf_in, void *vbuf_out, int swizzle[4]);
+
+// Same number of channels, no swizzle
+void convert_u8_to_f32_fast(
+	size_t in_elements, size_t out_elements, size_t num_pixels,
+	void *vbuf_in, void *vbuf_out, int swizzle[4]);
+
+// Same number of channels, no swizzle
+void convert_u16_to_u8_fast(
+	size_t in_elements, size_t out_elements, size_t num_pixels,
+	void *vbuf_in, void *vbuf_out, int swizzle[4]);
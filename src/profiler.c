@@ -0,0 +1,175 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+#include "dynarray.h"
+#include "log.h"
+#include "memory/arena.h"
+#include "thread.h"
+#include "util/env.h"
+#include "util/stringops.h"
+
+#include <SDL3/SDL_mutex.h>
+
+// Keeps a forgotten trace from eating all memory; ~64 MiB worth of events.
+#define PROFILER_MAX_EVENTS (1 << 21)
+
+typedef struct ProfileEvent {
+	const char *zone;
+	const char *detail;
+	hrtime_t begin;
+	hrtime_t duration;
+	ThreadID thread;
+} ProfileEvent;
+
+bool _profiler_active;
+
+static struct {
+	DYNAMIC_ARRAY(ProfileEvent) events;
+	MemArena details;
+	SDL_Mutex *mutex;
+	char *path;
+	hrtime_t start;
+	bool overflow;
+} profiler;
+
+void profiler_init(void) {
+	const char *path = env_get("TAISEI_PROFILE_TRACE", "");
+
+	if(!*path) {
+		return;
+	}
+
+	if(!(profiler.mutex = SDL_CreateMutex())) {
+		log_sdl_error(LOG_ERROR, "SDL_CreateMutex");
+		return;
+	}
+
+	stralloc(&profiler.path, path);
+	marena_init(&profiler.details, 0);
+	dynarray_ensure_capacity(&profiler.events, 1 << 16);
+	profiler.start = time_get();
+	_profiler_active = true;
+
+	log_info("Recording a profiler trace to %s", path);
+}
+
+void _profiler_record(const char *zone, const char *detail, hrtime_t begin, hrtime_t end) {
+	SDL_LockMutex(profiler.mutex);
+
+	if(UNLIKELY(profiler.events.num_elements >= PROFILER_MAX_EVENTS)) {
+		if(!profiler.overflow) {
+			log_warn("Profiler event limit reached, further zones will be dropped");
+			profiler.overflow = true;
+		}
+
+		SDL_UnlockMutex(profiler.mutex);
+		return;
+	}
+
+	char *detail_copy = NULL;
+
+	if(detail) {
+		size_t len = strlen(detail) + 1;
+		detail_copy = marena_alloc(&profiler.details, len);
+		memcpy(detail_copy, detail, len);
+	}
+
+	*dynarray_append(&profiler.events) = (ProfileEvent) {
+		.zone = zone,
+		.detail = detail_copy,
+		.begin = begin,
+		.duration = end - begin,
+		.thread = thread_get_current_id(),
+	};
+
+	SDL_UnlockMutex(profiler.mutex);
+}
+
+static void write_json_string(SDL_IOStream *out, const char *str) {
+	SDL_WriteIO(out, "\"", 1);
+
+	for(const char *c = str; *c; ++c) {
+		if(*c == '"' || *c == '\\') {
+			SDL_IOprintf(out, "\\%c", *c);
+		} else if((uchar)*c < 0x20) {
+			SDL_IOprintf(out, "\\u%04x", (uchar)*c);
+		} else {
+			SDL_WriteIO(out, c, 1);
+		}
+	}
+
+	SDL_WriteIO(out, "\"", 1);
+}
+
+static bool write_trace(void) {
+	SDL_IOStream *out = SDL_IOFromFile(profiler.path, "wb");
+
+	if(!out) {
+		log_sdl_error(LOG_ERROR, "SDL_IOFromFile");
+		return false;
+	}
+
+	// Timestamps are in microseconds
+	const double us = 1e6 / HRTIME_RESOLUTION;
+
+	SDL_IOprintf(out,
+		"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%"PRIu64",\"args\":{\"name\":\"main\"}}",
+		thread_get_main_id()
+	);
+
+	dynarray_foreach_elem(&profiler.events, ProfileEvent *e, {
+		SDL_IOprintf(out,
+			",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%"PRIu64",\"ts\":%.3f,\"dur\":%.3f",
+			e->zone, e->thread, (e->begin - profiler.start) * us, e->duration * us
+		);
+
+		if(e->detail) {
+			SDL_IOprintf(out, ",\"args\":{\"detail\":");
+			write_json_string(out, e->detail);
+			SDL_IOprintf(out, "}");
+		}
+
+		SDL_IOprintf(out, "}");
+	});
+
+	SDL_IOprintf(out, "\n]}\n");
+
+	if(!SDL_CloseIO(out)) {
+		log_sdl_error(LOG_ERROR, "SDL_CloseIO");
+		return false;
+	}
+
+	return true;
+}
+
+void profiler_shutdown(void) {
+	if(!_profiler_active) {
+		return;
+	}
+
+	_profiler_active = false;
+
+	if(write_trace()) {
+		log_info("Profiler trace with %i events written to %s", profiler.events.num_elements, profiler.path);
+	} else {
+		log_error("Failed to write profiler trace to %s", profiler.path);
+	}
+
+	dynarray_free_data(&profiler.events);
+	marena_deinit(&profiler.details);
+	SDL_DestroyMutex(profiler.mutex);
+	mem_free(profiler.path);
+	profiler = (typeof(profiler)) {};
+}
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,69 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "hirestime.h"
+
+/*
+ * Scoped-zone frame profiler.
+ *
+ * Zones are recorded between PROFILE_BEGIN(zone) and PROFILE_END(zone), where zone is a plain
+ * identifier that is also used as the event name. If TAISEI_PROFILE_TRACE is set, all zones are
+ * written to that file on shutdown, in the Chrome Trace Event format (load it in
+ * chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Only available in debug builds; otherwise all of this compiles to nothing. When compiled in
+ * but not enabled at runtime, a zone costs a single predictable branch.
+ */
+
+#ifdef DEBUG
+	#define PROFILER_ENABLED 1
+#else
+	#define PROFILER_ENABLED 0
+#endif
+
+#if PROFILER_ENABLED
+
+extern bool _profiler_active;
+
+void profiler_init(void);
+void profiler_shutdown(void);
+
+// detail is copied; may be NULL
+void _profiler_record(const char *zone, const char *detail, hrtime_t begin, hrtime_t end)
+	attr_nonnull(1);
+
+#define PROFILE_BEGIN(zone) \
+	hrtime_t _profile_begin_##zone = UNLIKELY(_profiler_active) ? time_get() : 0
+
+#define PROFILE_END_DETAIL(zone, detail) do { \
+	if(UNLIKELY(_profile_begin_##zone)) { \
+		_profiler_record(#zone, (detail), _profile_begin_##zone, time_get()); \
+	} \
+} while(0)
+
+#else
+
+#define profiler_init() ((void)0)
+#define profiler_shutdown() ((void)0)
+
+#define PROFILE_BEGIN(zone) ((void)0)
+#define PROFILE_END_DETAIL(zone, detail) ((void)0)
+
+#endif
+
+#define PROFILE_END(zone) PROFILE_END_DETAIL(zone, NULL)
+
+// Wraps a single statement in a zone
+#define PROFILE_ZONE(zone, ...) do { \
+	PROFILE_BEGIN(zone); \
+	{ __VA_ARGS__; } \
+	PROFILE_END(zone); \
+} while(0)
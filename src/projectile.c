@@ -8,11 +8,14 @@
 
 #include "projectile.h"
 
+#include "collision_grid.h"
+#include "coroutine/cotask.h"
 #include "global.h"
 #include "list.h"
 #include "stageobjects.h"
 #include "util/glm.h"
 #include "stage.h"
+#include "util/env.h"
 
 static ht_ptr2int_t shader_sublayer_map;
 
@@ -128,6 +131,7 @@ static cmplx projectile_size(Projectile *p) {
 }
 
 static Projectile *spawn_bullet_spawning_effect(Projectile *p);
+static inline bool proj_uses_spawning_effect(Projectile *proj, ProjFlags effect_flag);
 
 // Returns true if projectile should be destroyed
 static inline bool proj_update(Projectile *p, int t) {
@@ -338,6 +342,27 @@ void delete_projectiles(ProjectileList *projlist) {
 	alist_foreach(projlist, foreach_delete_projectile, NULL);
 }
 
+static inline void proj_check_lerp_distance(Projectile *p, LineSegment seg) {
+#ifdef DEBUG
+	attr_unused real seglen2 = cabs2(seg.a - seg.b);
+
+	if(seglen2 > 30 * 30) {
+		attr_unused real seglen = sqrt(seglen2);
+		log_debug(
+			seglen > VIEWPORT_W
+				? "Lerp over HUGE distance %f; this is ABSOLUTELY a bug! Player speed was %f. Spawned at %s:%d (%s); proj time = %d"
+				: "Lerp over large distance %f; this is either a bug or a very fast projectile, investigate. Player speed was %f. Spawned at %s:%d (%s); proj time = %d",
+			seglen,
+			cabs(global.plr.velocity),
+			p->debug.file,
+			p->debug.line,
+			p->debug.func,
+			global.frames - p->birthtime
+		);
+	}
+#endif
+}
+
 void calc_projectile_collision(Projectile *p, ProjCollisionResult *out_col) {
 	out_col->type = PCOL_NONE;
 	out_col->entity = NULL;
@@ -361,24 +386,7 @@ void calc_projectile_collision(Projectile *p, ProjCollisionResult *out_col) {
 			.b = global.plr.pos - p->pos
 		};
 
-#ifdef DEBUG
-		attr_unused real seglen2 = cabs2(seg.a - seg.b);
-
-		if(seglen2 > 30 * 30) {
-			attr_unused real seglen = sqrt(seglen2);
-			log_debug(
-				seglen > VIEWPORT_W
-					? "Lerp over HUGE distance %f; this is ABSOLUTELY a bug! Player speed was %f. Spawned at %s:%d (%s); proj time = %d"
-					: "Lerp over large distance %f; this is either a bug or a very fast projectile, investigate. Player speed was %f. Spawned at %s:%d (%s); proj time = %d",
-				seglen,
-				cabs(global.plr.velocity),
-				p->debug.file,
-				p->debug.line,
-				p->debug.func,
-				global.frames - p->birthtime
-			);
-		}
-#endif
+		proj_check_lerp_distance(p, seg);
 
 		if(lineseg_ellipse_intersect(seg, e_proj)) {
 			out_col->type = PCOL_ENTITY;
@@ -394,26 +402,11 @@ void calc_projectile_collision(Projectile *p, ProjCollisionResult *out_col) {
 			}
 		}
 	} else if(p->type == PROJ_PLAYER) {
-		for(Enemy *e = global.enemies.first; e; e = e->next) {
-			if(
-				!(e->flags & EFLAG_NO_HIT) &&
-				cabs2(e->pos - p->pos) < e->hit_radius * e->hit_radius
-			) {
-				out_col->type = PCOL_ENTITY;
-				out_col->entity = &e->ent;
-				out_col->fatal = !(p->flags & PFLAG_INDESTRUCTIBLE);
-
-				return;
-			}
-		}
+		EntityInterface *target = collision_grid_find_shot_target(p->pos);
 
-		if(
-			global.boss &&
-			boss_is_vulnerable(global.boss) &&
-			cabs2(global.boss->pos - p->pos) < 42 * 42
-		) {
+		if(target) {
 			out_col->type = PCOL_ENTITY;
-			out_col->entity = &global.boss->ent;
+			out_col->entity = target;
 			out_col->fatal = !(p->flags & PFLAG_INDESTRUCTIBLE);
 		}
 	}
@@ -566,51 +559,347 @@ void kill_projectile(Projectile *proj) {
 	coevent_signal_once(&proj->events.killed);
 }
 
-void process_projectiles(ProjectileList *projlist, bool collision) {
-	ProjCollisionResult col = {};
-	bool stage_cleared = stage_is_cleared();
+/*
+ * Projectiles are processed in chunks of up to PROJ_BATCH_SIZE. The per-frame update of every
+ * projectile in a chunk is done first, then the hot state needed for collision detection is
+ * gathered into a structure-of-arrays buffer and classified in one tight pass, and finally the
+ * collision results are applied in list order.
+ *
+ * This runs the updates of later projectiles before the results of earlier ones are applied,
+ * which is only correct as long as applying those results has no effect on anything else.
+ * Applying a collision may run arbitrary task code (via events) or damage an entity, though, and
+ * such code may well modify the projectiles that come after it. So right after updating each
+ * projectile, a cheap conservative test decides whether its result could possibly be anything
+ * but inert (not culled, not destroyed, nowhere near the player or a shot target, nobody
+ * listening for its collision event). The first projectile that fails the test ends the chunk,
+ * so that nothing has been updated ahead of it when its result is applied. The outcome is always
+ * exactly identical to processing projectiles one at a time, which is required to keep replays
+ * in sync.
+ */
 
-	for(Projectile *proj = projlist->first, *next; proj; proj = next) {
-		next = proj->next;
+enum {
+	PROJ_BATCH_SIZE = 64,
+};
+
+typedef struct ProjBatch {
+	// Hot state, one lane per projectile. Only meaningful for the lanes that need it.
+	struct {
+		alignas(32) double collision_w[PROJ_BATCH_SIZE];
+		alignas(32) double collision_h[PROJ_BATCH_SIZE];
+		alignas(32) double graze_w[PROJ_BATCH_SIZE];
+		alignas(32) double graze_h[PROJ_BATCH_SIZE];
+		alignas(32) double angle[PROJ_BATCH_SIZE];   // collision ellipse angle
+		alignas(32) double seg_a_x[PROJ_BATCH_SIZE]; // player movement segment, relative to the projectile
+		alignas(32) double seg_a_y[PROJ_BATCH_SIZE];
+		alignas(32) double seg_b_x[PROJ_BATCH_SIZE];
+		alignas(32) double seg_b_y[PROJ_BATCH_SIZE];
+		ProjFlags flags[PROJ_BATCH_SIZE];
+		ProjType type[PROJ_BATCH_SIZE];
+	} hot;
+
+	bool destroy[PROJ_BATCH_SIZE];
+	bool in_viewport[PROJ_BATCH_SIZE];
+	EntityInterface *shot_target[PROJ_BATCH_SIZE];
+	uint64_t near_player_mask;
+	uint64_t hit_mask;
+	uint64_t graze_mask;
+
+	Projectile *projs[PROJ_BATCH_SIZE];
+	ProjCollisionResult results[PROJ_BATCH_SIZE];
+	uint count;
+} ProjBatch;
+
+static_assert(PROJ_BATCH_SIZE <= 64, "Collision masks must fit into one word");
+
+static ProjBatch proj_batch;
+static bool proj_batching_enabled = true;
+
+void projectiles_set_batching(bool enable) {
+	proj_batching_enabled = enable;
+}
+
+static inline bool proj_batch_eligible(Projectile *p) {
+	if(p->flags & PFLAG_INTERNAL_DEAD) {
+		return false;
+	}
+
+	// The spawning effect consumes RNG state and spawns particles, see proj_update()
+	if(
+		global.frames - p->birthtime == 1 &&
+		proj_uses_spawning_effect(p, PFLAG_NOSPAWNFLARE)
+	) {
+		return false;
+	}
+
+	return true;
+}
+
+static inline bool proj_pre_update(Projectile *p) {
+	bool destroy = proj_update(p, global.frames - p->birthtime);
+
+	if(p->graze_counter && p->graze_counter_reset_timer - global.frames <= -90) {
+		p->graze_counter--;
+		p->graze_counter_reset_timer = global.frames;
+	}
+
+	if(p->type == PROJ_DEAD && !(p->clear_flags & CLEAR_HAZARDS_NOW)) {
+		p->clear_flags |= CLEAR_HAZARDS_NOW;
+	}
+
+	return destroy;
+}
+
+// Gathers the hot state of a freshly updated projectile. Returns true if applying its collision
+// result is guaranteed to have no side effects.
+static bool proj_batch_gather(ProjBatch *b, uint i, Projectile *p, bool collision) {
+	auto h = &b->hot;
+	uint64_t lane = UINT64_C(1) << i;
+
+	h->flags[i] = p->flags;
+	h->type[i] = p->type;
+	b->in_viewport[i] = (p->flags & PFLAG_NOAUTOREMOVE) || projectile_in_viewport(p);
+	b->shot_target[i] = NULL;
+	b->near_player_mask &= ~lane;
+
+	if(b->destroy[i] || !b->in_viewport[i]) {
+		return false;
+	}
+
+	if(p->events.collision.subscribers.num_elements) {
+		return false;
+	}
+
+	if(!collision || (p->flags & PFLAG_NOCOLLISION)) {
+		return true;
+	}
+
+	if(p->type == PROJ_PLAYER) {
+		b->shot_target[i] = collision_grid_find_shot_target(p->pos);
+		return !b->shot_target[i];
+	}
+
+	if(p->type != PROJ_ENEMY) {
+		return true;
+	}
+
+	// Same arithmetic as calc_projectile_collision()
+	LineSegment seg = {
+		.a = global.plr.pos - global.plr.velocity - p->prevpos,
+		.b = global.plr.pos - p->pos,
+	};
+
+	proj_check_lerp_distance(p, seg);
+
+	cmplx graze_size = projectile_graze_size(p);
+
+	// Both ellipses fit into a circle of this radius, with plenty of room for rounding
+	real r = max(max(re(p->collision_size), im(p->collision_size)), max(re(graze_size), im(graze_size))) + 1;
+
+	if(
+		fmin(re(seg.a), re(seg.b)) > r || fmax(re(seg.a), re(seg.b)) < -r ||
+		fmin(im(seg.a), im(seg.b)) > r || fmax(im(seg.a), im(seg.b)) < -r
+	) {
+		return true;
+	}
+
+	h->seg_a_x[i] = re(seg.a);
+	h->seg_a_y[i] = im(seg.a);
+	h->seg_b_x[i] = re(seg.b);
+	h->seg_b_y[i] = im(seg.b);
+	h->collision_w[i] = re(p->collision_size);
+	h->collision_h[i] = im(p->collision_size);
+	h->graze_w[i] = re(graze_size);
+	h->graze_h[i] = im(graze_size);
+	h->angle[i] = p->angle + M_PI/2;
+	b->near_player_mask |= lane;
 
-		if(proj->flags & PFLAG_INTERNAL_DEAD) {
-			delete_projectile(projlist, proj, NULL);
+	return false;
+}
+
+static void proj_batch_test_player(ProjBatch *b) {
+	auto h = &b->hot;
+	uint64_t lanes = b->near_player_mask;
+
+	b->hit_mask = 0;
+	b->graze_mask = 0;
+
+	if(!lanes) {
+		return;
+	}
+
+	LineSegmentBatch segs = {
+		.a_x = h->seg_a_x,
+		.a_y = h->seg_a_y,
+		.b_x = h->seg_b_x,
+		.b_y = h->seg_b_y,
+	};
+
+	b->hit_mask = lanes;
+	lineseg_ellipse_intersect_batch(b->count, &segs, &(EllipseBatch) {
+		.axes_x = h->collision_w,
+		.axes_y = h->collision_h,
+		.angle = h->angle,
+	}, &b->hit_mask);
+
+	uint64_t missed = lanes & ~b->hit_mask;
+	uint64_t graze_lanes = 0;
+
+	for(uint i = 0; i < b->count; ++i) {
+		if((missed & (UINT64_C(1) << i)) && h->graze_w[i] > 1) {
+			graze_lanes |= UINT64_C(1) << i;
+		}
+	}
+
+	b->graze_mask = graze_lanes;
+	lineseg_ellipse_intersect_batch(b->count, &segs, &(EllipseBatch) {
+		.axes_x = h->graze_w,
+		.axes_y = h->graze_h,
+		.angle = h->angle,
+	}, &b->graze_mask);
+}
+
+static void proj_batch_classify(ProjBatch *b, bool collision) {
+	auto h = &b->hot;
+
+	if(collision) {
+		proj_batch_test_player(b);
+	} else {
+		b->hit_mask = 0;
+		b->graze_mask = 0;
+	}
+
+	// Mirrors calc_projectile_collision()
+	for(uint i = 0; i < b->count; ++i) {
+		Projectile *p = b->projs[i];
+		ProjCollisionResult *col = b->results + i;
+
+		if(b->destroy[i]) {
+			*col = (typeof(*col)) { .fatal = true };
 			continue;
 		}
 
-		if(stage_cleared) {
-			clear_projectile(proj, CLEAR_HAZARDS_BULLETS | CLEAR_HAZARDS_FORCE);
+		if(!collision) {
+			*col = (typeof(*col)) { .fatal = !b->in_viewport[i] };
+			continue;
 		}
 
-		bool destroy = proj_update(proj, global.frames - proj->birthtime);
+		*col = (typeof(*col)) {
+			.type = PCOL_NONE,
+			.location = p->pos,
+			.damage.amount = p->damage,
+			.damage.type = p->damage_type,
+		};
 
-		if(proj->graze_counter && proj->graze_counter_reset_timer - global.frames <= -90) {
-			proj->graze_counter--;
-			proj->graze_counter_reset_timer = global.frames;
+		if(!(h->flags[i] & PFLAG_NOCOLLISION)) {
+			if(b->hit_mask & (UINT64_C(1) << i)) {
+				col->type = PCOL_ENTITY;
+				col->entity = &global.plr.ent;
+				col->fatal = !(h->flags[i] & PFLAG_INDESTRUCTIBLE);
+			} else if(b->graze_mask & (UINT64_C(1) << i)) {
+				col->type = PCOL_PLAYER_GRAZE;
+				col->entity = &global.plr.ent;
+			} else if(b->shot_target[i]) {
+				col->type = PCOL_ENTITY;
+				col->entity = b->shot_target[i];
+				col->fatal = !(h->flags[i] & PFLAG_INDESTRUCTIBLE);
+			}
 		}
 
-		if(proj->type == PROJ_DEAD && !(proj->clear_flags & CLEAR_HAZARDS_NOW)) {
-			proj->clear_flags |= CLEAR_HAZARDS_NOW;
+		if(col->type == PCOL_NONE && !b->in_viewport[i]) {
+			col->type = PCOL_VOID;
+			col->fatal = true;
 		}
+	}
+}
 
-		if(destroy) {
-			col = (typeof(col)) { .fatal = true };
-		} else if(collision) {
-			calc_projectile_collision(proj, &col);
+// Returns the next projectile to process.
+static Projectile *process_projectile_batch(ProjectileList *projlist, Projectile *first, bool collision) {
+	ProjBatch *b = &proj_batch;
+	Projectile *p = first;
+	b->count = 0;
+
+	while(p && b->count < PROJ_BATCH_SIZE && proj_batch_eligible(p)) {
+		uint i = b->count++;
+		b->projs[i] = p;
+		b->destroy[i] = proj_pre_update(p);
+		bool inert = proj_batch_gather(b, i, p, collision);
+		p = p->next;
+
+		if(!inert) {
+			// Applying this result may affect the projectiles after it, so they must not be
+			// updated until it has been applied.
+			break;
+		}
+	}
 
-			if(col.fatal && col.type != PCOL_VOID) {
-				spawn_projectile_collision_effect(proj);
-			}
-		} else {
-			col = (typeof(col)) { };
+	Projectile *next = p;
 
-			if(!(proj->flags & PFLAG_NOAUTOREMOVE) && !projectile_in_viewport(proj)) {
-				col.fatal = true;
-			}
+	proj_batch_classify(b, collision);
+
+	for(uint i = 0; i < b->count; ++i) {
+		Projectile *proj = b->projs[i];
+		ProjCollisionResult *col = b->results + i;
+
+		if(col->type == PCOL_ENTITY && col->fatal) {
+			spawn_projectile_collision_effect(proj);
 		}
 
 		proj->prevpos = proj->pos;
-		apply_projectile_collision(projlist, proj, &col);
+		apply_projectile_collision(projlist, proj, col);
+	}
+
+	return next;
+}
+
+static void process_projectile(ProjectileList *projlist, Projectile *proj, bool collision, bool stage_cleared) {
+	ProjCollisionResult col;
+
+	if(proj->flags & PFLAG_INTERNAL_DEAD) {
+		delete_projectile(projlist, proj, NULL);
+		return;
+	}
+
+	if(stage_cleared) {
+		clear_projectile(proj, CLEAR_HAZARDS_BULLETS | CLEAR_HAZARDS_FORCE);
+	}
+
+	bool destroy = proj_pre_update(proj);
+
+	if(destroy) {
+		col = (typeof(col)) { .fatal = true };
+	} else if(collision) {
+		calc_projectile_collision(proj, &col);
+
+		if(col.fatal && col.type != PCOL_VOID) {
+			spawn_projectile_collision_effect(proj);
+		}
+	} else {
+		col = (typeof(col)) { };
+
+		if(!(proj->flags & PFLAG_NOAUTOREMOVE) && !projectile_in_viewport(proj)) {
+			col.fatal = true;
+		}
+	}
+
+	proj->prevpos = proj->pos;
+	apply_projectile_collision(projlist, proj, &col);
+}
+
+void process_projectiles(ProjectileList *projlist, bool collision) {
+	bool stage_cleared = stage_is_cleared();
+	bool batching = proj_batching_enabled && !stage_cleared;
+
+	if(collision) {
+		collision_grid_begin_pass();
+	}
+
+	for(Projectile *proj = projlist->first, *next; proj; proj = next) {
+		if(batching && proj_batch_eligible(proj)) {
+			next = process_projectile_batch(projlist, proj, collision);
+		} else {
+			next = proj->next;
+			process_projectile(projlist, proj, collision, stage_cleared);
+		}
 	}
 
 	for(Projectile *proj = projlist->first, *next; proj; proj = next) {
@@ -620,6 +909,10 @@ void process_projectiles(ProjectileList *projlist, bool collision) {
 			really_clear_projectile(projlist, proj);
 		}
 	}
+
+	if(collision) {
+		collision_grid_end_pass();
+	}
 }
 
 int trace_projectile(Projectile *p, ProjCollisionResult *out_col, ProjCollisionType stopflags, int timeofs) {
@@ -1105,6 +1398,8 @@ void projectiles_preload(ResourceGroup *rg) {
 
 	defaults_proj.shader_ptr = res_shader(defaults_proj.shader);
 	defaults_part.shader_ptr = res_shader(defaults_part.shader);
+
+	projectiles_set_batching(env_get("TAISEI_PROJ_BATCH", true));
 }
 
 void projectiles_free(void) {
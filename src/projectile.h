@@ -239,6 +239,9 @@ void apply_projectile_collision(ProjectileList *projlist, Projectile *p, ProjCol
 int trace_projectile(Projectile *p, ProjCollisionResult *out_col, ProjCollisionType stopflags, int timeofs) attr_nonnull_all;
 bool projectile_in_viewport(Projectile *proj) attr_nonnull_all;
 void process_projectiles(ProjectileList *projlist, bool collision) attr_hot attr_nonnull_all;
+
+// Batched processing is on by default; results are identical either way.
+void projectiles_set_batching(bool enable);
 bool projectile_is_clearable(Projectile *p) attr_nonnull_all;
 
 Projectile *spawn_projectile_collision_effect(Projectile *proj) attr_nonnull_all;
@@ -10,8 +10,10 @@
 
 #include "common/backend.h"
 #include "common/matstack.h"
+#include "common/render_thread.h"
 #include "common/sprite_batch_internal.h"
 #include "common/state.h"
+#include "common/uniform_ids.h"
 
 #include "coroutine/coroutine.h"
 #include "hirestime.h"
@@ -43,6 +45,7 @@ void r_init(void) {
 	_r_backend_init();
 	_r_state_init();
 	_r_mat_init();
+	_r_uniform_ids_init();
 }
 
 void r_post_init(void) {
@@ -95,6 +98,7 @@ void r_shutdown(void) {
 
 	_r_state_shutdown();
 	B.shutdown();
+	_r_uniform_ids_shutdown();
 }
 
 const char *r_backend_name(void) {
@@ -276,7 +280,13 @@ VertexAttribFormat* r_vertex_attrib_format_interleaved(
 // A more realisic TODO would be to put assertions/argument validation here.
 
 SDL_Window* r_create_window(const char *title, int x, int y, int w, int h, uint32_t flags) {
-	return B.create_window(title, x, y, w, h, flags);
+	SDL_Window *window = B.create_window(title, x, y, w, h, flags);
+
+	if(window && !_r_render_thread.active && env_get("TAISEI_RENDERER_THREADED", false)) {
+		_r_render_thread_start(window);
+	}
+
+	return window;
 }
 
 void r_unclaim_window(SDL_Window *window) {
@@ -386,6 +396,7 @@ ShaderProgram* r_shader_program_link(uint num_objects, ShaderObject *shobjs[num_
 }
 
 void r_shader_program_destroy(ShaderProgram *prog) {
+	_r_uniform_ids_invalidate_program(prog);
 	B.shader_program_destroy(prog);
 }
 
@@ -398,6 +409,8 @@ const char* r_shader_program_get_debug_label(ShaderProgram *prog) {
 }
 
 bool r_shader_program_transfer(ShaderProgram *dst, ShaderProgram *src) {
+	_r_uniform_ids_invalidate_program(dst);
+	_r_uniform_ids_invalidate_program(src);
 	return B.shader_program_transfer(dst, src);
 }
 
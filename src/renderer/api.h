@@ -304,6 +304,9 @@ typedef struct UniformTypeInfo {
 
 typedef struct Uniform Uniform;
 
+// Interned uniform name; see r_uniform_id() and R_UNIFORM(). Zero is never a valid ID.
+typedef uint32_t UniformID;
+
 typedef enum BufferKindFlags {
 	BUFFER_COLOR = (1 << 0),
 	BUFFER_DEPTH = (1 << 1),
@@ -564,6 +567,23 @@ void r_shader_ptr(ShaderProgram *prog) attr_nonnull(1);
 ShaderProgram* r_shader_current(void) attr_returns_nonnull;
 
 Uniform* _r_shader_uniform(ShaderProgram *prog, const char *uniform_name, hash_t uniform_name_hash) attr_nonnull(1, 2);
+UniformID r_uniform_id(const char *uniform_name) attr_nonnull(1);
+Uniform* r_shader_uniform_by_id(ShaderProgram *prog, UniformID id) attr_nonnull(1);
+
+/*
+ * Looks up a uniform of the current shader program by a string literal name, without hashing
+ * the name on every call. The name is interned once per call site, and the lookup result is
+ * cached per program, so this is cheap enough for hot draw code:
+ *
+ *   r_uniform_float(R_UNIFORM("time"), t);
+ */
+#define R_UNIFORM(name) ({ \
+	static UniformID _r_uniform_id_; \
+	if(UNLIKELY(!_r_uniform_id_)) { \
+		_r_uniform_id_ = r_uniform_id("" name ""); \
+	} \
+	r_shader_uniform_by_id(r_shader_current(), _r_uniform_id_); \
+})
 UniformType r_uniform_type(Uniform *uniform);
 void r_uniform_ptr_unsafe(Uniform *uniform, uint offset, uint count, void *data);
 
@@ -875,6 +895,9 @@ VertexArray* r_vertex_array_static_models(void) attr_returns_nonnull;
 
 void r_state_push(void);
 void r_state_pop(void);
+// Undo all state changes made since the last r_state_push(), but keep the scope open.
+// Cheaper than a pop/push pair, especially if nothing was changed.
+void r_state_rollback(void);
 
 void r_draw_quad(void);
 void r_draw_quad_instanced(uint instances);
@@ -99,8 +99,16 @@ CachedBufferUpdate cachedbuf_flush(CachedBuffer *cbuf) {
 		.data = cbuf->cache + cbuf->update_begin,
 	};
 
-	cbuf->update_begin = 0;
+	// Empty range; the next write sets both ends
+	cbuf->update_begin = cbuf->size;
 	cbuf->update_end = 0;
 
 	return u;
 }
+
+void cachedbuf_write(CachedBuffer *cbuf, size_t offset, size_t size, const void *data) {
+	assert(offset + size <= cbuf->size);
+	memcpy(cbuf->cache + offset, data, size);
+	cbuf->update_begin = min(offset, cbuf->update_begin);
+	cbuf->update_end = max(offset + size, cbuf->update_end);
+}
@@ -32,3 +32,6 @@ void cachedbuf_init(CachedBuffer *cbuf);
 void cachedbuf_deinit(CachedBuffer *cbuf);
 void cachedbuf_resize(CachedBuffer *cbuf, size_t newsize);
 CachedBufferUpdate cachedbuf_flush(CachedBuffer *cbuf);
+
+// Like writing to the stream, but without moving the stream offset or resizing the buffer
+void cachedbuf_write(CachedBuffer *cbuf, size_t offset, size_t size, const void *data);
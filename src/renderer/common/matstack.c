@@ -42,6 +42,7 @@ void matstack_pop(MatrixStack *ms) {
 }
 
 MatrixStates _r_matrices;
+MatrixStates *_r_draw_matrices = &_r_matrices;
 
 // BEGIN modelview
 
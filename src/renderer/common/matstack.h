@@ -61,4 +61,8 @@ typedef struct MatrixStates {
 
 extern MatrixStates _r_matrices;
 
+// The matrices backends read when drawing. Normally _r_matrices; the threaded frontend points it
+// at the snapshot recorded with the draw being replayed.
+extern MatrixStates *_r_draw_matrices;
+
 void _r_mat_init(void);
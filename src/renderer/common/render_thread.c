@@ -0,0 +1,1727 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "render_thread.h"
+
+#include "backend.h"
+#include "matstack.h"
+#include "sprite_batch_internal.h"
+
+#include "dynarray.h"
+#include "memory/arena.h"
+
+/*
+ * Commands are recorded into one of two arena-backed streams while the render thread replays the
+ * other. r_swap() hands the recorded frame over and then waits for the previous one to finish, so
+ * the render thread runs at most one frame behind.
+ *
+ * Asynchronous commands copy their arguments (and any data they point to) into the stream's
+ * arena. Synchronous ones point to arguments on the caller's stack, which stay valid because the
+ * caller waits for the stream to be replayed; results are written back through the same struct.
+ */
+
+typedef void (*RenderCommandFunc)(void *args);
+
+typedef struct RenderCommand RenderCommand;
+
+struct RenderCommand {
+	RenderCommand *next;
+	RenderCommandFunc func;
+	void *args;
+};
+
+typedef struct CommandStream {
+	MemArena arena;
+	RenderCommand *head;
+	RenderCommand **tail;
+} CommandStream;
+
+// Vertex buffer stream as seen by the main thread; writes are recorded, not applied.
+typedef struct ProxyStream {
+	SDL_IOStream *io;
+	SDL_IOStream *real_io;  // only touched by the render thread
+	int64_t offset;
+	int64_t size;
+} ProxyStream;
+
+typedef struct TextureCache {
+	TextureParams params;
+	uint sizes[32][2];
+	uint32_t known_sizes;
+	bool have_params;
+} TextureCache;
+
+typedef struct FramebufferCache {
+	FramebufferAttachmentQueryResult attachments[FRAMEBUFFER_MAX_ATTACHMENTS];
+	FramebufferAttachment outputs[FRAMEBUFFER_MAX_OUTPUTS];
+	FloatRect viewport;
+	IntExtent size;
+	uint32_t known_attachments;
+	bool have_outputs;
+	bool have_viewport;
+	bool have_size;
+} FramebufferCache;
+
+typedef struct ReadRequest {
+	FramebufferReadAsyncCallback callback;
+	void *userdata;
+	Pixmap pixmap;
+	bool have_pixmap;
+} ReadRequest;
+
+// Marks a uniform that has been looked up, but doesn't exist in the program.
+static char absent_uniform;
+#define ABSENT_UNIFORM ((void*)&absent_uniform)
+
+static struct {
+	RendererFuncs funcs;
+	Thread *thread;
+	SDL_Semaphore *submit_sem;
+	SDL_Semaphore *done_sem;
+
+	CommandStream streams[2];
+	CommandStream *recording;
+	CommandStream *submitted;
+	bool busy;
+
+	SDL_Window *window;
+	SDL_GLContext gl_context;
+
+	struct {
+		ProxyStream *stream;
+		int64_t offset;
+		DYNAMIC_ARRAY(char) data;
+	} pending_write;
+
+	struct {
+		r_feature_bits_t features;
+		r_capability_bits_t capabilities;
+		Color color;
+		BlendMode blend;
+		CullFaceMode cull;
+		DepthTestFunc depth_func;
+		ShaderProgram *shader;
+		Framebuffer *framebuffer;
+		IntRect scissor;
+		VsyncMode vsync;
+	} shadow;
+
+	ht_ptr2ptr_t program_uniforms;
+	ht_ptr2int_t uniform_types;
+	ht_ptr2ptr_t textures;
+	ht_ptr2ptr_t framebuffers;
+	ht_ptr2ptr_t proxy_streams;
+
+	struct {
+		SDL_Mutex *mutex;
+		DYNAMIC_ARRAY(ReadRequest*) completed;
+	} reads;
+
+	// Snapshot of the matrix stacks for the draw being replayed; see _r_draw_matrices.
+	MatrixStates matrices;
+} RT;
+
+RenderThreadState _r_render_thread;
+
+#define PASSTHROUGH(...) do { \
+	if(_r_render_thread_is_current()) { \
+		return __VA_ARGS__; \
+	} \
+} while(0)
+
+#define PASSTHROUGH_VOID(...) do { \
+	if(_r_render_thread_is_current()) { \
+		__VA_ARGS__; \
+		return; \
+	} \
+} while(0)
+
+/*
+ * Command streams
+ */
+
+static void cmdstream_init(CommandStream *s) {
+	marena_init(&s->arena, 1 << 16);
+	s->head = NULL;
+	s->tail = &s->head;
+}
+
+static void cmdstream_reset(CommandStream *s) {
+	marena_reset(&s->arena);
+	s->head = NULL;
+	s->tail = &s->head;
+}
+
+static void cmdstream_deinit(CommandStream *s) {
+	marena_deinit(&s->arena);
+}
+
+static void push_command(RenderCommandFunc func, void *args) {
+	auto s = RT.recording;
+	auto cmd = ARENA_ALLOC(&s->arena, RenderCommand, {
+		.func = func,
+		.args = args,
+	});
+	*s->tail = cmd;
+	s->tail = &cmd->next;
+}
+
+static void flush_pending_write(void);
+
+static void *record(RenderCommandFunc func, size_t args_size) {
+	assert(thread_current_is_main());
+	flush_pending_write();
+	void *args = marena_alloc(&RT.recording->arena, args_size);
+	push_command(func, args);
+	return args;
+}
+
+static void *record_data(const void *data, size_t size) {
+	return marena_memdup(&RT.recording->arena, data, size);
+}
+
+static void wait_idle(void) {
+	if(RT.busy) {
+		SDL_WaitSemaphore(RT.done_sem);
+		RT.busy = false;
+		cmdstream_reset(RT.submitted);
+	}
+}
+
+static void kick(void) {
+	flush_pending_write();
+	wait_idle();
+
+	if(!RT.recording->head) {
+		return;
+	}
+
+	RT.submitted = RT.recording;
+	RT.recording = RT.recording == RT.streams ? RT.streams + 1 : RT.streams;
+	RT.busy = true;
+	SDL_SignalSemaphore(RT.submit_sem);
+}
+
+static void call_sync(RenderCommandFunc func, void *args) {
+	assert(thread_current_is_main());
+	flush_pending_write();
+	push_command(func, args);
+	kick();
+	wait_idle();
+}
+
+static void *render_thread_main(void *arg) {
+	for(;;) {
+		SDL_WaitSemaphore(RT.submit_sem);
+		CommandStream *s = RT.submitted;
+
+		if(!s) {
+			break;
+		}
+
+		for(RenderCommand *cmd = s->head; cmd; cmd = cmd->next) {
+			cmd->func(cmd->args);
+		}
+
+		SDL_SignalSemaphore(RT.done_sem);
+	}
+
+	return NULL;
+}
+
+#define CMD_ARGS(name) struct cmdargs_##name
+
+#define DEFINE_CMD(name, fields, ...) \
+	CMD_ARGS(name) { MACROHAX_EXPAND fields }; \
+	static void cmd_##name(void *_args) { \
+		attr_unused CMD_ARGS(name) *a = _args; \
+		__VA_ARGS__ \
+	}
+
+#define RECORD(name, ...) ({ \
+	CMD_ARGS(name) *_a = record(cmd_##name, sizeof(*_a)); \
+	*_a = (CMD_ARGS(name)) { __VA_ARGS__ }; \
+	_a; \
+})
+
+#define CALL_SYNC(name, ...) ({ \
+	CMD_ARGS(name) _a = { __VA_ARGS__ }; \
+	call_sync(cmd_##name, &_a); \
+	_a; \
+})
+
+/*
+ * Query caches
+ */
+
+static void forget_program(ShaderProgram *prog) {
+	ht_str2ptr_t *uniforms = ht_get(&RT.program_uniforms, prog, NULL);
+
+	if(!uniforms) {
+		return;
+	}
+
+	ht_str2ptr_iter_t iter;
+	ht_iter_begin(uniforms, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		if(iter.value != ABSENT_UNIFORM) {
+			ht_unset(&RT.uniform_types, iter.value);
+		}
+	}
+
+	ht_iter_end(&iter);
+	ht_destroy(uniforms);
+	mem_free(uniforms);
+	ht_unset(&RT.program_uniforms, prog);
+}
+
+static TextureCache *texture_cache(Texture *tex) {
+	TextureCache *c = ht_get(&RT.textures, tex, NULL);
+
+	if(!c) {
+		c = ALLOC(typeof(*c));
+		ht_set(&RT.textures, tex, c);
+	}
+
+	return c;
+}
+
+static void forget_texture(Texture *tex) {
+	mem_free(ht_get(&RT.textures, tex, NULL));
+	ht_unset(&RT.textures, tex);
+}
+
+static FramebufferCache *framebuffer_cache(Framebuffer *fb) {
+	FramebufferCache *c = ht_get(&RT.framebuffers, fb, NULL);
+
+	if(!c) {
+		c = ALLOC(typeof(*c));
+		ht_set(&RT.framebuffers, fb, c);
+	}
+
+	return c;
+}
+
+static void forget_framebuffer(Framebuffer *fb) {
+	mem_free(ht_get(&RT.framebuffers, fb, NULL));
+	ht_unset(&RT.framebuffers, fb);
+}
+
+static void free_ptr_values(ht_ptr2ptr_t *ht) {
+	ht_ptr2ptr_iter_t iter;
+	ht_iter_begin(ht, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		mem_free(iter.value);
+	}
+
+	ht_iter_end(&iter);
+}
+
+/*
+ * Context handover
+ */
+
+DEFINE_CMD(make_context_current, (SDL_Window *window; SDL_GLContext context;), {
+	if(!SDL_GL_MakeCurrent(a->window, a->context)) {
+		log_sdl_error(LOG_FATAL, "SDL_GL_MakeCurrent");
+	}
+})
+
+static void hand_over_context(SDL_Window *window) {
+	SDL_GLContext ctx = SDL_GL_GetCurrentContext();
+
+	if(ctx) {
+		SDL_GL_MakeCurrent(window, NULL);
+		RT.gl_context = ctx;
+	}
+
+	RT.window = window;
+
+	if(RT.gl_context) {
+		CALL_SYNC(make_context_current, window, RT.gl_context);
+	}
+}
+
+static void take_back_context(void) {
+	if(RT.gl_context) {
+		CALL_SYNC(make_context_current, RT.window, NULL);
+	}
+}
+
+/*
+ * Vertex buffer streams
+ */
+
+DEFINE_CMD(vertex_buffer_write, (ProxyStream *stream; int64_t offset; size_t size; void *data;), {
+	SDL_SeekIO(a->stream->real_io, a->offset, SDL_IO_SEEK_SET);
+	SDL_WriteIO(a->stream->real_io, a->data, a->size);
+})
+
+static void flush_pending_write(void) {
+	auto ps = RT.pending_write.stream;
+
+	if(!ps) {
+		return;
+	}
+
+	RT.pending_write.stream = NULL;
+
+	auto a = RECORD(vertex_buffer_write,
+		.stream = ps,
+		.offset = RT.pending_write.offset,
+		.size = RT.pending_write.data.num_elements,
+	);
+	a->data = record_data(RT.pending_write.data.data, a->size);
+	RT.pending_write.data.num_elements = 0;
+}
+
+static size_t proxy_stream_write(void *ctx, const void *data, size_t size, SDL_IOStatus *status) {
+	ProxyStream *ps = ctx;
+	auto pw = &RT.pending_write;
+
+	if(pw->stream != ps || pw->offset + pw->data.num_elements != ps->offset) {
+		flush_pending_write();
+		pw->stream = ps;
+		pw->offset = ps->offset;
+	}
+
+	dynarray_ensure_capacity(&pw->data, pw->data.num_elements + size);
+	memcpy(pw->data.data + pw->data.num_elements, data, size);
+	pw->data.num_elements += size;
+
+	ps->offset += size;
+	ps->size = max(ps->size, ps->offset);
+
+	return size;
+}
+
+static int64_t proxy_stream_seek(void *ctx, int64_t offset, SDL_IOWhence whence) {
+	ProxyStream *ps = ctx;
+
+	switch(whence) {
+		case SDL_IO_SEEK_CUR: ps->offset += offset;            break;
+		case SDL_IO_SEEK_END: ps->offset = ps->size + offset;  break;
+		case SDL_IO_SEEK_SET: ps->offset = offset;             break;
+	}
+
+	assert(ps->offset <= ps->size);
+	return ps->offset;
+}
+
+static int64_t proxy_stream_size(void *ctx) {
+	ProxyStream *ps = ctx;
+	return ps->size;
+}
+
+DEFINE_CMD(vertex_buffer_get_stream, (VertexBuffer *vbuf; SDL_IOStream *stream; int64_t offset; int64_t size;), {
+	a->stream = RT.funcs.vertex_buffer_get_stream(a->vbuf);
+	a->offset = max(0, SDL_TellIO(a->stream));
+	a->size = max(0, SDL_GetIOSize(a->stream));
+})
+
+static SDL_IOStream *proxy_vertex_buffer_get_stream(VertexBuffer *vbuf) {
+	PASSTHROUGH(RT.funcs.vertex_buffer_get_stream(vbuf));
+
+	ProxyStream *ps = ht_get(&RT.proxy_streams, vbuf, NULL);
+
+	if(!ps) {
+		auto r = CALL_SYNC(vertex_buffer_get_stream, .vbuf = vbuf);
+
+		ps = ALLOC(typeof(*ps), {
+			.real_io = r.stream,
+			.offset = r.offset,
+			.size = r.size,
+		});
+
+		ps->io = NOT_NULL(SDL_OpenIO(&(SDL_IOStreamInterface) {
+			.version = sizeof(SDL_IOStreamInterface),
+			.write = proxy_stream_write,
+			.seek = proxy_stream_seek,
+			.size = proxy_stream_size,
+		}, ps));
+
+		ht_set(&RT.proxy_streams, vbuf, ps);
+	}
+
+	return ps->io;
+}
+
+/*
+ * Framebuffer readbacks
+ *
+ * Callbacks are delivered on the main thread, like they are without the render thread.
+ */
+
+static void read_async_done(const Pixmap *pixmap, void *userdata) {
+	ReadRequest *req = userdata;
+
+	if(pixmap) {
+		pixmap_copy_alloc(pixmap, &req->pixmap);
+		req->have_pixmap = true;
+	}
+
+	SDL_LockMutex(RT.reads.mutex);
+	dynarray_append(&RT.reads.completed, req);
+	SDL_UnlockMutex(RT.reads.mutex);
+}
+
+static void dispatch_read_callbacks(void) {
+	SDL_LockMutex(RT.reads.mutex);
+	auto completed = RT.reads.completed;
+	RT.reads.completed = (typeof(completed)) {};
+	SDL_UnlockMutex(RT.reads.mutex);
+
+	dynarray_foreach_elem(&completed, ReadRequest **preq, {
+		ReadRequest *req = *preq;
+		req->callback(req->have_pixmap ? &req->pixmap : NULL, req->userdata);
+		mem_free(req->pixmap.data.untyped);
+		mem_free(req);
+	});
+
+	dynarray_free_data(&completed);
+}
+
+/*
+ * Proxies
+ */
+
+DEFINE_CMD(post_init, (), {
+	RT.funcs.post_init();
+})
+
+static void proxy_post_init(void) {
+	CALL_SYNC(post_init);
+}
+
+DEFINE_CMD(shutdown, (), {
+	RT.funcs.shutdown();
+})
+
+static void proxy_shutdown(void) {
+	CALL_SYNC(shutdown);
+
+	RT.submitted = NULL;
+	SDL_SignalSemaphore(RT.submit_sem);
+	thread_wait(RT.thread);
+	RT.thread = NULL;
+
+	_r_render_thread = (RenderThreadState) {};
+	_r_draw_matrices = &_r_matrices;
+	_r_backend.funcs = RT.funcs;
+
+	dispatch_read_callbacks();
+
+	ht_ptr2ptr_iter_t iter;
+	ht_iter_begin(&RT.program_uniforms, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		ht_destroy((ht_str2ptr_t*)iter.value);
+	}
+
+	ht_iter_end(&iter);
+
+	ht_iter_begin(&RT.proxy_streams, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		SDL_CloseIO(((ProxyStream*)iter.value)->io);
+	}
+
+	ht_iter_end(&iter);
+
+	free_ptr_values(&RT.program_uniforms);
+	free_ptr_values(&RT.textures);
+	free_ptr_values(&RT.framebuffers);
+	free_ptr_values(&RT.proxy_streams);
+	ht_destroy(&RT.program_uniforms);
+	ht_destroy(&RT.uniform_types);
+	ht_destroy(&RT.textures);
+	ht_destroy(&RT.framebuffers);
+	ht_destroy(&RT.proxy_streams);
+
+	cmdstream_deinit(RT.streams + 0);
+	cmdstream_deinit(RT.streams + 1);
+	dynarray_free_data(&RT.pending_write.data);
+	SDL_DestroyMutex(RT.reads.mutex);
+	SDL_DestroySemaphore(RT.submit_sem);
+	SDL_DestroySemaphore(RT.done_sem);
+
+	RT = (typeof(RT)) {};
+}
+
+static SDL_Window *proxy_create_window(const char *title, int x, int y, int w, int h, uint32_t flags) {
+	take_back_context();
+	SDL_Window *window = RT.funcs.create_window(title, x, y, w, h, flags);
+	hand_over_context(window ?: RT.window);
+	return window;
+}
+
+DEFINE_CMD(unclaim_window, (SDL_Window *window;), {
+	RT.funcs.unclaim_window(a->window);
+})
+
+static void proxy_unclaim_window(SDL_Window *window) {
+	CALL_SYNC(unclaim_window, window);
+}
+
+static r_feature_bits_t proxy_features(void) {
+	return RT.shadow.features;
+}
+
+DEFINE_CMD(capabilities, (r_capability_bits_t capbits;), {
+	RT.funcs.capabilities(a->capbits);
+})
+
+static void proxy_capabilities(r_capability_bits_t capbits) {
+	PASSTHROUGH_VOID(RT.funcs.capabilities(capbits));
+	RT.shadow.capabilities = capbits;
+	RECORD(capabilities, capbits);
+}
+
+static r_capability_bits_t proxy_capabilities_current(void) {
+	PASSTHROUGH(RT.funcs.capabilities_current());
+	return RT.shadow.capabilities;
+}
+
+DEFINE_CMD(draw, (
+	VertexArray *varr;
+	Primitive prim;
+	uint first;
+	uint count;
+	uint instances;
+	uint base_instance;
+	bool indexed;
+	mat4_noalign matrices[3];
+), {
+	for(int i = 0; i < ARRAY_SIZE(a->matrices); ++i) {
+		memcpy(*RT.matrices.indexed[i].head, a->matrices[i], sizeof(mat4));
+	}
+
+	if(a->indexed) {
+		RT.funcs.draw_indexed(a->varr, a->prim, a->first, a->count, a->instances, a->base_instance);
+	} else {
+		RT.funcs.draw(a->varr, a->prim, a->first, a->count, a->instances, a->base_instance);
+	}
+})
+
+static void record_draw(
+	bool indexed, VertexArray *varr, Primitive prim, uint first, uint count, uint instances, uint base_instance
+) {
+	// The backend would flush pending sprites before drawing; do it here, where they are.
+	r_flush_sprites();
+
+	auto a = RECORD(draw,
+		.varr = varr,
+		.prim = prim,
+		.first = first,
+		.count = count,
+		.instances = instances,
+		.base_instance = base_instance,
+		.indexed = indexed,
+	);
+
+	for(int i = 0; i < ARRAY_SIZE(a->matrices); ++i) {
+		memcpy(a->matrices[i], *_r_matrices.indexed[i].head, sizeof(mat4));
+	}
+}
+
+static void proxy_draw(VertexArray *varr, Primitive prim, uint firstvert, uint count, uint instances, uint base_instance) {
+	PASSTHROUGH_VOID(RT.funcs.draw(varr, prim, firstvert, count, instances, base_instance));
+	record_draw(false, varr, prim, firstvert, count, instances, base_instance);
+}
+
+static void proxy_draw_indexed(VertexArray *varr, Primitive prim, uint firstidx, uint count, uint instances, uint base_instance) {
+	PASSTHROUGH_VOID(RT.funcs.draw_indexed(varr, prim, firstidx, count, instances, base_instance));
+	record_draw(true, varr, prim, firstidx, count, instances, base_instance);
+}
+
+DEFINE_CMD(color4, (Color color;), {
+	RT.funcs.color4(a->color.r, a->color.g, a->color.b, a->color.a);
+})
+
+static void proxy_color4(float r, float g, float b, float a) {
+	PASSTHROUGH_VOID(RT.funcs.color4(r, g, b, a));
+	RT.shadow.color = *RGBA(r, g, b, a);
+	RECORD(color4, RT.shadow.color);
+}
+
+static const Color *proxy_color_current(void) {
+	PASSTHROUGH(RT.funcs.color_current());
+	return &RT.shadow.color;
+}
+
+DEFINE_CMD(blend, (BlendMode mode;), {
+	RT.funcs.blend(a->mode);
+})
+
+static void proxy_blend(BlendMode mode) {
+	PASSTHROUGH_VOID(RT.funcs.blend(mode));
+	RT.shadow.blend = mode;
+	RECORD(blend, mode);
+}
+
+static BlendMode proxy_blend_current(void) {
+	PASSTHROUGH(RT.funcs.blend_current());
+	return RT.shadow.blend;
+}
+
+DEFINE_CMD(cull, (CullFaceMode mode;), {
+	RT.funcs.cull(a->mode);
+})
+
+static void proxy_cull(CullFaceMode mode) {
+	PASSTHROUGH_VOID(RT.funcs.cull(mode));
+	RT.shadow.cull = mode;
+	RECORD(cull, mode);
+}
+
+static CullFaceMode proxy_cull_current(void) {
+	PASSTHROUGH(RT.funcs.cull_current());
+	return RT.shadow.cull;
+}
+
+DEFINE_CMD(depth_func, (DepthTestFunc func;), {
+	RT.funcs.depth_func(a->func);
+})
+
+static void proxy_depth_func(DepthTestFunc func) {
+	PASSTHROUGH_VOID(RT.funcs.depth_func(func));
+	RT.shadow.depth_func = func;
+	RECORD(depth_func, func);
+}
+
+static DepthTestFunc proxy_depth_func_current(void) {
+	PASSTHROUGH(RT.funcs.depth_func_current());
+	return RT.shadow.depth_func;
+}
+
+DEFINE_CMD(shader_language_supported, (
+	const ShaderLangInfo *lang;
+	SPIRVTranspileOptions *transpile_opts;
+	bool result;
+), {
+	a->result = RT.funcs.shader_language_supported(a->lang, a->transpile_opts);
+})
+
+static bool proxy_shader_language_supported(const ShaderLangInfo *lang, SPIRVTranspileOptions *transpile_opts) {
+	PASSTHROUGH(RT.funcs.shader_language_supported(lang, transpile_opts));
+	return CALL_SYNC(shader_language_supported, lang, transpile_opts).result;
+}
+
+DEFINE_CMD(shader_object_compile, (ShaderSource *source; ShaderObject *result;), {
+	a->result = RT.funcs.shader_object_compile(a->source);
+})
+
+static ShaderObject *proxy_shader_object_compile(ShaderSource *source) {
+	return CALL_SYNC(shader_object_compile, source).result;
+}
+
+DEFINE_CMD(shader_object_destroy, (ShaderObject *shobj;), {
+	RT.funcs.shader_object_destroy(a->shobj);
+})
+
+static void proxy_shader_object_destroy(ShaderObject *shobj) {
+	RECORD(shader_object_destroy, shobj);
+}
+
+DEFINE_CMD(shader_object_set_debug_label, (ShaderObject *shobj; const char *label;), {
+	RT.funcs.shader_object_set_debug_label(a->shobj, a->label);
+})
+
+static void proxy_shader_object_set_debug_label(ShaderObject *shobj, const char *label) {
+	auto a = RECORD(shader_object_set_debug_label, shobj);
+	a->label = label ? marena_strdup(&RT.recording->arena, label) : NULL;
+}
+
+DEFINE_CMD(shader_object_get_debug_label, (ShaderObject *shobj; const char *result;), {
+	a->result = RT.funcs.shader_object_get_debug_label(a->shobj);
+})
+
+static const char *proxy_shader_object_get_debug_label(ShaderObject *shobj) {
+	return CALL_SYNC(shader_object_get_debug_label, shobj).result;
+}
+
+DEFINE_CMD(shader_object_transfer, (ShaderObject *dst; ShaderObject *src; bool result;), {
+	a->result = RT.funcs.shader_object_transfer(a->dst, a->src);
+})
+
+static bool proxy_shader_object_transfer(ShaderObject *dst, ShaderObject *src) {
+	return CALL_SYNC(shader_object_transfer, dst, src).result;
+}
+
+DEFINE_CMD(shader_program_link, (uint num_objects; ShaderObject **shobjs; ShaderProgram *result;), {
+	a->result = RT.funcs.shader_program_link(a->num_objects, a->shobjs);
+})
+
+static ShaderProgram *proxy_shader_program_link(uint num_objects, ShaderObject *shobjs[num_objects]) {
+	return CALL_SYNC(shader_program_link, num_objects, shobjs).result;
+}
+
+DEFINE_CMD(shader_program_destroy, (ShaderProgram *prog;), {
+	RT.funcs.shader_program_destroy(a->prog);
+})
+
+static void proxy_shader_program_destroy(ShaderProgram *prog) {
+	forget_program(prog);
+	RECORD(shader_program_destroy, prog);
+}
+
+DEFINE_CMD(shader_program_set_debug_label, (ShaderProgram *prog; const char *label;), {
+	RT.funcs.shader_program_set_debug_label(a->prog, a->label);
+})
+
+static void proxy_shader_program_set_debug_label(ShaderProgram *prog, const char *label) {
+	auto a = RECORD(shader_program_set_debug_label, prog);
+	a->label = label ? marena_strdup(&RT.recording->arena, label) : NULL;
+}
+
+DEFINE_CMD(shader_program_get_debug_label, (ShaderProgram *prog; const char *result;), {
+	a->result = RT.funcs.shader_program_get_debug_label(a->prog);
+})
+
+static const char *proxy_shader_program_get_debug_label(ShaderProgram *prog) {
+	return CALL_SYNC(shader_program_get_debug_label, prog).result;
+}
+
+DEFINE_CMD(shader_program_transfer, (ShaderProgram *dst; ShaderProgram *src; bool result;), {
+	a->result = RT.funcs.shader_program_transfer(a->dst, a->src);
+})
+
+static bool proxy_shader_program_transfer(ShaderProgram *dst, ShaderProgram *src) {
+	forget_program(dst);
+	forget_program(src);
+	return CALL_SYNC(shader_program_transfer, dst, src).result;
+}
+
+DEFINE_CMD(shader, (ShaderProgram *prog;), {
+	RT.funcs.shader(a->prog);
+})
+
+static void proxy_shader(ShaderProgram *prog) {
+	PASSTHROUGH_VOID(RT.funcs.shader(prog));
+	RT.shadow.shader = prog;
+	RECORD(shader, prog);
+}
+
+static ShaderProgram *proxy_shader_current(void) {
+	PASSTHROUGH(RT.funcs.shader_current());
+	return RT.shadow.shader;
+}
+
+DEFINE_CMD(shader_uniform, (
+	ShaderProgram *prog;
+	const char *name;
+	hash_t hash;
+	Uniform *result;
+	UniformType type;
+), {
+	a->result = RT.funcs.shader_uniform(a->prog, a->name, a->hash);
+
+	if(a->result) {
+		a->type = RT.funcs.uniform_type(a->result);
+	}
+})
+
+static Uniform *proxy_shader_uniform(ShaderProgram *prog, const char *uniform_name, hash_t uniform_name_hash) {
+	PASSTHROUGH(RT.funcs.shader_uniform(prog, uniform_name, uniform_name_hash));
+
+	ht_str2ptr_t *uniforms = ht_get(&RT.program_uniforms, prog, NULL);
+
+	if(!uniforms) {
+		uniforms = ALLOC(typeof(*uniforms));
+		ht_create(uniforms);
+		ht_set(&RT.program_uniforms, prog, uniforms);
+	}
+
+	void *u;
+
+	if(ht_lookup_prehashed(uniforms, uniform_name, uniform_name_hash, &u)) {
+		return u == ABSENT_UNIFORM ? NULL : u;
+	}
+
+	auto r = CALL_SYNC(shader_uniform, prog, uniform_name, uniform_name_hash);
+	ht_set(uniforms, uniform_name, r.result ?: ABSENT_UNIFORM);
+
+	if(r.result) {
+		ht_set(&RT.uniform_types, r.result, r.type);
+	}
+
+	return r.result;
+}
+
+DEFINE_CMD(uniform_type, (Uniform *uniform; UniformType result;), {
+	a->result = RT.funcs.uniform_type(a->uniform);
+})
+
+static UniformType proxy_uniform_type(Uniform *uniform) {
+	PASSTHROUGH(RT.funcs.uniform_type(uniform));
+
+	int64_t type;
+
+	if(!ht_lookup(&RT.uniform_types, uniform, &type)) {
+		type = CALL_SYNC(uniform_type, uniform).result;
+		ht_set(&RT.uniform_types, uniform, type);
+	}
+
+	return type;
+}
+
+DEFINE_CMD(uniform, (Uniform *uniform; uint offset; uint count; void *data;), {
+	RT.funcs.uniform(a->uniform, a->offset, a->count, a->data);
+})
+
+static void proxy_uniform(Uniform *uniform, uint offset, uint count, const void *data) {
+	PASSTHROUGH_VOID(RT.funcs.uniform(uniform, offset, count, data));
+
+	auto tinfo = r_uniform_type_info(proxy_uniform_type(uniform));
+	auto a = RECORD(uniform, uniform, offset, count);
+	a->data = record_data(data, count * tinfo->elements * tinfo->element_size);
+}
+
+DEFINE_CMD(texture_create, (const TextureParams *params; Texture *result;), {
+	a->result = RT.funcs.texture_create(a->params);
+})
+
+static Texture *proxy_texture_create(const TextureParams *params) {
+	return CALL_SYNC(texture_create, params).result;
+}
+
+DEFINE_CMD(texture_get_params, (Texture *tex; TextureParams *params;), {
+	RT.funcs.texture_get_params(a->tex, a->params);
+})
+
+static void proxy_texture_get_params(Texture *tex, TextureParams *params) {
+	PASSTHROUGH_VOID(RT.funcs.texture_get_params(tex, params));
+
+	auto c = texture_cache(tex);
+
+	if(!c->have_params) {
+		CALL_SYNC(texture_get_params, tex, &c->params);
+		c->have_params = true;
+	}
+
+	*params = c->params;
+}
+
+DEFINE_CMD(texture_get_size, (Texture *tex; uint mipmap; uint *width; uint *height;), {
+	RT.funcs.texture_get_size(a->tex, a->mipmap, a->width, a->height);
+})
+
+static void proxy_texture_get_size(Texture *tex, uint mipmap, uint *width, uint *height) {
+	PASSTHROUGH_VOID(RT.funcs.texture_get_size(tex, mipmap, width, height));
+
+	auto c = texture_cache(tex);
+
+	if(UNLIKELY(mipmap >= ARRAY_SIZE(c->sizes))) {
+		CALL_SYNC(texture_get_size, tex, mipmap, width, height);
+		return;
+	}
+
+	if(!(c->known_sizes & (1u << mipmap))) {
+		CALL_SYNC(texture_get_size, tex, mipmap, &c->sizes[mipmap][0], &c->sizes[mipmap][1]);
+		c->known_sizes |= 1u << mipmap;
+	}
+
+	if(width) {
+		*width = c->sizes[mipmap][0];
+	}
+
+	if(height) {
+		*height = c->sizes[mipmap][1];
+	}
+}
+
+DEFINE_CMD(texture_get_debug_label, (Texture *tex; const char *result;), {
+	a->result = RT.funcs.texture_get_debug_label(a->tex);
+})
+
+static const char *proxy_texture_get_debug_label(Texture *tex) {
+	PASSTHROUGH(RT.funcs.texture_get_debug_label(tex));
+	return CALL_SYNC(texture_get_debug_label, tex).result;
+}
+
+DEFINE_CMD(texture_set_debug_label, (Texture *tex; const char *label;), {
+	RT.funcs.texture_set_debug_label(a->tex, a->label);
+})
+
+static void proxy_texture_set_debug_label(Texture *tex, const char *label) {
+	auto a = RECORD(texture_set_debug_label, tex);
+	a->label = label ? marena_strdup(&RT.recording->arena, label) : NULL;
+}
+
+DEFINE_CMD(texture_set_filter, (Texture *tex; TextureFilterMode fmin; TextureFilterMode fmag;), {
+	RT.funcs.texture_set_filter(a->tex, a->fmin, a->fmag);
+})
+
+static void proxy_texture_set_filter(Texture *tex, TextureFilterMode fmin, TextureFilterMode fmag) {
+	PASSTHROUGH_VOID(RT.funcs.texture_set_filter(tex, fmin, fmag));
+	texture_cache(tex)->have_params = false;
+	RECORD(texture_set_filter, tex, fmin, fmag);
+}
+
+DEFINE_CMD(texture_set_wrap, (Texture *tex; TextureWrapMode ws; TextureWrapMode wt;), {
+	RT.funcs.texture_set_wrap(a->tex, a->ws, a->wt);
+})
+
+static void proxy_texture_set_wrap(Texture *tex, TextureWrapMode ws, TextureWrapMode wt) {
+	PASSTHROUGH_VOID(RT.funcs.texture_set_wrap(tex, ws, wt));
+	texture_cache(tex)->have_params = false;
+	RECORD(texture_set_wrap, tex, ws, wt);
+}
+
+DEFINE_CMD(texture_destroy, (Texture *tex;), {
+	RT.funcs.texture_destroy(a->tex);
+})
+
+static void proxy_texture_destroy(Texture *tex) {
+	_r_sprite_batch_texture_deleted(tex);
+	forget_texture(tex);
+	RECORD(texture_destroy, tex);
+}
+
+DEFINE_CMD(texture_invalidate, (Texture *tex;), {
+	RT.funcs.texture_invalidate(a->tex);
+})
+
+static void proxy_texture_invalidate(Texture *tex) {
+	PASSTHROUGH_VOID(RT.funcs.texture_invalidate(tex));
+	RECORD(texture_invalidate, tex);
+}
+
+DEFINE_CMD(texture_fill, (Texture *tex; uint mipmap; uint layer; uint x; uint y; const Pixmap *image_data; bool region;), {
+	if(a->region) {
+		RT.funcs.texture_fill_region(a->tex, a->mipmap, a->layer, a->x, a->y, a->image_data);
+	} else {
+		RT.funcs.texture_fill(a->tex, a->mipmap, a->layer, a->image_data);
+	}
+})
+
+static void proxy_texture_fill(Texture *tex, uint mipmap, uint layer, const Pixmap *image_data) {
+	PASSTHROUGH_VOID(RT.funcs.texture_fill(tex, mipmap, layer, image_data));
+	CALL_SYNC(texture_fill, .tex = tex, .mipmap = mipmap, .layer = layer, .image_data = image_data);
+}
+
+static void proxy_texture_fill_region(Texture *tex, uint mipmap, uint layer, uint x, uint y, const Pixmap *image_data) {
+	PASSTHROUGH_VOID(RT.funcs.texture_fill_region(tex, mipmap, layer, x, y, image_data));
+	CALL_SYNC(texture_fill, tex, mipmap, layer, x, y, image_data, .region = true);
+}
+
+DEFINE_CMD(texture_dump, (Texture *tex; uint mipmap; uint layer; Pixmap *dst; bool result;), {
+	a->result = RT.funcs.texture_dump(a->tex, a->mipmap, a->layer, a->dst);
+})
+
+static bool proxy_texture_dump(Texture *tex, uint mipmap, uint layer, Pixmap *dst) {
+	return CALL_SYNC(texture_dump, tex, mipmap, layer, dst).result;
+}
+
+DEFINE_CMD(texture_clear, (Texture *tex; Color clr;), {
+	RT.funcs.texture_clear(a->tex, &a->clr);
+})
+
+static void proxy_texture_clear(Texture *tex, const Color *clr) {
+	PASSTHROUGH_VOID(RT.funcs.texture_clear(tex, clr));
+	RECORD(texture_clear, tex, *clr);
+}
+
+DEFINE_CMD(texture_type_query, (
+	TextureType type;
+	TextureFlags flags;
+	PixmapFormat pxfmt;
+	TextureTypeQueryResult *out;
+	bool result;
+), {
+	a->result = RT.funcs.texture_type_query(a->type, a->flags, a->pxfmt, a->out);
+})
+
+static bool proxy_texture_type_query(TextureType type, TextureFlags flags, PixmapFormat pxfmt, TextureTypeQueryResult *result) {
+	PASSTHROUGH(RT.funcs.texture_type_query(type, flags, pxfmt, result));
+	return CALL_SYNC(texture_type_query, type, flags, pxfmt, result).result;
+}
+
+DEFINE_CMD(texture_transfer, (Texture *dst; Texture *src; bool result;), {
+	a->result = RT.funcs.texture_transfer(a->dst, a->src);
+})
+
+static bool proxy_texture_transfer(Texture *dst, Texture *src) {
+	_r_sprite_batch_texture_deleted(dst);
+	_r_sprite_batch_texture_deleted(src);
+	forget_texture(dst);
+	forget_texture(src);
+	return CALL_SYNC(texture_transfer, dst, src).result;
+}
+
+DEFINE_CMD(framebuffer_create, (Framebuffer *result;), {
+	a->result = RT.funcs.framebuffer_create();
+})
+
+static Framebuffer *proxy_framebuffer_create(void) {
+	return CALL_SYNC(framebuffer_create).result;
+}
+
+DEFINE_CMD(framebuffer_get_debug_label, (Framebuffer *fb; const char *result;), {
+	a->result = RT.funcs.framebuffer_get_debug_label(a->fb);
+})
+
+static const char *proxy_framebuffer_get_debug_label(Framebuffer *fb) {
+	PASSTHROUGH(RT.funcs.framebuffer_get_debug_label(fb));
+	return CALL_SYNC(framebuffer_get_debug_label, fb).result;
+}
+
+DEFINE_CMD(framebuffer_set_debug_label, (Framebuffer *fb; const char *label;), {
+	RT.funcs.framebuffer_set_debug_label(a->fb, a->label);
+})
+
+static void proxy_framebuffer_set_debug_label(Framebuffer *fb, const char *label) {
+	auto a = RECORD(framebuffer_set_debug_label, fb);
+	a->label = label ? marena_strdup(&RT.recording->arena, label) : NULL;
+}
+
+DEFINE_CMD(framebuffer_destroy, (Framebuffer *fb;), {
+	RT.funcs.framebuffer_destroy(a->fb);
+})
+
+static void proxy_framebuffer_destroy(Framebuffer *fb) {
+	forget_framebuffer(fb);
+	RECORD(framebuffer_destroy, fb);
+}
+
+DEFINE_CMD(framebuffer_attach, (Framebuffer *fb; Texture *tex; uint mipmap; FramebufferAttachment attachment;), {
+	RT.funcs.framebuffer_attach(a->fb, a->tex, a->mipmap, a->attachment);
+})
+
+static void proxy_framebuffer_attach(Framebuffer *fb, Texture *tex, uint mipmap, FramebufferAttachment attachment) {
+	PASSTHROUGH_VOID(RT.funcs.framebuffer_attach(fb, tex, mipmap, attachment));
+	forget_framebuffer(fb);
+	RECORD(framebuffer_attach, fb, tex, mipmap, attachment);
+}
+
+DEFINE_CMD(framebuffer_viewport, (Framebuffer *fb; FloatRect vp;), {
+	RT.funcs.framebuffer_viewport(a->fb, a->vp);
+})
+
+static void proxy_framebuffer_viewport(Framebuffer *fb, FloatRect vp) {
+	PASSTHROUGH_VOID(RT.funcs.framebuffer_viewport(fb, vp));
+
+	if(fb) {
+		auto c = framebuffer_cache(fb);
+		c->viewport = vp;
+		c->have_viewport = true;
+	}
+
+	RECORD(framebuffer_viewport, fb, vp);
+}
+
+DEFINE_CMD(framebuffer_viewport_current, (Framebuffer *fb; FloatRect *vp;), {
+	RT.funcs.framebuffer_viewport_current(a->fb, a->vp);
+})
+
+static void proxy_framebuffer_viewport_current(Framebuffer *fb, FloatRect *vp) {
+	PASSTHROUGH_VOID(RT.funcs.framebuffer_viewport_current(fb, vp));
+
+	// The default framebuffer follows the window, so it's never cached.
+	if(!fb) {
+		CALL_SYNC(framebuffer_viewport_current, fb, vp);
+		return;
+	}
+
+	auto c = framebuffer_cache(fb);
+
+	if(!c->have_viewport) {
+		CALL_SYNC(framebuffer_viewport_current, fb, &c->viewport);
+		c->have_viewport = true;
+	}
+
+	*vp = c->viewport;
+}
+
+DEFINE_CMD(framebuffer_query_attachment, (
+	Framebuffer *fb;
+	FramebufferAttachment attachment;
+	FramebufferAttachmentQueryResult result;
+), {
+	a->result = RT.funcs.framebuffer_query_attachment(a->fb, a->attachment);
+})
+
+static FramebufferAttachmentQueryResult proxy_framebuffer_query_attachment(Framebuffer *fb, FramebufferAttachment attachment) {
+	PASSTHROUGH(RT.funcs.framebuffer_query_attachment(fb, attachment));
+
+	if(!fb || (uint)attachment >= FRAMEBUFFER_MAX_ATTACHMENTS) {
+		return CALL_SYNC(framebuffer_query_attachment, fb, attachment).result;
+	}
+
+	auto c = framebuffer_cache(fb);
+
+	if(!(c->known_attachments & (1u << attachment))) {
+		c->attachments[attachment] = CALL_SYNC(framebuffer_query_attachment, fb, attachment).result;
+		c->known_attachments |= 1u << attachment;
+	}
+
+	return c->attachments[attachment];
+}
+
+DEFINE_CMD(framebuffer_outputs, (
+	Framebuffer *fb;
+	FramebufferAttachment *config;
+	uint8_t write_mask;
+), {
+	RT.funcs.framebuffer_outputs(a->fb, a->config, a->write_mask);
+})
+
+static void proxy_framebuffer_outputs(Framebuffer *fb, FramebufferAttachment config[FRAMEBUFFER_MAX_OUTPUTS], uint8_t write_mask) {
+	PASSTHROUGH_VOID(RT.funcs.framebuffer_outputs(fb, config, write_mask));
+
+	FramebufferCache *c = fb ? framebuffer_cache(fb) : NULL;
+
+	if(!write_mask) {
+		if(!c) {
+			CALL_SYNC(framebuffer_outputs, fb, config, 0);
+			return;
+		}
+
+		if(!c->have_outputs) {
+			CALL_SYNC(framebuffer_outputs, fb, c->outputs, 0);
+			c->have_outputs = true;
+		}
+
+		memcpy(config, c->outputs, sizeof(c->outputs));
+		return;
+	}
+
+	if(c && c->have_outputs) {
+		for(uint i = 0; i < FRAMEBUFFER_MAX_OUTPUTS; ++i) {
+			if(write_mask & (1 << i)) {
+				c->outputs[i] = config[i];
+			}
+		}
+	}
+
+	auto a = RECORD(framebuffer_outputs, fb, .write_mask = write_mask);
+	a->config = record_data(config, sizeof(*config) * FRAMEBUFFER_MAX_OUTPUTS);
+}
+
+DEFINE_CMD(framebuffer_clear, (Framebuffer *fb; BufferKindFlags flags; Color colorval; float depthval;), {
+	RT.funcs.framebuffer_clear(a->fb, a->flags, &a->colorval, a->depthval);
+})
+
+static void proxy_framebuffer_clear(Framebuffer *fb, BufferKindFlags flags, const Color *colorval, float depthval) {
+	PASSTHROUGH_VOID(RT.funcs.framebuffer_clear(fb, flags, colorval, depthval));
+	r_flush_sprites();
+	RECORD(framebuffer_clear, fb, flags, colorval ? *colorval : (Color) {}, depthval);
+}
+
+DEFINE_CMD(framebuffer_copy, (Framebuffer *dst; Framebuffer *src; BufferKindFlags flags;), {
+	RT.funcs.framebuffer_copy(a->dst, a->src, a->flags);
+})
+
+static void proxy_framebuffer_copy(Framebuffer *dst, Framebuffer *src, BufferKindFlags flags) {
+	PASSTHROUGH_VOID(RT.funcs.framebuffer_copy(dst, src, flags));
+	r_flush_sprites();
+	RECORD(framebuffer_copy, dst, src, flags);
+}
+
+DEFINE_CMD(framebuffer_get_size, (Framebuffer *fb; IntExtent result;), {
+	a->result = RT.funcs.framebuffer_get_size(a->fb);
+})
+
+static IntExtent proxy_framebuffer_get_size(Framebuffer *fb) {
+	PASSTHROUGH(RT.funcs.framebuffer_get_size(fb));
+
+	if(!fb) {
+		return CALL_SYNC(framebuffer_get_size, fb).result;
+	}
+
+	auto c = framebuffer_cache(fb);
+
+	if(!c->have_size) {
+		c->size = CALL_SYNC(framebuffer_get_size, fb).result;
+		c->have_size = true;
+	}
+
+	return c->size;
+}
+
+DEFINE_CMD(framebuffer_read_async, (
+	Framebuffer *fb;
+	FramebufferAttachment attachment;
+	IntRect region;
+	ReadRequest *req;
+), {
+	RT.funcs.framebuffer_read_async(a->fb, a->attachment, a->region, a->req, read_async_done);
+})
+
+static void proxy_framebuffer_read_async(
+	Framebuffer *framebuffer,
+	FramebufferAttachment attachment,
+	IntRect region,
+	void *userdata,
+	FramebufferReadAsyncCallback callback
+) {
+	auto req = ALLOC(ReadRequest, {
+		.callback = callback,
+		.userdata = userdata,
+	});
+
+	r_flush_sprites();
+	RECORD(framebuffer_read_async, framebuffer, attachment, region, req);
+}
+
+DEFINE_CMD(framebuffer, (Framebuffer *fb;), {
+	RT.funcs.framebuffer(a->fb);
+})
+
+static void proxy_framebuffer(Framebuffer *fb) {
+	PASSTHROUGH_VOID(RT.funcs.framebuffer(fb));
+	RT.shadow.framebuffer = fb;
+	RECORD(framebuffer, fb);
+}
+
+static Framebuffer *proxy_framebuffer_current(void) {
+	PASSTHROUGH(RT.funcs.framebuffer_current());
+	return RT.shadow.framebuffer;
+}
+
+DEFINE_CMD(vertex_buffer_create, (size_t capacity; void *data; VertexBuffer *result;), {
+	a->result = RT.funcs.vertex_buffer_create(a->capacity, a->data);
+})
+
+static VertexBuffer *proxy_vertex_buffer_create(size_t capacity, void *data) {
+	return CALL_SYNC(vertex_buffer_create, capacity, data).result;
+}
+
+DEFINE_CMD(vertex_buffer_get_debug_label, (VertexBuffer *vbuf; const char *result;), {
+	a->result = RT.funcs.vertex_buffer_get_debug_label(a->vbuf);
+})
+
+static const char *proxy_vertex_buffer_get_debug_label(VertexBuffer *vbuf) {
+	PASSTHROUGH(RT.funcs.vertex_buffer_get_debug_label(vbuf));
+	return CALL_SYNC(vertex_buffer_get_debug_label, vbuf).result;
+}
+
+DEFINE_CMD(vertex_buffer_set_debug_label, (VertexBuffer *vbuf; const char *label;), {
+	RT.funcs.vertex_buffer_set_debug_label(a->vbuf, a->label);
+})
+
+static void proxy_vertex_buffer_set_debug_label(VertexBuffer *vbuf, const char *label) {
+	auto a = RECORD(vertex_buffer_set_debug_label, vbuf);
+	a->label = label ? marena_strdup(&RT.recording->arena, label) : NULL;
+}
+
+DEFINE_CMD(vertex_buffer_destroy, (VertexBuffer *vbuf; ProxyStream *stream;), {
+	RT.funcs.vertex_buffer_destroy(a->vbuf);
+	mem_free(a->stream);
+})
+
+static void proxy_vertex_buffer_destroy(VertexBuffer *vbuf) {
+	flush_pending_write();
+
+	ProxyStream *ps = ht_get(&RT.proxy_streams, vbuf, NULL);
+
+	if(ps) {
+		// Recorded writes still refer to the ProxyStream; the render thread frees it.
+		SDL_CloseIO(ps->io);
+		ht_unset(&RT.proxy_streams, vbuf);
+	}
+
+	RECORD(vertex_buffer_destroy, vbuf, ps);
+}
+
+DEFINE_CMD(vertex_buffer_invalidate, (VertexBuffer *vbuf;), {
+	RT.funcs.vertex_buffer_invalidate(a->vbuf);
+})
+
+static void proxy_vertex_buffer_invalidate(VertexBuffer *vbuf) {
+	PASSTHROUGH_VOID(RT.funcs.vertex_buffer_invalidate(vbuf));
+
+	RECORD(vertex_buffer_invalidate, vbuf);
+
+	// Invalidation rewinds the backend's stream.
+	ProxyStream *ps = ht_get(&RT.proxy_streams, vbuf, NULL);
+
+	if(ps) {
+		ps->offset = 0;
+	}
+}
+
+DEFINE_CMD(index_buffer_create, (uint index_size; size_t max_elements; IndexBuffer *result;), {
+	a->result = RT.funcs.index_buffer_create(a->index_size, a->max_elements);
+})
+
+static IndexBuffer *proxy_index_buffer_create(uint index_size, size_t max_elements) {
+	return CALL_SYNC(index_buffer_create, index_size, max_elements).result;
+}
+
+DEFINE_CMD(index_buffer_get_capacity, (IndexBuffer *ibuf; size_t result;), {
+	a->result = RT.funcs.index_buffer_get_capacity(a->ibuf);
+})
+
+static size_t proxy_index_buffer_get_capacity(IndexBuffer *ibuf) {
+	PASSTHROUGH(RT.funcs.index_buffer_get_capacity(ibuf));
+	return CALL_SYNC(index_buffer_get_capacity, ibuf).result;
+}
+
+DEFINE_CMD(index_buffer_get_index_size, (IndexBuffer *ibuf; uint result;), {
+	a->result = RT.funcs.index_buffer_get_index_size(a->ibuf);
+})
+
+static uint proxy_index_buffer_get_index_size(IndexBuffer *ibuf) {
+	PASSTHROUGH(RT.funcs.index_buffer_get_index_size(ibuf));
+	return CALL_SYNC(index_buffer_get_index_size, ibuf).result;
+}
+
+DEFINE_CMD(index_buffer_get_debug_label, (IndexBuffer *ibuf; const char *result;), {
+	a->result = RT.funcs.index_buffer_get_debug_label(a->ibuf);
+})
+
+static const char *proxy_index_buffer_get_debug_label(IndexBuffer *ibuf) {
+	PASSTHROUGH(RT.funcs.index_buffer_get_debug_label(ibuf));
+	return CALL_SYNC(index_buffer_get_debug_label, ibuf).result;
+}
+
+DEFINE_CMD(index_buffer_set_debug_label, (IndexBuffer *ibuf; const char *label;), {
+	RT.funcs.index_buffer_set_debug_label(a->ibuf, a->label);
+})
+
+static void proxy_index_buffer_set_debug_label(IndexBuffer *ibuf, const char *label) {
+	auto a = RECORD(index_buffer_set_debug_label, ibuf);
+	a->label = label ? marena_strdup(&RT.recording->arena, label) : NULL;
+}
+
+DEFINE_CMD(index_buffer_set_offset, (IndexBuffer *ibuf; size_t offset;), {
+	RT.funcs.index_buffer_set_offset(a->ibuf, a->offset);
+})
+
+static void proxy_index_buffer_set_offset(IndexBuffer *ibuf, size_t offset) {
+	PASSTHROUGH_VOID(RT.funcs.index_buffer_set_offset(ibuf, offset));
+	RECORD(index_buffer_set_offset, ibuf, offset);
+}
+
+DEFINE_CMD(index_buffer_get_offset, (IndexBuffer *ibuf; size_t result;), {
+	a->result = RT.funcs.index_buffer_get_offset(a->ibuf);
+})
+
+static size_t proxy_index_buffer_get_offset(IndexBuffer *ibuf) {
+	PASSTHROUGH(RT.funcs.index_buffer_get_offset(ibuf));
+	return CALL_SYNC(index_buffer_get_offset, ibuf).result;
+}
+
+DEFINE_CMD(index_buffer_add_indices, (IndexBuffer *ibuf; size_t data_size; void *data;), {
+	RT.funcs.index_buffer_add_indices(a->ibuf, a->data_size, a->data);
+})
+
+static void proxy_index_buffer_add_indices(IndexBuffer *ibuf, size_t data_size, void *data) {
+	PASSTHROUGH_VOID(RT.funcs.index_buffer_add_indices(ibuf, data_size, data));
+	auto a = RECORD(index_buffer_add_indices, ibuf, data_size);
+	a->data = record_data(data, data_size);
+}
+
+DEFINE_CMD(index_buffer_invalidate, (IndexBuffer *ibuf;), {
+	RT.funcs.index_buffer_invalidate(a->ibuf);
+})
+
+static void proxy_index_buffer_invalidate(IndexBuffer *ibuf) {
+	PASSTHROUGH_VOID(RT.funcs.index_buffer_invalidate(ibuf));
+	RECORD(index_buffer_invalidate, ibuf);
+}
+
+DEFINE_CMD(index_buffer_destroy, (IndexBuffer *ibuf;), {
+	RT.funcs.index_buffer_destroy(a->ibuf);
+})
+
+static void proxy_index_buffer_destroy(IndexBuffer *ibuf) {
+	RECORD(index_buffer_destroy, ibuf);
+}
+
+DEFINE_CMD(vertex_array_create, (VertexArray *result;), {
+	a->result = RT.funcs.vertex_array_create();
+})
+
+static VertexArray *proxy_vertex_array_create(void) {
+	return CALL_SYNC(vertex_array_create).result;
+}
+
+DEFINE_CMD(vertex_array_get_debug_label, (VertexArray *varr; const char *result;), {
+	a->result = RT.funcs.vertex_array_get_debug_label(a->varr);
+})
+
+static const char *proxy_vertex_array_get_debug_label(VertexArray *varr) {
+	PASSTHROUGH(RT.funcs.vertex_array_get_debug_label(varr));
+	return CALL_SYNC(vertex_array_get_debug_label, varr).result;
+}
+
+DEFINE_CMD(vertex_array_set_debug_label, (VertexArray *varr; const char *label;), {
+	RT.funcs.vertex_array_set_debug_label(a->varr, a->label);
+})
+
+static void proxy_vertex_array_set_debug_label(VertexArray *varr, const char *label) {
+	auto a = RECORD(vertex_array_set_debug_label, varr);
+	a->label = label ? marena_strdup(&RT.recording->arena, label) : NULL;
+}
+
+DEFINE_CMD(vertex_array_destroy, (VertexArray *varr;), {
+	RT.funcs.vertex_array_destroy(a->varr);
+})
+
+static void proxy_vertex_array_destroy(VertexArray *varr) {
+	RECORD(vertex_array_destroy, varr);
+}
+
+DEFINE_CMD(vertex_array_layout, (VertexArray *varr; uint nattribs; VertexAttribFormat *attribs;), {
+	RT.funcs.vertex_array_layout(a->varr, a->nattribs, a->attribs);
+})
+
+static void proxy_vertex_array_layout(VertexArray *varr, uint nattribs, VertexAttribFormat attribs[nattribs]) {
+	PASSTHROUGH_VOID(RT.funcs.vertex_array_layout(varr, nattribs, attribs));
+	auto a = RECORD(vertex_array_layout, varr, nattribs);
+	a->attribs = record_data(attribs, sizeof(*attribs) * nattribs);
+}
+
+DEFINE_CMD(vertex_array_attach_vertex_buffer, (VertexArray *varr; VertexBuffer *vbuf; uint attachment;), {
+	RT.funcs.vertex_array_attach_vertex_buffer(a->varr, a->vbuf, a->attachment);
+})
+
+static void proxy_vertex_array_attach_vertex_buffer(VertexArray *varr, VertexBuffer *vbuf, uint attachment) {
+	PASSTHROUGH_VOID(RT.funcs.vertex_array_attach_vertex_buffer(varr, vbuf, attachment));
+	RECORD(vertex_array_attach_vertex_buffer, varr, vbuf, attachment);
+}
+
+DEFINE_CMD(vertex_array_attach_index_buffer, (VertexArray *varr; IndexBuffer *ibuf;), {
+	RT.funcs.vertex_array_attach_index_buffer(a->varr, a->ibuf);
+})
+
+static void proxy_vertex_array_attach_index_buffer(VertexArray *varr, IndexBuffer *ibuf) {
+	PASSTHROUGH_VOID(RT.funcs.vertex_array_attach_index_buffer(varr, ibuf));
+	RECORD(vertex_array_attach_index_buffer, varr, ibuf);
+}
+
+DEFINE_CMD(vertex_array_get_vertex_attachment, (VertexArray *varr; uint attachment; VertexBuffer *result;), {
+	a->result = RT.funcs.vertex_array_get_vertex_attachment(a->varr, a->attachment);
+})
+
+static VertexBuffer *proxy_vertex_array_get_vertex_attachment(VertexArray *varr, uint attachment) {
+	PASSTHROUGH(RT.funcs.vertex_array_get_vertex_attachment(varr, attachment));
+	return CALL_SYNC(vertex_array_get_vertex_attachment, varr, attachment).result;
+}
+
+DEFINE_CMD(vertex_array_get_index_attachment, (VertexArray *varr; IndexBuffer *result;), {
+	a->result = RT.funcs.vertex_array_get_index_attachment(a->varr);
+})
+
+static IndexBuffer *proxy_vertex_array_get_index_attachment(VertexArray *varr) {
+	PASSTHROUGH(RT.funcs.vertex_array_get_index_attachment(varr));
+	return CALL_SYNC(vertex_array_get_index_attachment, varr).result;
+}
+
+DEFINE_CMD(scissor, (IntRect scissor;), {
+	RT.funcs.scissor(a->scissor);
+})
+
+static void proxy_scissor(IntRect scissor) {
+	PASSTHROUGH_VOID(RT.funcs.scissor(scissor));
+	RT.shadow.scissor = scissor;
+	RECORD(scissor, scissor);
+}
+
+static void proxy_scissor_current(IntRect *scissor) {
+	PASSTHROUGH_VOID(RT.funcs.scissor_current(scissor));
+	*scissor = RT.shadow.scissor;
+}
+
+DEFINE_CMD(vsync, (VsyncMode mode;), {
+	RT.funcs.vsync(a->mode);
+})
+
+static void proxy_vsync(VsyncMode mode) {
+	RT.shadow.vsync = mode;
+	RECORD(vsync, mode);
+}
+
+static VsyncMode proxy_vsync_current(void) {
+	return RT.shadow.vsync;
+}
+
+DEFINE_CMD(begin_frame, (), {
+	RT.funcs.begin_frame();
+})
+
+static void proxy_begin_frame(void) {
+	RECORD(begin_frame);
+}
+
+DEFINE_CMD(swap, (SDL_Window *window;), {
+	RT.funcs.swap(a->window);
+})
+
+static void proxy_swap(SDL_Window *window) {
+	r_flush_sprites();
+	RECORD(swap, window);
+
+	// Let the render thread have this frame, and wait until it's done with the previous one.
+	kick();
+
+	dispatch_read_callbacks();
+}
+
+void _r_render_thread_start(SDL_Window *window) {
+	assert(!_r_render_thread.active);
+	assert(thread_current_is_main());
+
+	const char *backend = _r_backend.name;
+
+	// sdlgpu has to acquire swapchain textures on the thread that created the window, and the gles30
+	// framebuffer copy fallback pushes and pops renderer state from within the backend.
+	// trace is supported so that its output can be checked against the unthreaded one.
+	if(strcmp(backend, "gl33") && strcmp(backend, "null") && strcmp(backend, "trace")) {
+		log_warn("The %s renderer doesn't support running on a separate thread", backend);
+		return;
+	}
+
+	RT.funcs = _r_backend.funcs;
+
+	RT.shadow.features = RT.funcs.features();
+	RT.shadow.capabilities = RT.funcs.capabilities_current();
+	RT.shadow.color = *RT.funcs.color_current();
+	RT.shadow.blend = RT.funcs.blend_current();
+	RT.shadow.cull = RT.funcs.cull_current();
+	RT.shadow.depth_func = RT.funcs.depth_func_current();
+	RT.shadow.shader = RT.funcs.shader_current();
+	RT.shadow.framebuffer = RT.funcs.framebuffer_current();
+	RT.funcs.scissor_current(&RT.shadow.scissor);
+	RT.shadow.vsync = RT.funcs.vsync_current();
+
+	cmdstream_init(RT.streams + 0);
+	cmdstream_init(RT.streams + 1);
+	RT.recording = RT.streams;
+
+	ht_create(&RT.program_uniforms);
+	ht_create(&RT.uniform_types);
+	ht_create(&RT.textures);
+	ht_create(&RT.framebuffers);
+	ht_create(&RT.proxy_streams);
+
+	RT.reads.mutex = NOT_NULL(SDL_CreateMutex());
+	RT.submit_sem = NOT_NULL(SDL_CreateSemaphore(0));
+	RT.done_sem = NOT_NULL(SDL_CreateSemaphore(0));
+
+	for(int i = 0; i < ARRAY_SIZE(RT.matrices.indexed); ++i) {
+		matstack_reset(RT.matrices.indexed + i);
+	}
+
+	_r_draw_matrices = &RT.matrices;
+
+	RT.thread = thread_create("Render thread", render_thread_main, NULL, THREAD_PRIO_HIGH);
+
+	if(!RT.thread) {
+		log_fatal("Failed to create the render thread");
+	}
+
+	_r_render_thread.id = thread_get_id(RT.thread);
+	_r_render_thread.active = true;
+
+	_r_backend.funcs = (RendererFuncs) {
+		.init = RT.funcs.init,
+		.post_init = proxy_post_init,
+		.shutdown = proxy_shutdown,
+		.create_window = proxy_create_window,
+		.unclaim_window = RT.funcs.unclaim_window ? proxy_unclaim_window : NULL,
+		.features = proxy_features,
+		.capabilities = proxy_capabilities,
+		.capabilities_current = proxy_capabilities_current,
+		.draw = proxy_draw,
+		.draw_indexed = proxy_draw_indexed,
+		.color4 = proxy_color4,
+		.color_current = proxy_color_current,
+		.blend = proxy_blend,
+		.blend_current = proxy_blend_current,
+		.cull = proxy_cull,
+		.cull_current = proxy_cull_current,
+		.depth_func = proxy_depth_func,
+		.depth_func_current = proxy_depth_func_current,
+		.shader_language_supported = proxy_shader_language_supported,
+		.shader_object_compile = proxy_shader_object_compile,
+		.shader_object_destroy = proxy_shader_object_destroy,
+		.shader_object_set_debug_label = proxy_shader_object_set_debug_label,
+		.shader_object_get_debug_label = proxy_shader_object_get_debug_label,
+		.shader_object_transfer = proxy_shader_object_transfer,
+		.shader_program_link = proxy_shader_program_link,
+		.shader_program_destroy = proxy_shader_program_destroy,
+		.shader_program_set_debug_label = proxy_shader_program_set_debug_label,
+		.shader_program_get_debug_label = proxy_shader_program_get_debug_label,
+		.shader_program_transfer = proxy_shader_program_transfer,
+		.shader = proxy_shader,
+		.shader_current = proxy_shader_current,
+		.shader_uniform = proxy_shader_uniform,
+		.uniform = proxy_uniform,
+		.uniform_type = proxy_uniform_type,
+		.texture_create = proxy_texture_create,
+		.texture_get_params = proxy_texture_get_params,
+		.texture_get_size = proxy_texture_get_size,
+		.texture_get_debug_label = proxy_texture_get_debug_label,
+		.texture_set_debug_label = proxy_texture_set_debug_label,
+		.texture_set_filter = proxy_texture_set_filter,
+		.texture_set_wrap = proxy_texture_set_wrap,
+		.texture_destroy = proxy_texture_destroy,
+		.texture_invalidate = proxy_texture_invalidate,
+		.texture_fill = proxy_texture_fill,
+		.texture_fill_region = proxy_texture_fill_region,
+		.texture_dump = proxy_texture_dump,
+		.texture_clear = proxy_texture_clear,
+		.texture_type_query = proxy_texture_type_query,
+		.texture_transfer = proxy_texture_transfer,
+		.framebuffer_create = proxy_framebuffer_create,
+		.framebuffer_get_debug_label = proxy_framebuffer_get_debug_label,
+		.framebuffer_set_debug_label = proxy_framebuffer_set_debug_label,
+		.framebuffer_destroy = proxy_framebuffer_destroy,
+		.framebuffer_attach = proxy_framebuffer_attach,
+		.framebuffer_viewport = proxy_framebuffer_viewport,
+		.framebuffer_viewport_current = proxy_framebuffer_viewport_current,
+		.framebuffer_query_attachment = proxy_framebuffer_query_attachment,
+		.framebuffer_outputs = proxy_framebuffer_outputs,
+		.framebuffer_clear = proxy_framebuffer_clear,
+		.framebuffer_copy = proxy_framebuffer_copy,
+		.framebuffer_get_size = proxy_framebuffer_get_size,
+		.framebuffer_read_async = proxy_framebuffer_read_async,
+		.framebuffer = proxy_framebuffer,
+		.framebuffer_current = proxy_framebuffer_current,
+		.vertex_buffer_create = proxy_vertex_buffer_create,
+		.vertex_buffer_get_debug_label = proxy_vertex_buffer_get_debug_label,
+		.vertex_buffer_set_debug_label = proxy_vertex_buffer_set_debug_label,
+		.vertex_buffer_destroy = proxy_vertex_buffer_destroy,
+		.vertex_buffer_invalidate = proxy_vertex_buffer_invalidate,
+		.vertex_buffer_get_stream = proxy_vertex_buffer_get_stream,
+		.index_buffer_create = proxy_index_buffer_create,
+		.index_buffer_get_capacity = proxy_index_buffer_get_capacity,
+		.index_buffer_get_index_size = proxy_index_buffer_get_index_size,
+		.index_buffer_get_debug_label = proxy_index_buffer_get_debug_label,
+		.index_buffer_set_debug_label = proxy_index_buffer_set_debug_label,
+		.index_buffer_set_offset = proxy_index_buffer_set_offset,
+		.index_buffer_get_offset = proxy_index_buffer_get_offset,
+		.index_buffer_add_indices = proxy_index_buffer_add_indices,
+		.index_buffer_invalidate = proxy_index_buffer_invalidate,
+		.index_buffer_destroy = proxy_index_buffer_destroy,
+		.vertex_array_create = proxy_vertex_array_create,
+		.vertex_array_get_debug_label = proxy_vertex_array_get_debug_label,
+		.vertex_array_set_debug_label = proxy_vertex_array_set_debug_label,
+		.vertex_array_destroy = proxy_vertex_array_destroy,
+		.vertex_array_layout = proxy_vertex_array_layout,
+		.vertex_array_attach_vertex_buffer = proxy_vertex_array_attach_vertex_buffer,
+		.vertex_array_attach_index_buffer = proxy_vertex_array_attach_index_buffer,
+		.vertex_array_get_vertex_attachment = proxy_vertex_array_get_vertex_attachment,
+		.vertex_array_get_index_attachment = proxy_vertex_array_get_index_attachment,
+		.scissor = proxy_scissor,
+		.scissor_current = proxy_scissor_current,
+		.vsync = proxy_vsync,
+		.vsync_current = proxy_vsync_current,
+		.begin_frame = RT.funcs.begin_frame ? proxy_begin_frame : NULL,
+		.swap = proxy_swap,
+	};
+
+	hand_over_context(window);
+
+	log_info("Rendering on a separate thread");
+}
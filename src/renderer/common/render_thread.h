@@ -0,0 +1,37 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "../api.h"
+#include "thread.h"
+
+/*
+ * Optional threaded frontend (TAISEI_RENDERER_THREADED).
+ *
+ * When started, the backend's function table is replaced with proxies that record calls into a
+ * command stream, which is replayed against the real backend on a dedicated render thread, one
+ * frame behind the main thread. Calls that return data either answer from state shadowed on the
+ * main thread, or round-trip to the render thread and wait for it to catch up.
+ */
+
+typedef struct RenderThreadState {
+	bool active;
+	ThreadID id;
+} RenderThreadState;
+
+extern RenderThreadState _r_render_thread;
+
+// Takes over the backend's GL context (if any) from the calling thread, which must be the main one.
+void _r_render_thread_start(SDL_Window *window) attr_nonnull(1);
+
+// True when called from the render thread, i.e. when a backend is re-entering the API.
+INLINE bool _r_render_thread_is_current(void) {
+	return UNLIKELY(_r_render_thread.active) && thread_get_current_id() == _r_render_thread.id;
+}
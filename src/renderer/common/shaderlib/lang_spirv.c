@@ -282,6 +282,37 @@ bool _spirv_compile(
 
 #define SPVCCALL(c) do if((spvc_return_code = (c)) != SPVC_SUCCESS) { goto spvc_error; } while(0)
 
+/*
+ * With SPIRV_CFLAG_VULKAN_RELAXED, glslang packs the loose uniforms of every stage into a block
+ * with the same name. Outside of Vulkan, blocks with the same name must be declared identically
+ * in all stages of a program, so in GLSL output each stage gets a block name of its own.
+ */
+static spvc_result _spirv_rename_default_uniform_block(spvc_compiler compiler, ShaderStage stage) {
+	spvc_result spvc_return_code = SPVC_SUCCESS;
+	spvc_resources res;
+	const spvc_reflected_resource *res_list;
+	size_t res_size;
+
+	SPVCCALL(spvc_compiler_create_shader_resources(compiler, &res));
+	SPVCCALL(spvc_resources_get_resource_list_for_type(
+		res, SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, &res_list, &res_size));
+
+	for(size_t i = 0; i < res_size; ++i) {
+		if(
+			strcmp(res_list[i].name, SPIRV_DEFAULT_UNIFORM_BLOCK_NAME) &&
+			strcmp(res_list[i].name, SPIRV_DEFAULT_UNIFORM_BLOCK_ALT_NAME)
+		) {
+			continue;
+		}
+
+		spvc_compiler_set_name(compiler, res_list[i].base_type_id,
+			stage == SHADER_STAGE_VERTEX ? "VertexUniforms" : "FragmentUniforms");
+	}
+
+spvc_error:
+	return spvc_return_code;
+}
+
 bool _spirv_decompile(
 	const ShaderSource *in,
 	ShaderSource *out,
@@ -349,6 +380,10 @@ bool _spirv_decompile(
 			spvc_options, SPVC_COMPILER_OPTION_GLSL_ENABLE_420PACK_EXTENSION, false));
 		SPVCCALL(spvc_compiler_options_set_bool(
 			spvc_options, SPVC_COMPILER_OPTION_GLSL_VULKAN_SEMANTICS, options->glsl.vulkan_semantics));
+
+		if(!options->glsl.vulkan_semantics) {
+			SPVCCALL(_spirv_rename_default_uniform_block(compiler, in->stage));
+		}
 	} else if(backend == SPVC_BACKEND_HLSL) {
 		SPVCCALL(spvc_compiler_options_set_uint(
 			spvc_options, SPVC_COMPILER_OPTION_HLSL_SHADER_MODEL, options->lang->hlsl.shader_model));
@@ -29,6 +29,11 @@ typedef struct ShaderLangInfoSPIRV {
 	SPIRVTarget target;
 } ShaderLangInfoSPIRV;
 
+// Name of the block glslang packs loose uniforms into with SPIRV_CFLAG_VULKAN_RELAXED
+#define SPIRV_DEFAULT_UNIFORM_BLOCK_NAME "gl_DefaultUniformBlock"
+// ...and the same name after SPIRV-Cross sanitizes reserved identifiers
+#define SPIRV_DEFAULT_UNIFORM_BLOCK_ALT_NAME "_RESERVED_IDENTIFIER_FIXUP_gl_DefaultUniformBlock"
+
 typedef enum SPIRVCompileFlag {
 	SPIRV_CFLAG_DEBUG_INFO = (1 << 0),
 	SPIRV_CFLAG_VULKAN_RELAXED = (1 << 1),
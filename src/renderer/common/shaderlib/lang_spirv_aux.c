@@ -250,6 +250,7 @@ bool spirv_decompile(const ShaderSource *in, ShaderSource *out, MemArena *arena,
 
 	CacheEntryMetadata m = {
 		.stage = in->stage,
+		.reflection = options->reflect,
 		.lang = *options->lang,
 	};
 
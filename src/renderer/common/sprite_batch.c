@@ -9,6 +9,8 @@
 #include "sprite_batch_internal.h"
 
 #include "../api.h"
+#include "render_thread.h"
+#include "profiler.h"
 #include "util.h"
 #include "util/glm.h"
 #include "resource/sprite.h"
@@ -118,7 +120,8 @@ void r_sprite_batch_shutdown(void) {
 }
 
 void r_flush_sprites(void) {
-	if(_r_sprite_batch.num_pending == 0) {
+	// Pending sprites belong to the main thread; the threaded frontend flushes them while recording.
+	if(_r_sprite_batch.num_pending == 0 || _r_render_thread_is_current()) {
 		return;
 	}
 
@@ -127,6 +130,8 @@ void r_flush_sprites(void) {
 	// needs to be done early to thwart recursive calls
 	_r_sprite_batch.num_pending = 0;
 
+	PROFILE_BEGIN(r_flush_sprites);
+
 #if SPRITE_BATCH_STATS
 	if(_r_sprite_batch.frame_stats.flushes) {
 		if(pending > _r_sprite_batch.frame_stats.best_batch) {
@@ -180,6 +185,8 @@ void r_flush_sprites(void) {
 
 	r_mat_proj_pop();
 	r_state_pop();
+
+	PROFILE_END(r_flush_sprites);
 }
 
 static void _r_sprite_batch_compute_attribs(
@@ -403,7 +410,16 @@ void _r_sprite_batch_end_frame(void) {
 #endif
 }
 
+VertexArray *_r_sprite_batch_vertex_array(void) {
+	return _r_sprite_batch.varr;
+}
+
 void _r_sprite_batch_texture_deleted(Texture *tex) {
+	// The threaded frontend calls this on the main thread when recording the deletion.
+	if(_r_render_thread_is_current()) {
+		return;
+	}
+
 	if(_r_sprite_batch.primary_texture == tex) {
 		_r_sprite_batch.primary_texture = NULL;
 	}
@@ -15,3 +15,4 @@
 
 void _r_sprite_batch_end_frame(void);
 void _r_sprite_batch_texture_deleted(Texture *tex);
+VertexArray *_r_sprite_batch_vertex_array(void);
@@ -9,6 +9,7 @@
 #include "state.h"
 
 #include "backend.h"
+#include "render_thread.h"
 
 #define RSTATE_STACK_SIZE 16
 
@@ -27,8 +28,9 @@ void _r_state_shutdown(void) {
 
 #define S (*_r_state.head)
 #define B (_r_backend.funcs)
+// Backends re-entering the API from the render thread must not touch the main thread's state stack.
 #define TAINT(db, code) do {\
-	if(_r_state.head && !(S.dirty_bits & (db))) { \
+	if(_r_state.head && !(S.dirty_bits & (db)) && !_r_render_thread_is_current()) { \
 			S.dirty_bits |= (db); \
 			do { code } while(0); \
 		} \
@@ -48,9 +50,7 @@ void r_state_push(void) {
 	_r_state.head->dirty_bits = 0;
 }
 
-void r_state_pop(void) {
-	assert(_r_state.head >= _r_state.stack);
-
+static void r_state_restore(void) {
 	RESTORE(RSTATE_CAPABILITIES) {
 		B.capabilities(S.capabilities);
 	}
@@ -86,6 +86,12 @@ void r_state_pop(void) {
 	RESTORE(RSTATE_SCISSOR) {
 		B.scissor(S.scissor);
 	}
+}
+
+void r_state_pop(void) {
+	assert(_r_state.head >= _r_state.stack);
+
+	r_state_restore();
 
 	if(_r_state.head == _r_state.stack) {
 		_r_state.head = NULL;
@@ -94,6 +100,15 @@ void r_state_pop(void) {
 	}
 }
 
+void r_state_rollback(void) {
+	assert(_r_state.head >= _r_state.stack);
+
+	if(S.dirty_bits) {
+		r_state_restore();
+		S.dirty_bits = 0;
+	}
+}
+
 void _r_state_touch_capabilities(void) {
 	TAINT(RSTATE_CAPABILITIES, {
 		S.capabilities = B.capabilities_current();
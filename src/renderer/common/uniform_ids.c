@@ -0,0 +1,146 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "uniform_ids.h"
+
+#include "dynarray.h"
+#include "memory/arena.h"
+
+/*
+ * Interned uniform names are numbered sequentially starting from 1. Every shader program that
+ * has been queried by ID gets a slot table indexed by those numbers, which caches the backend's
+ * answer for each name — including "no such uniform", which is common for shared draw code.
+ *
+ * The table of the most recently queried program is kept at hand, since draw code tends to set
+ * several uniforms of the same program in a row.
+ */
+
+typedef struct UniformName {
+	const char *name;
+	hash_t hash;
+} UniformName;
+
+typedef struct UniformSlotTable {
+	DYNAMIC_ARRAY(Uniform*) slots;
+} UniformSlotTable;
+
+// Marks a slot that has been resolved to a uniform the program doesn't have.
+static char absent_uniform;
+#define ABSENT_UNIFORM ((Uniform*)&absent_uniform)
+
+static struct {
+	ht_str2int_t ids;
+	DYNAMIC_ARRAY(UniformName) names;
+	MemArena arena;
+
+	ht_ptr2ptr_t tables;
+
+	struct {
+		ShaderProgram *prog;
+		UniformSlotTable *table;
+	} last;
+} UI;
+
+void _r_uniform_ids_init(void) {
+	ht_create(&UI.ids);
+	ht_create(&UI.tables);
+	marena_init(&UI.arena, 4096);
+	dynarray_append(&UI.names, {});  // reserve ID 0
+}
+
+static void free_slot_table(UniformSlotTable *table) {
+	dynarray_free_data(&table->slots);
+	mem_free(table);
+}
+
+void _r_uniform_ids_shutdown(void) {
+	ht_ptr2ptr_iter_t iter;
+	ht_iter_begin(&UI.tables, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		free_slot_table(iter.value);
+	}
+
+	ht_iter_end(&iter);
+	ht_destroy(&UI.tables);
+	ht_destroy(&UI.ids);
+	dynarray_free_data(&UI.names);
+	marena_deinit(&UI.arena);
+	UI = (typeof(UI)) {};
+}
+
+void _r_uniform_ids_invalidate_program(ShaderProgram *prog) {
+	UniformSlotTable *table = ht_get(&UI.tables, prog, NULL);
+
+	if(table) {
+		ht_unset(&UI.tables, prog);
+		free_slot_table(table);
+	}
+
+	if(UI.last.prog == prog) {
+		UI.last.prog = NULL;
+		UI.last.table = NULL;
+	}
+}
+
+UniformID r_uniform_id(const char *uniform_name) {
+	int64_t id;
+
+	if(ht_lookup(&UI.ids, uniform_name, &id)) {
+		return id;
+	}
+
+	id = UI.names.num_elements;
+	dynarray_append(&UI.names, {
+		.name = marena_strdup(&UI.arena, uniform_name),
+		.hash = ht_str2ptr_hash(uniform_name),
+	});
+	ht_set(&UI.ids, uniform_name, id);
+
+	return id;
+}
+
+static UniformSlotTable *get_slot_table(ShaderProgram *prog) {
+	if(LIKELY(UI.last.prog == prog)) {
+		return UI.last.table;
+	}
+
+	UniformSlotTable *table = ht_get(&UI.tables, prog, NULL);
+
+	if(!table) {
+		table = ALLOC(typeof(*table));
+		ht_set(&UI.tables, prog, table);
+	}
+
+	UI.last.prog = prog;
+	UI.last.table = table;
+	return table;
+}
+
+Uniform *r_shader_uniform_by_id(ShaderProgram *prog, UniformID id) {
+	assert(id > 0);
+	assert(id < UI.names.num_elements);
+
+	UniformSlotTable *table = get_slot_table(prog);
+
+	if(UNLIKELY(id >= table->slots.num_elements)) {
+		dynarray_size_t old_num = table->slots.num_elements;
+		dynarray_ensure_capacity(&table->slots, UI.names.num_elements);
+		memset(table->slots.data + old_num, 0, (UI.names.num_elements - old_num) * sizeof(*table->slots.data));
+		table->slots.num_elements = UI.names.num_elements;
+	}
+
+	Uniform **slot = table->slots.data + id;
+
+	if(UNLIKELY(!*slot)) {
+		UniformName *n = dynarray_get_ptr(&UI.names, id);
+		*slot = _r_shader_uniform(prog, n->name, n->hash) ?: ABSENT_UNIFORM;
+	}
+
+	return *slot == ABSENT_UNIFORM ? NULL : *slot;
+}
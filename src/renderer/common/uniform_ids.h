@@ -0,0 +1,18 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "../api.h"
+
+void _r_uniform_ids_init(void);
+void _r_uniform_ids_shutdown(void);
+
+// Must be called whenever the set of uniforms of a program may change (destruction, reloads).
+void _r_uniform_ids_invalidate_program(ShaderProgram *prog) attr_nonnull(1);
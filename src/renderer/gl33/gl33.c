@@ -521,11 +521,11 @@ static void gl33_sync_magic_uniforms(void) {
 		glFrontFace(GL_CCW);
 	}
 
-	glm_mat4_mul(clip_conversion, *_r_matrices.projection.head, proj);
+	glm_mat4_mul(clip_conversion, *_r_draw_matrices->projection.head, proj);
 
-	r_uniform_mat4(u[UMAGIC_MATRIX_MV], *_r_matrices.modelview.head);
+	r_uniform_mat4(u[UMAGIC_MATRIX_MV], *_r_draw_matrices->modelview.head);
 	r_uniform_mat4(u[UMAGIC_MATRIX_PROJ], proj);
-	r_uniform_mat4(u[UMAGIC_MATRIX_TEX], *_r_matrices.texture.head);
+	r_uniform_mat4(u[UMAGIC_MATRIX_TEX], *_r_draw_matrices->texture.head);
 	r_uniform_vec4_rgba(u[UMAGIC_COLOR], &R.color);
 	r_uniform_vec4_vec(u[UMAGIC_VIEWPORT], (float*)&R.viewport.active);
 
@@ -862,6 +862,7 @@ GLenum gl33_bindidx_to_glenum(BufferBindingIndex bindidx) {
 		[GL33_BUFFER_BINDING_COPY_WRITE] = GL_COPY_WRITE_BUFFER,
 		[GL33_BUFFER_BINDING_PIXEL_UNPACK] = GL_PIXEL_UNPACK_BUFFER,
 		[GL33_BUFFER_BINDING_PIXEL_PACK] = GL_PIXEL_PACK_BUFFER,
+		[GL33_BUFFER_BINDING_UNIFORM] = GL_UNIFORM_BUFFER,
 	};
 
 	static_assert(sizeof(map) == sizeof(GLenum) * GL33_NUM_BUFFER_BINDINGS, "Fix the lookup table");
@@ -10,8 +10,24 @@
 
 #include "../glcommon/debug.h"
 #include "../glcommon/shaders.h"
+#include "util/env.h"
 
 bool gl33_shader_language_supported(const ShaderLangInfo *lang, SPIRVTranspileOptions *transpile_opts) {
+	if(transpile_opts && lang->lang == SHLANG_GLSL && env_get("TAISEI_GL33_UNIFORM_BUFFERS", false)) {
+		// Route even natively supported GLSL through SPIR-V: compiling with Vulkan rules packs the
+		// loose uniforms into a block, and reflection tells us its layout.
+		transpile_opts->compile.target = SPIRV_TARGET_VULKAN_10;
+		transpile_opts->decompile.reflect = true;
+
+		if(glcommon_shader_lang_table.data) {
+			transpile_opts->decompile.lang = &dynarray_get(&glcommon_shader_lang_table, 0);
+		} else {
+			transpile_opts->decompile.lang = lang;
+		}
+
+		return false;
+	}
+
 	if(glcommon_shader_lang_table.data) {
 		dynarray_foreach_elem(&glcommon_shader_lang_table, ShaderLangInfo *l, {
 			if(!memcmp(l, lang, sizeof(*l))) {
@@ -46,6 +62,39 @@ bool gl33_shader_language_supported(const ShaderLangInfo *lang, SPIRVTranspileOp
 	return supported;
 }
 
+static void gl33_shader_object_init_uniform_block(ShaderObject *shobj, const ShaderReflection *reflection) {
+	if(reflection->num_uniform_buffers < 1) {
+		return;
+	}
+
+	if(reflection->num_uniform_buffers > 1) {
+		log_warn("%s: %u uniform blocks found, only the first one is supported",
+			shobj->debug_label, reflection->num_uniform_buffers);
+	}
+
+	const ShaderBlock *src = &reflection->uniform_buffers[0];
+
+	marena_init(&shobj->arena, sizeof(ShaderBlock) + src->num_fields * (sizeof(ShaderStructField) + 32));
+
+	auto block = ARENA_ALLOC(&shobj->arena, ShaderBlock, *src);
+	block->name = marena_strdup(&shobj->arena, src->name);
+	block->fields = ARENA_ALLOC_ARRAY(&shobj->arena, src->num_fields, ShaderStructField);
+
+	for(uint i = 0; i < src->num_fields; ++i) {
+		block->fields[i] = src->fields[i];
+		block->fields[i].name = marena_strdup(&shobj->arena, src->fields[i].name);
+	}
+
+	shobj->uniform_block = block;
+}
+
+static void gl33_shader_object_free_uniform_block(ShaderObject *shobj) {
+	if(shobj->uniform_block) {
+		marena_deinit(&shobj->arena);
+		shobj->uniform_block = NULL;
+	}
+}
+
 static void print_info_log(GLuint shader) {
 	GLint len = 0, alen = 0;
 	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
@@ -107,6 +156,10 @@ ShaderObject *gl33_shader_object_compile(ShaderSource *source) {
 		});
 
 		snprintf(shobj->debug_label, sizeof(shobj->debug_label), "Shader object #%i", gl_handle);
+
+		if(source->reflection) {
+			gl33_shader_object_init_uniform_block(shobj, source->reflection);
+		}
 	} else {
 		glDeleteShader(gl_handle);
 	}
@@ -116,6 +169,7 @@ ShaderObject *gl33_shader_object_compile(ShaderSource *source) {
 
 void gl33_shader_object_destroy(ShaderObject *shobj) {
 	glDeleteShader(shobj->gl_handle);
+	gl33_shader_object_free_uniform_block(shobj);
 	mem_free(shobj);
 }
 
@@ -134,6 +188,7 @@ bool gl33_shader_object_transfer(ShaderObject *dst, ShaderObject *src) {
 	}
 
 	glDeleteShader(dst->gl_handle);
+	gl33_shader_object_free_uniform_block(dst);
 
 	*dst = *src;
 	mem_free(src);
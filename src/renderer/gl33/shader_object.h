@@ -10,14 +10,21 @@
 #include "taisei.h"
 
 #include "../api.h"
+#include "../common/shaderlib/reflect.h"
 #include "../common/shaderlib/shaderlib.h"
 #include "opengl.h"
+#include "memory/arena.h"
 #include "resource/shader_object.h"
 
 struct ShaderObject {
 	GLuint gl_handle;
 	ShaderStage stage;
 	char debug_label[R_DEBUG_LABEL_SIZE];
+
+	// Layout of the std140 block holding this stage's loose uniforms, if they were packed into one
+	// by the transpiler (see TAISEI_GL33_UNIFORM_BUFFERS); NULL otherwise. Allocated from arena.
+	ShaderBlock *uniform_block;
+	MemArena arena;
 };
 
 bool gl33_shader_language_supported(const ShaderLangInfo *lang, SPIRVTranspileOptions *transpile_opts);
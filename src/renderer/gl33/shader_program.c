@@ -17,6 +17,9 @@
 
 static Uniform *sampler_uniforms;
 
+// Buffer whose block ranges are currently bound to the indexed GL_UNIFORM_BUFFER binding points
+static GLuint bound_uniform_buffer;
+
 Uniform *gl33_shader_uniform(ShaderProgram *prog, const char *uniform_name, hash_t uniform_name_hash) {
 	return ht_get_prehashed(&prog->uniforms, uniform_name, uniform_name_hash, NULL);
 }
@@ -200,6 +203,38 @@ static void gl33_commit_uniform(Uniform *uniform) {
 	uniform->cache.update_last_idx = 0;
 }
 
+static void gl33_update_buffer_backed_uniform(Uniform *uniform, uint offset, uint count, const void *data) {
+	const ShaderDataType *type = &uniform->buffer_backed.type;
+	CachedBuffer *cbuf = &uniform->prog->uniform_buffer.buffer->cachedbuf;
+
+	uint field_offset = 0;
+	uint size = shader_type_size(type);
+
+	if(type->array_stride) {
+		field_offset = type->array_stride * offset;
+		size = type->array_stride * count;
+	} else {
+		assert(offset == 0);
+		assert(count == 1);
+	}
+
+	// Start from the current contents, so that the padding stays intact
+	char packed[size];
+	memcpy(packed, cbuf->cache + uniform->buffer_backed.offsets[0] + field_offset, size);
+
+	attr_unused uint num_packed = shader_type_unpack_from_bytes(
+		type, count * uniform->elem_size, data, size, packed);
+	assert(num_packed == count);
+
+	for(uint i = 0; i < uniform->buffer_backed.num_offsets; ++i) {
+		size_t dst_offset = uniform->buffer_backed.offsets[i] + field_offset;
+
+		if(memcmp(cbuf->cache + dst_offset, packed, size)) {
+			cachedbuf_write(cbuf, dst_offset, size, packed);
+		}
+	}
+}
+
 static GLuint get_texture_target(Texture *tex, UniformType utype) {
 	if(tex) {
 		return tex->bind_target;
@@ -212,9 +247,7 @@ static GLuint get_texture_target(Texture *tex, UniformType utype) {
 	}
 }
 
-static void *gl33_sync_uniform(const char *key, void *value, void *arg) {
-	Uniform *uniform = value;
-
+static void gl33_sync_uniform(Uniform *uniform) {
 	// special case: for sampler uniforms, we have to construct the actual data from the texture pointers array.
 	UniformType utype = uniform->type;
 	if(UNIFORM_TYPE_IS_SAMPLER(utype)) {
@@ -232,11 +265,37 @@ static void *gl33_sync_uniform(const char *key, void *value, void *arg) {
 	}
 
 	gl33_commit_uniform(uniform);
-	return NULL;
+}
+
+static void gl33_sync_uniform_buffer(ShaderProgram *prog) {
+	CommonBuffer *buffer = prog->uniform_buffer.buffer;
+
+	if(!buffer) {
+		return;
+	}
+
+	gl33_buffer_flush(buffer);
+
+	if(bound_uniform_buffer != buffer->gl_handle) {
+		// glBindBufferRange also replaces the generic binding; keep the state tracker in sync
+		gl33_bind_buffer(GL33_BUFFER_BINDING_UNIFORM, buffer->gl_handle);
+		gl33_sync_buffer(GL33_BUFFER_BINDING_UNIFORM);
+
+		for(uint i = 0; i < prog->uniform_buffer.num_blocks; ++i) {
+			auto block = &prog->uniform_buffer.blocks[i];
+			glBindBufferRange(GL_UNIFORM_BUFFER, i, buffer->gl_handle, block->offset, block->size);
+		}
+
+		bound_uniform_buffer = buffer->gl_handle;
+	}
 }
 
 void gl33_sync_uniforms(ShaderProgram *prog) {
-	ht_foreach(&prog->uniforms, gl33_sync_uniform, NULL);
+	dynarray_foreach_elem(&prog->loose_uniforms, Uniform **uniform, {
+		gl33_sync_uniform(*uniform);
+	});
+
+	gl33_sync_uniform_buffer(prog);
 }
 
 void gl33_uniform(Uniform *uniform, uint offset, uint count, const void *data) {
@@ -255,6 +314,11 @@ void gl33_uniform(Uniform *uniform, uint offset, uint count, const void *data) {
 		count = uniform->array_size - offset;
 	}
 
+	if(uniform->buffer_backed.num_offsets) {
+		gl33_update_buffer_backed_uniform(uniform, offset, count, data);
+		return;
+	}
+
 	// special case: for sampler uniforms, data is an array of Texture pointers that we'll have to bind later.
 	if(UNIFORM_TYPE_IS_SAMPLER(uniform->type)) {
 		Texture **textures = (Texture**)data;
@@ -271,6 +335,53 @@ void gl33_uniform(Uniform *uniform, uint offset, uint count, const void *data) {
 	}
 }
 
+static bool find_magic_uniform(const char *name, UniformType type, MagicUniformIndex *out_index) {
+	*out_index = UMAGIC_INVALID;
+
+	for(int j = 0; j < ARRAY_SIZE(magic_unfiroms); ++j) {
+		MagicUniformSpec *m = magic_unfiroms + j;
+
+		if(strcmp(name, m->name)) {
+			continue;
+		}
+
+		if(type != m->type) {
+			log_error("Magic uniform '%s' must be of type '%s'", name, m->typename);
+			return false;
+		}
+
+		*out_index = j;
+		break;
+	}
+
+	return true;
+}
+
+static void register_magic_uniform(ShaderProgram *prog, MagicUniformIndex magic_index, Uniform *uni) {
+	if(magic_index != UMAGIC_INVALID) {
+		assume((uint)magic_index < ARRAY_SIZE(prog->magic_uniforms));
+		assert(prog->magic_uniforms[magic_index] == NULL);
+		prog->magic_uniforms[magic_index] = uni;
+	}
+}
+
+static void collect_loose_uniforms(ShaderProgram *prog) {
+	prog->loose_uniforms.num_elements = 0;
+
+	ht_str2ptr_iter_t iter;
+	ht_iter_begin(&prog->uniforms, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		Uniform *u = NOT_NULL(iter.value);
+
+		if(u->location != INVALID_UNIFORM_LOCATION) {
+			*dynarray_append(&prog->loose_uniforms) = u;
+		}
+	}
+
+	ht_iter_end(&iter);
+}
+
 static bool cache_uniforms(ShaderProgram *prog) {
 	int maxlen = 0;
 	GLint unicount;
@@ -323,22 +434,10 @@ static bool cache_uniforms(ShaderProgram *prog) {
 				continue;
 		}
 
-		MagicUniformIndex magic_index = UMAGIC_INVALID;
-
-		for(int j = 0; j < ARRAY_SIZE(magic_unfiroms); ++j) {
-			MagicUniformSpec *m = magic_unfiroms + j;
-
-			if(strcmp(name, m->name)) {
-				continue;
-			}
-
-			if(uni.type != m->type) {
-				log_error("Magic uniform '%s' must be of type '%s'", name, m->typename);
-				return false;
-			}
+		MagicUniformIndex magic_index;
 
-			magic_index = j;
-			break;
+		if(!find_magic_uniform(name, uni.type, &magic_index)) {
+			return false;
 		}
 
 		const UniformTypeInfo *typeinfo = r_uniform_type_info(uni.type);
@@ -390,12 +489,7 @@ static bool cache_uniforms(ShaderProgram *prog) {
 			gl33_update_uniform(new_uni, 0, new_uni->array_size, payload);
 		}
 
-		if(magic_index != UMAGIC_INVALID) {
-			assume((uint)magic_index < ARRAY_SIZE(prog->magic_uniforms));
-			assert(prog->magic_uniforms[magic_index] == NULL);
-			prog->magic_uniforms[magic_index] = new_uni;
-		}
-
+		register_magic_uniform(prog, magic_index, new_uni);
 		ht_set(&prog->uniforms, name, new_uni);
 		log_debug("%s = %i [array elements: %i; size: %zi bytes]", name, loc, uni.array_size, uni.array_size * uni.elem_size);
 	}
@@ -403,6 +497,132 @@ static bool cache_uniforms(ShaderProgram *prog) {
 	return true;
 }
 
+static bool add_buffer_backed_uniform(ShaderProgram *prog, const ShaderStructField *field, uint block_offset) {
+	UniformType type = shader_type_to_uniform_type(&field->type);
+
+	if(type == UNIFORM_UNKNOWN) {
+		log_warn("Uniform '%s' is of an unsupported type and will be ignored.", field->name);
+		return true;
+	}
+
+	Uniform *uni = ht_get(&prog->uniforms, field->name, NULL);
+
+	if(uni) {
+		// Also declared in another stage; both copies must be kept up to date
+		if(
+			!uni->buffer_backed.num_offsets ||
+			memcmp(&uni->buffer_backed.type, &field->type, sizeof(field->type))
+		) {
+			log_error("Uniform '%s' is declared differently in different shader stages", field->name);
+			return false;
+		}
+
+		assert(uni->buffer_backed.num_offsets < ARRAY_SIZE(uni->buffer_backed.offsets));
+		uni->buffer_backed.offsets[uni->buffer_backed.num_offsets++] = block_offset + field->offset;
+		return true;
+	}
+
+	MagicUniformIndex magic_index;
+
+	if(!find_magic_uniform(field->name, type, &magic_index)) {
+		return false;
+	}
+
+	const UniformTypeInfo *typeinfo = r_uniform_type_info(type);
+
+	uni = ALLOC(Uniform, {
+		.prog = prog,
+		.type = type,
+		.location = INVALID_UNIFORM_LOCATION,
+		.array_size = max(1u, field->type.array_size),
+		.elem_size = typeinfo->element_size * typeinfo->elements,
+		.buffer_backed = {
+			.type = field->type,
+			.offsets = { block_offset + field->offset },
+			.num_offsets = 1,
+		},
+	});
+
+	register_magic_uniform(prog, magic_index, uni);
+	ht_set(&prog->uniforms, field->name, uni);
+	log_debug("%s = +%u [array elements: %i]", field->name, block_offset + field->offset, uni->array_size);
+
+	return true;
+}
+
+static bool cache_uniform_blocks(ShaderProgram *prog, uint num_objects, ShaderObject *shobjs[num_objects]) {
+	auto ubuf = &prog->uniform_buffer;
+	uint total_size = 0;
+
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	alignment = max(alignment, 1);
+
+	for(uint i = 0; i < num_objects; ++i) {
+		const ShaderBlock *block = shobjs[i]->uniform_block;
+
+		if(!block) {
+			continue;
+		}
+
+		GLuint block_index = glGetUniformBlockIndex(prog->gl_handle, block->name);
+
+		if(block_index == GL_INVALID_INDEX) {
+			// Optimized out entirely
+			continue;
+		}
+
+		if(ubuf->num_blocks >= ARRAY_SIZE(ubuf->blocks)) {
+			log_error("Too many uniform blocks");
+			return false;
+		}
+
+		GLint data_size = 0;
+		glGetActiveUniformBlockiv(prog->gl_handle, block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &data_size);
+
+		uint binding = ubuf->num_blocks++;
+		uint offset = (total_size + alignment - 1) / alignment * alignment;
+		uint size = max((uint)data_size, block->size);
+
+		glUniformBlockBinding(prog->gl_handle, block_index, binding);
+		ubuf->blocks[binding].offset = offset;
+		ubuf->blocks[binding].size = size;
+		total_size = offset + size;
+
+		log_debug("%s: binding %u, %u bytes at offset %u", block->name, binding, size, offset);
+
+		for(uint f = 0; f < block->num_fields; ++f) {
+			if(!add_buffer_backed_uniform(prog, &block->fields[f], offset)) {
+				return false;
+			}
+		}
+	}
+
+	if(total_size > 0) {
+		ubuf->buffer = gl33_buffer_create(GL33_BUFFER_BINDING_UNIFORM, sizeof(CommonBuffer));
+		snprintf(ubuf->buffer->debug_label, sizeof(ubuf->buffer->debug_label),
+			"Uniform buffer for program #%i", prog->gl_handle);
+
+		void *zeros = mem_alloc(total_size);
+		gl33_buffer_init(ubuf->buffer, total_size, zeros, GL_DYNAMIC_DRAW);
+		mem_free(zeros);
+	}
+
+	return true;
+}
+
+static void free_uniform_buffer(ShaderProgram *prog) {
+	if(prog->uniform_buffer.buffer) {
+		if(bound_uniform_buffer == prog->uniform_buffer.buffer->gl_handle) {
+			bound_uniform_buffer = 0;
+		}
+
+		gl33_buffer_destroy(prog->uniform_buffer.buffer);
+	}
+
+	prog->uniform_buffer = (typeof(prog->uniform_buffer)) {};
+}
+
 void gl33_unref_texture_from_samplers(Texture *tex) {
 	for(Uniform *u = sampler_uniforms; u; u = u->next) {
 		assert(UNIFORM_TYPE_IS_SAMPLER(u->type));
@@ -467,6 +687,8 @@ void gl33_shader_program_destroy(ShaderProgram *prog) {
 	glDeleteProgram(prog->gl_handle);
 	ht_foreach(&prog->uniforms, free_uniform, NULL);
 	ht_destroy(&prog->uniforms);
+	dynarray_free_data(&prog->loose_uniforms);
+	free_uniform_buffer(prog);
 	mem_free(prog);
 }
 
@@ -494,11 +716,16 @@ ShaderProgram *gl33_shader_program_link(uint num_objects, ShaderObject *shobjs[n
 		return NULL;
 	}
 
-	if(!cache_uniforms(prog)) {
+	if(
+		!cache_uniforms(prog) ||
+		!cache_uniform_blocks(prog, num_objects, shobjs)
+	) {
 		gl33_shader_program_destroy(prog);
 		return NULL;
 	}
 
+	collect_loose_uniforms(prog);
+
 	return prog;
 }
 
@@ -567,6 +794,7 @@ bool gl33_shader_program_transfer(ShaderProgram *dst, ShaderProgram *src) {
 			uold->location = unew->location;
 			assert(uold->type == unew->type);
 			uold->cache = unew->cache;
+			uold->buffer_backed = unew->buffer_backed;
 
 			if(UNIFORM_TYPE_IS_SAMPLER(unew->type)) {
 				list_unlink(&sampler_uniforms, unew);
@@ -582,6 +810,7 @@ bool gl33_shader_program_transfer(ShaderProgram *dst, ShaderProgram *src) {
 			uold->textures = NULL;
 			uold->cache.pending = NULL;
 			uold->cache.committed = NULL;
+			uold->buffer_backed.num_offsets = 0;
 		}
 	}
 
@@ -605,6 +834,12 @@ bool gl33_shader_program_transfer(ShaderProgram *dst, ShaderProgram *src) {
 	dst->gl_handle = src->gl_handle;
 	memcpy(dst->debug_label, src->debug_label, sizeof(dst->debug_label));
 
+	free_uniform_buffer(dst);
+	dst->uniform_buffer = src->uniform_buffer;
+
+	dynarray_free_data(&src->loose_uniforms);
+	collect_loose_uniforms(dst);
+
 	for(int i = 0; i < ARRAY_SIZE(dst->magic_uniforms); ++i) {
 		Uniform *unew = src->magic_uniforms[i];
 		dst->magic_uniforms[i] = ht_get(&old_new_map, unew, unew);
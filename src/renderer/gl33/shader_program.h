@@ -11,16 +11,36 @@
 
 #include "../api.h"
 #include "../common/magic_uniforms.h"
+#include "../common/shaderlib/reflect.h"
+#include "common_buffer.h"
 #include "opengl.h"
 
+#include "dynarray.h"
 #include "hashtable.h"
 #include "resource/shader_program.h"
 
+// One per shader stage
+#define GL33_MAX_UNIFORM_BLOCKS 2
+
 struct ShaderProgram {
 	GLuint gl_handle;
 	ht_str2ptr_t uniforms;
 	Uniform *magic_uniforms[NUM_MAGIC_UNIFORMS];
 	char debug_label[R_DEBUG_LABEL_SIZE];
+
+	// Uniforms that are set with glUniform*, including all samplers
+	DYNAMIC_ARRAY(Uniform*) loose_uniforms;
+
+	// Backing storage for the uniform blocks, if any; block i is bound to binding point i.
+	// The CPU-side copy tracks the dirty range, which is uploaded once before a draw.
+	struct {
+		CommonBuffer *buffer;
+		uint num_blocks;
+		struct {
+			uint offset;
+			uint size;
+		} blocks[GL33_MAX_UNIFORM_BLOCKS];
+	} uniform_buffer;
 };
 
 #define INVALID_UNIFORM_LOCATION 0xffffffff
@@ -44,6 +64,14 @@ struct Uniform {
 		uint update_first_idx;
 		uint update_last_idx;
 	} cache;
+
+	// Only for uniforms that live in a uniform block; location is INVALID_UNIFORM_LOCATION for those
+	struct {
+		ShaderDataType type;
+		// Byte offsets into prog->uniform_buffer, one per block (stage) that declares the uniform
+		uint offsets[GL33_MAX_UNIFORM_BLOCKS];
+		uint num_offsets;
+	} buffer_backed;
 };
 
 void gl33_sync_uniforms(ShaderProgram *prog);
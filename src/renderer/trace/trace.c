@@ -0,0 +1,1342 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "trace.h"
+
+#include "../api.h"
+#include "../common/shaderlib/shaderlib.h"
+#include "../common/sprite_batch_internal.h"
+
+#include "dynarray.h"
+#include "log.h"
+#include "util.h"
+#include "util/env.h"
+#include "util/stringops.h"
+
+typedef struct TraceUniformDecl {
+	char *name;
+	UniformType type;
+} TraceUniformDecl;
+
+struct ShaderObject {
+	uint32_t id;
+	char *debug_label;
+	DYNAMIC_ARRAY(TraceUniformDecl) uniforms;
+};
+
+struct Uniform {
+	ShaderProgram *prog;
+	uint32_t id;
+	UniformType type;
+};
+
+struct ShaderProgram {
+	uint32_t id;
+	char *debug_label;
+	ht_str2ptr_t uniforms;
+};
+
+struct Texture {
+	uint32_t id;
+	char *debug_label;
+	TextureParams params;
+};
+
+struct Framebuffer {
+	uint32_t id;
+	char *debug_label;
+	FramebufferAttachmentQueryResult attachments[FRAMEBUFFER_MAX_ATTACHMENTS];
+	FramebufferAttachment outputs[FRAMEBUFFER_MAX_OUTPUTS];
+	FloatRect viewport;
+};
+
+struct VertexBuffer {
+	uint32_t id;
+	char *debug_label;
+	SDL_IOStream *stream;
+	int64_t offset;
+	int64_t size;
+};
+
+struct IndexBuffer {
+	uint32_t id;
+	char *debug_label;
+	size_t capacity;
+	size_t offset;
+	uint index_size;
+};
+
+struct VertexArray {
+	uint32_t id;
+	char *debug_label;
+	DYNAMIC_ARRAY(VertexBuffer*) attachments;
+	IndexBuffer *index_attachment;
+};
+
+typedef struct TraceCounters {
+	#define TRACE_COUNTER(name) uint64_t name;
+	TRACE_COUNTERS(TRACE_COUNTER)
+	#undef TRACE_COUNTER
+} TraceCounters;
+
+static struct {
+	SDL_Window *window;
+	SDL_IOStream *out;
+	SDL_IOStream *summary;
+	DYNAMIC_ARRAY(uint8_t) buf;
+	uint32_t next_id;
+	uint32_t frame;
+
+	TraceCounters counters;
+	TraceCounters total;
+	TraceCounters peak;
+
+	// Consecutive writes into the same vertex buffer are coalesced into one record.
+	struct {
+		VertexBuffer *vbuf;
+		uint32_t size;
+	} pending_upload;
+
+	struct {
+		r_capability_bits_t capabilities;
+		Color color;
+		BlendMode blend;
+		CullFaceMode cull;
+		DepthTestFunc depth_func;
+		ShaderProgram *shader;
+		Framebuffer *framebuffer;
+		IntRect scissor;
+		FloatRect default_viewport;
+		VsyncMode vsync;
+	} state;
+} T;
+
+#define OBJ_ID(obj) ((obj) ? (obj)->id : 0)
+
+/*
+ * Trace encoding
+ */
+
+static void put(const void *data, size_t size) {
+	dynarray_ensure_capacity(&T.buf, T.buf.num_elements + size);
+	memcpy(T.buf.data + T.buf.num_elements, data, size);
+	T.buf.num_elements += size;
+}
+
+static void put_u8(uint8_t v) {
+	put(&v, sizeof(v));
+}
+
+static void put_u16(uint16_t v) {
+	v = SDL_Swap16LE(v);
+	put(&v, sizeof(v));
+}
+
+static void put_u32(uint32_t v) {
+	v = SDL_Swap32LE(v);
+	put(&v, sizeof(v));
+}
+
+static void put_u64(uint64_t v) {
+	v = SDL_Swap64LE(v);
+	put(&v, sizeof(v));
+}
+
+static void put_f32(float v) {
+	union { float f; uint32_t u; } c = { .f = v };
+	put_u32(c.u);
+}
+
+static void put_str(const char *s) {
+	size_t len = min(strlen(s), UINT16_MAX);
+	put_u16(len);
+	put(s, len);
+}
+
+static bool begin_op(TraceOp op);
+
+static void flush_pending_upload(void) {
+	auto vbuf = T.pending_upload.vbuf;
+
+	if(!vbuf) {
+		return;
+	}
+
+	T.pending_upload.vbuf = NULL;
+
+	if(begin_op(TRACE_OP_VERTEX_UPLOAD)) {
+		put_u32(vbuf->id);
+		put_u32(T.pending_upload.size);
+	}
+}
+
+// Returns false if no trace is being written; the operands must not be emitted then.
+static bool begin_op(TraceOp op) {
+	if(!T.out) {
+		return false;
+	}
+
+	flush_pending_upload();
+	put_u8(op);
+	return true;
+}
+
+static void write_buffer(void) {
+	if(!T.out || !T.buf.num_elements) {
+		return;
+	}
+
+	if(SDL_WriteIO(T.out, T.buf.data, T.buf.num_elements) != T.buf.num_elements) {
+		log_sdl_error(LOG_ERROR, "SDL_WriteIO");
+		log_error("Renderer trace is incomplete");
+		SDL_CloseIO(T.out);
+		T.out = NULL;
+	}
+
+	T.buf.num_elements = 0;
+}
+
+static uint32_t new_object(TraceObjectKind kind) {
+	uint32_t id = ++T.next_id;
+
+	if(begin_op(TRACE_OP_CREATE)) {
+		put_u8(kind);
+		put_u32(id);
+	}
+
+	return id;
+}
+
+static void destroy_object(TraceObjectKind kind, uint32_t id, char *debug_label) {
+	mem_free(debug_label);
+
+	if(begin_op(TRACE_OP_DESTROY)) {
+		put_u8(kind);
+		put_u32(id);
+	}
+}
+
+static void set_label(TraceObjectKind kind, uint32_t id, char **label, const char *new_label) {
+	stralloc(label, new_label);
+
+	if(new_label && begin_op(TRACE_OP_LABEL)) {
+		put_u8(kind);
+		put_u32(id);
+		put_str(new_label);
+	}
+}
+
+static void count_state_change(bool changed) {
+	if(changed) {
+		++T.counters.state_changes;
+	} else {
+		++T.counters.redundant_state_changes;
+	}
+}
+
+static void end_frame(void) {
+	if(begin_op(TRACE_OP_END_FRAME)) {
+		put_u32(T.frame);
+		#define TRACE_COUNTER(name) put_u64(T.counters.name);
+		TRACE_COUNTERS(TRACE_COUNTER)
+		#undef TRACE_COUNTER
+	}
+
+	write_buffer();
+
+	if(T.summary) {
+		SDL_IOprintf(T.summary, "%u", T.frame);
+		#define TRACE_COUNTER(name) SDL_IOprintf(T.summary, ",%"PRIu64, T.counters.name);
+		TRACE_COUNTERS(TRACE_COUNTER)
+		#undef TRACE_COUNTER
+		SDL_IOprintf(T.summary, "\n");
+	}
+
+	#define TRACE_COUNTER(name) \
+		T.total.name += T.counters.name; \
+		T.peak.name = max(T.peak.name, T.counters.name);
+	TRACE_COUNTERS(TRACE_COUNTER)
+	#undef TRACE_COUNTER
+
+	T.counters = (TraceCounters) {};
+	++T.frame;
+}
+
+/*
+ * Uniform declarations
+ *
+ * Nothing compiles the shaders here, so the uniforms a program exposes are found by scanning the
+ * GLSL sources for declarations. Conditional compilation is not evaluated; a declaration in an
+ * inactive branch merely adds a uniform nobody sets.
+ */
+
+typedef struct GLSLToken {
+	const char *str;
+	size_t len;
+} GLSLToken;
+
+typedef struct GLSLScanner {
+	const char *pos;
+	const char *end;
+} GLSLScanner;
+
+static bool glsl_is_ident_char(char c) {
+	return isalnum((uchar)c) || c == '_';
+}
+
+static bool glsl_next_token(GLSLScanner *s, GLSLToken *tok) {
+	while(s->pos < s->end) {
+		const char *p = s->pos;
+
+		if(isspace((uchar)*p)) {
+			++s->pos;
+		} else if(*p == '#') {
+			// Preprocessor directive; skip to the end of the line, honoring continuations.
+			while(s->pos < s->end && !(*s->pos == '\n' && s->pos[-1] != '\\')) {
+				++s->pos;
+			}
+		} else if(*p == '/' && p + 1 < s->end && p[1] == '/') {
+			while(s->pos < s->end && *s->pos != '\n') {
+				++s->pos;
+			}
+		} else if(*p == '/' && p + 1 < s->end && p[1] == '*') {
+			s->pos += 2;
+
+			while(s->pos + 1 < s->end && !(s->pos[0] == '*' && s->pos[1] == '/')) {
+				++s->pos;
+			}
+
+			s->pos = s->pos + 1 < s->end ? s->pos + 2 : s->end;
+		} else if(glsl_is_ident_char(*p)) {
+			while(s->pos < s->end && glsl_is_ident_char(*s->pos)) {
+				++s->pos;
+			}
+
+			*tok = (GLSLToken) { p, s->pos - p };
+			return true;
+		} else {
+			*tok = (GLSLToken) { p, 1 };
+			++s->pos;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool glsl_token_is(const GLSLToken *tok, const char *str) {
+	return strlen(str) == tok->len && !memcmp(tok->str, str, tok->len);
+}
+
+static bool glsl_skip_past(GLSLScanner *s, const char *closing) {
+	GLSLToken tok;
+
+	while(glsl_next_token(s, &tok)) {
+		if(glsl_token_is(&tok, closing)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool glsl_uniform_type(const GLSLToken *tok, UniformType *out_type) {
+	static const struct {
+		const char *name;
+		UniformType type;
+	} types[] = {
+		{ "float",       UNIFORM_FLOAT },
+		{ "vec2",        UNIFORM_VEC2 },
+		{ "vec3",        UNIFORM_VEC3 },
+		{ "vec4",        UNIFORM_VEC4 },
+		{ "int",         UNIFORM_INT },
+		{ "ivec2",       UNIFORM_IVEC2 },
+		{ "ivec3",       UNIFORM_IVEC3 },
+		{ "ivec4",       UNIFORM_IVEC4 },
+		{ "sampler2D",   UNIFORM_SAMPLER_2D },
+		{ "samplerCube", UNIFORM_SAMPLER_CUBE },
+		{ "mat3",        UNIFORM_MAT3 },
+		{ "mat4",        UNIFORM_MAT4 },
+	};
+
+	for(uint i = 0; i < ARRAY_SIZE(types); ++i) {
+		if(glsl_token_is(tok, types[i].name)) {
+			*out_type = types[i].type;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void scan_glsl_uniforms(ShaderObject *shobj, const char *src, size_t size) {
+	GLSLScanner s = { src, src + strnlen(src, size) };
+	GLSLToken tok;
+
+	while(glsl_next_token(&s, &tok)) {
+		if(glsl_token_is(&tok, "UNIFORM")) {
+			// UNIFORM(location) macro from lib/defs.glslh
+			if(!glsl_next_token(&s, &tok) || !glsl_token_is(&tok, "(") || !glsl_skip_past(&s, ")")) {
+				return;
+			}
+		} else if(!glsl_token_is(&tok, "uniform")) {
+			continue;
+		}
+
+		if(!glsl_next_token(&s, &tok)) {
+			return;
+		}
+
+		if(glsl_token_is(&tok, "lowp") || glsl_token_is(&tok, "mediump") || glsl_token_is(&tok, "highp")) {
+			if(!glsl_next_token(&s, &tok)) {
+				return;
+			}
+		}
+
+		UniformType type;
+
+		if(!glsl_uniform_type(&tok, &type)) {
+			continue;
+		}
+
+		// One or more declarators: name[size], name, ...
+		while(glsl_next_token(&s, &tok) && glsl_is_ident_char(*tok.str)) {
+			dynarray_append(&shobj->uniforms, {
+				.name = memcpy(mem_alloc(tok.len + 1), tok.str, tok.len),
+				.type = type,
+			});
+
+			if(!glsl_next_token(&s, &tok)) {
+				return;
+			}
+
+			if(glsl_token_is(&tok, "[")) {
+				if(!glsl_skip_past(&s, "]") || !glsl_next_token(&s, &tok)) {
+					return;
+				}
+			}
+
+			if(!glsl_token_is(&tok, ",")) {
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * Backend
+ */
+
+static SDL_Window *trace_create_window(const char *title, int x, int y, int w, int h, uint32_t flags) {
+	SDL_Window *window = SDL_CreateWindow(title, w, h, flags);
+
+	if(window) {
+		int pw = w, ph = h;
+		SDL_GetWindowSizeInPixels(window, &pw, &ph);
+		T.window = window;
+		T.state.default_viewport = (FloatRect) { 0, 0, pw, ph };
+	}
+
+	return window;
+}
+
+static SDL_IOStream *open_output(const char *env, const char *what) {
+	const char *path = env_get(env, "");
+
+	if(!*path) {
+		return NULL;
+	}
+
+	SDL_IOStream *io = SDL_IOFromFile(path, "wb");
+
+	if(!io) {
+		log_sdl_error(LOG_ERROR, "SDL_IOFromFile");
+		return NULL;
+	}
+
+	log_info("Writing a renderer %s to %s", what, path);
+	return io;
+}
+
+static bool trace_init(RendererBackend *backend, char *opts) {
+	T.state.color = *RGBA(1, 1, 1, 1);
+	T.state.blend = BLEND_NONE;
+	T.state.cull = CULL_BACK;
+	T.state.depth_func = DEPTH_LESS;
+
+	if((T.out = open_output("TAISEI_RENDERER_TRACE", "trace"))) {
+		put_u64(TRACE_MAGIC);
+		put_u16(TRACE_VERSION);
+	}
+
+	if((T.summary = open_output("TAISEI_RENDERER_TRACE_SUMMARY", "trace summary"))) {
+		SDL_IOprintf(T.summary, "frame");
+		#define TRACE_COUNTER(name) SDL_IOprintf(T.summary, "," #name);
+		TRACE_COUNTERS(TRACE_COUNTER)
+		#undef TRACE_COUNTER
+		SDL_IOprintf(T.summary, "\n");
+	}
+
+	return true;
+}
+
+static void trace_post_init(void) { }
+
+static void trace_shutdown(void) {
+	flush_pending_upload();
+	write_buffer();
+
+	if(T.frame > 0) {
+		log_info("Renderer trace: %u frames", T.frame);
+
+		#define TRACE_COUNTER(name) \
+			log_info("  %-24s total %12"PRIu64"  avg %12.2f  max %10"PRIu64, \
+				#name, T.total.name, T.total.name / (double)T.frame, T.peak.name);
+		TRACE_COUNTERS(TRACE_COUNTER)
+		#undef TRACE_COUNTER
+	}
+
+	if(T.out) {
+		SDL_CloseIO(T.out);
+	}
+
+	if(T.summary) {
+		SDL_CloseIO(T.summary);
+	}
+
+	dynarray_free_data(&T.buf);
+	T = (typeof(T)) {};
+}
+
+static r_feature_bits_t trace_features(void) { return ~0; }
+
+static void trace_capabilities(r_capability_bits_t capbits) {
+	count_state_change(capbits != T.state.capabilities);
+	T.state.capabilities = capbits;
+
+	if(begin_op(TRACE_OP_CAPABILITIES)) {
+		put_u64(capbits);
+	}
+}
+
+static r_capability_bits_t trace_capabilities_current(void) {
+	return T.state.capabilities;
+}
+
+static void trace_draw_common(
+	VertexArray *varr, Primitive prim, uint first, uint count, uint instances, uint base_instance, TraceDrawFlags flags
+) {
+	++T.counters.draw_calls;
+	T.counters.instances += max(instances, 1u);
+
+	if(varr == _r_sprite_batch_vertex_array()) {
+		flags |= TRACE_DRAW_SPRITE_BATCH;
+		++T.counters.sprite_batch_flushes;
+	}
+
+	if(begin_op(TRACE_OP_DRAW)) {
+		put_u32(OBJ_ID(varr));
+		put_u8(prim);
+		put_u8(flags);
+		put_u32(first);
+		put_u32(count);
+		put_u32(instances);
+		put_u32(base_instance);
+	}
+}
+
+static void trace_draw(VertexArray *varr, Primitive prim, uint first, uint count, uint instances, uint base_instance) {
+	trace_draw_common(varr, prim, first, count, instances, base_instance, 0);
+}
+
+static void trace_draw_indexed(VertexArray *varr, Primitive prim, uint first, uint count, uint instances, uint base_instance) {
+	trace_draw_common(varr, prim, first, count, instances, base_instance, TRACE_DRAW_INDEXED);
+}
+
+static void trace_color4(float r, float g, float b, float a) {
+	Color c = *RGBA(r, g, b, a);
+	count_state_change(memcmp(&c, &T.state.color, sizeof(c)));
+	T.state.color = c;
+
+	if(begin_op(TRACE_OP_COLOR)) {
+		put_f32(r);
+		put_f32(g);
+		put_f32(b);
+		put_f32(a);
+	}
+}
+
+static const Color *trace_color_current(void) {
+	return &T.state.color;
+}
+
+static void trace_blend(BlendMode mode) {
+	count_state_change(mode != T.state.blend);
+	T.state.blend = mode;
+
+	if(begin_op(TRACE_OP_BLEND)) {
+		put_u32(mode);
+	}
+}
+
+static BlendMode trace_blend_current(void) {
+	return T.state.blend;
+}
+
+static void trace_cull(CullFaceMode mode) {
+	count_state_change(mode != T.state.cull);
+	T.state.cull = mode;
+
+	if(begin_op(TRACE_OP_CULL)) {
+		put_u8(mode);
+	}
+}
+
+static CullFaceMode trace_cull_current(void) {
+	return T.state.cull;
+}
+
+static void trace_depth_func(DepthTestFunc func) {
+	count_state_change(func != T.state.depth_func);
+	T.state.depth_func = func;
+
+	if(begin_op(TRACE_OP_DEPTH_FUNC)) {
+		put_u8(func);
+	}
+}
+
+static DepthTestFunc trace_depth_func_current(void) {
+	return T.state.depth_func;
+}
+
+static bool trace_shader_language_supported(const ShaderLangInfo *lang, SPIRVTranspileOptions *transpile_opts) {
+	return true;
+}
+
+static ShaderObject *trace_shader_object_compile(ShaderSource *source) {
+	auto shobj = ALLOC(ShaderObject, {
+		.id = new_object(TRACE_OBJ_SHADER_OBJECT),
+	});
+
+	if(source->lang.lang == SHLANG_GLSL) {
+		scan_glsl_uniforms(shobj, source->content, source->content_size);
+	}
+
+	return shobj;
+}
+
+static void shader_object_free_uniforms(ShaderObject *shobj) {
+	dynarray_foreach_elem(&shobj->uniforms, TraceUniformDecl *decl, {
+		mem_free(decl->name);
+	});
+
+	dynarray_free_data(&shobj->uniforms);
+}
+
+static void trace_shader_object_destroy(ShaderObject *shobj) {
+	shader_object_free_uniforms(shobj);
+	destroy_object(TRACE_OBJ_SHADER_OBJECT, shobj->id, shobj->debug_label);
+	mem_free(shobj);
+}
+
+static void trace_shader_object_set_debug_label(ShaderObject *shobj, const char *label) {
+	set_label(TRACE_OBJ_SHADER_OBJECT, shobj->id, &shobj->debug_label, label);
+}
+
+static const char *trace_shader_object_get_debug_label(ShaderObject *shobj) {
+	return shobj->debug_label ?: "Trace shader object";
+}
+
+static bool trace_shader_object_transfer(ShaderObject *dst, ShaderObject *src) {
+	shader_object_free_uniforms(dst);
+	dst->uniforms = src->uniforms;
+	src->uniforms = (typeof(src->uniforms)) {};
+	trace_shader_object_destroy(src);
+	return true;
+}
+
+static void shader_program_free_uniforms(ShaderProgram *prog) {
+	ht_str2ptr_iter_t iter;
+	ht_iter_begin(&prog->uniforms, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		mem_free(iter.value);
+	}
+
+	ht_iter_end(&iter);
+	ht_destroy(&prog->uniforms);
+}
+
+static ShaderProgram *trace_shader_program_link(uint num_objects, ShaderObject *shobjs[num_objects]) {
+	auto prog = ALLOC(ShaderProgram, {
+		.id = new_object(TRACE_OBJ_SHADER_PROGRAM),
+	});
+
+	ht_create(&prog->uniforms);
+
+	for(uint i = 0; i < num_objects; ++i) {
+		dynarray_foreach_elem(&shobjs[i]->uniforms, TraceUniformDecl *decl, {
+			if(ht_get(&prog->uniforms, decl->name, NULL)) {
+				continue;
+			}
+
+			auto u = ALLOC(Uniform, {
+				.prog = prog,
+				.id = ++T.next_id,
+				.type = decl->type,
+			});
+
+			ht_set(&prog->uniforms, decl->name, u);
+
+			if(begin_op(TRACE_OP_UNIFORM_INFO)) {
+				put_u32(prog->id);
+				put_u32(u->id);
+				put_u8(u->type);
+				put_str(decl->name);
+			}
+		});
+	}
+
+	return prog;
+}
+
+static void trace_shader_program_destroy(ShaderProgram *prog) {
+	if(T.state.shader == prog) {
+		T.state.shader = NULL;
+	}
+
+	shader_program_free_uniforms(prog);
+	destroy_object(TRACE_OBJ_SHADER_PROGRAM, prog->id, prog->debug_label);
+	mem_free(prog);
+}
+
+static void trace_shader_program_set_debug_label(ShaderProgram *prog, const char *label) {
+	set_label(TRACE_OBJ_SHADER_PROGRAM, prog->id, &prog->debug_label, label);
+}
+
+static const char *trace_shader_program_get_debug_label(ShaderProgram *prog) {
+	return prog->debug_label ?: "Trace shader program";
+}
+
+static bool trace_shader_program_transfer(ShaderProgram *dst, ShaderProgram *src) {
+	ht_str2ptr_iter_t iter;
+	ht_iter_begin(&src->uniforms, &iter);
+
+	bool fail = false;
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		Uniform *unew = NOT_NULL(iter.value);
+		Uniform *uold = ht_get(&dst->uniforms, iter.key, NULL);
+
+		if(uold && unew->type != uold->type) {
+			log_error(
+				"Can't update shader program '%s': uniform %s changed type",
+				trace_shader_program_get_debug_label(dst), iter.key
+			);
+			fail = true;
+			break;
+		}
+	}
+
+	ht_iter_end(&iter);
+
+	if(fail) {
+		trace_shader_program_destroy(src);
+		return false;
+	}
+
+	// Keep the existing uniforms, because user code may be referencing them; only add new ones.
+	// Uniforms that are gone from the new program stay around as well, like in gl33.
+
+	ht_iter_begin(&src->uniforms, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		Uniform *unew = NOT_NULL(iter.value);
+
+		if(ht_get(&dst->uniforms, iter.key, NULL)) {
+			mem_free(unew);
+		} else {
+			unew->prog = dst;
+			ht_set(&dst->uniforms, iter.key, unew);
+		}
+	}
+
+	ht_iter_end(&iter);
+
+	ht_destroy(&src->uniforms);
+	ht_create(&src->uniforms);
+
+	trace_shader_program_destroy(src);
+	return true;
+}
+
+static void trace_shader(ShaderProgram *prog) {
+	bool changed = prog != T.state.shader;
+	count_state_change(changed);
+	T.counters.shader_switches += changed;
+	T.state.shader = prog;
+
+	if(begin_op(TRACE_OP_SHADER)) {
+		put_u32(OBJ_ID(prog));
+	}
+}
+
+static ShaderProgram *trace_shader_current(void) {
+	return T.state.shader;
+}
+
+static Uniform *trace_shader_uniform(ShaderProgram *prog, const char *uniform_name, hash_t uniform_name_hash) {
+	void *u = NULL;
+	ht_lookup_prehashed(&prog->uniforms, uniform_name, uniform_name_hash, &u);
+	return u;
+}
+
+static void trace_uniform(Uniform *uniform, uint offset, uint count, const void *data) {
+	auto tinfo = r_uniform_type_info(uniform->type);
+	uint32_t size = count * tinfo->elements * tinfo->element_size;
+
+	++T.counters.uniform_uploads;
+	T.counters.uniform_bytes += size;
+
+	if(begin_op(TRACE_OP_UNIFORM)) {
+		put_u32(uniform->id);
+		put_u32(offset);
+		put_u32(count);
+		put_u32(size);
+	}
+}
+
+static UniformType trace_uniform_type(Uniform *uniform) {
+	return uniform->type;
+}
+
+static Texture *trace_texture_create(const TextureParams *params) {
+	return ALLOC(Texture, {
+		.id = new_object(TRACE_OBJ_TEXTURE),
+		.params = *params,
+	});
+}
+
+static void trace_texture_get_size(Texture *tex, uint mipmap, uint *width, uint *height) {
+	if(width) *width = max(1u, tex->params.width >> mipmap);
+	if(height) *height = max(1u, tex->params.height >> mipmap);
+}
+
+static void trace_texture_get_params(Texture *tex, TextureParams *params) {
+	*params = tex->params;
+}
+
+static void trace_texture_set_debug_label(Texture *tex, const char *label) {
+	set_label(TRACE_OBJ_TEXTURE, tex->id, &tex->debug_label, label);
+}
+
+static const char *trace_texture_get_debug_label(Texture *tex) {
+	return tex->debug_label ?: "Trace texture";
+}
+
+static void trace_texture_set_filter(Texture *tex, TextureFilterMode fmin, TextureFilterMode fmag) {
+	tex->params.filter.min = fmin;
+	tex->params.filter.mag = fmag;
+}
+
+static void trace_texture_set_wrap(Texture *tex, TextureWrapMode ws, TextureWrapMode wt) {
+	tex->params.wrap.s = ws;
+	tex->params.wrap.t = wt;
+}
+
+static void trace_texture_fill_region(Texture *tex, uint mipmap, uint layer, uint x, uint y, const Pixmap *image_data) {
+	T.counters.texture_bytes += image_data->data_size;
+
+	if(begin_op(TRACE_OP_TEXTURE_UPLOAD)) {
+		put_u32(tex->id);
+		put_u32(mipmap);
+		put_u32(layer);
+		put_u32(x);
+		put_u32(y);
+		put_u32(image_data->width);
+		put_u32(image_data->height);
+		put_u32(image_data->data_size);
+	}
+}
+
+static void trace_texture_fill(Texture *tex, uint mipmap, uint layer, const Pixmap *image_data) {
+	trace_texture_fill_region(tex, mipmap, layer, 0, 0, image_data);
+}
+
+static bool trace_texture_dump(Texture *tex, uint mipmap, uint layer, Pixmap *dst) { return false; }
+static void trace_texture_invalidate(Texture *tex) { }
+
+static void trace_texture_destroy(Texture *tex) {
+	destroy_object(TRACE_OBJ_TEXTURE, tex->id, tex->debug_label);
+	mem_free(tex);
+}
+
+static void trace_texture_clear(Texture *tex, const Color *color) {
+	++T.counters.clears;
+}
+
+static bool trace_texture_type_query(TextureType type, TextureFlags flags, PixmapFormat pxfmt, TextureTypeQueryResult *result) {
+	if(result) {
+		result->optimal_pixmap_format = pxfmt;
+		result->supplied_pixmap_format_supported = true;
+	}
+
+	return true;
+}
+
+static bool trace_texture_transfer(Texture *dst, Texture *src) {
+	dst->params = src->params;
+	trace_texture_destroy(src);
+	return true;
+}
+
+static Framebuffer *trace_framebuffer_create(void) {
+	auto fb = ALLOC(Framebuffer, {
+		.id = new_object(TRACE_OBJ_FRAMEBUFFER),
+	});
+
+	for(int i = 0; i < FRAMEBUFFER_MAX_OUTPUTS; ++i) {
+		fb->outputs[i] = FRAMEBUFFER_ATTACH_COLOR0 + i;
+	}
+
+	return fb;
+}
+
+static void trace_framebuffer_set_debug_label(Framebuffer *fb, const char *label) {
+	set_label(TRACE_OBJ_FRAMEBUFFER, fb->id, &fb->debug_label, label);
+}
+
+static const char *trace_framebuffer_get_debug_label(Framebuffer *fb) {
+	return fb->debug_label ?: "Trace framebuffer";
+}
+
+static void trace_framebuffer_attach(Framebuffer *fb, Texture *tex, uint mipmap, FramebufferAttachment attachment) {
+	assert((uint)attachment < FRAMEBUFFER_MAX_ATTACHMENTS);
+	fb->attachments[attachment] = (FramebufferAttachmentQueryResult) {
+		.texture = tex,
+		.miplevel = mipmap,
+	};
+}
+
+static FramebufferAttachmentQueryResult trace_framebuffer_query_attachment(Framebuffer *fb, FramebufferAttachment attachment) {
+	assert((uint)attachment < FRAMEBUFFER_MAX_ATTACHMENTS);
+	return fb->attachments[attachment];
+}
+
+static void trace_framebuffer_outputs(Framebuffer *fb, FramebufferAttachment config[FRAMEBUFFER_MAX_OUTPUTS], uint8_t write_mask) {
+	for(int i = 0; i < FRAMEBUFFER_MAX_OUTPUTS; ++i) {
+		if(write_mask & (1 << i)) {
+			fb->outputs[i] = config[i];
+		} else if(write_mask == 0x00) {
+			config[i] = fb->outputs[i];
+		}
+	}
+}
+
+static void trace_framebuffer_destroy(Framebuffer *fb) {
+	if(T.state.framebuffer == fb) {
+		T.state.framebuffer = NULL;
+	}
+
+	destroy_object(TRACE_OBJ_FRAMEBUFFER, fb->id, fb->debug_label);
+	mem_free(fb);
+}
+
+static void trace_framebuffer_viewport(Framebuffer *fb, FloatRect vp) {
+	FloatRect *cur = fb ? &fb->viewport : &T.state.default_viewport;
+	count_state_change(memcmp(cur, &vp, sizeof(vp)));
+	*cur = vp;
+
+	if(begin_op(TRACE_OP_VIEWPORT)) {
+		put_u32(OBJ_ID(fb));
+		put_f32(vp.x);
+		put_f32(vp.y);
+		put_f32(vp.w);
+		put_f32(vp.h);
+	}
+}
+
+static void trace_framebuffer_viewport_current(Framebuffer *fb, FloatRect *vp) {
+	*vp = fb ? fb->viewport : T.state.default_viewport;
+}
+
+static void trace_framebuffer(Framebuffer *fb) {
+	bool changed = fb != T.state.framebuffer;
+	count_state_change(changed);
+	T.counters.framebuffer_switches += changed;
+	T.state.framebuffer = fb;
+
+	if(begin_op(TRACE_OP_FRAMEBUFFER)) {
+		put_u32(OBJ_ID(fb));
+	}
+}
+
+static Framebuffer *trace_framebuffer_current(void) {
+	return T.state.framebuffer;
+}
+
+static void trace_framebuffer_clear(Framebuffer *fb, BufferKindFlags flags, const Color *colorval, float depthval) {
+	++T.counters.clears;
+
+	if(begin_op(TRACE_OP_CLEAR)) {
+		put_u32(OBJ_ID(fb));
+		put_u8(flags);
+	}
+}
+
+static void trace_framebuffer_copy(Framebuffer *dst, Framebuffer *src, BufferKindFlags flags) {
+	if(begin_op(TRACE_OP_COPY)) {
+		put_u32(OBJ_ID(dst));
+		put_u32(OBJ_ID(src));
+		put_u8(flags);
+	}
+}
+
+static IntExtent trace_framebuffer_get_size(Framebuffer *fb) {
+	if(!fb) {
+		int w = 0, h = 0;
+
+		if(T.window) {
+			SDL_GetWindowSizeInPixels(T.window, &w, &h);
+		}
+
+		return (IntExtent) { w, h };
+	}
+
+	for(int i = 0; i < FRAMEBUFFER_MAX_ATTACHMENTS; ++i) {
+		auto a = &fb->attachments[i];
+
+		if(a->texture) {
+			uint w, h;
+			trace_texture_get_size(a->texture, a->miplevel, &w, &h);
+			return (IntExtent) { w, h };
+		}
+	}
+
+	return (IntExtent) { 1, 1 };
+}
+
+static void trace_framebuffer_read_async(Framebuffer *framebuffer, FramebufferAttachment attachment, IntRect region, void *userdata, FramebufferReadAsyncCallback callback) {
+	if(begin_op(TRACE_OP_READ)) {
+		put_u32(OBJ_ID(framebuffer));
+		put_u8(attachment);
+	}
+
+	callback(NULL, userdata);
+}
+
+static size_t trace_vertex_buffer_stream_write(void *ctx, const void *data, size_t size, SDL_IOStatus *status) {
+	VertexBuffer *vbuf = ctx;
+
+	vbuf->offset += size;
+	vbuf->size = max(vbuf->size, vbuf->offset);
+	T.counters.vertex_bytes += size;
+
+	if(T.pending_upload.vbuf != vbuf) {
+		flush_pending_upload();
+		T.pending_upload.vbuf = vbuf;
+		T.pending_upload.size = 0;
+	}
+
+	T.pending_upload.size += size;
+	return size;
+}
+
+static int64_t trace_vertex_buffer_stream_seek(void *ctx, int64_t offset, SDL_IOWhence whence) {
+	VertexBuffer *vbuf = ctx;
+
+	switch(whence) {
+		case SDL_IO_SEEK_CUR: offset += vbuf->offset;  break;
+		case SDL_IO_SEEK_END: offset += vbuf->size;    break;
+		case SDL_IO_SEEK_SET:                          break;
+	}
+
+	if(offset < 0 || offset > vbuf->size) {
+		SDL_SetError("Attempted to seek outside of the buffer");
+		return -1;
+	}
+
+	return (vbuf->offset = offset);
+}
+
+static int64_t trace_vertex_buffer_stream_size(void *ctx) {
+	VertexBuffer *vbuf = ctx;
+	return vbuf->size;
+}
+
+static VertexBuffer *trace_vertex_buffer_create(size_t capacity, void *data) {
+	auto vbuf = ALLOC(VertexBuffer, {
+		.id = new_object(TRACE_OBJ_VERTEX_BUFFER),
+		.size = capacity,
+	});
+
+	vbuf->stream = NOT_NULL(SDL_OpenIO(&(SDL_IOStreamInterface) {
+		.version = sizeof(SDL_IOStreamInterface),
+		.write = trace_vertex_buffer_stream_write,
+		.seek = trace_vertex_buffer_stream_seek,
+		.size = trace_vertex_buffer_stream_size,
+	}, vbuf));
+
+	if(data) {
+		T.counters.vertex_bytes += capacity;
+
+		if(begin_op(TRACE_OP_VERTEX_UPLOAD)) {
+			put_u32(vbuf->id);
+			put_u32(capacity);
+		}
+	}
+
+	return vbuf;
+}
+
+static void trace_vertex_buffer_set_debug_label(VertexBuffer *vbuf, const char *label) {
+	set_label(TRACE_OBJ_VERTEX_BUFFER, vbuf->id, &vbuf->debug_label, label);
+}
+
+static const char *trace_vertex_buffer_get_debug_label(VertexBuffer *vbuf) {
+	return vbuf->debug_label ?: "Trace vertex buffer";
+}
+
+static void trace_vertex_buffer_destroy(VertexBuffer *vbuf) {
+	flush_pending_upload();
+	SDL_CloseIO(vbuf->stream);
+	destroy_object(TRACE_OBJ_VERTEX_BUFFER, vbuf->id, vbuf->debug_label);
+	mem_free(vbuf);
+}
+
+static void trace_vertex_buffer_invalidate(VertexBuffer *vbuf) {
+	vbuf->offset = 0;
+}
+
+static SDL_IOStream *trace_vertex_buffer_get_stream(VertexBuffer *vbuf) {
+	return vbuf->stream;
+}
+
+static IndexBuffer *trace_index_buffer_create(uint index_size, size_t max_elements) {
+	return ALLOC(IndexBuffer, {
+		.id = new_object(TRACE_OBJ_INDEX_BUFFER),
+		.index_size = index_size,
+		.capacity = max_elements,
+	});
+}
+
+static size_t trace_index_buffer_get_capacity(IndexBuffer *ibuf) {
+	return ibuf->capacity;
+}
+
+static uint trace_index_buffer_get_index_size(IndexBuffer *ibuf) {
+	return ibuf->index_size;
+}
+
+static const char *trace_index_buffer_get_debug_label(IndexBuffer *ibuf) {
+	return ibuf->debug_label ?: "Trace index buffer";
+}
+
+static void trace_index_buffer_set_debug_label(IndexBuffer *ibuf, const char *label) {
+	set_label(TRACE_OBJ_INDEX_BUFFER, ibuf->id, &ibuf->debug_label, label);
+}
+
+static void trace_index_buffer_set_offset(IndexBuffer *ibuf, size_t offset) {
+	ibuf->offset = offset;
+}
+
+static size_t trace_index_buffer_get_offset(IndexBuffer *ibuf) {
+	return ibuf->offset;
+}
+
+static void trace_index_buffer_add_indices(IndexBuffer *ibuf, size_t data_size, void *data) {
+	ibuf->offset += data_size / ibuf->index_size;
+	T.counters.index_bytes += data_size;
+
+	if(begin_op(TRACE_OP_INDEX_UPLOAD)) {
+		put_u32(ibuf->id);
+		put_u32(data_size);
+	}
+}
+
+static void trace_index_buffer_invalidate(IndexBuffer *ibuf) {
+	ibuf->offset = 0;
+}
+
+static void trace_index_buffer_destroy(IndexBuffer *ibuf) {
+	destroy_object(TRACE_OBJ_INDEX_BUFFER, ibuf->id, ibuf->debug_label);
+	mem_free(ibuf);
+}
+
+static VertexArray *trace_vertex_array_create(void) {
+	return ALLOC(VertexArray, {
+		.id = new_object(TRACE_OBJ_VERTEX_ARRAY),
+	});
+}
+
+static void trace_vertex_array_set_debug_label(VertexArray *varr, const char *label) {
+	set_label(TRACE_OBJ_VERTEX_ARRAY, varr->id, &varr->debug_label, label);
+}
+
+static const char *trace_vertex_array_get_debug_label(VertexArray *varr) {
+	return varr->debug_label ?: "Trace vertex array";
+}
+
+static void trace_vertex_array_destroy(VertexArray *varr) {
+	dynarray_free_data(&varr->attachments);
+	destroy_object(TRACE_OBJ_VERTEX_ARRAY, varr->id, varr->debug_label);
+	mem_free(varr);
+}
+
+static void trace_vertex_array_attach_vertex_buffer(VertexArray *varr, VertexBuffer *vbuf, uint attachment) {
+	while(varr->attachments.num_elements <= attachment) {
+		dynarray_append(&varr->attachments, NULL);
+	}
+
+	dynarray_set(&varr->attachments, attachment, vbuf);
+}
+
+static VertexBuffer *trace_vertex_array_get_vertex_attachment(VertexArray *varr, uint attachment) {
+	if(attachment >= varr->attachments.num_elements) {
+		return NULL;
+	}
+
+	return dynarray_get(&varr->attachments, attachment);
+}
+
+static void trace_vertex_array_attach_index_buffer(VertexArray *varr, IndexBuffer *ibuf) {
+	varr->index_attachment = ibuf;
+}
+
+static IndexBuffer *trace_vertex_array_get_index_attachment(VertexArray *varr) {
+	return varr->index_attachment;
+}
+
+static void trace_vertex_array_layout(VertexArray *varr, uint nattribs, VertexAttribFormat attribs[nattribs]) { }
+
+static void trace_scissor(IntRect scissor) {
+	count_state_change(memcmp(&scissor, &T.state.scissor, sizeof(scissor)));
+	T.state.scissor = scissor;
+
+	if(begin_op(TRACE_OP_SCISSOR)) {
+		put_u32(scissor.x);
+		put_u32(scissor.y);
+		put_u32(scissor.w);
+		put_u32(scissor.h);
+	}
+}
+
+static void trace_scissor_current(IntRect *scissor) {
+	*scissor = T.state.scissor;
+}
+
+static void trace_vsync(VsyncMode mode) {
+	T.state.vsync = mode;
+}
+
+static VsyncMode trace_vsync_current(void) {
+	return T.state.vsync;
+}
+
+static void trace_swap(SDL_Window *window) {
+	end_frame();
+}
+
+RendererBackend _r_backend_trace = {
+	.name = "trace",
+	.funcs = {
+		.init = trace_init,
+		.post_init = trace_post_init,
+		.shutdown = trace_shutdown,
+		.create_window = trace_create_window,
+		.features = trace_features,
+		.capabilities = trace_capabilities,
+		.capabilities_current = trace_capabilities_current,
+		.draw = trace_draw,
+		.draw_indexed = trace_draw_indexed,
+		.color4 = trace_color4,
+		.color_current = trace_color_current,
+		.blend = trace_blend,
+		.blend_current = trace_blend_current,
+		.cull = trace_cull,
+		.cull_current = trace_cull_current,
+		.depth_func = trace_depth_func,
+		.depth_func_current = trace_depth_func_current,
+		.shader_language_supported = trace_shader_language_supported,
+		.shader_object_compile = trace_shader_object_compile,
+		.shader_object_destroy = trace_shader_object_destroy,
+		.shader_object_set_debug_label = trace_shader_object_set_debug_label,
+		.shader_object_get_debug_label = trace_shader_object_get_debug_label,
+		.shader_object_transfer = trace_shader_object_transfer,
+		.shader_program_link = trace_shader_program_link,
+		.shader_program_destroy = trace_shader_program_destroy,
+		.shader_program_set_debug_label = trace_shader_program_set_debug_label,
+		.shader_program_get_debug_label = trace_shader_program_get_debug_label,
+		.shader_program_transfer = trace_shader_program_transfer,
+		.shader = trace_shader,
+		.shader_current = trace_shader_current,
+		.shader_uniform = trace_shader_uniform,
+		.uniform = trace_uniform,
+		.uniform_type = trace_uniform_type,
+		.texture_create = trace_texture_create,
+		.texture_get_params = trace_texture_get_params,
+		.texture_get_size = trace_texture_get_size,
+		.texture_get_debug_label = trace_texture_get_debug_label,
+		.texture_set_debug_label = trace_texture_set_debug_label,
+		.texture_set_filter = trace_texture_set_filter,
+		.texture_set_wrap = trace_texture_set_wrap,
+		.texture_destroy = trace_texture_destroy,
+		.texture_invalidate = trace_texture_invalidate,
+		.texture_fill = trace_texture_fill,
+		.texture_fill_region = trace_texture_fill_region,
+		.texture_dump = trace_texture_dump,
+		.texture_clear = trace_texture_clear,
+		.texture_type_query = trace_texture_type_query,
+		.texture_transfer = trace_texture_transfer,
+		.framebuffer_create = trace_framebuffer_create,
+		.framebuffer_get_debug_label = trace_framebuffer_get_debug_label,
+		.framebuffer_set_debug_label = trace_framebuffer_set_debug_label,
+		.framebuffer_destroy = trace_framebuffer_destroy,
+		.framebuffer_attach = trace_framebuffer_attach,
+		.framebuffer_query_attachment = trace_framebuffer_query_attachment,
+		.framebuffer_outputs = trace_framebuffer_outputs,
+		.framebuffer_viewport = trace_framebuffer_viewport,
+		.framebuffer_viewport_current = trace_framebuffer_viewport_current,
+		.framebuffer = trace_framebuffer,
+		.framebuffer_current = trace_framebuffer_current,
+		.framebuffer_clear = trace_framebuffer_clear,
+		.framebuffer_copy = trace_framebuffer_copy,
+		.framebuffer_get_size = trace_framebuffer_get_size,
+		.framebuffer_read_async = trace_framebuffer_read_async,
+		.vertex_buffer_create = trace_vertex_buffer_create,
+		.vertex_buffer_get_debug_label = trace_vertex_buffer_get_debug_label,
+		.vertex_buffer_set_debug_label = trace_vertex_buffer_set_debug_label,
+		.vertex_buffer_destroy = trace_vertex_buffer_destroy,
+		.vertex_buffer_invalidate = trace_vertex_buffer_invalidate,
+		.vertex_buffer_get_stream = trace_vertex_buffer_get_stream,
+		.index_buffer_create = trace_index_buffer_create,
+		.index_buffer_get_capacity = trace_index_buffer_get_capacity,
+		.index_buffer_get_index_size = trace_index_buffer_get_index_size,
+		.index_buffer_get_debug_label = trace_index_buffer_get_debug_label,
+		.index_buffer_set_debug_label = trace_index_buffer_set_debug_label,
+		.index_buffer_set_offset = trace_index_buffer_set_offset,
+		.index_buffer_get_offset = trace_index_buffer_get_offset,
+		.index_buffer_add_indices = trace_index_buffer_add_indices,
+		.index_buffer_invalidate = trace_index_buffer_invalidate,
+		.index_buffer_destroy = trace_index_buffer_destroy,
+		.vertex_array_create = trace_vertex_array_create,
+		.vertex_array_get_debug_label = trace_vertex_array_get_debug_label,
+		.vertex_array_set_debug_label = trace_vertex_array_set_debug_label,
+		.vertex_array_destroy = trace_vertex_array_destroy,
+		.vertex_array_layout = trace_vertex_array_layout,
+		.vertex_array_attach_vertex_buffer = trace_vertex_array_attach_vertex_buffer,
+		.vertex_array_get_vertex_attachment = trace_vertex_array_get_vertex_attachment,
+		.vertex_array_attach_index_buffer = trace_vertex_array_attach_index_buffer,
+		.vertex_array_get_index_attachment = trace_vertex_array_get_index_attachment,
+		.scissor = trace_scissor,
+		.scissor_current = trace_scissor_current,
+		.vsync = trace_vsync,
+		.vsync_current = trace_vsync_current,
+		.swap = trace_swap,
+	},
+};
@@ -0,0 +1,86 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "../common/backend.h"
+
+/*
+ * The trace backend draws nothing, like the null one, but keeps track of every object and piece
+ * of state it is given, and records what it was asked to do.
+ *
+ * If TAISEI_RENDERER_TRACE is set, a binary trace is written to that path. It starts with
+ * TRACE_MAGIC (u64) and TRACE_VERSION (u16), followed by records. Every record is a u8 TraceOp and
+ * its operands, listed next to each op below. All integers are little-endian; f32 are IEEE floats
+ * stored the same way as u32. Objects are referred to by u32 IDs, unique for the whole trace;
+ * ID 0 means NULL (e.g. the default framebuffer).
+ *
+ * If TAISEI_RENDERER_TRACE_SUMMARY is set, the per-frame counters (TRACE_COUNTERS) are written to
+ * that path as CSV. Totals, averages and maxima are logged on shutdown either way.
+ */
+
+#define TRACE_MAGIC 0x45434152545354ull  // "TSTRACE\0"
+#define TRACE_VERSION 1
+
+typedef enum TraceOp {
+	TRACE_OP_CREATE = 1,      // kind:u8 id:u32
+	TRACE_OP_DESTROY,         // kind:u8 id:u32
+	TRACE_OP_LABEL,           // kind:u8 id:u32 len:u16 label:u8[len]
+	TRACE_OP_UNIFORM_INFO,    // program:u32 uniform:u32 type:u8 len:u16 name:u8[len]
+	TRACE_OP_CAPABILITIES,    // bits:u64
+	TRACE_OP_COLOR,           // r:f32 g:f32 b:f32 a:f32
+	TRACE_OP_BLEND,           // mode:u32
+	TRACE_OP_CULL,            // mode:u8
+	TRACE_OP_DEPTH_FUNC,      // func:u8
+	TRACE_OP_SHADER,          // program:u32
+	TRACE_OP_FRAMEBUFFER,     // framebuffer:u32
+	TRACE_OP_VIEWPORT,        // framebuffer:u32 x:f32 y:f32 w:f32 h:f32
+	TRACE_OP_SCISSOR,         // x:u32 y:u32 w:u32 h:u32
+	TRACE_OP_UNIFORM,         // uniform:u32 offset:u32 count:u32 size:u32
+	TRACE_OP_TEXTURE_UPLOAD,  // texture:u32 mipmap:u32 layer:u32 x:u32 y:u32 w:u32 h:u32 size:u32
+	TRACE_OP_VERTEX_UPLOAD,   // vertex_buffer:u32 size:u32
+	TRACE_OP_INDEX_UPLOAD,    // index_buffer:u32 size:u32
+	TRACE_OP_DRAW,            // vertex_array:u32 primitive:u8 flags:u8 first:u32 count:u32 instances:u32 base_instance:u32
+	TRACE_OP_CLEAR,           // framebuffer:u32 flags:u8
+	TRACE_OP_COPY,            // dst:u32 src:u32 flags:u8
+	TRACE_OP_READ,            // framebuffer:u32 attachment:u8
+	TRACE_OP_END_FRAME,       // frame:u32, then one u64 for each of TRACE_COUNTERS in order
+} TraceOp;
+
+typedef enum TraceDrawFlags {
+	TRACE_DRAW_INDEXED = (1 << 0),
+	TRACE_DRAW_SPRITE_BATCH = (1 << 1),
+} TraceDrawFlags;
+
+typedef enum TraceObjectKind {
+	TRACE_OBJ_SHADER_OBJECT,
+	TRACE_OBJ_SHADER_PROGRAM,
+	TRACE_OBJ_TEXTURE,
+	TRACE_OBJ_FRAMEBUFFER,
+	TRACE_OBJ_VERTEX_BUFFER,
+	TRACE_OBJ_INDEX_BUFFER,
+	TRACE_OBJ_VERTEX_ARRAY,
+} TraceObjectKind;
+
+#define TRACE_COUNTERS(X) \
+	X(draw_calls) \
+	X(sprite_batch_flushes) \
+	X(instances) \
+	X(state_changes) \
+	X(redundant_state_changes) \
+	X(shader_switches) \
+	X(framebuffer_switches) \
+	X(clears) \
+	X(uniform_uploads) \
+	X(uniform_bytes) \
+	X(texture_bytes) \
+	X(vertex_bytes) \
+	X(index_bytes) \
+
+extern RendererBackend _r_backend_trace;
@@ -0,0 +1,408 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "benchmark.h"
+
+#include "dynarray.h"
+#include "global.h"
+#include "hirestime.h"
+#include "list.h"
+#include "stageobjects.h"
+#include "util/strbuf.h"
+#include "util/stringops.h"
+#include "version.h"
+
+typedef struct BenchmarkSample {
+	hrtime_t time;
+	hrtime_t draw_time;
+	size_t arena_used;
+	uint projectiles;
+	uint particles;
+	uint items;
+	uint enemies;
+	uint lasers;
+	uint tasks;
+} BenchmarkSample;
+
+typedef struct BenchmarkRun {
+	uint first_sample;
+	uint num_samples;
+	hrtime_t wall_time;
+} BenchmarkRun;
+
+typedef struct MetricSummary {
+	double mean, min, p50, p90, p99, max;
+} MetricSummary;
+
+typedef double (*MetricGetter)(const BenchmarkSample *s);
+
+#define METRIC_GETTER(name, expr) \
+	static double metric_##name(const BenchmarkSample *s) { return (expr); }
+
+METRIC_GETTER(frame_time_ns, s->time * (1e9 / HRTIME_RESOLUTION))
+METRIC_GETTER(draw_time_ns, s->draw_time * (1e9 / HRTIME_RESOLUTION))
+METRIC_GETTER(projectiles, s->projectiles)
+METRIC_GETTER(particles, s->particles)
+METRIC_GETTER(items, s->items)
+METRIC_GETTER(enemies, s->enemies)
+METRIC_GETTER(lasers, s->lasers)
+METRIC_GETTER(tasks, s->tasks)
+METRIC_GETTER(arena_bytes, s->arena_used)
+
+#undef METRIC_GETTER
+
+static const struct {
+	const char *name;
+	MetricGetter get;
+} metrics[] = {
+	#define METRIC(name) { #name, metric_##name },
+	METRIC(frame_time_ns)
+	METRIC(draw_time_ns)
+	METRIC(projectiles)
+	METRIC(particles)
+	METRIC(items)
+	METRIC(enemies)
+	METRIC(lasers)
+	METRIC(tasks)
+	METRIC(arena_bytes)
+	#undef METRIC
+};
+
+static struct {
+	DYNAMIC_ARRAY(BenchmarkSample) samples;
+	DYNAMIC_ARRAY(BenchmarkRun) runs;
+	DYNAMIC_ARRAY(double) scratch;
+	const char *subject_kind;
+	char *subject;
+	char *report_path;
+	int num_runs;
+	int frame_limit;
+	uint run_frames;
+	hrtime_t run_start;
+	hrtime_t frame_start;
+	hrtime_t draw_start;
+	bool active;
+} rbench;
+
+static void benchmark_init(
+	const char *subject_kind, const char *subject, const char *report_path, int num_runs, int frame_limit
+) {
+	assert(!rbench.active);
+	assert(num_runs > 0);
+	assert(frame_limit >= 0);
+
+	rbench.subject_kind = subject_kind;
+	stralloc(&rbench.subject, subject);
+	stralloc(&rbench.report_path, report_path);
+	rbench.num_runs = num_runs;
+	rbench.frame_limit = frame_limit;
+	rbench.active = true;
+	rbench.run_start = time_get();
+
+	if(frame_limit) {
+		log_info("Benchmarking %s %s, %i runs of %i frames", subject_kind, subject, num_runs, frame_limit);
+	} else {
+		log_info("Benchmarking %s %s, %i runs", subject_kind, subject, num_runs);
+	}
+}
+
+void replay_benchmark_init(const char *replay_path, const char *report_path, int num_runs, int frame_limit) {
+	benchmark_init("replay", replay_path, report_path, num_runs, frame_limit);
+}
+
+void replay_benchmark_init_stage(const char *stage_name, const char *report_path, int num_runs, int frame_limit) {
+	assert(frame_limit > 0);
+	benchmark_init("stage", stage_name, report_path, num_runs, frame_limit);
+}
+
+void replay_benchmark_shutdown(void) {
+	dynarray_free_data(&rbench.samples);
+	dynarray_free_data(&rbench.runs);
+	dynarray_free_data(&rbench.scratch);
+	mem_free(rbench.subject);
+	mem_free(rbench.report_path);
+	rbench = (typeof(rbench)) {};
+}
+
+bool replay_benchmark_is_active(void) {
+	return rbench.active;
+}
+
+void replay_benchmark_frame_begin(void) {
+	if(!rbench.active) {
+		return;
+	}
+
+	rbench.frame_start = time_get();
+}
+
+static uint list_length(void *anchor) {
+	uint n = 0;
+
+	for(List *l = ((ListAnchor*)anchor)->first; l; l = l->next) {
+		++n;
+	}
+
+	return n;
+}
+
+void replay_benchmark_frame_end(CoSched *sched) {
+	if(!rbench.active) {
+		return;
+	}
+
+	hrtime_t t = time_get() - rbench.frame_start;
+
+	*dynarray_append(&rbench.samples) = (BenchmarkSample) {
+		.time = t,
+		.arena_used = stage_objects.arena.total_used,
+		.projectiles = list_length(&global.projs),
+		.particles = list_length(&global.particles),
+		.items = list_length(&global.items),
+		.enemies = list_length(&global.enemies),
+		.lasers = list_length(&global.lasers),
+		.tasks = list_length(&sched->tasks),
+	};
+
+	++rbench.run_frames;
+}
+
+bool replay_benchmark_frame_limit_reached(void) {
+	return rbench.active && rbench.frame_limit && rbench.run_frames >= (uint)rbench.frame_limit;
+}
+
+void replay_benchmark_draw_begin(void) {
+	if(!rbench.active) {
+		return;
+	}
+
+	rbench.draw_start = time_get();
+}
+
+void replay_benchmark_draw_end(void) {
+	if(!rbench.active || rbench.run_frames == 0) {
+		return;
+	}
+
+	// Attributed to the logic frame that preceded it
+	BenchmarkSample *s = dynarray_get_ptr(&rbench.samples, rbench.samples.num_elements - 1);
+	s->draw_time += time_get() - rbench.draw_start;
+}
+
+bool replay_benchmark_end_run(void) {
+	assert(rbench.active);
+
+	uint first_sample = 0;
+
+	if(rbench.runs.num_elements > 0) {
+		BenchmarkRun *prev = dynarray_get_ptr(&rbench.runs, rbench.runs.num_elements - 1);
+		first_sample = prev->first_sample + prev->num_samples;
+	}
+
+	hrtime_t now = time_get();
+
+	BenchmarkRun *run = dynarray_append(&rbench.runs);
+	*run = (BenchmarkRun) {
+		.first_sample = first_sample,
+		.num_samples = rbench.samples.num_elements - first_sample,
+		.wall_time = now - rbench.run_start,
+	};
+
+	rbench.run_start = now;
+	rbench.run_frames = 0;
+
+	log_info("Benchmark run %i/%i done: %u logic frames in %.3f s",
+		rbench.runs.num_elements, rbench.num_runs, run->num_samples,
+		run->wall_time / (double)HRTIME_RESOLUTION
+	);
+
+	return rbench.runs.num_elements < rbench.num_runs;
+}
+
+static int cmp_double(const void *a, const void *b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile
+static double percentile(const double *sorted, uint n, double p) {
+	uint rank = (uint)ceil(p / 100.0 * n);
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static MetricSummary summarize(MetricGetter get, uint first, uint count) {
+	if(count == 0) {
+		return (MetricSummary) {};
+	}
+
+	rbench.scratch.num_elements = 0;
+	dynarray_ensure_capacity(&rbench.scratch, count);
+	double sum = 0;
+
+	for(uint i = first; i < first + count; ++i) {
+		double v = get(dynarray_get_ptr(&rbench.samples, i));
+		*dynarray_append(&rbench.scratch) = v;
+		sum += v;
+	}
+
+	dynarray_qsort(&rbench.scratch, cmp_double);
+	double *sorted = rbench.scratch.data;
+
+	return (MetricSummary) {
+		.mean = sum / count,
+		.min = sorted[0],
+		.p50 = percentile(sorted, count, 50),
+		.p90 = percentile(sorted, count, 90),
+		.p99 = percentile(sorted, count, 99),
+		.max = sorted[count - 1],
+	};
+}
+
+static void json_write_string(StringBuffer *buf, const char *str) {
+	strbuf_cat(buf, "\"");
+
+	for(const char *c = str; *c; ++c) {
+		if(*c == '"' || *c == '\\') {
+			strbuf_printf(buf, "\\%c", *c);
+		} else if((uchar)*c < 0x20) {
+			strbuf_printf(buf, "\\u%04x", (uchar)*c);
+		} else {
+			strbuf_ncat(buf, 1, c);
+		}
+	}
+
+	strbuf_cat(buf, "\"");
+}
+
+static void json_write_summary(StringBuffer *buf, const MetricSummary *m) {
+	strbuf_printf(buf,
+		"{ \"mean\": %.1f, \"min\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f }",
+		m->mean, m->min, m->p50, m->p90, m->p99, m->max
+	);
+}
+
+static void write_report_json(StringBuffer *buf) {
+	uint num_samples = rbench.samples.num_elements;
+
+	strbuf_printf(buf, "{\n  \"%s\": ", rbench.subject_kind);
+	json_write_string(buf, rbench.subject);
+	char version[128];
+	snprintf(version, sizeof(version), "%s %s", TAISEI_VERSION_FULL, TAISEI_VERSION_BUILD_TYPE);
+	strbuf_cat(buf, ",\n  \"version\": ");
+	json_write_string(buf, version);
+	strbuf_printf(buf, ",\n  \"runs\": %i,\n  \"frames\": %u,\n  \"metrics\": {\n",
+		rbench.runs.num_elements, num_samples
+	);
+
+	for(uint i = 0; i < ARRAY_SIZE(metrics); ++i) {
+		MetricSummary m = summarize(metrics[i].get, 0, num_samples);
+		strbuf_printf(buf, "    \"%s\": ", metrics[i].name);
+		json_write_summary(buf, &m);
+		strbuf_cat(buf, i + 1 < ARRAY_SIZE(metrics) ? ",\n" : "\n");
+	}
+
+	strbuf_cat(buf, "  },\n  \"per_run\": [\n");
+
+	dynarray_foreach(&rbench.runs, int i, BenchmarkRun *run, {
+		MetricSummary m = summarize(metric_frame_time_ns, run->first_sample, run->num_samples);
+		strbuf_printf(buf,
+			"    { \"frames\": %u, \"wall_time_ns\": %"PRIuTIME", \"frame_time_ns\": ",
+			run->num_samples, run->wall_time * (HRTIME_C(1000000000) / HRTIME_RESOLUTION)
+		);
+		json_write_summary(buf, &m);
+		m = summarize(metric_draw_time_ns, run->first_sample, run->num_samples);
+		strbuf_cat(buf, ", \"draw_time_ns\": ");
+		json_write_summary(buf, &m);
+		strbuf_cat(buf, i + 1 < rbench.runs.num_elements ? " },\n" : " }\n");
+	});
+
+	strbuf_cat(buf, "  ]\n}\n");
+}
+
+static void write_report_csv(StringBuffer *buf) {
+	uint num_samples = rbench.samples.num_elements;
+
+	strbuf_cat(buf, "metric,run,mean,min,p50,p90,p99,max\n");
+
+	for(uint i = 0; i < ARRAY_SIZE(metrics); ++i) {
+		MetricSummary m = summarize(metrics[i].get, 0, num_samples);
+		strbuf_printf(buf, "%s,all,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+			metrics[i].name, m.mean, m.min, m.p50, m.p90, m.p99, m.max
+		);
+	}
+
+	dynarray_foreach(&rbench.runs, int i, BenchmarkRun *run, {
+		MetricSummary m = summarize(metric_frame_time_ns, run->first_sample, run->num_samples);
+		strbuf_printf(buf, "frame_time_ns,%i,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+			i, m.mean, m.min, m.p50, m.p90, m.p99, m.max
+		);
+		m = summarize(metric_draw_time_ns, run->first_sample, run->num_samples);
+		strbuf_printf(buf, "draw_time_ns,%i,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+			i, m.mean, m.min, m.p50, m.p90, m.p99, m.max
+		);
+	});
+}
+
+bool replay_benchmark_report(void) {
+	assert(rbench.active);
+
+	MetricSummary ft = summarize(metric_frame_time_ns, 0, rbench.samples.num_elements);
+	log_info(
+		"Benchmark: %i logic frames over %i runs; frame time (us): mean %.1f, p50 %.1f, p90 %.1f, p99 %.1f, max %.1f",
+		rbench.samples.num_elements, rbench.runs.num_elements,
+		ft.mean * 1e-3, ft.p50 * 1e-3, ft.p90 * 1e-3, ft.p99 * 1e-3, ft.max * 1e-3
+	);
+
+	MetricSummary dt = summarize(metric_draw_time_ns, 0, rbench.samples.num_elements);
+	log_info(
+		"Benchmark: draw submission time (us): mean %.1f, p50 %.1f, p90 %.1f, p99 %.1f, max %.1f",
+		dt.mean * 1e-3, dt.p50 * 1e-3, dt.p90 * 1e-3, dt.p99 * 1e-3, dt.max * 1e-3
+	);
+
+	if(!rbench.report_path) {
+		return true;
+	}
+
+	MemArena arena;
+	marena_init(&arena, 0);
+	StringBuffer buf = { &arena };
+
+	if(strendswith(rbench.report_path, ".csv")) {
+		write_report_csv(&buf);
+	} else {
+		write_report_json(&buf);
+	}
+
+	bool ok = true;
+	size_t size = buf.pos - buf.start;
+
+	if(!strcmp(rbench.report_path, "-")) {
+		ok = fwrite(buf.start, 1, size, stdout) == size;
+		fflush(stdout);
+	} else {
+		SDL_IOStream *out = SDL_IOFromFile(rbench.report_path, "wb");
+
+		if(!out) {
+			log_sdl_error(LOG_ERROR, "SDL_IOFromFile");
+			ok = false;
+		} else {
+			ok = SDL_WriteIO(out, buf.start, size) == size;
+			ok = SDL_CloseIO(out) && ok;
+		}
+	}
+
+	if(ok) {
+		log_info("Benchmark report written to %s", rbench.report_path);
+	} else {
+		log_error("Failed to write benchmark report to %s", rbench.report_path);
+	}
+
+	marena_deinit(&arena);
+	return ok;
+}
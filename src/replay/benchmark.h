@@ -0,0 +1,48 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "coroutine/cosched.h"
+
+/*
+ * Headless replay benchmark (--benchmark-replay, --benchmark-stage).
+ *
+ * The replay (or a stage, with no input) is played back several times against the null
+ * renderer, without frame limiting. For every logic frame, the time spent running stage tasks
+ * and submitting the following draw is recorded along with entity counts and stage arena usage.
+ * When all runs are done, a summary with percentiles is logged and optionally written to a JSON
+ * or CSV file (chosen by extension, "-" for stdout).
+ *
+ * If a frame limit is set, each run is cut short after that many logic frames. Stages never
+ * end on their own in this mode, so they need one.
+ */
+
+void replay_benchmark_init(const char *replay_path, const char *report_path, int num_runs, int frame_limit);
+void replay_benchmark_init_stage(const char *stage_name, const char *report_path, int num_runs, int frame_limit);
+void replay_benchmark_shutdown(void);
+
+bool replay_benchmark_is_active(void);
+
+// Wrap the logic part of a stage frame; no-ops if the benchmark is not active.
+void replay_benchmark_frame_begin(void);
+void replay_benchmark_frame_end(CoSched *sched);
+
+// True once the current run has reached its frame limit.
+bool replay_benchmark_frame_limit_reached(void);
+
+// Wrap the draw submission part of a stage frame; no-ops if the benchmark is not active.
+void replay_benchmark_draw_begin(void);
+void replay_benchmark_draw_end(void);
+
+// Returns true if another run should be started.
+bool replay_benchmark_end_run(void);
+
+// Returns false if the report could not be written.
+bool replay_benchmark_report(void);
@@ -19,6 +19,7 @@ typedef struct ReplayContext {
 	Replay *rpy;
 	ResourceGroup rg;
 	int stage_idx;
+	int seek_frame;
 	bool demo_mode;
 } ReplayContext;
 
@@ -68,6 +69,8 @@ static void replay_do_play(CallChainResult ccr) {
 		assume(rstg != NULL);
 		replay_state_init_play(&global.replay.input, rpy, rstg);
 		global.replay.input.play.demo_mode = ctx->demo_mode;
+		global.replay.input.play.skip_frames = max(global.replay.input.play.skip_frames, ctx->seek_frame);
+		ctx->seek_frame = 0;
 		global.plr.mode = plrmode_find(rstg->plr_char, rstg->plr_shot);
 		res_group_release(&ctx->rg);
 		stage_enter(stginfo, &ctx->rg, CALLCHAIN(replay_do_post_play, ctx));
@@ -84,6 +87,7 @@ static void replay_do_post_play(CallChainResult ccr) {
 
 	if(global.gameover == GAMEOVER_RESTART) {
 		--ctx->stage_idx;
+		ctx->seek_frame = global.replay.input.play.seek_frame;
 	}
 
 	global.gameover = 0;
@@ -117,6 +117,7 @@ static bool replay_read_header(
 		case REPLAY_STRUCT_VERSION_TS103000_REV3:
 		case REPLAY_STRUCT_VERSION_TS104000_REV0:
 		case REPLAY_STRUCT_VERSION_TS104000_REV1:
+		case REPLAY_STRUCT_VERSION_TS104000_REV2:
 		{
 			if(taisei_version_read(file, &rpy->game_version) != TAISEI_VERSION_SIZE) {
 				log_error("%s: Failed to read game version", source);
@@ -328,6 +329,29 @@ static bool _replay_read_events(ReplayReadContext *ctx) {
 			CHECKPROP(evt->type, SDL_ReadU8, ctx->stream, u);
 			CHECKPROP(evt->value, SDL_ReadU16LE, ctx->stream, u);
 		}
+
+		if(ctx->version >= REPLAY_STRUCT_VERSION_TS104000_REV2) {
+			uint16_t num_keyframes;
+			CHECKPROP(num_keyframes, SDL_ReadU16LE, ctx->stream, u);
+			dynarray_ensure_capacity(&stg->keyframes, num_keyframes);
+
+			for(int j = 0; j < num_keyframes; ++j) {
+				ReplayKeyframe *kf = dynarray_append(&stg->keyframes, {});
+
+				CHECKPROP(kf->frame, SDL_ReadU32LE, ctx->stream, u);
+				CHECKPROP(kf->event_index, SDL_ReadU16LE, ctx->stream, u);
+				CHECKPROP(kf->digest, SDL_ReadU64LE, ctx->stream, zu);
+			}
+
+			uint32_t checksum = 0;
+			CHECKPROP(checksum, SDL_ReadU32LE, ctx->stream, x);
+
+			if(replay_struct_stage_keyframes_checksum(stg) + checksum) {
+				// Keyframes are optional; the events are still usable without them.
+				log_warn("%s: Keyframe index is corrupt, ignoring it", ctx->filename);
+				dynarray_free_data(&stg->keyframes);
+			}
+		}
 	});
 
 	return true;
@@ -69,6 +69,19 @@ uint32_t replay_struct_stage_metadata_checksum(ReplayStage *stg, uint16_t versio
 	return cs;
 }
 
+uint32_t replay_struct_stage_keyframes_checksum(ReplayStage *stg) {
+	uint32_t cs = stg->keyframes.num_elements;
+
+	dynarray_foreach_elem(&stg->keyframes, ReplayKeyframe *kf, {
+		cs += kf->frame;
+		cs += kf->event_index;
+		cs += (uint32_t)kf->digest;
+		cs += (uint32_t)(kf->digest >> 32);
+	});
+
+	return cs;
+}
+
 SDL_IOStream *replay_wrap_stream_compress(uint16_t version, SDL_IOStream *rw, bool autoclose) {
 	if((version & ~REPLAY_VERSION_COMPRESSION_BIT) >= REPLAY_STRUCT_VERSION_TS104000_REV1) {
 		return SDL_RWWrapZstdWriter(rw, 22, autoclose);
@@ -12,6 +12,7 @@
 #include "struct.h"
 
 uint32_t replay_struct_stage_metadata_checksum(ReplayStage *stg, uint16_t version);
+uint32_t replay_struct_stage_keyframes_checksum(ReplayStage *stg);
 
 SDL_IOStream *replay_wrap_stream_compress(uint16_t version, SDL_IOStream *rw,
 					  bool autoclose);
@@ -10,6 +10,7 @@
 #include "struct.h"
 
 #include "plrmodes.h"
+#include "util/miscmath.h"
 
 ReplayStage *replay_stage_new(Replay *rpy, StageInfo *stage, uint64_t start_time, uint64_t seed, Difficulty diff, Player *plr) {
 	ReplayStage *s = dynarray_append(&rpy->stages, {});
@@ -85,6 +86,16 @@ void replay_stage_event(ReplayStage *stg, uint32_t frame, uint8_t type, uint16_t
 	}
 }
 
+void replay_stage_keyframe(ReplayStage *stg, uint32_t frame, uint64_t digest) {
+	// NOTE: if this overflows, the replay can't be saved anyway (see replay_stage_event)
+	dynarray_append(&stg->keyframes, {
+		.frame = frame,
+		.event_index = min(stg->events.num_elements, UINT16_MAX),
+		.digest = digest,
+	});
+}
+
 void replay_stage_destroy_events(ReplayStage *stg) {
 	dynarray_free_data(&stg->events);
+	dynarray_free_data(&stg->keyframes);
 }
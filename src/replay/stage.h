@@ -25,6 +25,10 @@ ReplayStage *replay_stage_new(
 void replay_stage_event(ReplayStage *stg, uint32_t frame, uint8_t type, uint16_t value)
 	attr_nonnull_all;
 
+// Records a keyframe at the current end of the event stream
+void replay_stage_keyframe(ReplayStage *stg, uint32_t frame, uint64_t digest)
+	attr_nonnull_all;
+
 void replay_stage_sync_player_state(ReplayStage *stg, Player *plr)
 	attr_nonnull_all;
 
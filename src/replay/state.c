@@ -59,6 +59,60 @@ ReplaySyncStatus replay_state_check_desync(ReplayState *rst, int time, uint16_t
 	return REPLAY_SYNC_OK;
 }
 
+static ReplayKeyframe *replay_state_seek_keyframe(ReplayState *rst, int frame) {
+	assert(rst->replay != NULL);
+	assert(rst->mode == REPLAY_PLAY);
+
+	auto keyframes = &NOT_NULL(rst->stage)->keyframes;
+
+	for(; rst->play.keyframe < keyframes->num_elements; ++rst->play.keyframe) {
+		ReplayKeyframe *kf = dynarray_get_ptr(keyframes, rst->play.keyframe);
+
+		if(kf->frame == frame) {
+			return kf;
+		}
+
+		if(kf->frame > frame) {
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+bool replay_state_is_keyframe(ReplayState *rst, int frame) {
+	return rst->stage && replay_state_seek_keyframe(rst, frame);
+}
+
+ReplaySyncStatus replay_state_check_keyframe(ReplayState *rst, int frame, uint64_t digest) {
+	if(!rst->stage) {
+		return REPLAY_SYNC_NODATA;
+	}
+
+	ReplayKeyframe *kf = replay_state_seek_keyframe(rst, frame);
+
+	if(!kf) {
+		return REPLAY_SYNC_NODATA;
+	}
+
+	++rst->play.keyframe;
+
+	if(kf->digest != digest || kf->event_index != rst->play.pos) {
+		log_warn("Frame %d: replay desync detected! Keyframe %016"PRIx64" @ %u != %016"PRIx64" @ %i",
+			frame, kf->digest, kf->event_index, digest, rst->play.pos
+		);
+
+		if(rst->play.desync_frame < 0) {
+			rst->play.desync_frame = frame;
+		}
+
+		return REPLAY_SYNC_FAIL;
+	}
+
+	log_debug("Frame %d: keyframe %016"PRIx64" OK", frame, digest);
+	return REPLAY_SYNC_OK;
+}
+
 void replay_state_play_advance(ReplayState *rst, int frame, ReplayEventFunc event_callback, void *arg) {
 	assert(rst->mode == REPLAY_PLAY);
 
@@ -30,6 +30,8 @@ typedef struct ReplayState {
 			int desync_check_frame;
 			int desync_frame;
 			int skip_frames;
+			int keyframe;
+			int seek_frame;  // where to fast-forward to after the stage is restarted
 			bool demo_mode;
 		} play;
 
@@ -59,5 +61,14 @@ void replay_state_deinit(ReplayState *rst)
 ReplaySyncStatus replay_state_check_desync(ReplayState *rst, int time, uint16_t check)
 	attr_nonnull_all;
 
+// Returns true if the stage's keyframe index has a keyframe for this frame.
+// Frames must be queried in increasing order.
+bool replay_state_is_keyframe(ReplayState *rst, int frame)
+	attr_nonnull_all;
+
+// Checks the game state digest against the stage's keyframe index, if it has a keyframe for this frame
+ReplaySyncStatus replay_state_check_keyframe(ReplayState *rst, int frame, uint64_t digest)
+	attr_nonnull_all;
+
 void replay_state_play_advance(ReplayState *rst, int frame, ReplayEventFunc event_callback, void *arg)
 	attr_nonnull(1, 3);
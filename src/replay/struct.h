@@ -55,13 +55,16 @@
 
 	// Taisei v1.4 revision 1: switch to zstd compression, remove plr_focus, add skip_frames (for demos), rework/fix player resource usage stats
 	#define REPLAY_STRUCT_VERSION_TS104000_REV1 14
+
+	// Taisei v1.4 revision 2: add keyframe index after the input events of each stage
+	#define REPLAY_STRUCT_VERSION_TS104000_REV2 15
 /* END supported struct versions */
 
 #define REPLAY_VERSION_COMPRESSION_BIT 0x8000
 
 // What struct version to use when saving recorded replays
 #define REPLAY_STRUCT_VERSION_WRITE \
-	(REPLAY_STRUCT_VERSION_TS104000_REV1 | REPLAY_VERSION_COMPRESSION_BIT)
+	(REPLAY_STRUCT_VERSION_TS104000_REV2 | REPLAY_VERSION_COMPRESSION_BIT)
 
 #define REPLAY_ALLOC_INITIAL 256
 
@@ -81,6 +84,20 @@ typedef struct ReplayEvent {
 	/* END stored fields */
 } ReplayEvent;
 
+typedef struct ReplayKeyframe {
+	/* BEGIN stored fields */
+
+	uint32_t frame;
+
+	// Number of input events before this frame, i.e. the playback position at the keyframe
+	uint16_t event_index;
+
+	// Digest of the game state at this frame, as computed by the stage code
+	uint64_t digest;
+
+	/* END stored fields */
+} ReplayKeyframe;
+
 typedef struct ReplayStage {
 	/* BEGIN stored fields */
 
@@ -165,6 +182,7 @@ typedef struct ReplayStage {
 
 	SystemTime init_time;
 	DYNAMIC_ARRAY(ReplayEvent) events;
+	DYNAMIC_ARRAY(ReplayKeyframe) keyframes;
 } ReplayStage;
 
 typedef struct Replay {
@@ -217,6 +235,18 @@ typedef struct Replay {
 	//
 	// ReplayStage input_events[];
 
+	/* BEGIN REPLAY_STRUCT_VERSION_TS104000_REV2 and above */
+
+	// Each stage's input events are immediately followed by its keyframe index:
+	//      uint16_t num_keyframes;
+	//      ReplayKeyframe keyframes[num_keyframes];
+	//      uint32_t checksum;  // 2's complement of value returned by replay_struct_stage_keyframes_checksum()
+	//
+	// Keyframes are optional (num_keyframes may be 0). They are used to verify playback and
+	// to pinpoint desyncs, including while seeking.
+
+	/* END REPLAY_STRUCT_VERSION_TS104000_REV2 and above */
+
 	// at least one trailing byte, value doesn't matter
 	// uint8_t useless;
 
@@ -139,6 +139,13 @@ static int cmd_trim(int argc, char **argv) {
 		}
 	});
 
+	dynarray_foreach(&stg->keyframes, int i, ReplayKeyframe *kf, {
+		if(kf->frame >= endframe) {
+			stg->keyframes.num_elements = i;
+			break;
+		}
+	});
+
 	replay_stage_event(stg, endframe, EV_OVER, 0);
 	stg->num_events = stg->events.num_elements;
 
@@ -337,6 +344,9 @@ static int cmd_info(int argc, char **argv) {
 
 		strbuf_printf(&sbuf, "Events: %u", stg->events.num_elements);
 		flushline(&sbuf);
+
+		strbuf_printf(&sbuf, "Keyframes: %u", stg->keyframes.num_elements);
+		flushline(&sbuf);
 	});
 
 	return 0;
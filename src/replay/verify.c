@@ -0,0 +1,305 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "verify.h"
+
+#include "hirestime.h"
+#include "log.h"
+#include "replay.h"
+#include "struct.h"
+#include "thread.h"
+#include "util/env.h"
+#include "util/miscmath.h"
+#include "util/stringops.h"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_process.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+typedef enum VerifyStatus {
+	VERIFY_PASS,
+	VERIFY_DESYNC,
+	VERIFY_FAIL,
+} VerifyStatus;
+
+typedef struct VerifyJob {
+	char *path;
+	char *output;
+	uint64_t frames;
+	hrtime_t time;
+	int desync_frame;
+	int exit_code;
+	VerifyStatus status;
+} VerifyJob;
+
+static struct {
+	VerifyJob *jobs;
+	int num_jobs;
+	SDL_AtomicInt next_job;
+	SDL_Environment *env;
+	char *exe_path;
+} vbatch;
+
+static bool is_file(const char *path) {
+	SDL_PathInfo info;
+	return SDL_GetPathInfo(path, &info) && info.type == SDL_PATHTYPE_FILE;
+}
+
+// argv[0] can't be used to spawn workers as-is: it may be a bare name that was looked up in PATH,
+// relative to some other directory, or whatever the parent process felt like passing.
+static char *find_exe_path(const char *argv0) {
+#ifdef __linux__
+	char buf[4096];
+	ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+
+	if(len > 0) {
+		buf[len] = 0;
+
+		if(is_file(buf)) {
+			return mem_strdup(buf);
+		}
+	}
+#endif
+
+	const char *basepath = SDL_GetBasePath();
+
+	if(!basepath) {
+		log_sdl_error(LOG_ERROR, "SDL_GetBasePath");
+		return NULL;
+	}
+
+	const char *name = argv0;
+
+	for(const char *p = argv0; *p; ++p) {
+		if(*p == '/' || *p == '\\') {
+			name = p + 1;
+		}
+	}
+
+	// SDL_GetBasePath() ends with a path separator
+	size_t size = strlen(basepath) + strlen(name) + sizeof(".exe");
+	char *path = mem_alloc(size);
+	snprintf(path, size, "%s%s", basepath, name);
+
+	if(is_file(path)) {
+		return path;
+	}
+
+#ifdef _WIN32
+	if(!strendswith(path, ".exe")) {
+		strcat(path, ".exe");
+
+		if(is_file(path)) {
+			return path;
+		}
+	}
+#endif
+
+	log_error("Can't find the game executable to run workers from (tried %s)", path);
+	mem_free(path);
+	return NULL;
+}
+
+static uint64_t count_replay_frames(const char *path) {
+	Replay rpy = {};
+	uint64_t frames = 0;
+
+	if(replay_load_syspath(&rpy, path, REPLAY_READ_ALL)) {
+		dynarray_foreach_elem(&rpy.stages, ReplayStage *stg, {
+			if(stg->events.num_elements > 0) {
+				frames += dynarray_get(&stg->events, stg->events.num_elements - 1).frame;
+			}
+		});
+	}
+
+	replay_reset(&rpy);
+	return frames;
+}
+
+static void run_job(VerifyJob *job) {
+	const char *args[] = { vbatch.exe_path, "--verify-replay", job->path, NULL };
+
+	SDL_PropertiesID props = SDL_CreateProperties();
+	SDL_SetPointerProperty(props, SDL_PROP_PROCESS_CREATE_ARGS_POINTER, (void*)args);
+	SDL_SetPointerProperty(props, SDL_PROP_PROCESS_CREATE_ENVIRONMENT_POINTER, vbatch.env);
+	SDL_SetNumberProperty(props, SDL_PROP_PROCESS_CREATE_STDIN_NUMBER, SDL_PROCESS_STDIO_NULL);
+	SDL_SetNumberProperty(props, SDL_PROP_PROCESS_CREATE_STDOUT_NUMBER, SDL_PROCESS_STDIO_APP);
+	SDL_SetBooleanProperty(props, SDL_PROP_PROCESS_CREATE_STDERR_TO_STDOUT_BOOLEAN, true);
+
+	hrtime_t t = time_get();
+	SDL_Process *proc = SDL_CreateProcessWithProperties(props);
+	SDL_DestroyProperties(props);
+
+	job->status = VERIFY_FAIL;
+	job->exit_code = -1;
+
+	if(!proc) {
+		log_sdl_error(LOG_ERROR, "SDL_CreateProcessWithProperties");
+		return;
+	}
+
+	// Blocks until the worker exits; the output is NUL-terminated
+	char *output = SDL_ReadProcess(proc, NULL, &job->exit_code);
+	job->time = time_get() - t;
+	SDL_DestroyProcess(proc);
+
+	if(output) {
+		stralloc(&job->output, output);
+		SDL_free(output);
+	}
+
+	const char *desync = job->output ? strstr(job->output, REPLAY_VERIFY_DESYNC_PREFIX) : NULL;
+
+	if(desync) {
+		job->status = VERIFY_DESYNC;
+		job->desync_frame = strtol(desync + strlen(REPLAY_VERIFY_DESYNC_PREFIX), NULL, 10);
+	} else if(job->exit_code == 0) {
+		job->status = VERIFY_PASS;
+	}
+}
+
+static void *verify_worker(void *arg) {
+	int i;
+
+	while((i = SDL_AddAtomicInt(&vbatch.next_job, 1)) < vbatch.num_jobs) {
+		run_job(vbatch.jobs + i);
+	}
+
+	return NULL;
+}
+
+static int cmp_path(const void *a, const void *b) {
+	return strcmp(*(char *const*)a, *(char *const*)b);
+}
+
+static void report_job(VerifyJob *job) {
+	switch(job->status) {
+		case VERIFY_PASS:
+			log_info("PASS    %s: %"PRIu64" frames in %.3f s",
+				job->path, job->frames, job->time / (double)HRTIME_RESOLUTION
+			);
+			break;
+
+		case VERIFY_DESYNC:
+			log_error("DESYNC  %s: first desync at frame %i\n%s",
+				job->path, job->desync_frame, job->output
+			);
+			break;
+
+		case VERIFY_FAIL:
+			log_error("FAIL    %s: exit code %i\n%s",
+				job->path, job->exit_code, job->output ? job->output : ""
+			);
+			break;
+	}
+}
+
+int replay_verify_batch(const char *argv0, const char *dir) {
+	int num_files = 0;
+	char **files = SDL_GlobDirectory(dir, "*." REPLAY_EXTENSION, 0, &num_files);
+
+	if(!files) {
+		log_sdl_error(LOG_ERROR, "SDL_GlobDirectory");
+		return 1;
+	}
+
+	if(num_files == 0) {
+		log_error("No replays found in %s", dir);
+		SDL_free(files);
+		return 1;
+	}
+
+	qsort(files, num_files, sizeof(*files), cmp_path);
+
+	if(!(vbatch.exe_path = find_exe_path(argv0))) {
+		SDL_free(files);
+		return 1;
+	}
+
+	log_info("Running workers from %s", vbatch.exe_path);
+	vbatch.num_jobs = num_files;
+	vbatch.jobs = ALLOC_ARRAY(num_files, VerifyJob);
+
+	for(int i = 0; i < num_files; ++i) {
+		VerifyJob *job = vbatch.jobs + i;
+		size_t size = strlen(dir) + strlen(files[i]) + 2;
+		job->path = mem_alloc(size);
+		snprintf(job->path, size, "%s/%s", dir, files[i]);
+		job->frames = count_replay_frames(job->path);
+	}
+
+	SDL_free(files);
+
+	// Workers only report warnings and errors, and synchronously so nothing is lost on exit(1)
+	vbatch.env = SDL_CreateEnvironment(true);
+	SDL_SetEnvironmentVariable(vbatch.env, "TAISEI_LOGLVLS_STDOUT", "-a", true);
+	SDL_SetEnvironmentVariable(vbatch.env, "TAISEI_LOG_ASYNC", "0", true);
+
+	int num_workers = env_get("TAISEI_REPLAY_VERIFY_JOBS", 0);
+
+	if(num_workers <= 0) {
+		num_workers = SDL_GetNumLogicalCPUCores();
+	}
+
+	num_workers = clamp(num_workers, 1, num_files);
+	log_info("Verifying %i replays from %s using %i workers", num_files, dir, num_workers);
+
+	auto threads = ALLOC_ARRAY(num_workers, Thread*);
+	hrtime_t t = time_get();
+
+	// The main thread is one of the workers; it also picks up the slack if threads are unavailable
+	for(int i = 1; i < num_workers; ++i) {
+		threads[i] = thread_create("replay verifier", verify_worker, NULL, THREAD_PRIO_NORMAL);
+	}
+
+	verify_worker(NULL);
+
+	for(int i = 1; i < num_workers; ++i) {
+		if(threads[i]) {
+			thread_wait(threads[i]);
+		}
+	}
+
+	t = time_get() - t;
+
+	int num_passed = 0, num_desynced = 0, num_failed = 0;
+	uint64_t frames = 0;
+
+	for(int i = 0; i < num_files; ++i) {
+		VerifyJob *job = vbatch.jobs + i;
+		report_job(job);
+
+		switch(job->status) {
+			case VERIFY_PASS:   ++num_passed; frames += job->frames; break;
+			case VERIFY_DESYNC: ++num_desynced; break;
+			case VERIFY_FAIL:   ++num_failed; break;
+		}
+
+		mem_free(job->path);
+		mem_free(job->output);
+	}
+
+	double seconds = t / (double)HRTIME_RESOLUTION;
+
+	log_info(
+		"Verified %i replays in %.3f s: %i passed, %i desynced, %i failed; "
+		"%"PRIu64" frames verified, %.0f frames/sec",
+		num_files, seconds, num_passed, num_desynced, num_failed, frames, seconds > 0 ? frames / seconds : 0
+	);
+
+	SDL_DestroyEnvironment(vbatch.env);
+	mem_free(vbatch.exe_path);
+	mem_free(threads);
+	mem_free(vbatch.jobs);
+	vbatch = (typeof(vbatch)) {};
+
+	return num_passed == num_files ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+/*
+ * Batch replay verification (--verify-replays).
+ *
+ * Every *.tsr file in a directory is verified by a separate worker process running
+ * "--verify-replay FILE" (headless, null audio and renderer), several at a time. The results are
+ * collected into a pass/desync/failure summary together with the total verification throughput.
+ *
+ * This runs before any subsystem is initialized. Returns the process exit status: 0 if every
+ * replay passed, 1 otherwise.
+ */
+
+// Printed by a --verify-replay worker on desync, followed by the frame number
+#define REPLAY_VERIFY_DESYNC_PREFIX "Replay desynced at frame "
+
+// [argv0] is only used to find the executable's name if its full path can't be determined otherwise.
+int replay_verify_batch(const char *argv0, const char *dir);
@@ -108,9 +108,31 @@ static void replay_write_stage_events(ReplayStage *stg, SDL_IOStream *file) {
 	});
 }
 
-static bool replay_write_events(Replay *rpy, SDL_IOStream *file) {
+static bool replay_write_stage_keyframes(ReplayStage *stg, SDL_IOStream *file) {
+	if(stg->keyframes.num_elements > UINT16_MAX) {
+		log_error("Too many keyframes in replay, cannot write this");
+		return false;
+	}
+
+	SDL_WriteU16LE(file, stg->keyframes.num_elements);
+
+	dynarray_foreach_elem(&stg->keyframes, ReplayKeyframe *kf, {
+		SDL_WriteU32LE(file, kf->frame);
+		SDL_WriteU16LE(file, kf->event_index);
+		SDL_WriteU64LE(file, kf->digest);
+	});
+
+	SDL_WriteU32LE(file, 1 + ~replay_struct_stage_keyframes_checksum(stg));
+	return true;
+}
+
+static bool replay_write_events(Replay *rpy, SDL_IOStream *file, uint16_t version) {
 	dynarray_foreach_elem(&rpy->stages, ReplayStage *stg, {
 		replay_write_stage_events(stg, file);
+
+		if(version >= REPLAY_STRUCT_VERSION_TS104000_REV2 && !replay_write_stage_keyframes(stg, file)) {
+			return false;
+		}
 	});
 
 	return true;
@@ -193,7 +215,7 @@ bool replay_write(Replay *rpy, SDL_IOStream *file, uint16_t version) {
 		vfile = replay_wrap_stream_compress(version, file, false);
 	}
 
-	bool events_ok = replay_write_events(rpy, vfile);
+	bool events_ok = replay_write_events(rpy, vfile, base_version);
 
 	if(compression) {
 		SDL_CloseIO(vfile);
@@ -7,11 +7,13 @@
  */
 
 #include "font.h"
+#include "font_glyph_cache.h"
 
 #include "config.h"
 #include "dynarray.h"
 #include "events.h"
 #include "i18n/i18n.h"
+#include "locale.h"
 #include "memory/arena.h"
 #include "memory/memory.h"
 #include "memory/scratch.h"
@@ -29,6 +31,7 @@
 #include FT_FREETYPE_H
 #include FT_STROKER_H
 #include FT_MODULE_H
+#include FT_TRUETYPE_TABLES_H
 
 #include <linebreak.h>
 #include <graphemebreak.h>
@@ -125,6 +128,7 @@ struct Font {
 	float base_border_outer;
 	ht_int2int_t charcodes_to_glyph_ofs;
 	ht_int2int_t ftindex_to_glyph_ofs;
+	GlyphCache *glyph_cache;
 	FontMetrics metrics;
 	bool kerning;
 
@@ -407,6 +411,35 @@ static FT_Error set_font_size(Font *fnt, float scale) {
 	return err;
 }
 
+static void font_reset_glyph_cache(Font *font) {
+	glyph_cache_free(font->glyph_cache);
+
+	// Everything the rasterized glyphs depend on. Hashing the whole font file would be too slow
+	// for the big CJK fonts, so the sfnt header's revision and checksum stand in for it.
+	FT_Face face = font->face;
+	TT_Header *head = FT_Get_Sfnt_Table(face, FT_SFNT_HEAD);
+	FT_Int ft_major, ft_minor, ft_patch;
+	FT_Library_Version(globals.lib, &ft_major, &ft_minor, &ft_patch);
+
+	char key[512];
+	snprintf(key, sizeof(key), "%s:%li:%s:%s:%li:%08lx:%08lx:%lu:%i.%i.%i:%u:%a:%a",
+		font->source_path,
+		font->base_face_idx,
+		face->family_name ? face->family_name : "",
+		face->style_name ? face->style_name : "",
+		face->num_glyphs,
+		head ? (ulong)head->Font_Revision : 0ul,
+		head ? (ulong)head->CheckSum_Adjust : 0ul,
+		face->stream ? face->stream->size : 0ul,
+		ft_major, ft_minor, ft_patch,
+		(uint)float_to_f26dot6(font->base_size * font->metrics.scale),
+		font->base_border_outer,
+		font->base_border_inner
+	);
+
+	font->glyph_cache = glyph_cache_load(key);
+}
+
 bool font_get_kerning_available(Font *font) {
 	return FT_HAS_KERNING(font->face);
 }
@@ -541,8 +574,8 @@ static void delete_spritesheet(SpriteSheetAnchor *spritesheets, SpriteSheet *ss)
 	mem_free(ss);
 }
 
-static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesheets) {
-	// log_debug("Loading glyph 0x%08x", gindex);
+static GlyphCacheEntry *rasterize_glyph(Font *font, FT_UInt gindex) {
+	// log_debug("Rasterizing glyph 0x%08x", gindex);
 
 	FT_Render_Mode render_mode = GLOBAL_RENDER_MODE;
 	FT_Error err = FT_Load_Glyph(font->face, gindex,
@@ -555,17 +588,15 @@ static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesh
 		return NULL;
 	}
 
-	Glyph *glyph = dynarray_append(&font->glyphs, {
-		.metrics = {
-			.bearing_x = f26dot6_to_float(font->face->glyph->metrics.horiBearingX),
-			.bearing_y = f26dot6_to_float(font->face->glyph->metrics.horiBearingY),
-			.width = f26dot6_to_float(font->face->glyph->metrics.width),
-			.height = f26dot6_to_float(font->face->glyph->metrics.height),
-			.advance = f26dot6_to_float(font->face->glyph->metrics.horiAdvance),
-			.lsb_delta = f26dot6_to_float(font->face->glyph->lsb_delta),
-			.rsb_delta = f26dot6_to_float(font->face->glyph->rsb_delta),
-		}
-	});
+	GlyphMetrics metrics = {
+		.bearing_x = f26dot6_to_float(font->face->glyph->metrics.horiBearingX),
+		.bearing_y = f26dot6_to_float(font->face->glyph->metrics.horiBearingY),
+		.width = f26dot6_to_float(font->face->glyph->metrics.width),
+		.height = f26dot6_to_float(font->face->glyph->metrics.height),
+		.advance = f26dot6_to_float(font->face->glyph->metrics.horiAdvance),
+		.lsb_delta = f26dot6_to_float(font->face->glyph->lsb_delta),
+		.rsb_delta = f26dot6_to_float(font->face->glyph->rsb_delta),
+	};
 
 	FT_Glyph g_src = NULL, g_fill = NULL, g_border = NULL, g_inner = NULL;
 	FT_BitmapGlyph g_bm_fill = NULL, g_bm_border = NULL, g_bm_inner = NULL;
@@ -582,9 +613,11 @@ static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesh
 		have_bitmap = ((FT_BitmapGlyph)g_fill)->bitmap.width > 0;
 	}
 
+	GlyphCacheEntry *entry;
+
 	if(!have_bitmap) {
 		// Some glyphs may be invisible, but we still need the metrics data for them (e.g. space)
-		glyph->sprite = (typeof(glyph->sprite)) {};
+		entry = ALLOC(GlyphCacheEntry, { .metrics = metrics });
 	} else {
 		FT_Stroker_Set(font->stroker,
 			FT_MulFix(
@@ -626,15 +659,21 @@ static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesh
 			FT_Done_Glyph(g_fill);
 			FT_Done_Glyph(g_border);
 			FT_Done_Glyph(g_inner);
-			font->glyphs.num_elements--;
 			return NULL;
 		}
 
-		Pixmap px;
-		px.format = PIXMAP_FORMAT_RGBA8;
-		px.width = max(g_bm_fill->bitmap.width, max(g_bm_border->bitmap.width, g_bm_inner->bitmap.width));
-		px.height = max(g_bm_fill->bitmap.rows, max(g_bm_border->bitmap.rows, g_bm_inner->bitmap.rows));
-		px.data.rgba8 = pixmap_alloc_buffer_for_copy(&px, &px.data_size);
+		uint width = max(g_bm_fill->bitmap.width, max(g_bm_border->bitmap.width, g_bm_inner->bitmap.width));
+		uint height = max(g_bm_fill->bitmap.rows, max(g_bm_border->bitmap.rows, g_bm_inner->bitmap.rows));
+
+		entry = ALLOC_FLEX(GlyphCacheEntry, sizeof(PixelRGB8) * width * height);
+		*entry = (GlyphCacheEntry) {
+			.metrics = metrics,
+			.width = width,
+			.height = height,
+			.pad_w = width - g_bm_fill->bitmap.width,
+			.pad_h = height - g_bm_fill->bitmap.rows,
+		};
+
 		int ref_left = g_bm_border->left;
 		int ref_top = g_bm_border->top;
 
@@ -645,9 +684,9 @@ static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesh
 		ssize_t inner_ofs_x  =  (g_bm_inner->left  - ref_left);
 		ssize_t inner_ofs_y  = -(g_bm_inner->top   - ref_top);
 
-		for(ssize_t x = 0; x < px.width; ++x) {
-			for(ssize_t y = 0; y < px.height; ++y) {
-				PixelRGBA8 *p = px.data.rgba8 + (x + y * px.width);
+		for(ssize_t x = 0; x < width; ++x) {
+			for(ssize_t y = 0; y < height; ++y) {
+				PixelRGB8 *p = entry->pixels + (x + y * width);
 
 				ssize_t fill_coord_x = x - fill_ofs_x;
 				ssize_t fill_coord_y = y - fill_ofs_y;
@@ -686,34 +725,61 @@ static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesh
 				} else {
 					p->b = 0;
 				}
-
-				p->a = 0;
 			}
 		}
+	}
+
+	FT_Done_Glyph(g_src);
+	FT_Done_Glyph(g_fill);
+	FT_Done_Glyph(g_border);
+	FT_Done_Glyph(g_inner);
+
+	entry->ft_index = gindex;
+	return entry;
+}
+
+static Glyph *add_glyph(Font *font, const GlyphCacheEntry *entry, SpriteSheetAnchor *spritesheets) {
+	Glyph *glyph = dynarray_append(&font->glyphs, {
+		.metrics = entry->metrics,
+	});
 
-		if(!add_glyph_to_spritesheets(glyph, &px, spritesheets)) {
+	if(entry->width == 0) {
+		glyph->sprite = (typeof(glyph->sprite)) {};
+	} else {
+		// The spritesheets are RGBA; the cache doesn't store the unused alpha channel.
+		uint num_pixels = entry->width * entry->height;
+		Pixmap px = {
+			.format = PIXMAP_FORMAT_RGBA8,
+			.width = entry->width,
+			.height = entry->height,
+			.data.rgba8 = mem_alloc(sizeof(PixelRGBA8) * num_pixels),
+			.data_size = sizeof(PixelRGBA8) * num_pixels,
+		};
+
+		for(uint i = 0; i < num_pixels; ++i) {
+			PixelRGB8 src = entry->pixels[i];
+			px.data.rgba8[i] = (PixelRGBA8) { .r = src.r, .g = src.g, .b = src.b, .a = 0 };
+		}
+
+		bool added = add_glyph_to_spritesheets(glyph, &px, spritesheets);
+		mem_free(px.data.rgba8);
+
+		if(!added) {
 			log_error(
 				"Glyph %u fill can't fit into any spritesheets (padded bitmap size: %ux%u; max spritesheet size: %ux%u)",
-				gindex,
+				entry->ft_index,
 				px.width + 2,
 				px.height + 2,
 				SS_WIDTH,
 				SS_HEIGHT
 			);
 
-			mem_free(px.data.rgba8);
-			FT_Done_Glyph(g_src);
-			FT_Done_Glyph(g_fill);
-			FT_Done_Glyph(g_border);
-			FT_Done_Glyph(g_inner);
 			--font->glyphs.num_elements;
 			return NULL;
 		}
 
-		mem_free(px.data.rgba8);
-
-		float xpad = px.width - g_bm_fill->bitmap.width;
-		float ypad = px.height - g_bm_fill->bitmap.rows;
+		float xpad = entry->pad_w;
+		float ypad = entry->pad_h;
 		glyph->sprite.padding.extent.w = xpad;
 		glyph->sprite.padding.extent.h = ypad;
 		glyph->sprite.padding.offset.x = -xpad;
@@ -721,15 +787,27 @@ static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesh
 		glyph->sprite.extent.as_cmplx += glyph->sprite.padding.extent.as_cmplx;
 	}
 
-	FT_Done_Glyph(g_src);
-	FT_Done_Glyph(g_fill);
-	FT_Done_Glyph(g_border);
-	FT_Done_Glyph(g_inner);
-
-	glyph->ft_index = gindex;
+	glyph->ft_index = entry->ft_index;
 	return glyph;
 }
 
+static Glyph *load_glyph(Font *font, FT_UInt gindex, SpriteSheetAnchor *spritesheets) {
+	const GlyphCacheEntry *entry = glyph_cache_lookup(font->glyph_cache, gindex);
+
+	if(!entry) {
+		GlyphCacheEntry *new_entry = rasterize_glyph(font, gindex);
+
+		if(!new_entry) {
+			return NULL;
+		}
+
+		glyph_cache_add(font->glyph_cache, new_entry);
+		entry = new_entry;
+	}
+
+	return add_glyph(font, entry, spritesheets);
+}
+
 static Glyph *_get_glyph(Font *fnt, charcode_t cp) {
 	int64_t ofs;
 
@@ -817,6 +895,8 @@ static void free_font_resources(Font *font) {
 	}
 
 	wipe_glyph_cache(font);
+	glyph_cache_free(font->glyph_cache);
+	font->glyph_cache = NULL;
 
 	ht_destroy(&font->charcodes_to_glyph_ofs);
 	ht_destroy(&font->ftindex_to_glyph_ofs);
@@ -826,6 +906,7 @@ static void free_font_resources(Font *font) {
 }
 
 static void finish_reload(ResourceLoadState *st);
+static void warm_up_font(ResourceLoadState *st);
 
 static int parse_fallbacks(char **commalist) {
 	int num_fallbacks = 0;
@@ -924,6 +1005,8 @@ void load_font_stage1(ResourceLoadState *st) {
 		return;
 	}
 
+	font_reset_glyph_cache(&font);
+
 	dynarray_ensure_capacity(&font.glyphs, 32);
 
 #ifdef DEBUG
@@ -956,7 +1039,8 @@ static void load_font_stage2(ResourceLoadState *st) {
 		// workaround to avoid data race (font in use on main thread)
 		res_load_continue_on_main(st, finish_reload, font);
 	} else {
-		res_load_finished(st, font);
+		// Adding glyphs to the spritesheets has to happen on the main thread
+		res_load_continue_on_main(st, warm_up_font, font);
 	}
 }
 
@@ -964,6 +1048,18 @@ static void finish_reload(ResourceLoadState *st) {
 	res_load_finished(st, st->opaque);
 }
 
+static void warm_up_font(ResourceLoadState *st) {
+	Font *font = st->opaque;
+
+	// Get the glyphs for plain ASCII text into the spritesheets while we're loading anyway, rather
+	// than on the first frame that draws them.
+	for(charcode_t cp = 0x20; cp < 0x7f; ++cp) {
+		get_glyph(font, cp);
+	}
+
+	res_load_finished(st, font);
+}
+
 void unload_font(void *vfont) {
 	free_font_resources(vfont);
 	mem_free(vfont);
@@ -977,7 +1073,10 @@ attr_nonnull(1)
 static void reload_font(Font *font, float quality) {
 	if(font->metrics.scale != quality) {
 		wipe_glyph_cache(font);
-		set_font_size(font, quality);
+
+		if(!set_font_size(font, quality)) {
+			font_reset_glyph_cache(font);
+		}
 	}
 }
 
@@ -991,6 +1090,86 @@ static void reload_fonts(float quality) {
 	res_for_each(RES_FONT, reload_font_callback, &(struct rlfonts_arg) { quality });
 }
 
+static void collect_codepoints(const char *text, ht_int2int_t *codepoints) {
+	if(!text) {
+		return;
+	}
+
+	for(uint32_t cp; (cp = SDL_StepUTF8(&text, NULL));) {
+		ht_set(codepoints, cp, 1);
+	}
+}
+
+static void collect_locale_codepoints(const char *source, const char *translation, void *arg) {
+	collect_codepoints(source, arg);
+	collect_codepoints(translation, arg);
+}
+
+struct prewarm_arg {
+	ht_int2int_t codepoints;
+	uint num_rasterized;
+};
+
+static void *prewarm_font_callback(const char *name, Resource *res, void *varg) {
+	struct prewarm_arg *a = varg;
+	Font *font = res->data;
+	uint cached = glyph_cache_size(font->glyph_cache);
+
+	ht_int2int_iter_t iter;
+	ht_iter_begin(&a->codepoints, &iter);
+
+	for(; iter.has_data; ht_iter_next(&iter)) {
+		// Characters this face lacks are rasterized for the fallback fonts, which are visited too
+		FT_UInt ft_index = FT_Get_Char_Index(font->face, iter.key);
+
+		if(ft_index == 0 || glyph_cache_contains(font->glyph_cache, ft_index)) {
+			continue;
+		}
+
+		GlyphCacheEntry *entry = rasterize_glyph(font, ft_index);
+
+		if(entry) {
+			glyph_cache_add(font->glyph_cache, entry);
+		}
+	}
+
+	ht_iter_end(&iter);
+
+	uint added = glyph_cache_size(font->glyph_cache) - cached;
+	log_debug("%s: %u glyphs rasterized", name, added);
+	a->num_rasterized += added;
+
+	return NULL;
+}
+
+void fonts_prewarm_glyph_caches(void) {
+	struct prewarm_arg a = {};
+	ht_create(&a.codepoints);
+
+	ht_set(&a.codepoints, UNICODE_UNKNOWN, 1);
+
+	for(uint32_t cp = 0x20; cp < 0x7f; ++cp) {
+		ht_set(&a.codepoints, cp, 1);
+	}
+
+	size_t num_locales;
+	auto locale_ids = i18n_list_locales(&num_locales);
+
+	for(size_t i = 0; i < num_locales; ++i) {
+		I18nLocale *locale = res_locale(locale_ids[i]);
+
+		if(locale) {
+			i18n_locale_foreach_string(locale, collect_locale_codepoints, &a.codepoints);
+		}
+	}
+
+	res_for_each(RES_FONT, prewarm_font_callback, &a);
+	log_info("Prewarmed glyph caches: %u distinct characters, %u glyphs rasterized",
+		(uint)a.codepoints.num_elements_occupied, a.num_rasterized);
+
+	ht_destroy(&a.codepoints);
+}
+
 static inline float apply_kerning(Font *font, uint prev_index, Glyph *gthis) {
 	FT_Vector kvec;
 
@@ -124,6 +124,10 @@ bool font_get_kerning_available(Font *font) attr_nonnull(1);
 bool font_get_kerning_enabled(Font *font) attr_nonnull(1);
 void font_set_kerning_enabled(Font *font, bool newval) attr_nonnull(1);
 
+// Rasterizes every character used by the known locales into the persistent glyph caches of
+// all loaded fonts, at their current size. Used by --populate-cache.
+void fonts_prewarm_glyph_caches(void);
+
 extern ResourceHandler font_res_handler;
 
 #define FONT_PATH_PREFIX "res/fonts/"
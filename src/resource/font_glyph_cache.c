@@ -0,0 +1,421 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "font_glyph_cache.h"
+
+#include "dynarray.h"
+#include "hashtable.h"
+#include "log.h"
+#include "rwops/rwops_crc32.h"
+#include "util/env.h"
+#include "util/sha256.h"
+#include "vfs/public.h"
+
+#include <zlib.h>
+
+// Bump this whenever rasterization in font.c changes in a way that affects the output
+#define GLYPH_CACHE_VERSION 2
+#define GLYPH_CACHE_MAGIC 0x32434754  // "TGC2"
+#define GLYPH_CACHE_DIR "cache/fonts"
+
+// Sanity limits for reading; anything beyond these is treated as corruption
+#define MAX_ENTRIES (1 << 20)
+#define MAX_GLYPH_DIMENSION 4096
+
+#define CRC_INIT 0
+
+/*
+ * File layout (all integers little-endian):
+ *
+ *      u32 magic, version, num_entries
+ *      num_entries * {
+ *          f32 bearing_x, bearing_y, width, height, advance, lsb_delta, rsb_delta
+ *          u32 ft_index, width, height, pad_w, pad_h
+ *          u32 pixels_crc
+ *      }
+ *      u32 crc of all of the above
+ *      pixels of every entry with a bitmap, in index order
+ *
+ * The file is not compressed, so that the index can be read on its own and the bitmaps fetched
+ * with a seek when they're actually needed. Most cached glyphs are never looked up in a session.
+ */
+
+// FIXME: Like the other caches, this is not atomic. Two fonts with an identical key (same face,
+// size and borders) would write the same file; the last one wins.
+
+typedef struct GlyphCacheRecord {
+	// Resident entries (new ones) own their pixels. For entries that are still on disk this only
+	// holds the header, and the pixels are read into GlyphCache.scratch on lookup. NULL if the
+	// entry turned out to be unreadable and was dropped.
+	GlyphCacheEntry *entry;
+	int64_t file_offset;  // -1 if resident
+	uint32_t pixels_crc;
+} GlyphCacheRecord;
+
+struct GlyphCache {
+	DYNAMIC_ARRAY(GlyphCacheRecord) records;
+	ht_int2int_t index;
+	SDL_IOStream *stream;
+	GlyphCacheEntry *scratch;
+	size_t scratch_size;
+	char path[sizeof(GLYPH_CACHE_DIR) + SHA256_HEXDIGEST_SIZE + 8];
+	uint num_loaded;
+	uint num_dropped;
+	bool persistent;
+};
+
+static bool glyph_cache_enabled(void) {
+	return env_get("TAISEI_FONT_GLYPH_CACHE", true);
+}
+
+#define READ(_file, _func, _type) ({ \
+	_type _tmp = 0; \
+	ok = ok && (_func)((_file), &_tmp); \
+	_tmp; \
+})
+
+#define READU32LE(_file) READ(_file, SDL_ReadU32LE, uint32_t)
+
+static float u32_to_float(uint32_t u) {
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+static uint32_t float_to_u32(float f) {
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+static size_t entry_pixels_size(const GlyphCacheEntry *e) {
+	return sizeof(PixelRGB8) * e->width * e->height;
+}
+
+static uint32_t entry_pixels_crc(const GlyphCacheEntry *e, const PixelRGB8 *pixels) {
+	return crc32(CRC_INIT, (const Bytef*)pixels, entry_pixels_size(e));
+}
+
+static bool glyph_cache_read_index(GlyphCache *gc, SDL_IOStream *stream) {
+	uint32_t crc = CRC_INIT;
+	SDL_IOStream *s = SDL_RWWrapCRC32(stream, &crc, false);
+
+	if(UNLIKELY(!s)) {
+		log_sdl_error(LOG_ERROR, "SDL_RWWrapCRC32");
+		return false;
+	}
+
+	bool ok = true;
+	uint32_t magic = READU32LE(s);
+	uint32_t version = READU32LE(s);
+	uint32_t num_entries = READU32LE(s);
+
+	if(!ok || magic != GLYPH_CACHE_MAGIC || version != GLYPH_CACHE_VERSION || num_entries > MAX_ENTRIES) {
+		log_warn("%s: Bad header, ignoring", gc->path);
+		SDL_CloseIO(s);
+		return false;
+	}
+
+	dynarray_ensure_capacity(&gc->records, num_entries);
+	int64_t data_size = 0;
+
+	for(uint32_t i = 0; i < num_entries && ok; ++i) {
+		GlyphMetrics metrics;
+		metrics.bearing_x = u32_to_float(READU32LE(s));
+		metrics.bearing_y = u32_to_float(READU32LE(s));
+		metrics.width = u32_to_float(READU32LE(s));
+		metrics.height = u32_to_float(READU32LE(s));
+		metrics.advance = u32_to_float(READU32LE(s));
+		metrics.lsb_delta = u32_to_float(READU32LE(s));
+		metrics.rsb_delta = u32_to_float(READU32LE(s));
+
+		uint32_t ft_index = READU32LE(s);
+		uint32_t width = READU32LE(s);
+		uint32_t height = READU32LE(s);
+		uint32_t pad_w = READU32LE(s);
+		uint32_t pad_h = READU32LE(s);
+		uint32_t pixels_crc = READU32LE(s);
+
+		if(!ok || width > MAX_GLYPH_DIMENSION || height > MAX_GLYPH_DIMENSION) {
+			ok = false;
+			break;
+		}
+
+		auto e = ALLOC(GlyphCacheEntry, {
+			.metrics = metrics,
+			.ft_index = ft_index,
+			.width = width,
+			.height = height,
+			.pad_w = pad_w,
+			.pad_h = pad_h,
+		});
+
+		ht_set(&gc->index, ft_index, gc->records.num_elements);
+		dynarray_append(&gc->records, {
+			.entry = e,
+			.file_offset = data_size,  // relative for now
+			.pixels_crc = pixels_crc,
+		});
+
+		data_size += entry_pixels_size(e);
+	}
+
+	SDL_CloseIO(s);
+
+	uint32_t file_crc = 0;
+	ok = ok && SDL_ReadU32LE(stream, &file_crc);
+
+	if(!ok || crc != file_crc) {
+		log_warn("%s: Cache index is truncated or corrupted, ignoring", gc->path);
+		return false;
+	}
+
+	int64_t data_start = SDL_TellIO(stream);
+	int64_t file_size = SDL_GetIOSize(stream);
+
+	if(data_start < 0 || file_size < data_start + data_size) {
+		log_warn("%s: Cache file is truncated, ignoring", gc->path);
+		return false;
+	}
+
+	dynarray_foreach_elem(&gc->records, GlyphCacheRecord *r, {
+		r->file_offset += data_start;
+	});
+
+	return true;
+}
+
+static bool glyph_cache_read_pixels(GlyphCache *gc, GlyphCacheRecord *r, PixelRGB8 *pixels) {
+	size_t size = entry_pixels_size(r->entry);
+
+	if(size == 0) {
+		return true;
+	}
+
+	return
+		gc->stream &&
+		SDL_SeekIO(gc->stream, r->file_offset, SDL_IO_SEEK_SET) >= 0 &&
+		SDL_ReadIO(gc->stream, pixels, size) == size &&
+		entry_pixels_crc(r->entry, pixels) == r->pixels_crc;
+}
+
+static void glyph_cache_clear(GlyphCache *gc) {
+	dynarray_foreach_elem(&gc->records, GlyphCacheRecord *r, {
+		mem_free(r->entry);
+	});
+
+	gc->records.num_elements = 0;
+	gc->num_dropped = 0;
+	ht_unset_all(&gc->index);
+
+	if(gc->stream) {
+		SDL_CloseIO(gc->stream);
+		gc->stream = NULL;
+	}
+}
+
+GlyphCache *glyph_cache_load(const char *key) {
+	auto gc = ALLOC(GlyphCache, {
+		.persistent = glyph_cache_enabled(),
+	});
+
+	ht_create(&gc->index);
+
+	if(!gc->persistent) {
+		return gc;
+	}
+
+	char hash[SHA256_HEXDIGEST_SIZE];
+	sha256_hexdigest((const uint8_t*)key, strlen(key), hash, sizeof(hash));
+	snprintf(gc->path, sizeof(gc->path), GLYPH_CACHE_DIR "/%s", hash);
+
+	if(!vfs_query(gc->path).exists) {
+		return gc;
+	}
+
+	// Kept open for as long as the cache lives, to read bitmaps from on demand.
+	gc->stream = vfs_open(gc->path, VFS_MODE_READ);
+
+	if(!gc->stream) {
+		log_error("VFS error: %s", vfs_get_error());
+		return gc;
+	}
+
+	if(!glyph_cache_read_index(gc, gc->stream)) {
+		glyph_cache_clear(gc);
+	}
+
+	gc->num_loaded = gc->records.num_elements;
+	log_debug("%s: Indexed %u cached glyphs", gc->path, gc->num_loaded);
+
+	return gc;
+}
+
+// Makes every entry resident, so that the file can be closed and rewritten
+static void glyph_cache_load_all(GlyphCache *gc) {
+	dynarray_foreach_elem(&gc->records, GlyphCacheRecord *r, {
+		if(!r->entry || r->file_offset < 0) {
+			continue;
+		}
+
+		auto e = ALLOC_FLEX(GlyphCacheEntry, entry_pixels_size(r->entry));
+		*e = *r->entry;
+
+		bool ok = glyph_cache_read_pixels(gc, r, e->pixels);
+		mem_free(r->entry);
+		r->file_offset = -1;
+
+		if(ok) {
+			r->entry = e;
+		} else {
+			log_warn("%s: Failed to read cached glyph %u, dropping it", gc->path, e->ft_index);
+			mem_free(e);
+			r->entry = NULL;
+			++gc->num_dropped;
+		}
+	});
+}
+
+static void glyph_cache_write(GlyphCache *gc) {
+	if(!vfs_mkparents(gc->path)) {
+		log_warn("VFS error: %s", vfs_get_error());
+		return;
+	}
+
+	SDL_IOStream *stream = vfs_open(gc->path, VFS_MODE_WRITE);
+
+	if(!stream) {
+		log_warn("VFS error: %s", vfs_get_error());
+		return;
+	}
+
+	uint32_t crc = CRC_INIT;
+	SDL_IOStream *s = NOT_NULL(SDL_RWWrapCRC32(stream, &crc, false));
+
+	bool ok = true;
+	ok = ok && SDL_WriteU32LE(s, GLYPH_CACHE_MAGIC);
+	ok = ok && SDL_WriteU32LE(s, GLYPH_CACHE_VERSION);
+	ok = ok && SDL_WriteU32LE(s, glyph_cache_size(gc));
+
+	dynarray_foreach_elem(&gc->records, GlyphCacheRecord *r, {
+		GlyphCacheEntry *e = r->entry;
+
+		if(!e) {
+			continue;
+		}
+
+		ok = ok && SDL_WriteU32LE(s, float_to_u32(e->metrics.bearing_x));
+		ok = ok && SDL_WriteU32LE(s, float_to_u32(e->metrics.bearing_y));
+		ok = ok && SDL_WriteU32LE(s, float_to_u32(e->metrics.width));
+		ok = ok && SDL_WriteU32LE(s, float_to_u32(e->metrics.height));
+		ok = ok && SDL_WriteU32LE(s, float_to_u32(e->metrics.advance));
+		ok = ok && SDL_WriteU32LE(s, float_to_u32(e->metrics.lsb_delta));
+		ok = ok && SDL_WriteU32LE(s, float_to_u32(e->metrics.rsb_delta));
+		ok = ok && SDL_WriteU32LE(s, e->ft_index);
+		ok = ok && SDL_WriteU32LE(s, e->width);
+		ok = ok && SDL_WriteU32LE(s, e->height);
+		ok = ok && SDL_WriteU32LE(s, e->pad_w);
+		ok = ok && SDL_WriteU32LE(s, e->pad_h);
+		ok = ok && SDL_WriteU32LE(s, entry_pixels_crc(e, e->pixels));
+	});
+
+	SDL_CloseIO(s);
+	ok = ok && SDL_WriteU32LE(stream, crc);
+
+	dynarray_foreach_elem(&gc->records, GlyphCacheRecord *r, {
+		if(r->entry) {
+			size_t pixels_size = entry_pixels_size(r->entry);
+			ok = ok && SDL_WriteIO(stream, r->entry->pixels, pixels_size) == pixels_size;
+		}
+	});
+
+	ok = SDL_CloseIO(stream) && ok;
+
+	if(ok) {
+		log_debug("%s: Stored %u glyphs (%u new)",
+			gc->path, glyph_cache_size(gc), gc->records.num_elements - gc->num_loaded);
+	} else {
+		log_warn("%s: Failed to write glyph cache: %s", gc->path, SDL_GetError());
+	}
+}
+
+void glyph_cache_free(GlyphCache *gc) {
+	if(!gc) {
+		return;
+	}
+
+	if(gc->persistent && (gc->records.num_elements > gc->num_loaded || gc->num_dropped)) {
+		glyph_cache_load_all(gc);
+
+		if(gc->stream) {
+			SDL_CloseIO(gc->stream);
+			gc->stream = NULL;
+		}
+
+		glyph_cache_write(gc);
+	}
+
+	glyph_cache_clear(gc);
+	dynarray_free_data(&gc->records);
+	ht_destroy(&gc->index);
+	mem_free(gc->scratch);
+	mem_free(gc);
+}
+
+bool glyph_cache_contains(GlyphCache *gc, uint32_t ft_index) {
+	return ht_lookup(&gc->index, ft_index, NULL);
+}
+
+const GlyphCacheEntry *glyph_cache_lookup(GlyphCache *gc, uint32_t ft_index) {
+	int64_t ofs;
+
+	if(!ht_lookup(&gc->index, ft_index, &ofs)) {
+		return NULL;
+	}
+
+	GlyphCacheRecord *r = dynarray_get_ptr(&gc->records, ofs);
+
+	if(r->file_offset < 0) {
+		return r->entry;
+	}
+
+	size_t size = sizeof(GlyphCacheEntry) + entry_pixels_size(r->entry);
+
+	if(size > gc->scratch_size) {
+		mem_free(gc->scratch);
+		gc->scratch = mem_alloc(size);
+		gc->scratch_size = size;
+	}
+
+	*gc->scratch = *r->entry;
+
+	if(!glyph_cache_read_pixels(gc, r, gc->scratch->pixels)) {
+		// The caller will rasterize it again and add the result as a new entry
+		log_warn("%s: Failed to read cached glyph %u, dropping it", gc->path, ft_index);
+		ht_unset(&gc->index, ft_index);
+		mem_free(r->entry);
+		r->entry = NULL;
+		++gc->num_dropped;
+		return NULL;
+	}
+
+	return gc->scratch;
+}
+
+void glyph_cache_add(GlyphCache *gc, GlyphCacheEntry *entry) {
+	assert(!ht_lookup(&gc->index, entry->ft_index, NULL));
+	ht_set(&gc->index, entry->ft_index, gc->records.num_elements);
+	dynarray_append(&gc->records, {
+		.entry = entry,
+		.file_offset = -1,
+	});
+}
+
+uint glyph_cache_size(GlyphCache *gc) {
+	return gc->records.num_elements - gc->num_dropped;
+}
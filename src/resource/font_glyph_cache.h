@@ -0,0 +1,56 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "font.h"
+#include "pixmap/pixmap.h"
+
+/*
+ * Persistent cache of rasterized glyphs for one font face at one size.
+ *
+ * Entries are keyed by FreeType glyph index. Only the index is read from the cache directory when
+ * the cache is created; bitmaps stay on disk until they're looked up. The cache is written back
+ * when it's freed, if any glyphs were added in the meantime.
+ * The key string passed to glyph_cache_load() must identify everything the rasterized glyphs
+ * depend on (font file, face, pixel size, border parameters, FreeType version); it is hashed to
+ * form the file name.
+ */
+
+typedef struct GlyphCache GlyphCache;
+
+typedef struct GlyphCacheEntry {
+	GlyphMetrics metrics;
+	uint32_t ft_index;
+	uint32_t width;   // 0 if the glyph has no bitmap (e.g. space)
+	uint32_t height;
+	uint32_t pad_w;
+	uint32_t pad_h;
+	PixelRGB8 pixels[];  // width * height; fill, border and inner coverage in r, g and b
+} GlyphCacheEntry;
+
+GlyphCache *glyph_cache_load(const char *key)
+	attr_nonnull_all attr_returns_nonnull attr_nodiscard;
+
+// Writes the cache if it has new entries, then frees it
+void glyph_cache_free(GlyphCache *gc);
+
+bool glyph_cache_contains(GlyphCache *gc, uint32_t ft_index)
+	attr_nonnull_all;
+
+// The returned entry is only valid until the next call to glyph_cache_lookup() or glyph_cache_free()
+const GlyphCacheEntry *glyph_cache_lookup(GlyphCache *gc, uint32_t ft_index)
+	attr_nonnull_all;
+
+// Takes ownership of entry, which must be allocated with mem_alloc() and friends
+void glyph_cache_add(GlyphCache *gc, GlyphCacheEntry *entry)
+	attr_nonnull_all;
+
+uint glyph_cache_size(GlyphCache *gc)
+	attr_nonnull_all;
@@ -269,6 +269,21 @@ const char *i18n_locale_get_translation_prehashed(I18nLocale *locale, const char
 	return ht_str2str_extern_get_prehashed(&locale->table, source, source_hash, source);
 }
 
+void i18n_locale_foreach_string(
+	I18nLocale *locale,
+	void (*callback)(const char *source, const char *translation, void *arg),
+	void *arg
+) {
+	ht_str2str_extern_iter_t iter;
+	ht_str2str_extern_iter_begin(&locale->table, &iter);
+
+	for(; iter.has_data; ht_str2str_extern_iter_next(&iter)) {
+		callback(iter.key, iter.value, arg);
+	}
+
+	ht_str2str_extern_iter_end(&iter);
+}
+
 static bool locale_search_filter(const char *path) {
 	size_t pathlen = strlen(path);
 	char mopath[sizeof(LOCALE_PATH_PREFIX) + sizeof(LOCALE_PATH_SUFFIX) + pathlen];
@@ -21,6 +21,12 @@ INLINE const char *i18n_locale_get_translation(I18nLocale *locale, const char *s
 	return i18n_locale_get_translation_prehashed(locale, source, htutil_hashfunc_string(source));
 }
 
+void i18n_locale_foreach_string(
+	I18nLocale *locale,
+	void (*callback)(const char *source, const char *translation, void *arg),
+	void *arg
+) attr_nonnull(1, 2);
+
 char **i18n_find_locales(size_t *num_results);   // Free result with vfs_dir_list_free()
 
 DEFINE_OPTIONAL_RESOURCE_GETTER(I18nLocale, res_locale, RES_LOCALE)
@@ -25,10 +25,15 @@
 #include "eventloop/eventloop.h"
 #include "events.h"
 #include "filewatch/filewatch.h"
+#include "profiler.h"
 #include "taskmanager.h"
 #include "util.h"
 #include "util/env.h"
 
+#ifdef TAISEI_BUILDCONF_HAVE_POSIX
+#include <sys/resource.h>
+#endif
+
 #define DEBUG_LOAD 0
 #define DEBUG_LOCKS 0
 
@@ -141,6 +146,10 @@ struct InternalResource {
 	// For simplicity of implementation, this is a counted set (a multiset)
 	ht_ires_counted_set_t dependents;
 
+	// Loads of other resources that are parked until this one is done loading.
+	// See park_until_dependencies_loaded().
+	DYNAMIC_ARRAY(InternalResLoadState*) load_waiters;
+
 #if DEBUG_LOCKS
 	SDL_AtomicInt num_locks;
 #endif
@@ -153,6 +162,9 @@ struct InternalResLoadState {
 	ResourceLoadProc continuation;
 	LoadStatus status;
 	bool ready_to_finalize;
+
+	// Number of dependencies this load is parked on, if any.
+	SDL_AtomicInt pending_deps;
 };
 
 typedef struct FileWatchHandlerData {
@@ -365,9 +377,11 @@ static void ires_free_meta(InternalResource *ires) {
 	assert(ires->load == NULL);
 	assert(ires->watched_paths.num_elements == 0);
 	assert(ires->dependents.num_elements_occupied == 0);
+	assert(ires->load_waiters.num_elements == 0);
 
 	dynarray_free_data(&ires->watched_paths);
 	dynarray_free_data(&ires->dependencies);
+	dynarray_free_data(&ires->load_waiters);
 	ht_ires_counted_set_destroy(&ires->dependents);
 }
 
@@ -717,39 +731,54 @@ static void ires_unmake_dependent(InternalResource *ires, IResPtrArray *dependen
 	ires_unlock(ires);
 }
 
-SDL_IOStream *res_open_file(ResourceLoadState *st, const char *path, VFSOpenMode mode) {
-	SDL_IOStream *rw = vfs_open(path, mode);
-
-	if(UNLIKELY(!rw)) {
-		return NULL;
-	}
-
+static void res_watch_file(ResourceLoadState *st, const char *path) {
 	InternalResLoadState *ist = loadstate_internal(st);
 	InternalResource *ires = ist->ires;
 	ResourceHandler *handler = get_ires_handler(ires);
 
 	if(!handler->procs.transfer) {
-		return rw;
+		return;
 	}
 
 	// FIXME: we probably need a better API to obtain the underlying syspath
 	char *syspath = vfs_repr(path, true);
 
 	if(syspath == NULL) {
-		return rw;
+		return;
 	}
 
 	FileWatch *w = filewatch_watch(syspath);
 	mem_free(syspath);
 
 	if(w == NULL) {
-		return rw;
+		return;
 	}
 
 	register_watched_path(ires, path, w);
+}
+
+SDL_IOStream *res_open_file(ResourceLoadState *st, const char *path, VFSOpenMode mode) {
+	SDL_IOStream *rw = vfs_open(path, mode);
+
+	if(UNLIKELY(!rw)) {
+		return NULL;
+	}
+
+	res_watch_file(st, path);
 	return rw;
 }
 
+VFSMapping *res_mmap_file(ResourceLoadState *st, const char *path, const void **out_data, size_t *out_size) {
+	VFSMapping *m = vfs_mmap(path, out_data, out_size);
+
+	if(!m) {
+		return NULL;
+	}
+
+	res_watch_file(st, path);
+	return m;
+}
+
 INLINE void alloc_handler(ResourceHandler *h) {
 	assert(h != NULL);
 	ht_create(&h->private.mapping);
@@ -899,12 +928,20 @@ static ResourceStatus pump_or_wait_for_resource_load_nolock(
 					wait_for_dependencies(load_state);
 				}
 
-				while(!load_state->ready_to_finalize) {
+				// If the load was parked, it's resumed on a worker thread by the last dependency to
+				// finish, which may also finalize it; don't touch load_state once that happens.
+				while(ires->load == load_state && !load_state->ready_to_finalize) {
+					if(SDL_GetAtomicInt(&load_state->pending_deps) > 0) {
+						// Parked (again) on new dependencies, which may need us to finalize them.
+						wait_for_dependencies(load_state);
+						continue;
+					}
+
 					ires_cond_wait(ires);
 				}
 
 				// May have been finalized while we were sleeping
-				// Can happen if load fails
+				// Can happen if load fails, or by a resumed load task
 				load_state = ires->load;
 
 				if(load_state) {
@@ -1012,17 +1049,108 @@ static ResourceStatus pump_or_wait_for_dependencies(InternalResLoadState *st, bo
 	assert(_ist->st.flags == _orig_flags); \
 } while(0)
 
-static void *load_resource_async_task(void *vdata) {
-	InternalResLoadState *st = vdata;
+/*
+ * Dependency-aware scheduling of loads.
+ *
+ * A load that can't continue until its dependencies are loaded does not need to block a worker
+ * thread, or to be polled on the main thread every frame. Instead, it registers itself with every
+ * dependency that is still loading, and gets resumed by whichever of them finishes last: loads in
+ * the LOAD_CONT state are resubmitted to the task manager, and LOAD_CONT_ON_MAIN ones are handed
+ * back to the main thread. This way, independent loads run in parallel as soon as their inputs
+ * are ready, and only the main-thread-only parts are serialized.
+ */
+
+static void *load_resource_resume_task(void *vdata);
+
+static bool park_until_dependencies_loaded(InternalResLoadState *st) {
+	if(st->st.flags & RESF_RELOAD) {
+		// Reloads need to wait for reloads of their dependencies, too; keep it simple.
+		return false;
+	}
+
+	assert(SDL_GetAtomicInt(&st->pending_deps) == 0);
+
+	// Hold an extra count while registering, so that we can't be resumed prematurely.
+	SDL_SetAtomicInt(&st->pending_deps, 1);
+
+	dynarray_foreach_elem(&st->ires->dependencies, InternalResource **pdep, {
+		InternalResource *dep = *pdep;
+		ires_lock(dep);
+
+		if(dep->status == RES_STATUS_LOADING) {
+			SDL_AtomicIncRef(&st->pending_deps);
+			dynarray_append(&dep->load_waiters, st);
+		}
+
+		ires_unlock(dep);
+	});
+
+	// If this drops the count to zero, then all dependencies finished in the meantime, and none
+	// of them will resume us.
+	return !SDL_AtomicDecRef(&st->pending_deps);
+}
+
+static void unpark_load(InternalResLoadState *st) {
+	// Only needed if a load is finalized before all of its dependencies are done, i.e. when one
+	// of them failed.
+
+	dynarray_foreach_elem(&st->ires->dependencies, InternalResource **pdep, {
+		InternalResource *dep = *pdep;
+		ires_lock(dep);
+
+		dynarray_foreach_elem(&dep->load_waiters, InternalResLoadState **pwaiter, {
+			if(*pwaiter == st) {
+				*pwaiter = dynarray_get(&dep->load_waiters, dep->load_waiters.num_elements - 1);
+				--dep->load_waiters.num_elements;
+				SDL_AtomicDecRef(&st->pending_deps);
+				break;
+			}
+		});
+
+		ires_unlock(dep);
+	});
+
+	assert(SDL_GetAtomicInt(&st->pending_deps) == 0);
+}
+
+static void resume_parked_load(InternalResLoadState *st) {
+	// NOTE: called with the last dependency locked; st->ires must not be locked here.
 	InternalResource *ires = st->ires;
-	assume(st == ires->load);
 
-	LOAD_DBG("BEGIN:\t\tires = %p\t\tst = %p", ires, st);
+	if(st->status == LOAD_CONT) {
+		Task *task = taskmgr_global_submit((TaskParams) {
+			.callback = load_resource_resume_task,
+			.userdata = st,
+			// Get this done before starting new loads
+			.topmost = true,
+		});
 
-	ResourceHandler *h = get_ires_handler(ires);
+		if(UNLIKELY(!task)) {
+			log_fatal("Internal error: failed to resume load of %s '%s'", type_name(ires->res.type), ires->name);
+		}
 
-	lstate_set_status(st, LOAD_NONE);
-	PROTECT_FLAGS(st, h->procs.load(&st->st));
+		task_detach(task);
+	} else {
+		assert(st->status == LOAD_CONT_ON_MAIN);
+		events_emit(TE_RESOURCE_ASYNC_LOADED, 0, ires, (void*)(uintptr_t)ires->generation_id);
+	}
+}
+
+static void resume_load_waiters(InternalResource *ires) {
+	// NOTE: ires must be locked
+	dynarray_foreach_elem(&ires->load_waiters, InternalResLoadState **pwaiter, {
+		InternalResLoadState *waiter = *pwaiter;
+
+		if(SDL_AtomicDecRef(&waiter->pending_deps)) {
+			resume_parked_load(waiter);
+		}
+	});
+
+	ires->load_waiters.num_elements = 0;
+}
+
+static void load_resource_async_continue(InternalResLoadState *st) {
+	InternalResource *ires = st->ires;
 
 retry:
 	LOAD_DBG("st->status == %s", loadstatus_name(st->status));
@@ -1041,6 +1169,19 @@ static void *load_resource_async_task(void *vdata) {
 				PROTECT_FLAGS(st, st->continuation(&st->st));
 				goto retry;
 			} else {
+				if(park_until_dependencies_loaded(st)) {
+					// Will be resumed on a worker thread by the last dependency to finish.
+					// st may already be gone at this point.
+					LOAD_DBG("%p parked", ires);
+
+					// The main thread may be waiting for this load, and the new dependencies may
+					// need it to finalize them; wake it up.
+					ires_lock(ires);
+					ires_cond_broadcast(ires);
+					ires_unlock(ires);
+					break;
+				}
+
 				dep_status = pump_dependencies(st);
 
 				if(dep_status == RES_STATUS_LOADING) {
@@ -1080,6 +1221,45 @@ static void *load_resource_async_task(void *vdata) {
 		default:
 			UNREACHABLE;
 	}
+}
+
+static void *load_resource_async_task(void *vdata) {
+	InternalResLoadState *st = vdata;
+	InternalResource *ires = st->ires;
+	assume(st == ires->load);
+
+	LOAD_DBG("BEGIN:\t\tires = %p\t\tst = %p", ires, st);
+	PROFILE_BEGIN(load_resource_async);
+
+	ResourceHandler *h = get_ires_handler(ires);
+
+	lstate_set_status(st, LOAD_NONE);
+	PROTECT_FLAGS(st, h->procs.load(&st->st));
+	// Handing st off may free it along with ires, so keep a copy of the name for the zone
+	char *name = mem_strdup(ires->name);
+	load_resource_async_continue(st);
+	PROFILE_END_DETAIL(load_resource_async, name);
+	mem_free(name);
+
+	LOAD_DBG("  END:\t\tires = %p\t\tst = %p", ires, st);
+	return NULL;
+}
+
+static void *load_resource_resume_task(void *vdata) {
+	InternalResLoadState *st = vdata;
+	InternalResource *ires = st->ires;
+	assume(st == ires->load);
+	assert(st->status == LOAD_CONT);
+
+	LOAD_DBG("RESUME:\t\tires = %p\t\tst = %p", ires, st);
+	PROFILE_BEGIN(load_resource_resume);
+
+	lstate_set_status(st, LOAD_NONE);
+	PROTECT_FLAGS(st, st->continuation(&st->st));
+	char *name = mem_strdup(ires->name);
+	load_resource_async_continue(st);
+	PROFILE_END_DETAIL(load_resource_resume, name);
+	mem_free(name);
 
 	LOAD_DBG("  END:\t\tires = %p\t\tst = %p", ires, st);
 	return NULL;
@@ -1187,12 +1367,24 @@ static bool resource_asyncload_handler(SDL_Event *evt, void *arg) {
 
 	ires_lock(ires);
 
+	if(SDL_GetAtomicInt(&st->pending_deps) > 0) {
+		// Still parked; we'll get another event once the dependencies are done.
+		ires_unlock(ires);
+		return true;
+	}
+
 	ResourceStatus dep_status = pump_dependencies(st);
 
 	if(dep_status == RES_STATUS_LOADING) {
+		if(park_until_dependencies_loaded(st)) {
+			LOAD_DBG("Parking %s '%s' until its dependencies are loaded", type_name(ires->res.type), st->st.name);
+			ires_unlock(ires);
+			return true;
+		}
+
 		LOAD_DBG("Deferring %s '%s' because some dependencies are not satisfied", type_name(ires->res.type), st->st.name);
 
-		// FIXME: Make this less braindead.
+		// Either a reload, or the dependencies finished just now.
 		// This will retry every frame until dependencies are satisfied.
 		ires_unlock(ires);
 		events_defer(evt);
@@ -1295,6 +1487,7 @@ static void load_resource(
 		if(async) {
 			load_resource_async(&st);
 		} else {
+			PROFILE_BEGIN(load_resource);
 			lstate_set_status(&st, LOAD_NONE);
 			PROTECT_FLAGS(&st, handler->procs.load(&st.st));
 
@@ -1312,6 +1505,8 @@ static void load_resource(
 					goto retry;
 				default: UNREACHABLE;
 			}
+
+			PROFILE_END_DETAIL(load_resource, name);
 		}
 	}
 }
@@ -1440,6 +1635,10 @@ static void load_resource_finish(InternalResLoadState *st) {
 
 	assume(!ires->load || ires->load == st);
 
+	if(SDL_GetAtomicInt(&st->pending_deps) > 0) {
+		unpark_load(st);
+	}
+
 	Task *async_task = st->async_task;
 	if(async_task) {
 		LOAD_DBG("%p still has async task %p; detaching", ires, st->async_task);
@@ -1454,6 +1653,8 @@ static void load_resource_finish(InternalResLoadState *st) {
 	ires_cond_broadcast(ires);
 	assert(ires->status != RES_STATUS_LOADING);
 
+	resume_load_waiters(ires);
+
 	// If we are reloading, ires points to a transient resource that will be copied into the
 	// persistent version at the end of this function.
 	// In case of a regular load, persistent == ires.
@@ -1767,6 +1968,30 @@ void *res_for_each(ResourceType type, void* (*callback)(const char *name, Resour
 	return result;
 }
 
+static void wait_for_group(ResourceGroup *rg) {
+	// NOTE: finalizing a load may add more resources to the default group, so the array may be
+	// reallocated while we wait.
+	for(int i = 0; i < rg->refs.num_elements; ++i) {
+		wait_for_resource_load(dynarray_get(&rg->refs, i), 0);
+	}
+}
+
+static void log_peak_memory_usage(void) {
+#ifdef TAISEI_BUILDCONF_HAVE_POSIX
+	struct rusage usage;
+
+	if(getrusage(RUSAGE_SELF, &usage) == 0) {
+		// In bytes on macOS, kilobytes elsewhere
+		#ifdef __APPLE__
+		long peak_kb = usage.ru_maxrss / 1024;
+		#else
+		long peak_kb = usage.ru_maxrss;
+		#endif
+		log_info("Peak resident set size: %.1f MiB", peak_kb / 1024.0);
+	}
+#endif
+}
+
 void res_post_init(void) {
 	for(uint i = 0; i < RES_NUMTYPES; ++i) {
 		ResourceHandler *h = get_handler(i);
@@ -1784,7 +2009,13 @@ void res_post_init(void) {
 
 	if(env_get("TAISEI_AGGRESSIVE_PRELOAD", 0)) {
 		log_info("Attempting to load all resources now due to TAISEI_AGGRESSIVE_PRELOAD");
+		hrtime_t t = time_get();
 		vfs_dir_walk("res/", preload_all, NULL);
+		int num_preloaded = res_gstate.default_group.refs.num_elements;
+		wait_for_group(&res_gstate.default_group);
+		t = time_get() - t;
+		log_info("Loaded %i resources in %.3f s", num_preloaded, t / (double)HRTIME_RESOLUTION);
+		log_peak_memory_usage();
 	}
 }
 
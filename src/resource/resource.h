@@ -92,6 +92,10 @@ void res_load_dependency(ResourceLoadState *st, ResourceType type, const char *n
 // Note that file monitoring support is not guaranteed.
 SDL_IOStream *res_open_file(ResourceLoadState *st, const char *path, VFSOpenMode mode);
 
+// Like res_open_file(), but memory-maps the whole file read-only instead (see vfs_mmap()).
+// Returns NULL if the file can't be mapped; the caller should fall back to res_open_file().
+VFSMapping *res_mmap_file(ResourceLoadState *st, const char *path, const void **out_data, size_t *out_size);
+
 // Unloads a resource, freeing all allocated to it memory.
 typedef void (*ResourceUnloadProc)(void *res);
 
@@ -344,7 +344,10 @@ static PixmapFormat texture_loader_basisu_pick_and_apply_compressed_format(
 }
 
 struct basisu_load_data {
+	const void *filedata;
+	size_t filesize;
 	char *filebuf;
+	VFSMapping *filemap;
 	basist_transcoder *tc;
 	uint mip_bias;
 	PixmapFormat px_decode_format;
@@ -365,6 +368,9 @@ static void texture_loader_basisu_cleanup(struct basisu_load_data *bld) {
 
 	mem_free(bld->filebuf);
 	bld->filebuf = NULL;
+	vfs_munmap(bld->filemap);
+	bld->filemap = NULL;
+	bld->filedata = NULL;
 }
 
 static void texture_loader_basisu_failed(TextureLoadData *ld, struct basisu_load_data *bld) {
@@ -372,10 +378,19 @@ static void texture_loader_basisu_failed(TextureLoadData *ld, struct basisu_load
 	texture_loader_failed(ld);
 }
 
-static char *read_basis_file(SDL_IOStream *rw, size_t *file_size,
-			     size_t hash_size, char hash[hash_size]) {
+static void format_basis_hash(
+	const uint8_t raw_hash[SHA256_BLOCK_SIZE], size_t file_size, size_t hash_size, char hash[hash_size]
+) {
 	assert(hash_size >= BASISU_HASH_SIZE);
 
+	hexdigest(raw_hash, SHA256_BLOCK_SIZE, hash, hash_size);
+
+	assert(hash[SHA256_HEXDIGEST_SIZE - 1] == 0);
+	snprintf(&hash[SHA256_HEXDIGEST_SIZE - 1], BASISU_HASH_SIZE - SHA256_HEXDIGEST_SIZE, "-%zx", file_size);
+}
+
+static char *read_basis_file(SDL_IOStream *rw, size_t *file_size,
+			     size_t hash_size, char hash[hash_size]) {
 	SHA256State *sha256 = sha256_new();
 	rw = SDL_RWWrapSHA256(rw, sha256, false);
 	char *buf = NULL;
@@ -393,14 +408,44 @@ static char *read_basis_file(SDL_IOStream *rw, size_t *file_size,
 	uint8_t raw_hash[SHA256_BLOCK_SIZE];
 	sha256_final(sha256, raw_hash, sizeof(raw_hash));
 	sha256_free(sha256);
-	hexdigest(raw_hash, sizeof(raw_hash), hash, hash_size);
-
-	assert(hash[SHA256_HEXDIGEST_SIZE - 1] == 0);
-	snprintf(&hash[SHA256_HEXDIGEST_SIZE - 1], BASISU_HASH_SIZE - SHA256_HEXDIGEST_SIZE, "-%zx", *file_size);
+	format_basis_hash(raw_hash, *file_size, hash_size, hash);
 
 	return buf;
 }
 
+static bool load_basis_file(TextureLoadData *ld, struct basisu_load_data *bld) {
+	const char *basis_file = ld->src_paths.main;
+
+	// Prefer mapping the file directly: the transcoder only ever reads from it, so this saves
+	// a heap copy of the whole compressed texture. Not possible e.g. for compressed ZIP entries.
+	bld->filemap = res_mmap_file(ld->st, basis_file, &bld->filedata, &bld->filesize);
+
+	if(bld->filemap) {
+		uint8_t raw_hash[SHA256_BLOCK_SIZE];
+		sha256_digest(bld->filedata, bld->filesize, raw_hash, sizeof(raw_hash));
+		format_basis_hash(raw_hash, bld->filesize, sizeof(bld->basis_hash), bld->basis_hash);
+		return true;
+	}
+
+	SDL_IOStream *rw_in = res_open_file(ld->st, basis_file, VFS_MODE_READ);
+
+	if(!UNLIKELY(rw_in)) {
+		log_error("%s: VFS error: %s", ld->st->name, vfs_get_error());
+		return false;
+	}
+
+	bld->filebuf = read_basis_file(rw_in, &bld->filesize, sizeof(bld->basis_hash), bld->basis_hash);
+	SDL_CloseIO(rw_in);
+
+	if(UNLIKELY(!bld->filebuf)) {
+		log_error("%s: Read error: %s", basis_file, SDL_GetError());
+		return false;
+	}
+
+	bld->filedata = bld->filebuf;
+	return true;
+}
+
 static void texture_loader_basisu_set_swizzle(TextureLoadData *ld, PixmapFormat fmt, uint32_t taisei_meta) {
 	PixmapLayout channels = pixmap_format_layout(fmt);
 
@@ -716,28 +761,15 @@ void texture_loader_basisu(TextureLoadData *ld) {
 	const char *ctx = ld->st->name;
 	const char *basis_file = ld->src_paths.main;
 
-	SDL_IOStream *rw_in = res_open_file(ld->st, basis_file, VFS_MODE_READ);
-
-	if(!UNLIKELY(rw_in)) {
-		log_error("%s: VFS error: %s", ctx, vfs_get_error());
-		texture_loader_basisu_failed(ld, &bld);
-		return;
-	}
-
-	size_t filesize;
-	bld.filebuf = read_basis_file(rw_in, &filesize, sizeof(bld.basis_hash), bld.basis_hash);
-	SDL_CloseIO(rw_in);
-
-	if(UNLIKELY(!bld.filebuf)) {
-		log_error("%s: Read error: %s", basis_file, SDL_GetError());
+	if(UNLIKELY(!load_basis_file(ld, &bld))) {
 		texture_loader_basisu_failed(ld, &bld);
 		return;
 	}
 
 	assert(!basist_transcoder_get_ready_to_transcode(bld.tc));
 
-	basist_transcoder_set_data(bld.tc, (basist_data) { .data = bld.filebuf, .size = filesize });
-	log_info("%s: Loaded Basis Universal data from %s", ctx, basis_file);
+	basist_transcoder_set_data(bld.tc, (basist_data) { .data = bld.filedata, .size = bld.filesize });
+	log_info("%s: Loaded Basis Universal data from %s%s", ctx, basis_file, bld.filemap ? " (mapped)" : "");
 
 	basist_file_info file_info = {};
 	TRY(basist_transcoder_get_file_info, bld.tc, &file_info);
@@ -11,7 +11,9 @@
 
 #include "log.h"
 #include "memory/scratch.h"
+#include "taskmanager.h"
 #include "util.h"
+#include "util/env.h"
 #include "util/miscmath.h"
 
 #include <zstd.h>
@@ -32,6 +34,13 @@
  * position and not caching, especially if the cache keeps getting thrashed. For that reason, the
  * cache will disable itself after 8 consecutive misses (num cached frames * 2).
  *
+ * If TAISEI_ZSTD_PREFETCH_DEPTH is non-zero (the default), streams with a seek table are instead
+ * read frame by frame: each frame is decompressed as a whole on the global task manager, and
+ * while a sequential reader consumes one frame, up to depth-1 following frames are decompressed
+ * in parallel ahead of it. The prefetch slots double as a cache, so short backward seeks (e.g.
+ * looping audio) are cheap too. Random (non-sequential) access only decompresses the frame that
+ * was landed on, to avoid wasting work. The LRU cache described above is not used in this mode.
+ *
  * If the seek table is missing, corrupted, or incompatible, the stream is still usable, but
  * seeking will be slow.
  *
@@ -53,6 +62,7 @@ typedef struct ZstdReaderSeekTableEntry {
 } ZstdReaderSeekTableEntry;
 
 typedef struct ZstdReaderSeekTable {
+	uint64_t comp_size;
 	uint32_t num_entries;
 	ZstdReaderSeekTableEntry entries[];
 } ZstdReaderSeekTable;
@@ -90,6 +100,28 @@ typedef struct ZstdFrameCache {
 	ZstdFrameCacheEntry entries[RWZSTD_NUM_CACHED_FRAMES];
 } ZstdFrameCache;
 
+#define RWZSTD_DEFAULT_PREFETCH_DEPTH 4
+#define RWZSTD_MAX_PREFETCH_DEPTH 64
+
+typedef struct ZstdPrefetchSlot {
+	Task *task;
+	ZSTD_DCtx *dctx;
+	uint8_t *comp_data;
+	uint8_t *data;
+	uint32_t comp_alloc_size;
+	uint32_t alloc_size;
+	uint32_t comp_size;
+	uint32_t frame_size;
+	uint32_t frame_idx;
+	const char *error;
+} ZstdPrefetchSlot;
+
+typedef struct ZstdPrefetch {
+	uint32_t last_frame_idx;
+	uint32_t num_slots;
+	ZstdPrefetchSlot slots[];
+} ZstdPrefetch;
+
 typedef struct ZstdData {
 	SDL_IOStream *wrapped;
 	SDL_IOStream *iostream;
@@ -110,6 +142,7 @@ typedef struct ZstdData {
 			int64_t uncompressed_size;
 			ZstdReaderSeekTable *seek_table;
 			ZstdFrameCache frame_cache;
+			ZstdPrefetch *prefetch;
 
 			#if RWZSTD_STATS
 			struct {
@@ -452,8 +485,225 @@ static int64_t rwzstd_reader_seek_source(ZstdData *z, int64_t comp_pos, SDL_IOWh
 	return decomp_pos;
 }
 
+static uint32_t rwzstd_seektable_entry_comp_size(
+	const ZstdData *zdata, const ZstdReaderSeekTableEntry *e
+) {
+	auto st = NOT_NULL(zdata->reader.seek_table);
+
+	uint64_t next_ofs =
+		(e == &st->entries[st->num_entries - 1])
+			? st->comp_size
+			: e[1].comp_offset;
+
+	return next_ofs - e->comp_offset;
+}
+
+static void *rwzstd_prefetch_task(void *arg) {
+	ZstdPrefetchSlot *slot = arg;
+
+	size_t r = ZSTD_decompressDCtx(slot->dctx,
+		slot->data, slot->frame_size, slot->comp_data, slot->comp_size);
+
+	if(UNLIKELY(ZSTD_isError(r))) {
+		slot->error = ZSTD_getErrorName(r);
+	} else if(UNLIKELY(r != slot->frame_size)) {
+		slot->error = "Decompressed frame size doesn't match the seek table";
+	}
+
+	return NULL;
+}
+
+/*
+ * Wait for (or cancel) the slot's pending task, and mark the slot as empty.
+ */
+static void rwzstd_prefetch_slot_reset(ZstdPrefetchSlot *slot) {
+	if(slot->task) {
+		if(!task_cancel(slot->task)) {
+			task_wait(slot->task, NULL);
+		}
+
+		task_detach(slot->task);
+		slot->task = NULL;
+	}
+
+	slot->frame_idx = CACHE_FRAME_IDX_EMPTY;
+	slot->error = NULL;
+}
+
+/*
+ * Read the compressed data of frame frame_idx into the slot.
+ * The reading thread owns the source stream; worker tasks only ever see the slot buffers.
+ */
+static bool rwzstd_prefetch_read_frame(ZstdData *z, ZstdPrefetchSlot *slot, uint32_t frame_idx) {
+	auto e = z->reader.seek_table->entries + frame_idx;
+	uint32_t comp_size = rwzstd_seektable_entry_comp_size(z, e);
+	uint32_t frame_size = rwzstd_seektable_entry_frame_size(z, e);
+
+	if(slot->comp_alloc_size < comp_size) {
+		slot->comp_data = mem_realloc(slot->comp_data, comp_size);
+		slot->comp_alloc_size = comp_size;
+	}
+
+	if(slot->alloc_size < frame_size) {
+		slot->data = mem_realloc(slot->data, frame_size);
+		slot->alloc_size = frame_size;
+	}
+
+	if(UNLIKELY(SDL_SeekIO(z->wrapped, e->comp_offset, SDL_IO_SEEK_SET) < 0)) {
+		log_sdl_error(LOG_ERROR, "SDL_SeekIO");
+		return false;
+	}
+
+	for(uint32_t pos = 0; pos < comp_size;) {
+		size_t read = SDL_ReadIO(z->wrapped, slot->comp_data + pos, comp_size - pos);
+
+		if(UNLIKELY(read == 0)) {
+			log_error("%s: Unexpected end of input while reading frame %u",
+				iostream_get_name(z->iostream), frame_idx);
+			return false;
+		}
+
+		pos += read;
+	}
+
+	slot->comp_size = comp_size;
+	slot->frame_size = frame_size;
+	return true;
+}
+
+static void rwzstd_prefetch_submit(ZstdData *z, uint32_t frame_idx) {
+	auto pf = z->reader.prefetch;
+	auto slot = pf->slots + frame_idx % pf->num_slots;
+
+	if(slot->frame_idx == frame_idx) {
+		return;
+	}
+
+	rwzstd_prefetch_slot_reset(slot);
+
+	if(UNLIKELY(!rwzstd_prefetch_read_frame(z, slot, frame_idx))) {
+		// The error will surface once the reader actually gets to this frame.
+		return;
+	}
+
+	if(!slot->dctx) {
+		slot->dctx = NOT_NULL(ZSTD_createDCtx());
+	}
+
+	slot->frame_idx = frame_idx;
+	slot->task = taskmgr_global_submit((TaskParams) {
+		.callback = rwzstd_prefetch_task,
+		.userdata = slot,
+	});
+
+	if(UNLIKELY(!slot->task)) {
+		rwzstd_prefetch_task(slot);
+	}
+
+	#if RWZSTD_STATS
+	z->reader.stats.total_bytes_decompressed += slot->frame_size;
+	#endif
+
+	SPAM("%s: Prefetching frame %u", iostream_get_name(z->iostream), frame_idx);
+}
+
+/*
+ * Get the decompressed frame frame_idx, waiting for it if necessary.
+ * If the access pattern looks sequential, also schedule decompression of the frames after it.
+ */
+static ZstdPrefetchSlot *rwzstd_prefetch_get(ZstdData *z, uint32_t frame_idx) {
+	auto pf = z->reader.prefetch;
+	auto st = z->reader.seek_table;
+
+	bool sequential = frame_idx - pf->last_frame_idx <= 1;
+	uint32_t end = sequential ? min(st->num_entries, frame_idx + pf->num_slots) : frame_idx + 1;
+
+	for(uint32_t i = frame_idx; i < end; ++i) {
+		rwzstd_prefetch_submit(z, i);
+	}
+
+	pf->last_frame_idx = frame_idx;
+
+	auto slot = pf->slots + frame_idx % pf->num_slots;
+
+	if(UNLIKELY(slot->frame_idx != frame_idx)) {
+		SDL_SetError("Failed to read frame %u", frame_idx);
+		return NULL;
+	}
+
+	if(slot->task) {
+		task_finish(slot->task, NULL);
+		slot->task = NULL;
+	}
+
+	if(UNLIKELY(slot->error)) {
+		SDL_SetError("ZSTD_decompressDCtx() failed for frame %u: %s", frame_idx, slot->error);
+		log_debug("%s", SDL_GetError());
+		rwzstd_prefetch_slot_reset(slot);
+		return NULL;
+	}
+
+	return slot;
+}
+
+static size_t rwzstd_read_prefetched(ZstdData *z, void *ptr, size_t size, SDL_IOStatus *status) {
+	auto st = NOT_NULL(z->reader.seek_table);
+	size_t total_read = 0;
+
+	while(size > 0) {
+		if(z->pos >= z->reader.uncompressed_size) {
+			*status = SDL_IO_STATUS_EOF;
+			break;
+		}
+
+		auto e = rwzstd_find_seektable_entry(st, z->pos);
+		auto slot = rwzstd_prefetch_get(z, (uint32_t)(e - st->entries));
+
+		if(UNLIKELY(!slot)) {
+			*status = SDL_IO_STATUS_ERROR;
+			break;
+		}
+
+		uint32_t local_pos = (uint32_t)(z->pos - e->decomp_offset);
+		size_t chunk = min(size, (size_t)(slot->frame_size - local_pos));
+		memcpy(ptr, slot->data + local_pos, chunk);
+
+		ptr = (uint8_t*)ptr + chunk;
+		size -= chunk;
+		z->pos += chunk;
+		total_read += chunk;
+	}
+
+	#if RWZSTD_STATS
+	z->reader.stats.total_bytes_served += total_read;
+	#endif
+
+	return total_read;
+}
+
+static void rwzstd_prefetch_free(ZstdPrefetch *pf) {
+	if(!pf) {
+		return;
+	}
+
+	for(uint i = 0; i < pf->num_slots; ++i) {
+		auto slot = pf->slots + i;
+		rwzstd_prefetch_slot_reset(slot);
+		ZSTD_freeDCtx(slot->dctx);
+		mem_free(slot->comp_data);
+		mem_free(slot->data);
+	}
+
+	mem_free(pf);
+}
+
 static size_t rwzstd_read(void *ctx, void *ptr, size_t size, SDL_IOStatus *status) {
 	ZstdData *z = ctx;
+
+	if(z->reader.prefetch) {
+		return rwzstd_read_prefetched(z, ptr, size, status);
+	}
+
 	ZstdFrameCache *cache = &z->reader.frame_cache;
 	attr_unused size_t request_size = size;
 
@@ -594,6 +844,7 @@ static bool rwzstd_reader_close(void *ctx) {
 		rwzstd_reader_dump_stats(z);
 	}
 
+	rwzstd_prefetch_free(z->reader.prefetch);
 	ZSTD_freeDStream(z->reader.stream);
 	mem_free((void*)z->reader.in_buffer.src);
 	mem_free(z->reader.seek_table);
@@ -723,6 +974,7 @@ static bool rwzstd_reader_init_seektable(ZstdData *zdata) {
 		decomp_accum += SDL_Swap32LE(entries[i].decomp_size);
 	}
 
+	st->comp_size = comp_accum;
 	release_scratch_arena(scratch);
 
 	if(zdata->reader.uncompressed_size < 0) {
@@ -745,7 +997,23 @@ static bool rwzstd_reader_init_seektable(ZstdData *zdata) {
 
 	log_debug("%s: Loaded seek table with %u entries", iostream_get_name(src), st->num_entries);
 
-	zdata->reader.frame_cache.enabled = true;
+	int prefetch_depth = env_get("TAISEI_ZSTD_PREFETCH_DEPTH", RWZSTD_DEFAULT_PREFETCH_DEPTH);
+
+	if(prefetch_depth > 0) {
+		uint num_slots = min(prefetch_depth, RWZSTD_MAX_PREFETCH_DEPTH);
+		auto pf = ALLOC_FLEX(ZstdPrefetch, sizeof(ZstdPrefetchSlot) * num_slots);
+		pf->num_slots = num_slots;
+		pf->last_frame_idx = CACHE_FRAME_IDX_EMPTY;
+
+		for(uint i = 0; i < num_slots; ++i) {
+			pf->slots[i].frame_idx = CACHE_FRAME_IDX_EMPTY;
+		}
+
+		zdata->reader.prefetch = pf;
+	} else {
+		zdata->reader.frame_cache.enabled = true;
+	}
+
 	return true;
 
 fail:
@@ -906,6 +1174,12 @@ static int64_t rwzstd_reader_seek(void *ctx, int64_t offset, SDL_IOWhence whence
 
 	SPAM("%s: %zi --> %zi", iostream_get_name(zdata->iostream), zdata->pos, target_pos);
 
+	if(zdata->reader.prefetch) {
+		// Frames are located on demand by rwzstd_read_prefetched()
+		zdata->pos = target_pos;
+		return target_pos;
+	}
+
 	auto st = zdata->reader.seek_table;
 	int64_t skip_begin = 0;
 
@@ -9,6 +9,7 @@
 #include "stage.h"
 
 #include "audio/audio.h"
+#include "collision_grid.h"
 #include "common_tasks.h"  // IWYU pragma: keep
 #include "config.h"
 #include "dynstage.h"
@@ -21,16 +22,20 @@
 #include "menu/gameovermenu.h"
 #include "menu/ingamemenu.h"
 #include "player.h"
+#include "profiler.h"
+#include "replay/benchmark.h"
 #include "replay/demoplayer.h"
 #include "replay/stage.h"
 #include "replay/state.h"
 #include "replay/struct.h"
+#include "replay/verify.h"
 #include "resource/bgm.h"
 #include "stagedraw.h"
 #include "stageinfo.h"
 #include "stageobjects.h"
 #include "stagetext.h"
 #include "util/env.h"
+#include "util/io.h"
 #include "watchdog.h"
 
 typedef struct StageFrameState {
@@ -46,6 +51,7 @@ typedef struct StageFrameState {
 	uint32_t dynstage_generation;
 	int transition_delay;
 	int desync_check_freq;
+	int keyframe_freq;
 	uint16_t last_replay_fps;
 	float view_shake;
 	int bgm_start_time;
@@ -445,6 +451,9 @@ static Replay *create_quicksave_replay(ReplayStage *rstg_src) {
 	dynarray_ensure_capacity(&rstg->events, rstg_src->events.num_elements + 1);
 	dynarray_set_elements(&rstg->events, rstg_src->events.num_elements, rstg_src->events.data);
 
+	rstg->keyframes = (typeof(rstg->keyframes)) {};
+	dynarray_set_elements(&rstg->keyframes, rstg_src->keyframes.num_elements, rstg_src->keyframes.data);
+
 	replay_stage_event(rstg, global.frames, EV_RESUME, 0);
 	replay_stage_update_final_stats(rstg, &global.plr.stats);
 
@@ -782,6 +791,7 @@ static void stage_free(void) {
 	}
 
 	lasers_shutdown();
+	collision_grid_shutdown();
 	projectiles_free();
 	stagetext_free();
 }
@@ -926,6 +936,22 @@ static void stage_give_clear_bonus(const StageInfo *stage, StageClearBonus *bonu
 	player_add_points(&global.plr, bonus->total, global.plr.pos);
 }
 
+static void stage_replay_desynced(StageFrameState *fstate) {
+	if(
+		global.is_replay_verification &&
+		!global.replay.output.stage
+	) {
+		tsfprintf(stdout, REPLAY_VERIFY_DESYNC_PREFIX "%i (stage %X)\n", global.frames, global.stage->id);
+		fflush(stdout);
+		exit(1);
+	}
+
+	if(is_quickloading(fstate)) {
+		log_warn("Quicksave replay desynced; resuming prematurely!");
+		leave_replay_mode(fstate, &global.replay.input);
+	}
+}
+
 static void stage_replay_sync(StageFrameState *fstate) {
 	uint16_t desync_check = (rng_u64() ^ global.plr.points) & 0xFFFF;
 	ReplaySyncStatus rpsync = replay_state_check_desync(&global.replay.input, global.frames, desync_check);
@@ -939,17 +965,87 @@ static void stage_replay_sync(StageFrameState *fstate) {
 	}
 
 	if(rpsync == REPLAY_SYNC_FAIL) {
-		if(
-			global.is_replay_verification &&
-			!global.replay.output.stage
-		) {
-			exit(1);
-		}
+		stage_replay_desynced(fstate);
+	}
+}
 
-		if(fstate->quicksave && fstate->quicksave == global.replay.input.replay) {
-			log_warn("Quicksave replay desynced; resuming prematurely!");
-			leave_replay_mode(fstate, &global.replay.input);
-		}
+static void digest_mix(uint64_t *digest, uint64_t val) {
+	*digest ^= val;
+	splitmix64(digest);
+}
+
+static void digest_mix_list(uint64_t *digest, void *anchor) {
+	uint64_t n = 0;
+
+	for(List *l = ((ListAnchor*)anchor)->first; l; l = l->next) {
+		++n;
+	}
+
+	digest_mix(digest, n);
+}
+
+static uint64_t stage_state_digest(void) {
+	// NOTE: must not have any side effects on the game state (e.g. by advancing the RNG)
+	// NOTE: only include state that evolves the same way whether or not frames are rendered.
+	// Render frames are dropped while skipping, under frameskip and in headless verification, and
+	// some tasks only advance on draw events (e.g. bomb backgrounds), so e.g. the number of
+	// running tasks is not fit for this.
+
+	uint64_t digest = global.frames;
+	Player *plr = &global.plr;
+
+	for(uint i = 0; i < ARRAY_SIZE(global.rand_game.state); ++i) {
+		digest_mix(&digest, global.rand_game.state[i]);
+	}
+
+	digest_mix(&digest, plr->points);
+	digest_mix(&digest, plr->lives);
+	digest_mix(&digest, plr->bombs);
+	digest_mix(&digest, plr->power_stored);
+	digest_mix(&digest, plr->voltage);
+	digest_mix(&digest, plr->graze);
+	digest_mix(&digest, UNION_CAST(double, uint64_t, re(plr->pos)));
+	digest_mix(&digest, UNION_CAST(double, uint64_t, im(plr->pos)));
+
+	if(global.boss) {
+		digest_mix(&digest, UNION_CAST(double, uint64_t, re(global.boss->pos)));
+		digest_mix(&digest, UNION_CAST(double, uint64_t, im(global.boss->pos)));
+	}
+
+	digest_mix_list(&digest, &global.projs);
+	digest_mix_list(&digest, &global.items);
+	digest_mix_list(&digest, &global.enemies);
+	digest_mix_list(&digest, &global.lasers);
+
+	return digest;
+}
+
+// Keyframes don't allow restoring the game state (coroutine stacks can't be captured), but
+// they pinpoint desyncs much more reliably than the 16-bit EV_CHECK_DESYNC hashes.
+static void stage_replay_keyframe(StageFrameState *fstate) {
+	ReplayState *rp_in = &global.replay.input;
+	ReplayStage *rstg_out = global.replay.output.stage;
+
+	bool record = (
+		rstg_out &&
+		fstate->keyframe_freq > 0 &&
+		!(global.frames % fstate->keyframe_freq)
+	);
+
+	bool verify = rp_in->stage && replay_state_is_keyframe(rp_in, global.frames);
+
+	if(!record && !verify) {
+		return;
+	}
+
+	uint64_t digest = stage_state_digest();
+
+	if(record) {
+		replay_stage_keyframe(rstg_out, global.frames, digest);
+	}
+
+	if(verify && replay_state_check_keyframe(rp_in, global.frames, digest) == REPLAY_SYNC_FAIL) {
+		stage_replay_desynced(fstate);
 	}
 }
 
@@ -963,6 +1059,10 @@ static LogicFrameAction stage_logic_frame(void *arg) {
 		global.gameover = GAMEOVER_ABORT;
 	}
 
+	if(replay_benchmark_frame_limit_reached()) {
+		global.gameover = GAMEOVER_ABORT;
+	}
+
 	if(stage_is_skip_mode()) {
 		global.plr.iddqd = true;
 	}
@@ -983,12 +1083,16 @@ static LogicFrameAction stage_logic_frame(void *arg) {
 		// Usually stage_comain will do this
 		events_poll(NULL, 0);
 	} else {
-		cosched_run_tasks(&fstate->sched);
+		replay_benchmark_frame_begin();
+		PROFILE_ZONE(cosched_run_tasks, cosched_run_tasks(&fstate->sched));
+		replay_benchmark_frame_end(&fstate->sched);
 		update_all_sfx();
 		stage_replay_sync(fstate);
 
 		global.frames++;
 
+		stage_replay_keyframe(fstate);
+
 		/*
 		 * TODO: Investigate why/if any of this needs to happen after global.frames++,
 		 *       and possibly fix that.
@@ -1073,6 +1177,7 @@ static RenderFrameAction stage_render_frame(void *arg) {
 		return RFRAME_DROP;
 	}
 
+	replay_benchmark_draw_begin();
 	rng_lock(&global.rand_game);
 	rng_make_active(&global.rand_visual);
 	BEGIN_DRAW_CODE();
@@ -1081,6 +1186,7 @@ static RenderFrameAction stage_render_frame(void *arg) {
 	rng_unlock(&global.rand_game);
 	rng_make_active(&global.rand_game);
 	draw_transition();
+	replay_benchmark_draw_end();
 
 	return RFRAME_SWAP;
 }
@@ -1115,10 +1221,10 @@ TASK(stage_comain, { StageFrameState *fstate; }) {
 		process_input(fstate);
 		process_boss(&global.boss);
 		process_enemies(&global.enemies);
-		process_projectiles(&global.projs, true);
-		process_items();
-		process_lasers();
-		process_projectiles(&global.particles, false);
+		PROFILE_ZONE(process_projectiles, process_projectiles(&global.projs, true));
+		PROFILE_ZONE(process_items, process_items());
+		PROFILE_ZONE(process_lasers, process_lasers());
+		PROFILE_ZONE(process_particles, process_projectiles(&global.particles, false));
 
 		if(global.dialog) {
 			dialog_update(global.dialog);
@@ -1187,6 +1293,7 @@ static void _stage_enter(
 	stage_preload(stage, rg);
 	stage_draw_init();
 	lasers_init();
+	collision_grid_init();
 
 	rng_make_active(&global.rand_game);
 	stage_start(stage);
@@ -1207,7 +1314,8 @@ static void _stage_enter(
 		log_debug("REPLAY_PLAY mode: %d events, stage: \"%s\"", rstg->events.num_elements, title);
 	} else {
 		start_time = (uint64_t)time(0);
-		seed = makeseed();
+		// Stage benchmarks should spawn the same things on every run
+		seed = replay_benchmark_is_active() ? 0 : makeseed();
 
 		StageProgress *p = NOT_NULL(stageinfo_get_progress(stage, global.diff, true));
 		progress_register_stage_played(p, global.plr.mode);
@@ -1243,6 +1351,7 @@ static void _stage_enter(
 		.quicksave = quickload,
 		.quicksave_is_automatic = quicksave_is_automatic,
 		.desync_check_freq = env_get("TAISEI_REPLAY_DESYNC_CHECK_FREQUENCY", FPS * 5),
+		.keyframe_freq = env_get("TAISEI_REPLAY_KEYFRAME_FREQUENCY", FPS * 5),
 		.dynstage_generation = dynstage_generation,
 		.rg = rg,
 	});
@@ -1355,6 +1464,33 @@ float stage_get_view_shake_strength(void) {
 	return 0;
 }
 
+void stage_replay_seek(int frame) {
+	ReplayState *rp_in = &global.replay.input;
+	assert(rp_in->mode == REPLAY_PLAY);
+
+	ReplayStage *rstg = NOT_NULL(rp_in->stage);
+	ReplayEvent *last_event = dynarray_get_ptr(&rstg->events, rstg->events.num_elements - 1);
+	int last_frame = max(0, (int)last_event->frame - FADE_TIME);
+
+	if(frame > global.frames) {
+		// Don't skip past the end, but don't turn a seek forward near the end into a rewind either.
+		frame = max(global.frames, min(frame, last_frame));
+	} else {
+		frame = max(0, frame);
+	}
+
+	if(frame < global.frames) {
+		// Can't go back in time; replay the stage from the start instead.
+		rp_in->play.seek_frame = frame;
+		global.gameover = GAMEOVER_RESTART;
+		log_info("Seeking back to frame %i", frame);
+	} else if(frame > global.frames) {
+		rp_in->play.skip_frames = frame - global.frames;
+		audio_sfx_set_enabled(false);
+		log_info("Seeking forward to frame %i", frame);
+	}
+}
+
 void stage_load_quicksave(void) {
 	stage_do_quickload(NOT_NULL(_current_stage_state));
 }
@@ -61,6 +61,11 @@ float stage_get_view_shake_strength(void);
 
 void stage_load_quicksave(void);
 
+// Fast-forward replay playback to the given frame. Seeking backwards restarts the stage.
+// NOTE: this always re-simulates; keyframes only verify the state, they can't restore it, since
+// the stage's coroutine stacks can't be captured.
+void stage_replay_seek(int frame);
+
 CoSched *stage_get_sched(void);
 
 bool stage_is_demo_mode(void);
@@ -8,6 +8,7 @@
 
 #include "stagedraw.h"
 
+#include "coroutine/cotask.h"
 #include "entity.h"
 #include "events.h"
 #include "global.h"
@@ -400,8 +401,8 @@ static void stage_draw_collision_areas(void) {
 	}
 
 	r_shader("sprite_filled_circle");
-	r_uniform_vec4("color_inner", 0, 0, 0, 1);
-	r_uniform_vec4("color_outer", 1, 1, 1, 0.1);
+	r_uniform_vec4(R_UNIFORM("color_inner"), 0, 0, 0, 1);
+	r_uniform_vec4(R_UNIFORM("color_outer"), 1, 1, 1, 0.1);
 
 	for(Projectile *p = global.projs.first; p; p = p->next) {
 		cmplx gsize = projectile_graze_size(p);
@@ -419,8 +420,8 @@ static void stage_draw_collision_areas(void) {
 	}
 
 	r_flush_sprites();
-	r_uniform_vec4("color_inner", 0.0, 1.0, 0.0, 0.75);
-	r_uniform_vec4("color_outer", 0.0, 0.5, 0.5, 0.75);
+	r_uniform_vec4(R_UNIFORM("color_inner"), 0.0, 1.0, 0.0, 0.75);
+	r_uniform_vec4(R_UNIFORM("color_outer"), 0.0, 0.5, 0.5, 0.75);
 
 	for(Projectile *p = global.projs.first; p; p = p->next) {
 		r_draw_sprite(&(SpriteParams) {
@@ -507,12 +508,12 @@ static void draw_wall_of_text(float f, const char *txt) {
 	r_texture_get_size(spr.tex, 0, &tw, &th);
 
 	r_shader("spellcard_walloftext");
-	r_uniform_float("w", spr.tex_area.w);
-	r_uniform_float("h", spr.tex_area.h);
-	r_uniform_float("ratio", h/w);
-	r_uniform_vec2("origin", re(global.boss->pos)/h, im(global.boss->pos)/w); // what the fuck?
-	r_uniform_float("t", f);
-	r_uniform_sampler("tex", spr.tex);
+	r_uniform_float(R_UNIFORM("w"), spr.tex_area.w);
+	r_uniform_float(R_UNIFORM("h"), spr.tex_area.h);
+	r_uniform_float(R_UNIFORM("ratio"), h/w);
+	r_uniform_vec2(R_UNIFORM("origin"), re(global.boss->pos)/h, im(global.boss->pos)/w); // what the fuck?
+	r_uniform_float(R_UNIFORM("t"), f);
+	r_uniform_sampler(R_UNIFORM("tex"), spr.tex);
 	r_draw_quad();
 	r_shader_standard();
 
@@ -577,8 +578,8 @@ static bool fxaa_rule(Framebuffer *fb) {
 	Texture *tex = r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_COLOR0);
 	uint w, h;
 	r_texture_get_size(tex, 0, &w, &h);
-	r_uniform_vec2("tex_size", w, h);
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_vec2(R_UNIFORM("tex_size"), w, h);
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 	r_state_pop();
 
@@ -636,24 +637,24 @@ static bool draw_powersurge_effect(Framebuffer *target_fb, BlendMode blend) {
 	// TODO: Add heuristic to not run the effect if the buffer can be reasonably assumed to be empty.
 
 	r_shader("powersurge_feedback");
-	r_uniform_vec2("blur_resolution", 0.5*VIEWPORT_W, 0.5*VIEWPORT_H);
+	r_uniform_vec2(R_UNIFORM("blur_resolution"), 0.5*VIEWPORT_W, 0.5*VIEWPORT_H);
 
 	r_framebuffer(stagedraw.powersurge_fbpair.back);
-	r_uniform_vec2("blur_direction", 1, 0);
-	r_uniform_vec4("fade", 1, 1, 1, 1);
+	r_uniform_vec2(R_UNIFORM("blur_direction"), 1, 0);
+	r_uniform_vec4(R_UNIFORM("fade"), 1, 1, 1, 1);
 	draw_framebuffer_tex(stagedraw.powersurge_fbpair.front, VIEWPORT_W, VIEWPORT_H);
 	fbpair_swap(&stagedraw.powersurge_fbpair);
 
 	r_framebuffer(stagedraw.powersurge_fbpair.back);
-	r_uniform_vec2("blur_direction", 0, 1);
-	r_uniform_vec4("fade", 0.9, 0.9, 0.9, 0.9);
+	r_uniform_vec2(R_UNIFORM("blur_direction"), 0, 1);
+	r_uniform_vec4(R_UNIFORM("fade"), 0.9, 0.9, 0.9, 0.9);
 	draw_framebuffer_tex(stagedraw.powersurge_fbpair.front, VIEWPORT_W, VIEWPORT_H);
 
 	r_framebuffer(target_fb);
 	r_shader("powersurge_effect");
-	r_uniform_sampler("shotlayer", r_framebuffer_get_attachment(stagedraw.powersurge_fbpair.back, FRAMEBUFFER_ATTACH_COLOR0));
-	r_uniform_sampler("flowlayer", "powersurge_flow");
-	r_uniform_float("time", global.frames/60.0);
+	r_uniform_sampler(R_UNIFORM("shotlayer"), r_framebuffer_get_attachment(stagedraw.powersurge_fbpair.back, FRAMEBUFFER_ATTACH_COLOR0));
+	r_uniform_sampler(R_UNIFORM("flowlayer"), "powersurge_flow");
+	r_uniform_float(R_UNIFORM("time"), global.frames/60.0);
 	r_blend(blend);
 	r_cull(CULL_BACK);
 	r_mat_mv_push();
@@ -682,12 +683,12 @@ static bool boss_distortion_rule(Framebuffer *fb) {
 	cmplx pos = fpos;
 
 	r_shader("boss_zoom");
-	r_uniform_vec2("blur_orig", re(pos)  / VIEWPORT_W,  im(pos)  / VIEWPORT_H);
-	r_uniform_vec2("fix_orig",  re(fpos) / VIEWPORT_W,  im(fpos) / VIEWPORT_H);
-	r_uniform_float("blur_rad", 1.5*(0.2+0.025*sin(global.frames/15.0)));
-	r_uniform_float("rad", 0.24);
-	r_uniform_float("ratio", (float)VIEWPORT_H/VIEWPORT_W);
-	r_uniform_vec4_rgba("color", &global.boss->zoomcolor);
+	r_uniform_vec2(R_UNIFORM("blur_orig"), re(pos)  / VIEWPORT_W,  im(pos)  / VIEWPORT_H);
+	r_uniform_vec2(R_UNIFORM("fix_orig"),  re(fpos) / VIEWPORT_W,  im(fpos) / VIEWPORT_H);
+	r_uniform_float(R_UNIFORM("blur_rad"), 1.5*(0.2+0.025*sin(global.frames/15.0)));
+	r_uniform_float(R_UNIFORM("rad"), 0.24);
+	r_uniform_float(R_UNIFORM("ratio"), (float)VIEWPORT_H/VIEWPORT_W);
+	r_uniform_vec4_rgba(R_UNIFORM("color"), &global.boss->zoomcolor);
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 
 	r_state_pop();
@@ -777,17 +778,17 @@ static void apply_bg_shaders(ShaderRule *shaderrules, FBPair *fbos) {
 
 			if(trans_intro) {
 				r_shader("spellcard_intro");
-				r_uniform_float("ratio", ratio);
-				r_uniform_vec2("origin", re(pos) / VIEWPORT_W, im(pos) / VIEWPORT_H);
-				r_uniform_float("t", SPELL_INTRO_TIME_FACTOR * (t + delay) / (float)SPELL_INTRO_DURATION);
+				r_uniform_float(R_UNIFORM("ratio"), ratio);
+				r_uniform_vec2(R_UNIFORM("origin"), re(pos) / VIEWPORT_W, im(pos) / VIEWPORT_H);
+				r_uniform_float(R_UNIFORM("t"), SPELL_INTRO_TIME_FACTOR * (t + delay) / (float)SPELL_INTRO_DURATION);
 			} else {
 				int tn = global.frames - b->current->endtime;
 				delay = b->current->endtime - b->current->endtime_undelayed;
 
 				r_shader("spellcard_outro");
-				r_uniform_float("ratio", ratio);
-				r_uniform_vec2("origin", re(pos) / VIEWPORT_W, im(pos) / VIEWPORT_H);
-				r_uniform_float("t", max(0, tn / (float)delay + 1));
+				r_uniform_float(R_UNIFORM("ratio"), ratio);
+				r_uniform_vec2(R_UNIFORM("origin"), re(pos) / VIEWPORT_W, im(pos) / VIEWPORT_H);
+				r_uniform_float(R_UNIFORM("t"), max(0, tn / (float)delay + 1));
 			}
 
 			r_blend(BLEND_PREMUL_ALPHA);
@@ -898,9 +899,9 @@ void stage_draw_overlay(void) {
 }
 
 static void postprocess_prepare(Framebuffer *fb, ShaderProgram *s, void *arg) {
-	r_uniform_int("frames", global.frames);
-	r_uniform_vec2("viewport", VIEWPORT_W, VIEWPORT_H);
-	r_uniform_vec2("player", re(global.plr.pos), VIEWPORT_H - im(global.plr.pos));
+	r_uniform_int(R_UNIFORM("frames"), global.frames);
+	r_uniform_vec2(R_UNIFORM("viewport"), VIEWPORT_W, VIEWPORT_H);
+	r_uniform_vec2(R_UNIFORM("player"), re(global.plr.pos), VIEWPORT_H - im(global.plr.pos));
 }
 
 static inline void begin_viewport_shake(void) {
@@ -967,7 +968,7 @@ void stage_draw_end_noshake(void) {
 void stage_draw_viewport(void) {
 	FloatRect dest_vp;
 	r_framebuffer_viewport_current(r_framebuffer_current(), &dest_vp);
-	r_uniform_sampler("tex", r_framebuffer_get_attachment(stagedraw.fb_pairs[FBPAIR_FG].front, FRAMEBUFFER_ATTACH_COLOR0));
+	r_uniform_sampler(R_UNIFORM("tex"), r_framebuffer_get_attachment(stagedraw.fb_pairs[FBPAIR_FG].front, FRAMEBUFFER_ATTACH_COLOR0));
 
 	// CAUTION: Very intricate pixel perfect scaling that will ruin your day.
 	float facw = dest_vp.w / SCREEN_W;
@@ -1233,6 +1234,30 @@ static void stage_draw_hud_objpool_stats(float x, float y, float width) {
 		y += lineskip;
 	}
 
+	y += lineskip * 0.5;
+
+	for(CoStackClass c = 0; c < CO_NUM_STACK_CLASSES; ++c) {
+		CoTaskPoolStats s = cotask_get_pool_stats(c);
+		char name[32];
+
+		snprintf(name, sizeof(name), "CoTask %zukb", s.stack_size / 1024);
+		snprintf(buf, sizeof(buf), "%u | %7u", s.num_used, s.num_allocated);
+
+		text_draw(name, &(TextParams) {
+			.pos = { x, y },
+			.font_ptr = font,
+			.align = ALIGN_LEFT,
+		});
+
+		text_draw(buf, &(TextParams) {
+			.pos = { x + width, y },
+			.font_ptr = font,
+			.align = ALIGN_RIGHT,
+		});
+
+		y += lineskip;
+	}
+
 	r_shader_ptr(sh_prev);
 }
 
@@ -1591,10 +1616,10 @@ void stage_draw_bottom_text(void) {
 		});
 
 		r_shader("graph");
-		r_uniform_vec3("color_low",  1.0, 0.0, 0.0);
-		r_uniform_vec3("color_mid",  1.0, 1.0, 0.0);
-		r_uniform_vec3("color_high", 0.0, 1.0, 0.0);
-		r_uniform_float_array("points", 0, graphspan, graph);
+		r_uniform_vec3(R_UNIFORM("color_low"),  1.0, 0.0, 0.0);
+		r_uniform_vec3(R_UNIFORM("color_mid"),  1.0, 1.0, 0.0);
+		r_uniform_vec3(R_UNIFORM("color_high"), 0.0, 1.0, 0.0);
+		r_uniform_float_array(R_UNIFORM("points"), 0, graphspan, graph);
 		draw_graph(142, SCREEN_H - text_h, graphspan, text_h);
 	}
 #endif
@@ -1620,20 +1645,20 @@ static void stage_draw_framerate_graphs(float x, float y, float w, float h) {
 	r_shader("graph");
 
 	fill_graph(NUM_SAMPLES, samples, &global.fps.logic);
-	r_uniform_vec3("color_low",  0.0, 1.0, 1.0);
-	r_uniform_vec3("color_mid",  1.0, 1.0, 0.0);
-	r_uniform_vec3("color_high", 1.0, 0.0, 0.0);
-	r_uniform_float_array("points", 0, NUM_SAMPLES, samples);
+	r_uniform_vec3(R_UNIFORM("color_low"),  0.0, 1.0, 1.0);
+	r_uniform_vec3(R_UNIFORM("color_mid"),  1.0, 1.0, 0.0);
+	r_uniform_vec3(R_UNIFORM("color_high"), 1.0, 0.0, 0.0);
+	r_uniform_float_array(R_UNIFORM("points"), 0, NUM_SAMPLES, samples);
 	draw_graph(x, y, w, h);
 
 	// x -= w * 1.1;
 	y += h + 1;
 
 	fill_graph(NUM_SAMPLES, samples, &global.fps.busy);
-	r_uniform_vec3("color_low",  0.0, 1.0, 0.0);
-	r_uniform_vec3("color_mid",  1.0, 0.0, 0.0);
-	r_uniform_vec3("color_high", 1.0, 0.0, 0.5);
-	r_uniform_float_array("points", 0, NUM_SAMPLES, samples);
+	r_uniform_vec3(R_UNIFORM("color_low"),  0.0, 1.0, 0.0);
+	r_uniform_vec3(R_UNIFORM("color_mid"),  1.0, 0.0, 0.0);
+	r_uniform_vec3(R_UNIFORM("color_high"), 1.0, 0.0, 0.5);
+	r_uniform_float_array(R_UNIFORM("points"), 0, NUM_SAMPLES, samples);
 	draw_graph(x, y, w, h);
 
 	r_state_pop();
@@ -1645,7 +1670,7 @@ void stage_draw_hud(void) {
 	r_mat_mv_translate(SCREEN_W * 0.5, SCREEN_H * 0.5, 0);
 	r_mat_mv_scale(SCREEN_W, SCREEN_W, 1);
 	r_shader_standard();
-	r_uniform_sampler("tex", "hud");
+	r_uniform_sampler(R_UNIFORM("tex"), "hud");
 	r_draw_model("hud");
 	r_mat_mv_pop();
 
@@ -128,6 +128,11 @@ static void stageinfo_fill(StagesExports *e) {
 	add_stage(0x40|0, e->testing.dps_single, STAGE_SPECIAL, (StageTitle){.title = "DPS Test"}, "Single target",    NULL, D_Normal);
 	add_stage(0x40|1, e->testing.dps_multi,  STAGE_SPECIAL, (StageTitle){.title = "DPS Test"}, "Multiple targets", NULL, D_Normal);
 	add_stage(0x40|2, e->testing.dps_boss,   STAGE_SPECIAL, (StageTitle){.title = "DPS Test"}, "Boss",             NULL, D_Normal);
+	add_stage(0x40|3, e->testing.stress_projectiles, STAGE_SPECIAL, (StageTitle){.title = "Stress Test"}, "Projectiles", NULL, D_Normal);
+	add_stage(0x40|4, e->testing.stress_lasers,      STAGE_SPECIAL, (StageTitle){.title = "Stress Test"}, "Lasers",      NULL, D_Normal);
+	add_stage(0x40|5, e->testing.stress_items,       STAGE_SPECIAL, (StageTitle){.title = "Stress Test"}, "Items",       NULL, D_Normal);
+	add_stage(0x40|6, e->testing.stress_enemies,     STAGE_SPECIAL, (StageTitle){.title = "Stress Test"}, "Enemies",     NULL, D_Normal);
+	add_stage(0x40|7, e->testing.stress_tasks,       STAGE_SPECIAL, (StageTitle){.title = "Stress Test"}, "Coroutines",  NULL, D_Normal);
 #endif
 
 	// generate spellpractice stages
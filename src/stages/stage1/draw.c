@@ -91,7 +91,7 @@ static void stage1_horizon_draw(vec3 pos) {
 	r_mat_mv_scale(3640 * 1.4, 1456 * 1.4, 1);
 	r_mat_mv_translate(0, -0.5, 0);
 	r_shader_standard();
-	r_uniform_sampler("tex", "stage1/horizon");
+	r_uniform_sampler(R_UNIFORM("tex"), "stage1/horizon");
 	r_draw_quad();
 	r_mat_mv_pop();
 	r_state_pop();
@@ -118,10 +118,10 @@ static void stage1_water_render_reflections(void) {
 
 static void stage1_water_render_waves(float pos) {
 	r_shader_ptr(stage1_draw_data->water_shader);
-	r_uniform_float("time", 0.5f * global.frames / (float)FPS);
-	r_uniform_vec4_rgba("water_color", &water_color);
-	r_uniform_vec2("wave_offset", 0, pos / 2400.0f);
-	r_uniform_sampler("water_noisetex", "fractal_noise");
+	r_uniform_float(R_UNIFORM("time"), 0.5f * global.frames / (float)FPS);
+	r_uniform_vec4_rgba(R_UNIFORM("water_color"), &water_color);
+	r_uniform_vec2(R_UNIFORM("wave_offset"), 0, pos / 2400.0f);
+	r_uniform_sampler(R_UNIFORM("water_noisetex"), "fractal_noise");
 	r_mat_mv_push();
 	r_mat_mv_scale(VIEWPORT_W, VIEWPORT_H, 1);
 	r_mat_mv_scale(0.01, 0.01, 1);
@@ -215,12 +215,12 @@ static bool stage1_fog(Framebuffer *fb) {
 	Stage1DrawData *draw_data = stage1_get_draw_data();
 
 	r_shader("zbuf_fog");
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
-	r_uniform_vec4("fog_color", 0.78, 0.8, 0.85, 1.0);
-	r_uniform_float("start", draw_data->fog.near);
-	r_uniform_float("end", draw_data->fog.far);
-	r_uniform_float("exponent", 1.0);
-	r_uniform_float("curvature", 0.2);
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_vec4(R_UNIFORM("fog_color"), 0.78, 0.8, 0.85, 1.0);
+	r_uniform_float(R_UNIFORM("start"), draw_data->fog.near);
+	r_uniform_float(R_UNIFORM("end"), draw_data->fog.far);
+	r_uniform_float(R_UNIFORM("exponent"), 1.0);
+	r_uniform_float(R_UNIFORM("curvature"), 0.2);
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 	r_shader_standard();
 
@@ -260,14 +260,14 @@ static void stage2_bg_water_draw(vec3 pos) {
 	r_state_push();
 
 	r_shader("pbr_water");
-	r_uniform_float("time", 0.2 * global.frames / (float)FPS);
-	r_uniform_float("wave_height", 0.06);
-	r_uniform_float("wave_scale", 16);
-	r_uniform_vec2("wave_offset", pos[0]/WATER_SIZE, pos[1]/WATER_SIZE);
-	r_uniform_float("water_depth", 5.0);
-	r_uniform_sampler("water_noisetex", "fractal_noise");
-	r_uniform_vec3("water_color", 0.1, 0.2, 0.3);
-	r_uniform_vec3("wave_highlight_color", 0.1, 0.1, 0.1);
+	r_uniform_float(R_UNIFORM("time"), 0.2 * global.frames / (float)FPS);
+	r_uniform_float(R_UNIFORM("wave_height"), 0.06);
+	r_uniform_float(R_UNIFORM("wave_scale"), 16);
+	r_uniform_vec2(R_UNIFORM("wave_offset"), pos[0]/WATER_SIZE, pos[1]/WATER_SIZE);
+	r_uniform_float(R_UNIFORM("water_depth"), 5.0);
+	r_uniform_sampler(R_UNIFORM("water_noisetex"), "fractal_noise");
+	r_uniform_vec3(R_UNIFORM("water_color"), 0.1, 0.2, 0.3);
+	r_uniform_vec3(R_UNIFORM("wave_highlight_color"), 0.1, 0.1, 0.1);
 
 	PBREnvironment env = {};
 	stage2_bg_setup_pbr_env(&stage_3d_context.cam, STAGE2_MAX_LIGHTS, &env);
@@ -277,11 +277,11 @@ static void stage2_bg_water_draw(vec3 pos) {
 	r_mat_mv_scale(-WATER_SIZE, WATER_SIZE, 1);
 
 	bool have_bottom = config_get_int(CONFIG_POSTPROCESS) > 1;
-	r_uniform_int("water_has_bottom_layer", have_bottom);
+	r_uniform_int(R_UNIFORM("water_has_bottom_layer"), have_bottom);
 	if(have_bottom) {
 		mat4 imv;
 		glm_mat4_inv_fast(*r_mat_mv_current_ptr(), imv);
-		r_uniform_mat4("inverse_modelview", imv);
+		r_uniform_mat4(R_UNIFORM("inverse_modelview"), imv);
 	}
 
 	r_mat_tex_push();
@@ -333,16 +333,16 @@ static uint stage2_bg_branch_pos(Stage3D *s3d, vec3 cam, float maxrange) {
 static bool stage2_fog(Framebuffer *fb) {
 	Stage2DrawData *dd = stage2_get_draw_data();
 	r_shader("zbuf_fog_tonemap");
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
-	r_uniform_vec4_rgba("fog_color", &dd->fog.color);
-	r_uniform_float("start", 0.0);
-	r_uniform_float("end", dd->fog.end);
-	r_uniform_float("exponent", 24.0);
-	r_uniform_float("curvature", 0);
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_vec4_rgba(R_UNIFORM("fog_color"), &dd->fog.color);
+	r_uniform_float(R_UNIFORM("start"), 0.0);
+	r_uniform_float(R_UNIFORM("end"), dd->fog.end);
+	r_uniform_float(R_UNIFORM("exponent"), 24.0);
+	r_uniform_float(R_UNIFORM("curvature"), 0);
 
 	vec3 exp = { 0.9f, 0.95f, 1.0f };
 	glm_vec3_scale(exp, 0.7, exp);
-	r_uniform_vec3_vec("exposure", exp);
+	r_uniform_vec3_vec(R_UNIFORM("exposure"), exp);
 
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 	r_shader_standard();
@@ -404,18 +404,18 @@ static void stage3d_hinalights_draw(vec3 pos) {
 	const Model *quad = r_model_get_quad();
 	Sprite *spr = res_sprite("part/stain");
 	r_shader("fireparticles");
-	r_uniform_sampler("sprite_tex", spr->tex);
-	r_uniform_vec3("color_base", 1, 0, 0);
-	r_uniform_vec3("color_nstate", 0, 0, 1);
-	r_uniform_vec3("color_nstate2", 0, 0.2, 1);
-	r_uniform_vec4("tint", 1, 1, 1, 0);
-	r_uniform_vec4("sprite_tex_region",
+	r_uniform_sampler(R_UNIFORM("sprite_tex"), spr->tex);
+	r_uniform_vec3(R_UNIFORM("color_base"), 1, 0, 0);
+	r_uniform_vec3(R_UNIFORM("color_nstate"), 0, 0, 1);
+	r_uniform_vec3(R_UNIFORM("color_nstate2"), 0, 0.2, 1);
+	r_uniform_vec4(R_UNIFORM("tint"), 1, 1, 1, 0);
+	r_uniform_vec4(R_UNIFORM("sprite_tex_region"),
 		spr->tex_area.x,
 		spr->tex_area.y,
 		spr->tex_area.w,
 		spr->tex_area.h
 	);
-	r_uniform_float("time", global.frames / 120.0f);
+	r_uniform_float(R_UNIFORM("time"), global.frames / 120.0f);
 
 	Camera3D *cam = &stage_3d_context.cam;
 	PointLight3D lights[NUM_HINA_LIGHTS];
@@ -426,7 +426,7 @@ static void stage3d_hinalights_draw(vec3 pos) {
 	for(int i = 0; i < nlights; ++i) {
 		float s0 = splitmix32(&seed) / (double)UINT32_MAX;
 		float s1 = splitmix32(&seed) / (double)UINT32_MAX;
-		r_uniform_vec2("seed", s0, s1);
+		r_uniform_vec2(R_UNIFORM("seed"), s0, s1);
 
 		PointLight3D *l = lights + i;
 
@@ -8,7 +8,7 @@
 
 #include "spells.h"
 
-TASK(spinner_bullet_redirect, { BoxedProjectile p; MoveParams move; }) {
+TASK_SMALL_STACK(spinner_bullet_redirect, { BoxedProjectile p; MoveParams move; }) {
 	Projectile *p = TASK_BIND(ARGS.p);
 	cmplx ov = p->move.velocity;
 	p->move = ARGS.move;
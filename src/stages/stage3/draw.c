@@ -121,14 +121,14 @@ void stage3_drawsys_shutdown(void) {
 static bool stage3_fog(Framebuffer *fb) {
 	Stage3DrawData *dd = stage3_get_draw_data();
 	r_shader("zbuf_fog_tonemap");
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
-	r_uniform_vec4_vec("fog_color", dd->fog_color);
-	r_uniform_float("start", 0.9);
-	r_uniform_float("end", 2);
-	r_uniform_float("exponent", 1);
-	r_uniform_float("curvature", 0);
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_vec4_vec(R_UNIFORM("fog_color"), dd->fog_color);
+	r_uniform_float(R_UNIFORM("start"), 0.9);
+	r_uniform_float(R_UNIFORM("end"), 2);
+	r_uniform_float(R_UNIFORM("exponent"), 1);
+	r_uniform_float(R_UNIFORM("curvature"), 0);
 	float e = 1;
-	r_uniform_vec3("exposure", e, e, e);
+	r_uniform_vec3(R_UNIFORM("exposure"), e, e, e);
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 	r_shader_standard();
 	return true;
@@ -145,8 +145,8 @@ static bool stage3_glitch(Framebuffer *fb) {
 
 	if(strength > 0) {
 		r_shader("glitch");
-		r_uniform_float("strength", strength);
-		r_uniform_float("frames", global.frames + 15 * rng_sreal());
+		r_uniform_float(R_UNIFORM("strength"), strength);
+		r_uniform_float(R_UNIFORM("frames"), global.frames + 15 * rng_sreal());
 	} else {
 		return false;
 	}
@@ -30,13 +30,13 @@ static bool stage4_fog(Framebuffer *fb) {
 	Color c = *RGBA(0.05, 0.0, 0.01, 1.0);
 
 	r_shader("zbuf_fog_tonemap");
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
-	r_uniform_vec4_rgba("fog_color", &c);
-	r_uniform_float("start", 0.4);
-	r_uniform_float("end", 1);
-	r_uniform_float("exponent", 20.0);
-	r_uniform_float("curvature", 0);
-	r_uniform_vec3("exposure", 1, 1, 1);
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_vec4_rgba(R_UNIFORM("fog_color"), &c);
+	r_uniform_float(R_UNIFORM("start"), 0.4);
+	r_uniform_float(R_UNIFORM("end"), 1);
+	r_uniform_float(R_UNIFORM("exponent"), 20.0);
+	r_uniform_float(R_UNIFORM("curvature"), 0);
+	r_uniform_vec3(R_UNIFORM("exposure"), 1, 1, 1);
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 
 	r_state_pop();
@@ -66,12 +66,12 @@ static bool stage4_water(Framebuffer *fb) {
 
 	r_mat_mv_scale(15, -10, 1);
 	r_shader("ssr_water");
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
-	r_uniform_sampler("tex", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_COLOR0));
-	r_uniform_float("time", global.frames * 0.002);
-	r_uniform_vec2("wave_offset", -global.frames * 0.0005, 0);
-	r_uniform_float("wave_height", 0.005);
-	r_uniform_sampler("water_noisetex", "fractal_noise");
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_sampler(R_UNIFORM("tex"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_COLOR0));
+	r_uniform_float(R_UNIFORM("time"), global.frames * 0.002);
+	r_uniform_vec2(R_UNIFORM("wave_offset"), -global.frames * 0.0005, 0);
+	r_uniform_float(R_UNIFORM("wave_height"), 0.005);
+	r_uniform_sampler(R_UNIFORM("water_noisetex"), "fractal_noise");
 	r_color4(0.8, 0.9, 1.0, 1);
 	r_mat_tex_push();
 	r_mat_tex_scale(3, 3, 3);
@@ -110,7 +110,7 @@ static bool stage4_water_composite(Framebuffer *reflections) {
 	r_blend(BLEND_NONE);
 
 	r_shader("alpha_discard");
-	r_uniform_float("threshold", 1);
+	r_uniform_float(R_UNIFORM("threshold"), 1);
 	draw_framebuffer_tex(reflections, VIEWPORT_W, VIEWPORT_H);
 
 	r_state_pop();
@@ -269,25 +269,25 @@ static void stage4_flames_draw(vec3 pos) {
 	const Model *quad = r_model_get_quad();
 	Sprite *spr = res_sprite("part/stain");
 	r_shader("fireparticles");
-	r_uniform_sampler("sprite_tex", spr->tex);
-	r_uniform_vec3_vec("color_base", stage4_draw_data->corridor.torch_particles.c_base);
-	r_uniform_vec3_vec("color_nstate", stage4_draw_data->corridor.torch_particles.c_nstate);
-	r_uniform_vec3_vec("color_nstate2", stage4_draw_data->corridor.torch_particles.c_nstate2);
-	r_uniform_vec4("tint", al, al, al, al);
-	r_uniform_vec4("sprite_tex_region",
+	r_uniform_sampler(R_UNIFORM("sprite_tex"), spr->tex);
+	r_uniform_vec3_vec(R_UNIFORM("color_base"), stage4_draw_data->corridor.torch_particles.c_base);
+	r_uniform_vec3_vec(R_UNIFORM("color_nstate"), stage4_draw_data->corridor.torch_particles.c_nstate);
+	r_uniform_vec3_vec(R_UNIFORM("color_nstate2"), stage4_draw_data->corridor.torch_particles.c_nstate2);
+	r_uniform_vec4(R_UNIFORM("tint"), al, al, al, al);
+	r_uniform_vec4(R_UNIFORM("sprite_tex_region"),
 		spr->tex_area.x,
 		spr->tex_area.y,
 		spr->tex_area.w,
 		spr->tex_area.h
 	);
-	r_uniform_float("time", global.frames / 120.0f);
+	r_uniform_float(R_UNIFORM("time"), global.frames / 120.0f);
 
 	vec3 ofs = LIGHT_OFS;
 	vec3 p;
 	mat4 *mv;
 
 	glm_vec3_add(pos, ofs, p);
-	r_uniform_vec2_vec("seed", p);
+	r_uniform_vec2_vec(R_UNIFORM("seed"), p);
 	r_mat_mv_push();
 	r_mat_mv_translate_v(p);
 	mv = r_mat_mv_current_ptr();
@@ -298,7 +298,7 @@ static void stage4_flames_draw(vec3 pos) {
 	ofs[0] *= -1.0f;
 
 	glm_vec3_add(pos, ofs, p);
-	r_uniform_vec2_vec("seed", p);
+	r_uniform_vec2_vec(R_UNIFORM("seed"), p);
 	r_mat_mv_push();
 	r_mat_mv_translate_v(p);
 	mv = r_mat_mv_current_ptr();
@@ -99,12 +99,12 @@ void stage5_draw(void) {
 
 static bool stage5_fog(Framebuffer *fb) {
 	r_shader("zbuf_fog");
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
-	r_uniform_vec4_rgba("fog_color", color_mul_scalar(RGB(0.3,0.1,0.8), 1.0));
-	r_uniform_float("start", 0.2);
-	r_uniform_float("end", 3.8);
-	r_uniform_float("exponent", 3.0);
-	r_uniform_float("curvature", 0);
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_vec4_rgba(R_UNIFORM("fog_color"), color_mul_scalar(RGB(0.3,0.1,0.8), 1.0));
+	r_uniform_float(R_UNIFORM("start"), 0.2);
+	r_uniform_float(R_UNIFORM("end"), 3.8);
+	r_uniform_float(R_UNIFORM("exponent"), 3.0);
+	r_uniform_float(R_UNIFORM("curvature"), 0);
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 	r_shader_standard();
 	return true;
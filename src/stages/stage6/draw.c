@@ -73,7 +73,7 @@ static void stage6_bg_setup_pbr_lighting(Camera3D *cam) {
 	};
 
 	camera3d_set_point_light_uniforms(cam, ARRAY_SIZE(lights), lights);
-	r_uniform_vec3("ambient_color", 1, 1, 1);
+	r_uniform_vec3(R_UNIFORM("ambient_color"), 1, 1, 1);
 }
 
 static void stage6_bg_setup_pbr_env(Camera3D *cam, PBREnvironment *env) {
@@ -115,7 +115,7 @@ static void stage6_towertop_draw(vec3 pos) {
 	r_shader("calabi-yau-quintic");
 	//r_mat_mv_rotate(-global.frames*0.03, 0, 0, 1);
 	r_mat_mv_rotate(global.frames*0.01, 0, 1, 0);
-	r_uniform_float("alpha", global.frames*0.03);
+	r_uniform_float(R_UNIFORM("alpha"), global.frames*0.03);
 	r_draw_model_ptr(stage6_draw_data->models.calabi_yau_quintic, 0, 0);
 	r_mat_mv_pop();
 	r_state_pop();
@@ -131,7 +131,7 @@ static void stage6_skysphere_draw(vec3 pos) {
 	r_disable(RCAP_DEPTH_TEST);
 	r_cull(CULL_FRONT);
 	r_shader("stage6_sky");
-	r_uniform_sampler("skybox", "stage6/sky");
+	r_uniform_sampler(R_UNIFORM("skybox"), "stage6/sky");
 
 	r_mat_mv_push();
 	r_mat_mv_translate_v(stage_3d_context.cam.pos);
@@ -204,12 +204,12 @@ void elly_spellbg_modern_dark(Boss *b, int t) {
 
 static bool stage6_fog(Framebuffer *fb) {
 	r_shader("zbuf_fog");
-	r_uniform_sampler("depth", r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
-	r_uniform_vec4_rgba("fog_color", RGB(0.1,0.3,0.8));
-	r_uniform_float("start", 0.2);
-	r_uniform_float("end", 5);
-	r_uniform_float("exponent", 3.0);
-	r_uniform_float("curvature", 0);
+	r_uniform_sampler(R_UNIFORM("depth"), r_framebuffer_get_attachment(fb, FRAMEBUFFER_ATTACH_DEPTH));
+	r_uniform_vec4_rgba(R_UNIFORM("fog_color"), RGB(0.1,0.3,0.8));
+	r_uniform_float(R_UNIFORM("start"), 0.2);
+	r_uniform_float(R_UNIFORM("end"), 5);
+	r_uniform_float(R_UNIFORM("exponent"), 3.0);
+	r_uniform_float(R_UNIFORM("curvature"), 0);
 	draw_framebuffer_tex(fb, VIEWPORT_W, VIEWPORT_H);
 	r_shader_standard();
 	return true;
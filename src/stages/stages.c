@@ -17,6 +17,7 @@
 
 #ifdef TAISEI_BUILDCONF_TESTING_STAGES
 #include "stages/dpstest.h"
+#include "stages/stresstest.h"
 #endif
 
 StagesExports stages_exports = {
@@ -33,6 +34,11 @@ StagesExports stages_exports = {
 		.dps_single = &stage_dpstest_single_procs,
 		.dps_multi = &stage_dpstest_multi_procs,
 		.dps_boss = &stage_dpstest_boss_procs,
+		.stress_projectiles = &stage_stresstest_projectiles_procs,
+		.stress_lasers = &stage_stresstest_lasers_procs,
+		.stress_items = &stage_stresstest_items_procs,
+		.stress_enemies = &stage_stresstest_enemies_procs,
+		.stress_tasks = &stage_stresstest_tasks_procs,
 		.benchmark_spell = &stage1_spell_benchmark,
 	}
 #endif
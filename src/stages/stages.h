@@ -20,6 +20,7 @@ typedef struct StagesExports {
 #ifdef TAISEI_BUILDCONF_TESTING_STAGES
 	struct {
 		StageProcs *dps_single, *dps_multi, *dps_boss;
+		StageProcs *stress_projectiles, *stress_lasers, *stress_items, *stress_enemies, *stress_tasks;
 		AttackInfo *benchmark_spell;
 	} testing;
 #endif
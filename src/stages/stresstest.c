@@ -0,0 +1,193 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "stresstest.h"
+
+#include "common_imports.h"
+#include "lasers/rules.h"
+
+/*
+ * Synthetic stages that hammer one engine subsystem each, at a roughly constant load.
+ * Meant to be run with --benchmark-stage, which makes the player invulnerable and stops
+ * after a fixed number of frames; they never end on their own.
+ */
+
+#define STRESS_PROJECTILES 8000
+#define STRESS_PROJ_SPEED 6
+#define STRESS_LASER_RINGS_INTERVAL 6
+#define STRESS_LASERS_PER_RING 16
+#define STRESS_ITEMS_PER_FRAME 24
+#define STRESS_ENEMIES 400
+#define STRESS_TASKS 4000
+#define STRESS_TASKS_CHURN 64
+
+static ProjDrawRule stress_draw_rule(int lane) {
+	switch(lane % 5) {
+		case 0:  return pdraw_basic();
+		case 1:  return pdraw_timeout_scalefade(0.5, 1.5, 1, 0.2);
+		case 2:  return pdraw_timeout_fade(1, 0.3);
+		case 3:  return pdraw_petal_random();
+		default: return (ProjDrawRule) { };  // default rule for the prototype
+	}
+}
+
+static void stress_projectiles(void) {
+	// Spawn just enough to keep the population around STRESS_PROJECTILES as they fall off-screen
+	int count = STRESS_PROJECTILES * STRESS_PROJ_SPEED / VIEWPORT_H;
+	ProjPrototype *protos[] = { pp_ball, pp_rice, pp_card, pp_crystal, pp_wave, pp_bigball };
+
+	for(int i = 0; i < count; ++i) {
+		int lane = rng_irange(0, 32);
+		cmplx pos = rng_range(0, VIEWPORT_W) - 20*I;
+
+		PROJECTILE(
+			.proto = protos[lane % ARRAY_SIZE(protos)],
+			.pos = pos,
+			.color = RGBA(0.2 + lane / 40.0, 0.3, 1.0 - lane / 40.0, lane % 3 ? 0 : 1),
+			.move = move_linear(STRESS_PROJ_SPEED * cdir(M_PI/2 + rng_sreal() * 0.3)),
+			.draw_rule = stress_draw_rule(lane),
+			.timeout = VIEWPORT_H / STRESS_PROJ_SPEED * 2,
+			.flags = lane % 4 ? PFLAG_NOGRAZE : 0,
+		);
+	}
+}
+
+TASK(stress_projectiles) {
+	for(;;YIELD) {
+		stress_projectiles();
+	}
+}
+
+static void stresstest_projectiles(void) {
+	INVOKE_TASK(stress_projectiles);
+}
+
+TASK(stress_lasers) {
+	cmplx origin = VIEWPORT_W/2 + VIEWPORT_H/3*I;
+
+	for(int ring = 0;; ++ring, WAIT(STRESS_LASER_RINGS_INTERVAL)) {
+		cmplx r = cdir(ring * 0.3);
+
+		for(int i = 0; i < STRESS_LASERS_PER_RING; ++i) {
+			cmplx dir = r * cdir(M_TAU / STRESS_LASERS_PER_RING * i);
+
+			if(i & 1) {
+				create_laser(origin, 40, 200, RGBA(0.3, 1.0, 0.4, 0), laser_rule_linear(3 * dir));
+			} else {
+				create_laser(origin, 40, 200, RGBA(1.0, 0.3, 0.4, 0),
+					laser_rule_sine(3 * dir, 10 * dir, 0.25, ring * 0.5));
+			}
+		}
+	}
+}
+
+static void stresstest_lasers(void) {
+	INVOKE_TASK(stress_lasers);
+}
+
+TASK(stress_items) {
+	for(;;YIELD) {
+		for(int i = 0; i < STRESS_ITEMS_PER_FRAME; ++i) {
+			cmplx pos = rng_range(0, VIEWPORT_W) + rng_range(0, VIEWPORT_H/2) * I;
+			spawn_item(pos, rng_chance(0.5) ? ITEM_POINTS : ITEM_POWER_MINI);
+		}
+	}
+}
+
+static void stresstest_items(void) {
+	INVOKE_TASK(stress_items);
+}
+
+static cmplx stress_random_point(void) {
+	return rng_range(32, VIEWPORT_W - 32) + rng_range(32, VIEWPORT_H * 0.6) * I;
+}
+
+TASK_SMALL_STACK(stress_enemy_wander, { BoxedEnemy e; }) {
+	Enemy *e = TASK_BIND(ARGS.e);
+
+	for(;;WAIT(rng_irange(30, 90))) {
+		e->move = move_towards(e->move.velocity, stress_random_point(), 0.02);
+	}
+}
+
+TASK(stress_enemy, { EnemySpawner spawner; }) {
+	Enemy *e = TASK_BIND(ARGS.spawner(stress_random_point(), ITEMS(.points = 1)));
+	e->move = move_towards(0, stress_random_point(), 0.02);
+	INVOKE_SUBTASK(stress_enemy_wander, ENT_BOX(e));
+	INVOKE_TASK_AFTER(&e->events.killed, stress_enemy, ARGS.spawner);
+	STALL;
+}
+
+static void stresstest_enemies(void) {
+	EnemySpawner spawners[] = {
+		espawn_fairy_blue,
+		espawn_fairy_red,
+		espawn_big_fairy,
+		espawn_huge_fairy,
+	};
+
+	for(int i = 0; i < STRESS_ENEMIES; ++i) {
+		INVOKE_TASK(stress_enemy, spawners[i % ARRAY_SIZE(spawners)]);
+	}
+}
+
+static uint64_t stress_task_counter;
+
+TASK_SMALL_STACK(stress_task_ephemeral) {
+	WAIT(rng_irange(1, 30));
+	++stress_task_counter;
+}
+
+TASK_SMALL_STACK(stress_task_persistent, { int period; }) {
+	for(;;WAIT(ARGS.period)) {
+		++stress_task_counter;
+	}
+}
+
+TASK(stress_task_spawner) {
+	for(;;YIELD) {
+		for(int i = 0; i < STRESS_TASKS_CHURN; ++i) {
+			INVOKE_TASK(stress_task_ephemeral);
+		}
+	}
+}
+
+static void stresstest_tasks(void) {
+	stress_task_counter = 0;
+
+	for(int i = 0; i < STRESS_TASKS; ++i) {
+		INVOKE_TASK(stress_task_persistent, 1 + i % 8);
+	}
+
+	INVOKE_TASK(stress_task_spawner);
+}
+
+StageProcs stage_stresstest_projectiles_procs = {
+	.begin = stresstest_projectiles,
+	.shader_rules = (ShaderRule[]) { NULL },
+};
+
+StageProcs stage_stresstest_lasers_procs = {
+	.begin = stresstest_lasers,
+	.shader_rules = (ShaderRule[]) { NULL },
+};
+
+StageProcs stage_stresstest_items_procs = {
+	.begin = stresstest_items,
+	.shader_rules = (ShaderRule[]) { NULL },
+};
+
+StageProcs stage_stresstest_enemies_procs = {
+	.begin = stresstest_enemies,
+	.shader_rules = (ShaderRule[]) { NULL },
+};
+
+StageProcs stage_stresstest_tasks_procs = {
+	.begin = stresstest_tasks,
+	.shader_rules = (ShaderRule[]) { NULL },
+};
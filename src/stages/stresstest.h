@@ -0,0 +1,18 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "stageinfo.h"
+
+extern StageProcs stage_stresstest_projectiles_procs;
+extern StageProcs stage_stresstest_lasers_procs;
+extern StageProcs stage_stresstest_items_procs;
+extern StageProcs stage_stresstest_enemies_procs;
+extern StageProcs stage_stresstest_tasks_procs;
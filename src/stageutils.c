@@ -146,48 +146,48 @@ void camera3d_set_point_light_uniforms(
 	vec3 lrad[num_lights];
 	camera3d_fill_point_light_uniform_vectors(cam, num_lights, lights, lpos, lrad);
 
-	r_uniform_vec3_array("light_positions", 0, num_lights, lpos);
-	r_uniform_vec3_array("light_colors", 0, num_lights, lrad);
-	r_uniform_int("light_count", num_lights);
+	r_uniform_vec3_array(R_UNIFORM("light_positions"), 0, num_lights, lpos);
+	r_uniform_vec3_array(R_UNIFORM("light_colors"), 0, num_lights, lrad);
+	r_uniform_int(R_UNIFORM("light_count"), num_lights);
 }
 
 void pbr_set_material_uniforms(const PBRMaterial *m, const PBREnvironment *env)  {
 	int flags = 0;
 
 	if(m->diffuse_map) {
-		r_uniform_sampler("diffuse_map", m->diffuse_map);
+		r_uniform_sampler(R_UNIFORM("diffuse_map"), m->diffuse_map);
 		flags |= PBR_FEATURE_DIFFUSE_MAP;
 	}
 
 	if(m->normal_map) {
-		r_uniform_sampler("normal_map", m->normal_map);
+		r_uniform_sampler(R_UNIFORM("normal_map"), m->normal_map);
 		flags |= PBR_FEATURE_NORMAL_MAP;
 	}
 
 	if(m->roughness_map) {
-		r_uniform_sampler("roughness_map", m->roughness_map);
+		r_uniform_sampler(R_UNIFORM("roughness_map"), m->roughness_map);
 		flags |= PBR_FEATURE_ROUGHNESS_MAP;
 	}
 
 	if(m->ambient_map) {
-		r_uniform_sampler("ambient_map", m->ambient_map);
+		r_uniform_sampler(R_UNIFORM("ambient_map"), m->ambient_map);
 		flags |= PBR_FEATURE_AMBIENT_MAP;
 	}
 
 	if(m->depth_map && m->depth_scale) {
-		r_uniform_sampler("depth_map", m->depth_map);
+		r_uniform_sampler(R_UNIFORM("depth_map"), m->depth_map);
 		flags |= PBR_FEATURE_DEPTH_MAP;
 	}
 
 	if(env->environment_map) {
-		r_uniform_sampler("ibl_brdf_lut", "ibl_brdf_lut");
-		r_uniform_sampler("environment_map", env->environment_map);
-		r_uniform_mat4("inv_camera_transform", (vec4*)env->cam_inverse_transform);
+		r_uniform_sampler(R_UNIFORM("ibl_brdf_lut"), "ibl_brdf_lut");
+		r_uniform_sampler(R_UNIFORM("environment_map"), env->environment_map);
+		r_uniform_mat4(R_UNIFORM("inv_camera_transform"), (vec4*)env->cam_inverse_transform);
 		flags |= PBR_FEATURE_ENVIRONMENT_MAP;
 	}
 
 	if(m->ao_map) {
-		r_uniform_sampler("ao_map", m->ao_map);
+		r_uniform_sampler(R_UNIFORM("ao_map"), m->ao_map);
 		flags |= PBR_FEATURE_AO_MAP;
 	}
 
@@ -198,19 +198,19 @@ void pbr_set_material_uniforms(const PBRMaterial *m, const PBREnvironment *env)
 	vec4 diffuseRGB_metallicA;
 	glm_vec3_copy((float*)m->diffuse_color, diffuseRGB_metallicA);
 	diffuseRGB_metallicA[3] = m->metallic_value;
-	r_uniform_vec4_vec("diffuseRGB_metallicA", diffuseRGB_metallicA);
+	r_uniform_vec4_vec(R_UNIFORM("diffuseRGB_metallicA"), diffuseRGB_metallicA);
 
 	vec4 ambientRGB_roughnessA;
 	glm_vec3_mul((float*)env->ambient_color, (float*)m->ambient_color, ambientRGB_roughnessA);
 	ambientRGB_roughnessA[3] = m->roughness_value;
-	r_uniform_vec4_vec("ambientRGB_roughnessA", ambientRGB_roughnessA);
+	r_uniform_vec4_vec(R_UNIFORM("ambientRGB_roughnessA"), ambientRGB_roughnessA);
 
 	vec4 environmentRGB_depthScale;
 	glm_vec3_copy((float*)env->environment_color, (float*)environmentRGB_depthScale);
 	environmentRGB_depthScale[3] = m->depth_scale;
-	r_uniform_vec4_vec("environmentRGB_depthScale", environmentRGB_depthScale);
+	r_uniform_vec4_vec(R_UNIFORM("environmentRGB_depthScale"), environmentRGB_depthScale);
 
-	r_uniform_int("features_mask", flags);
+	r_uniform_int(R_UNIFORM("features_mask"), flags);
 }
 
 void pbr_draw_model(const PBRModel *pmdl, const PBREnvironment *env) {
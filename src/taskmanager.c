@@ -11,10 +11,18 @@
 #include "list.h"
 #include "log.h"
 #include "util/env.h"
+#include "util/miscmath.h"
 
 #include <SDL3/SDL_atomic.h>
 #include <SDL3/SDL_mutex.h>
 #include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+// Finished tasks are recycled, along with their wait primitives (if any); this caps the pool.
+#define TASK_POOL_SIZE 256
+
+// Marks an empty queue in TaskQueue.head_key
+#define QUEUE_EMPTY INT_MAX
 
 typedef enum TaskManagerState {
 	TMGR_STATE_SHUTDOWN,
@@ -22,13 +30,37 @@ typedef enum TaskManagerState {
 	TMGR_STATE_ABORTED,
 } TaskManagerState;
 
+typedef struct TaskOrder {
+	int prio;
+	bool topmost;
+} TaskOrder;
+
+/*
+ * Every worker has its own queue. Tasks submitted from a worker thread go into that worker's
+ * queue, others are spread out round-robin. Each queue is sorted by priority, with topmost tasks
+ * ahead of the others of the same priority. An idle worker takes the next task from its own queue,
+ * unless another queue's head comes before it (higher priority, or topmost where ours isn't), in
+ * which case it steals that one instead; it also steals when its own queue is empty. Queue heads
+ * are compared without locking, and only the one queue picked gets locked.
+ *
+ * This keeps lock contention low under bursts of submissions. Priorities are honored across
+ * queues, but tasks of equal priority in different queues may start in any order.
+ */
+typedef struct TaskQueue {
+	alignas(64) LIST_ANCHOR(Task) tasks;
+	SDL_SpinLock lock;
+	// Sort key of the first task (see taskqueue_update_head), or QUEUE_EMPTY.
+	SDL_AtomicInt head_key;
+	TaskManager *mgr;
+} TaskQueue;
+
 struct TaskManager {
-	LIST_ANCHOR(Task) queue;
+	TaskQueue *queues;
 	SDL_Semaphore *queue_sem;
-	SDL_SpinLock queue_lock;
 	uint numthreads;
 	TaskManagerState state;
 	SDL_AtomicInt numtasks;
+	SDL_AtomicInt next_queue;
 	Thread *threads[];
 };
 
@@ -37,22 +69,67 @@ struct Task {
 	task_func_t callback;
 	task_free_func_t userdata_free_callback;
 	void *userdata;
-	int prio;
-	SDL_Mutex *mutex;
-	SDL_Condition *cond;
-	TaskStatus status;
 	void *result;
+	TaskOrder order;
+	TaskStatus status;
+	SDL_SpinLock lock;
+	// Only created once somebody actually has to block in task_wait()
+	SDL_Mutex *wait_mutex;
+	SDL_Condition *wait_cond;
 	uint disowned : 1;
 	uint in_queue : 1;
+	uint has_waiters : 1;
 };
 
 static TaskManager *g_taskmgr;
 
+static struct {
+	Task *first;
+	uint size;
+	SDL_SpinLock lock;
+} task_pool;
+
 static void taskmgr_free(TaskManager *mgr) {
 	SDL_DestroySemaphore(mgr->queue_sem);
+	mem_free(mgr->queues);
 	mem_free(mgr);
 }
 
+static void task_destroy(Task *task) {
+	if(task->wait_mutex != NULL) {
+		SDL_DestroyMutex(task->wait_mutex);
+	}
+
+	if(task->wait_cond != NULL) {
+		SDL_DestroyCondition(task->wait_cond);
+	}
+
+	mem_free(task);
+}
+
+static Task *task_alloc(void) {
+	SDL_LockSpinlock(&task_pool.lock);
+	Task *task = task_pool.first;
+
+	if(task) {
+		task_pool.first = task->next;
+		--task_pool.size;
+	}
+
+	SDL_UnlockSpinlock(&task_pool.lock);
+
+	if(!task) {
+		return ALLOC(Task);
+	}
+
+	*task = (Task) {
+		.wait_mutex = task->wait_mutex,
+		.wait_cond = task->wait_cond,
+	};
+
+	return task;
+}
+
 static void task_free(Task *task) {
 	assert(!task->in_queue);
 	assert(task->disowned);
@@ -61,31 +138,138 @@ static void task_free(Task *task) {
 		task->userdata_free_callback(task->userdata);
 	}
 
-	if(task->mutex != NULL) {
-		SDL_DestroyMutex(task->mutex);
+	SDL_LockSpinlock(&task_pool.lock);
+
+	if(task_pool.size < TASK_POOL_SIZE) {
+		task->next = task_pool.first;
+		task_pool.first = task;
+		++task_pool.size;
+		task = NULL;
+	}
+
+	SDL_UnlockSpinlock(&task_pool.lock);
+
+	if(task) {
+		task_destroy(task);
 	}
+}
 
-	if(task->cond != NULL) {
-		SDL_DestroyCondition(task->cond);
+static void task_pool_drain(void) {
+	SDL_LockSpinlock(&task_pool.lock);
+	Task *task = task_pool.first;
+	task_pool.first = NULL;
+	task_pool.size = 0;
+	SDL_UnlockSpinlock(&task_pool.lock);
+
+	while(task) {
+		Task *next = task->next;
+		task_destroy(task);
+		task = next;
 	}
+}
 
-	mem_free(task);
+static int task_prio_func(List *ltask) {
+	return ((Task*)ltask)->order.prio;
+}
+
+static void taskqueue_update_head(TaskQueue *q) {
+	int key = QUEUE_EMPTY;
+	Task *head = q->tasks.first;
+
+	if(head) {
+		// Lower keys run first
+		int prio = clamp(head->order.prio, INT_MIN / 2, INT_MAX / 2 - 1);
+		key = prio * 2 + !head->order.topmost;
+	}
+
+	SDL_SetAtomicInt(&q->head_key, key);
+}
+
+static void taskqueue_push(TaskQueue *q, Task *task) {
+	SDL_LockSpinlock(&q->lock);
+
+	if(task->order.topmost) {
+		alist_insert_at_priority_head(&q->tasks, task, task->order.prio, task_prio_func);
+	} else {
+		alist_insert_at_priority_tail(&q->tasks, task, task->order.prio, task_prio_func);
+	}
+
+	taskqueue_update_head(q);
+	SDL_UnlockSpinlock(&q->lock);
+}
+
+static Task *taskqueue_pop(TaskQueue *q) {
+	SDL_LockSpinlock(&q->lock);
+	auto task = alist_pop(&q->tasks);
+	taskqueue_update_head(q);
+	SDL_UnlockSpinlock(&q->lock);
+	return task;
 }
 
-static Task *taskmgr_pop_queue(TaskManager *mgr) {
-	if(mgr->queue.first == NULL) {
-		return NULL;
+static TaskQueue *taskmgr_pick_queue(TaskManager *mgr) {
+	Thread *current = thread_get_current();
+
+	if(current) {
+		for(uint i = 0; i < mgr->numthreads; ++i) {
+			if(mgr->threads[i] == current) {
+				return &mgr->queues[i];
+			}
+		}
+	}
+
+	uint i = (uint)SDL_AtomicAdd(&mgr->next_queue, 1) % mgr->numthreads;
+	return &mgr->queues[i];
+}
+
+static Task *taskmgr_pop_queue(TaskManager *mgr, uint home) {
+	for(;;) {
+		uint best = home;
+		int best_key = SDL_GetAtomicInt(&mgr->queues[home].head_key);
+
+		for(uint i = 1; i < mgr->numthreads; ++i) {
+			uint q = (home + i) % mgr->numthreads;
+			int key = SDL_GetAtomicInt(&mgr->queues[q].head_key);
+
+			if(key < best_key) {
+				best = q;
+				best_key = key;
+			}
+		}
+
+		if(best_key == QUEUE_EMPTY) {
+			return NULL;
+		}
+
+		Task *task = taskqueue_pop(&mgr->queues[best]);
+
+		if(task) {
+			return task;
+		}
+
+		// Someone else got there first; look again.
 	}
+}
 
-	SDL_LockSpinlock(&mgr->queue_lock);
-	auto t = alist_pop(&mgr->queue);
-	SDL_UnlockSpinlock(&mgr->queue_lock);
-	return t;
+static void task_set_finished(Task *task, void *result) {
+	SDL_LockSpinlock(&task->lock);
+	task->result = result;
+	task->status = TASK_FINISHED;
+	bool wake = task->has_waiters;
+	SDL_UnlockSpinlock(&task->lock);
+
+	// NOTE: the task can't be freed under our feet here: either it's still in the queue, or the
+	// owner is the one running it.
+	if(wake) {
+		SDL_LockMutex(task->wait_mutex);
+		SDL_BroadcastCondition(task->wait_cond);
+		SDL_UnlockMutex(task->wait_mutex);
+	}
 }
 
 static void *taskmgr_thread(void *arg) {
-	TaskManager *mgr = arg;
-	attr_unused SDL_ThreadID tid = SDL_GetCurrentThreadID();
+	TaskQueue *home_queue = arg;
+	TaskManager *mgr = home_queue->mgr;
+	uint home = home_queue - mgr->queues;
 
 	TaskManagerState state = mgr->state;
 	SDL_Semaphore *qsem = mgr->queue_sem;
@@ -93,7 +277,7 @@ static void *taskmgr_thread(void *arg) {
 	while(state != TMGR_STATE_ABORTED) {
 		SDL_WaitSemaphore(qsem);
 
-		Task *task = taskmgr_pop_queue(mgr);
+		Task *task = taskmgr_pop_queue(mgr, home);
 		state = mgr->state;
 
 		if(UNLIKELY(task == NULL)) {
@@ -104,7 +288,7 @@ static void *taskmgr_thread(void *arg) {
 			continue;
 		}
 
-		SDL_LockMutex(task->mutex);
+		SDL_LockSpinlock(&task->lock);
 
 		if(state == TMGR_STATE_ABORTED && task->status == TASK_PENDING) {
 			task->status = TASK_CANCELLED;
@@ -112,39 +296,28 @@ static void *taskmgr_thread(void *arg) {
 
 		if(task->status == TASK_PENDING) {
 			task->status = TASK_RUNNING;
+			SDL_UnlockSpinlock(&task->lock);
 
-			SDL_UnlockMutex(task->mutex);
-			task->result = task->callback(task->userdata);
-			SDL_LockMutex(task->mutex);
-
-			assert(task->in_queue);
-			task->in_queue = false;
-			(void)SDL_AtomicDecRef(&mgr->numtasks);
-
-			if(task->disowned) {
-				SDL_UnlockMutex(task->mutex);
-				task_free(task);
-			} else {
-				task->status = TASK_FINISHED;
-				SDL_BroadcastCondition(task->cond);
-				SDL_UnlockMutex(task->mutex);
-			}
-		} else if(
-			task->status == TASK_CANCELLED ||
-			task->status == TASK_RUNNING ||
-			task->status == TASK_FINISHED
-		) {
-			assert(task->in_queue);
-			task->in_queue = false;
-			(void)SDL_AtomicDecRef(&mgr->numtasks);
-			bool task_disowned = task->disowned;
-			SDL_UnlockMutex(task->mutex);
-
-			if(task_disowned) {
-				task_free(task);
-			}
+			task_set_finished(task, task->callback(task->userdata));
+
+			SDL_LockSpinlock(&task->lock);
 		} else {
-			UNREACHABLE;
+			assert(
+				task->status == TASK_CANCELLED ||
+				task->status == TASK_RUNNING ||
+				task->status == TASK_FINISHED
+			);
+		}
+
+		assert(task->in_queue);
+		task->in_queue = false;
+		bool task_disowned = task->disowned;
+		SDL_UnlockSpinlock(&task->lock);
+
+		(void)SDL_AtomicDecRef(&mgr->numtasks);
+
+		if(task_disowned) {
+			task_free(task);
 		}
 	}
 
@@ -168,7 +341,13 @@ TaskManager *taskmgr_create(uint numthreads, ThreadPriority prio, const char *na
 		numthreads = maxthreads;
 	}
 
-	auto mgr = ALLOC_FLEX(TaskManager, numthreads * sizeof(SDL_Thread*));
+	auto mgr = ALLOC_FLEX(TaskManager, numthreads * sizeof(Thread*));
+	mgr->queues = ALLOC_ARRAY(numthreads, TaskQueue);
+
+	for(uint i = 0; i < numthreads; ++i) {
+		mgr->queues[i].mgr = mgr;
+		SDL_SetAtomicInt(&mgr->queues[i].head_key, QUEUE_EMPTY);
+	}
 
 	if(!(mgr->queue_sem = SDL_CreateSemaphore(0))) {
 		log_sdl_error(LOG_ERROR, "SDL_CreateSemaphore");
@@ -184,7 +363,7 @@ TaskManager *taskmgr_create(uint numthreads, ThreadPriority prio, const char *na
 		char threadname[sizeof(prefix) + strlen(name) + digits + 2];
 		snprintf(threadname, sizeof(threadname), "%s:%s/%i", prefix, name, i);
 
-		if(!(mgr->threads[i] = thread_create(threadname, taskmgr_thread, mgr, prio))) {
+		if(!(mgr->threads[i] = thread_create(threadname, taskmgr_thread, &mgr->queues[i], prio))) {
 			mgr->state = TMGR_STATE_ABORTED;
 
 			for(uint j = 0; j < i; ++j) {
@@ -212,55 +391,36 @@ TaskManager *taskmgr_create(uint numthreads, ThreadPriority prio, const char *na
 	return NULL;
 }
 
-static int task_prio_func(List *ltask) {
-	return ((Task*)ltask)->prio;
-}
-
 Task *taskmgr_submit(TaskManager *mgr, TaskParams params) {
 	assert(params.callback != NULL);
 	assert(mgr->state == TMGR_STATE_RUNNING);
 
-	auto task = ALLOC(Task, {
-		.callback = params.callback,
-		.userdata_free_callback = params.userdata_free_callback,
-		.userdata = params.userdata,
+	Task *task = task_alloc();
+	task->callback = params.callback;
+	task->userdata_free_callback = params.userdata_free_callback;
+	task->userdata = params.userdata;
+	task->order = (TaskOrder) {
 		.prio = params.prio,
-		.status = TASK_PENDING,
-	});
-
-	if(!(task->mutex = SDL_CreateMutex())) {
-		log_sdl_error(LOG_WARN, "SDL_CreateMutex");
-		goto fail;
-	}
-
-	if(!(task->cond = SDL_CreateCondition())) {
-		log_sdl_error(LOG_WARN, "SDL_CreateCondition");
-		goto fail;
-	}
-
-	SDL_LockSpinlock(&mgr->queue_lock);
-	if(params.topmost) {
-		alist_insert_at_priority_head(&mgr->queue, task, task->prio, task_prio_func);
-	} else {
-		alist_insert_at_priority_tail(&mgr->queue, task, task->prio, task_prio_func);
-	}
-	SDL_UnlockSpinlock(&mgr->queue_lock);
-
+		.topmost = params.topmost,
+	};
+	task->status = TASK_PENDING;
 	task->in_queue = true;
+
 	SDL_AtomicIncRef(&mgr->numtasks);
+	taskqueue_push(taskmgr_pick_queue(mgr), task);
 	SDL_SignalSemaphore(mgr->queue_sem);
 
 	return task;
-
-fail:
-	task_free(task);
-	return NULL;
 }
 
 uint taskmgr_remaining(TaskManager *mgr) {
 	return SDL_GetAtomicInt(&mgr->numtasks);
 }
 
+uint taskmgr_num_threads(TaskManager *mgr) {
+	return mgr->numthreads;
+}
+
 static void taskmgr_finalize_and_wait(TaskManager *mgr, bool do_abort) {
 	log_debug(
 		"%08llx [%p] waiting for %u tasks (abort = %i)",
@@ -296,25 +456,77 @@ TaskStatus task_status(Task *task) {
 	TaskStatus result = TASK_INVALID;
 
 	if(task != NULL) {
-		SDL_LockMutex(task->mutex);
+		SDL_LockSpinlock(&task->lock);
 		result = task->status;
-		SDL_UnlockMutex(task->mutex);
+		SDL_UnlockSpinlock(&task->lock);
 	}
 
 	return result;
 }
 
-static void *task_offload(Task *task) {
-	assert(task->status == TASK_PENDING);
-	task->status = TASK_RUNNING;
-	SDL_UnlockMutex(task->mutex);
-	void *result = task->callback(task->userdata);
-	SDL_LockMutex(task->mutex);
-	assert(!task->disowned);
-	task->status = TASK_FINISHED;
-	task->result = result;
-	SDL_BroadcastCondition(task->cond);
-	return result;
+static bool task_init_wait_primitives(Task *task) {
+	SDL_LockSpinlock(&task->lock);
+	bool have_primitives = task->wait_mutex != NULL;
+	SDL_UnlockSpinlock(&task->lock);
+
+	if(have_primitives) {
+		return true;
+	}
+
+	SDL_Mutex *mutex = SDL_CreateMutex();
+	SDL_Condition *cond = SDL_CreateCondition();
+
+	if(!mutex || !cond) {
+		log_sdl_error(LOG_WARN, mutex ? "SDL_CreateCondition" : "SDL_CreateMutex");
+		SDL_DestroyMutex(mutex);
+		SDL_DestroyCondition(cond);
+		return false;
+	}
+
+	SDL_LockSpinlock(&task->lock);
+
+	// Could've raced with another waiter
+	if(task->wait_mutex == NULL) {
+		task->wait_mutex = mutex;
+		task->wait_cond = cond;
+		mutex = NULL;
+		cond = NULL;
+	}
+
+	SDL_UnlockSpinlock(&task->lock);
+
+	SDL_DestroyMutex(mutex);
+	SDL_DestroyCondition(cond);
+	return true;
+}
+
+static TaskStatus task_wait_running(Task *task) {
+	if(UNLIKELY(!task_init_wait_primitives(task))) {
+		// Shouldn't happen, but if it does, poll.
+		TaskStatus status;
+
+		while((status = task_status(task)) == TASK_RUNNING) {
+			SDL_Delay(1);
+		}
+
+		return status;
+	}
+
+	SDL_LockMutex(task->wait_mutex);
+	SDL_LockSpinlock(&task->lock);
+	task->has_waiters = true;
+
+	while(task->status == TASK_RUNNING) {
+		SDL_UnlockSpinlock(&task->lock);
+		SDL_WaitCondition(task->wait_cond, task->wait_mutex);
+		SDL_LockSpinlock(&task->lock);
+	}
+
+	TaskStatus status = task->status;
+	SDL_UnlockSpinlock(&task->lock);
+	SDL_UnlockMutex(task->wait_mutex);
+
+	return status;
 }
 
 bool task_wait(Task *task, void **result) {
@@ -326,26 +538,34 @@ bool task_wait(Task *task, void **result) {
 
 	void *_result = NULL;
 
-	SDL_LockMutex(task->mutex);
+	SDL_LockSpinlock(&task->lock);
+	TaskStatus status = task->status;
 
-	if(task->status == TASK_CANCELLED) {
-		success = false;
-	} else if(task->status == TASK_FINISHED) {
-		success = true;
-		_result = task->result;
-	} else if(task->status == TASK_RUNNING) {
-		SDL_WaitCondition(task->cond, task->mutex);
-		_result = task->result;
-		success = (task->status == TASK_FINISHED);
-	} else if(task->status == TASK_PENDING) {
+	if(status == TASK_PENDING) {
 		// fine, i'll do it myself
-		_result = task_offload(task);
+		task->status = TASK_RUNNING;
+		SDL_UnlockSpinlock(&task->lock);
+		_result = task->callback(task->userdata);
+		assert(!task->disowned);
+		task_set_finished(task, _result);
 		success = true;
 	} else {
-		UNREACHABLE;
-	}
+		SDL_UnlockSpinlock(&task->lock);
+
+		if(status == TASK_RUNNING) {
+			status = task_wait_running(task);
+		}
 
-	SDL_UnlockMutex(task->mutex);
+		if(status == TASK_CANCELLED) {
+			success = false;
+		} else if(status == TASK_FINISHED) {
+			success = true;
+			// NOTE: the result is written before the status, under the same lock
+			_result = task->result;
+		} else {
+			UNREACHABLE;
+		}
+	}
 
 	if(success && result != NULL) {
 		*result = _result;
@@ -361,14 +581,14 @@ bool task_cancel(Task *task) {
 		return success;
 	}
 
-	SDL_LockMutex(task->mutex);
+	SDL_LockSpinlock(&task->lock);
 
 	if(task->status == TASK_PENDING) {
 		task->status = TASK_CANCELLED;
 		success = true;
 	}
 
-	SDL_UnlockMutex(task->mutex);
+	SDL_UnlockSpinlock(&task->lock);
 
 	return success;
 }
@@ -381,12 +601,12 @@ bool task_detach(Task *task) {
 		return success;
 	}
 
-	SDL_LockMutex(task->mutex);
+	SDL_LockSpinlock(&task->lock);
 	assert(!task->disowned);
 	task->disowned = true;
 	task_in_queue = task->in_queue;
 	success = true;
-	SDL_UnlockMutex(task->mutex);
+	SDL_UnlockSpinlock(&task->lock);
 
 	if(!task_in_queue) {
 		task_free(task);
@@ -418,17 +638,95 @@ void taskmgr_global_shutdown(void) {
 		taskmgr_finish(g_taskmgr);
 		g_taskmgr = NULL;
 	}
+
+	task_pool_drain();
 }
 
 Task *taskmgr_global_submit(TaskParams params) {
 	if(g_taskmgr == NULL) {
-		return ALLOC(Task, {
-			.callback = params.callback,
-			.userdata = params.userdata,
-			.userdata_free_callback = params.userdata_free_callback,
-			.result = params.callback(params.userdata),
-		});
+		Task *task = task_alloc();
+		task->callback = params.callback;
+		task->userdata = params.userdata;
+		task->userdata_free_callback = params.userdata_free_callback;
+		task->result = params.callback(params.userdata);
+		task->status = TASK_FINISHED;
+		return task;
 	}
 
 	return taskmgr_submit(g_taskmgr, params);
 }
+
+typedef struct ParallelForJob {
+	task_range_func_t func;
+	void *userdata;
+	size_t count;
+	size_t grain;
+	SDL_AtomicInt next_chunk;
+	int num_chunks;
+} ParallelForJob;
+
+static void parallel_for_run_chunks(ParallelForJob *job) {
+	int chunk;
+
+	while((chunk = SDL_AtomicAdd(&job->next_chunk, 1)) < job->num_chunks) {
+		size_t begin = (size_t)chunk * job->grain;
+		size_t end = min(begin + job->grain, job->count);
+		job->func(begin, end, job->userdata);
+	}
+}
+
+static void *parallel_for_task(void *arg) {
+	parallel_for_run_chunks(arg);
+	return NULL;
+}
+
+// Upper bound on helper tasks per call; anything more is just queue churn.
+#define PARALLEL_FOR_MAX_HELPERS 32
+
+void taskmgr_parallel_for(size_t count, size_t grain, task_range_func_t func, void *userdata) {
+	if(count == 0) {
+		return;
+	}
+
+	grain = max(grain, 1);
+	size_t num_chunks = (count - 1) / grain + 1;
+
+	if(g_taskmgr == NULL || num_chunks < 2) {
+		func(0, count, userdata);
+		return;
+	}
+
+	if(num_chunks > INT_MAX) {
+		grain = (count - 1) / INT_MAX + 1;
+		num_chunks = (count - 1) / grain + 1;
+	}
+
+	ParallelForJob job = {
+		.func = func,
+		.userdata = userdata,
+		.count = count,
+		.grain = grain,
+		.num_chunks = num_chunks,
+	};
+
+	uint num_helpers = min(min(g_taskmgr->numthreads, PARALLEL_FOR_MAX_HELPERS), num_chunks - 1);
+	Task *helpers[PARALLEL_FOR_MAX_HELPERS];
+
+	for(uint i = 0; i < num_helpers; ++i) {
+		helpers[i] = taskmgr_submit(g_taskmgr, (TaskParams) {
+			.callback = parallel_for_task,
+			.userdata = &job,
+			.topmost = true,
+		});
+	}
+
+	parallel_for_run_chunks(&job);
+
+	// Helpers that never got picked up are run inline here; they find no chunks left and return
+	// immediately. Either way, none of them can touch the job after this loop.
+	for(uint i = 0; i < num_helpers; ++i) {
+		if(helpers[i]) {
+			task_finish(helpers[i], NULL);
+		}
+	}
+}
@@ -24,6 +24,7 @@ typedef enum TaskStatus {
 
 typedef void *(*task_func_t)(void *userdata);
 typedef void (*task_free_func_t)(void *userdata);
+typedef void (*task_range_func_t)(size_t begin, size_t end, void *userdata);
 
 /**
  * Parameters for `taskmgr_submit`. See its documentation below.
@@ -78,8 +79,11 @@ TaskManager *taskmgr_create(uint numthreads, ThreadPriority prio, const char *na
 	attr_nodiscard attr_returns_max_aligned attr_nonnull(3);
 
 /**
- * Submit a new task to [mgr] described by [params]. It is generally placed at the end of the
- * task manager's queue, but that can be influenced with [params.prio] and [params.topmost].
+ * Submit a new task to [mgr] described by [params]. It is generally placed at the end of one of
+ * the task manager's per-worker queues, but that can be influenced with [params.prio] and
+ * [params.topmost]. Priorities are honored across all queues: an idle worker picks a task of the
+ * highest priority pending anywhere, preferring topmost ones. Tasks of the same priority start in
+ * queue order within each queue, but in no particular order across queues.
  *
  * See documentation for TaskParams above.
  *
@@ -100,6 +104,12 @@ Task *taskmgr_submit(TaskManager *mgr, TaskParams params)
 uint taskmgr_remaining(TaskManager *mgr)
 	attr_nonnull(1);
 
+/**
+ * Returns the number of worker threads in [mgr].
+ */
+uint taskmgr_num_threads(TaskManager *mgr)
+	attr_nonnull(1);
+
 /**
  * Wait for all remaining tasks to complete, then destroy [mgr], freeing associated resources.
  * [mgr] must be treated as an invalid pointer as soon as this function is called.
@@ -176,3 +186,19 @@ void taskmgr_global_shutdown(void);
  * Submit a task to the global task manager. See `taskmgr_submit`.
  */
 Task *taskmgr_global_submit(TaskParams params);
+
+/**
+ * Call [func] over the index range [0, count), split into chunks of up to [grain] indices, in
+ * parallel on the global task manager's workers. The calling thread processes chunks as well,
+ * and this function returns only once all of them are done. Each call of [func] receives a
+ * half-open subrange [begin, end) and the [userdata] pointer; chunks may run in any order and
+ * on any thread, so they must not depend on each other.
+ *
+ * Pick [grain] so that a chunk takes at least a few tens of microseconds; smaller chunks are
+ * dominated by scheduling overhead. If the global task manager is not running, or the range fits
+ * in a single chunk, [func] is simply called once on the current thread.
+ *
+ * Safe to call from within a task.
+ */
+void taskmgr_parallel_for(size_t count, size_t grain, task_range_func_t func, void *userdata)
+	attr_nonnull(3);
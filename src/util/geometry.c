@@ -9,6 +9,8 @@
 #include "geometry.h"
 #include "miscmath.h"
 
+#include <SDL3/SDL_cpuinfo.h>
+
 Rect ellipse_bbox(Ellipse e) {
 	double largest_radius = max(re(e.axes), im(e.axes)) * 0.5;
 	cmplx d = CMPLX(largest_radius, largest_radius);
@@ -124,6 +126,71 @@ bool lineseg_ellipse_intersect(LineSegment seg, Ellipse e) {
 	return lineseg_circle_intersect_fallback(seg, c) >= 0;
 }
 
+static inline void lineseg_ellipse_intersect_batch_lane(
+	uint i, const LineSegmentBatch *restrict segs, const EllipseBatch *restrict ellipses, uint64_t *restrict mask
+) {
+	uint64_t bit = UINT64_C(1) << (i % 64);
+
+	if(!(mask[i / 64] & bit)) {
+		return;
+	}
+
+	LineSegment seg = {
+		.a = CMPLX(segs->a_x[i], segs->a_y[i]),
+		.b = CMPLX(segs->b_x[i], segs->b_y[i]),
+	};
+
+	Ellipse e = {
+		.axes = CMPLX(ellipses->axes_x[i], ellipses->axes_y[i]),
+		.angle = ellipses->angle[i],
+	};
+
+	if(!lineseg_ellipse_intersect(seg, e)) {
+		mask[i / 64] &= ~bit;
+	}
+}
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	#define LSEB_FUNC lineseg_ellipse_intersect_batch_vec2
+	#define LSEB_WIDTH 2
+	#define LSEB_ATTR
+	#include "geometry_batch.inc.h"
+	#define HAVE_LSEB_VEC2
+#endif
+
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+	#define LSEB_FUNC lineseg_ellipse_intersect_batch_avx2
+	#define LSEB_WIDTH 4
+	#define LSEB_ATTR __attribute__((target("avx2")))
+	#include "geometry_batch.inc.h"
+	#define HAVE_LSEB_AVX2
+#endif
+
+void lineseg_ellipse_intersect_batch(
+	uint count, const LineSegmentBatch *segs, const EllipseBatch *ellipses, uint64_t *mask
+) {
+#if defined(HAVE_LSEB_AVX2)
+	static int have_avx2 = -1;
+
+	if(UNLIKELY(have_avx2 < 0)) {
+		have_avx2 = SDL_HasAVX2();
+	}
+
+	if(have_avx2) {
+		lineseg_ellipse_intersect_batch_avx2(count, segs, ellipses, mask);
+		return;
+	}
+#endif
+
+#if defined(HAVE_LSEB_VEC2)
+	lineseg_ellipse_intersect_batch_vec2(count, segs, ellipses, mask);
+#else
+	for(uint i = 0; i < count; ++i) {
+		lineseg_ellipse_intersect_batch_lane(i, segs, ellipses, mask);
+	}
+#endif
+}
+
 double lineseg_circle_intersect(LineSegment seg, Circle c) {
 	Ellipse e = { .origin = c.origin, .axes = 2*c.radius + I*2*c.radius };
 	if(segment_ellipse_nonintersection_heuristic(seg, e)) {
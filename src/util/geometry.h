@@ -96,6 +96,26 @@ Rect lineseg_bbox(LineSegment seg) attr_const;
 bool point_in_ellipse(cmplx p, Ellipse e) attr_const;
 double lineseg_circle_intersect(LineSegment seg, Circle c) attr_const;
 bool lineseg_ellipse_intersect(LineSegment seg, Ellipse e) attr_const;
+
+/*
+ * Structure-of-arrays input for lineseg_ellipse_intersect_batch().
+ * All ellipses are centered at the origin; translate the segments instead.
+ */
+typedef struct LineSegmentBatch {
+	const double *a_x, *a_y;
+	const double *b_x, *b_y;
+} LineSegmentBatch;
+
+typedef struct EllipseBatch {
+	const double *axes_x, *axes_y;
+	const double *angle;
+} EllipseBatch;
+
+// Tests segment i against ellipse i for every bit i set in mask (64 bits per word), and clears the
+// bits of the pairs that don't intersect. Results are bit-identical to lineseg_ellipse_intersect().
+void lineseg_ellipse_intersect_batch(
+	uint count, const LineSegmentBatch *segs, const EllipseBatch *ellipses, uint64_t *mask
+) attr_nonnull_all;
 double lineseg_closest_factor(LineSegment seg, cmplx p) attr_const;
 cmplx lineseg_closest_point(LineSegment seg, cmplx p) attr_const;
 bool lineseg_lineseg_intersection(LineSegment seg0, LineSegment seg1, cmplx *out);
@@ -0,0 +1,139 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+// NOTE: no include guard; this is instantiated multiple times by geometry.c.
+// Expects LSEB_FUNC, LSEB_WIDTH, and LSEB_ATTR to be defined.
+
+/*
+ * Vectorized lineseg_ellipse_intersect(), LSEB_WIDTH lanes at a time.
+ *
+ * Every operation below maps 1:1 to an operation in the scalar code path (including the
+ * inlined bits of lineseg_bbox(), ellipse_bbox(), rect_rect_intersect(), cmul_finite(),
+ * clamp(), and clerp()), in the same order and with the same operands, so results are
+ * bit-identical. Don't "simplify" anything here without doing the same to the scalar code.
+ */
+
+LSEB_ATTR
+static void LSEB_FUNC(uint count, const LineSegmentBatch *restrict segs, const EllipseBatch *restrict ellipses, uint64_t *restrict mask) {
+	typedef double vf64 __attribute__((vector_size(LSEB_WIDTH * sizeof(double))));
+	typedef int64_t vi64 __attribute__((vector_size(LSEB_WIDTH * sizeof(int64_t))));
+
+	#define LOAD(src) ({ vf64 _v; memcpy(&_v, (src), sizeof(_v)); _v; })
+	#define SELECT(m, a, b) ((vf64)(((m) & (vi64)(a)) | (~(m) & (vi64)(b))))
+	#define LANE_BITS(m) ({ \
+		uint64_t _bits = 0; \
+		for(uint _l = 0; _l < LSEB_WIDTH; ++_l) { \
+			_bits |= (uint64_t)((m)[_l] & 1) << _l; \
+		} \
+		_bits; \
+	})
+
+	static_assert(64 % LSEB_WIDTH == 0);
+	const uint64_t group_mask = (UINT64_C(1) << LSEB_WIDTH) - 1;
+	const vf64 zero = { };
+	const vf64 one = zero + 1;
+
+	uint i = 0;
+
+	for(; i + LSEB_WIDTH <= count; i += LSEB_WIDTH) {
+		uint64_t *word = mask + i / 64;
+		uint shift = i % 64;
+		uint64_t lanes = (*word >> shift) & group_mask;
+
+		if(!lanes) {
+			continue;
+		}
+
+		vf64 a_x = LOAD(segs->a_x + i);
+		vf64 a_y = LOAD(segs->a_y + i);
+		vf64 b_x = LOAD(segs->b_x + i);
+		vf64 b_y = LOAD(segs->b_y + i);
+		vf64 axes_x = LOAD(ellipses->axes_x + i);
+		vf64 axes_y = LOAD(ellipses->axes_y + i);
+
+		// segment_ellipse_nonintersection_heuristic()
+		vi64 gt = (vi64)(b_x > a_x);
+		vf64 seg_left = SELECT(gt, a_x, b_x);
+		vf64 seg_right = SELECT(gt, b_x, a_x);
+		gt = (vi64)(b_y > a_y);
+		vf64 seg_top = SELECT(gt, a_y, b_y);
+		vf64 seg_bottom = SELECT(gt, b_y, a_y);
+		gt = (vi64)(axes_x > axes_y);
+		vf64 r = SELECT(gt, axes_x, axes_y) * 0.5;
+		vf64 e_min = zero - r;
+		vf64 e_max = zero + r;
+
+		vi64 reject =
+			(vi64)(seg_bottom < e_min) |
+			(vi64)(seg_top > e_max) |
+			(vi64)(seg_left > e_max) |
+			(vi64)(seg_right < e_min);
+
+		vf64 ratio = axes_x / axes_y;
+		vi64 bad = (vi64)(ratio != ratio) | (vi64)(ratio == zero);
+
+		uint64_t live = lanes & ~LANE_BITS(reject);
+		assert(!(live & LANE_BITS(bad)) && "Bad ellipse");
+		live &= ~LANE_BITS(bad);
+
+		uint64_t hits = 0;
+
+		if(live) {
+			vf64 rot_x = zero;
+			vf64 rot_y = zero;
+
+			// The transcendental part stays scalar; only done for the lanes that need it.
+			for(uint l = 0; l < LSEB_WIDTH; ++l) {
+				if(live & (UINT64_C(1) << l)) {
+					cmplx rot = cdir(-ellipses->angle[i + l]);
+					rot_x[l] = re(rot);
+					rot_y[l] = im(rot);
+				}
+			}
+
+			vf64 ta_x = a_x * rot_x - a_y * rot_y;
+			vf64 ta_y = a_x * rot_y + a_y * rot_x;
+			vf64 tb_x = b_x * rot_x - b_y * rot_y;
+			vf64 tb_y = b_x * rot_y + b_y * rot_x;
+			ta_y *= ratio;
+			tb_y *= ratio;
+
+			// lineseg_circle_intersect_fallback()
+			vf64 rad = axes_x * 0.5;
+			vf64 rad2 = rad * rad;
+
+			vf64 m_x = tb_x - ta_x;
+			vf64 m_y = tb_y - ta_y;
+			vf64 lm2 = m_x * m_x + m_y * m_y;
+			vf64 f = -(ta_x * m_x - ta_y * -m_y) / lm2;
+			f = SELECT((vi64)(lm2 == zero), zero, f);
+			f = SELECT((vi64)(f > zero), f, zero);
+			f = SELECT((vi64)(f > one), one, f);
+
+			vf64 p_x = f * (tb_x - ta_x) + ta_x;
+			vf64 p_y = f * (tb_y - ta_y) + ta_y;
+			vi64 inside = (vi64)(p_x * p_x + p_y * p_y <= rad2);
+
+			hits = live & LANE_BITS(inside);
+		}
+
+		*word = (*word & ~(group_mask << shift)) | (hits << shift);
+	}
+
+	for(; i < count; ++i) {
+		lineseg_ellipse_intersect_batch_lane(i, segs, ellipses, mask);
+	}
+
+	#undef LOAD
+	#undef SELECT
+	#undef LANE_BITS
+}
+
+#undef LSEB_FUNC
+#undef LSEB_WIDTH
+#undef LSEB_ATTR
@@ -17,6 +17,11 @@ typedef struct VFSDir {
 	void *opaque;
 } VFSDir;
 
+typedef struct VFSMapping {
+	VFSNode *node;
+	VFSMMapTicket ticket;
+} VFSMapping;
+
 bool vfs_mount_alias(const char *dst, const char *src) {
 	if(UNLIKELY(!vfs_initialized())) {
 		return false;
@@ -83,6 +88,50 @@ SDL_IOStream* vfs_open(const char *path, VFSOpenMode mode) {
 	return rwops;
 }
 
+VFSMapping *vfs_mmap(const char *path, const void **out_data, size_t *out_size) {
+	*out_data = NULL;
+	*out_size = 0;
+
+	if(UNLIKELY(!vfs_initialized())) {
+		return NULL;
+	}
+
+	char p[strlen(path)+1];
+	path = vfs_path_normalize(path, p);
+	VFSNode *node = vfs_locate(vfs_root, path);
+
+	if(!node) {
+		vfs_set_error("Node '%s' does not exist", path);
+		return NULL;
+	}
+
+	VFSMMapTicket ticket = vfs_node_mmap(node, out_data, out_size, false);
+
+	if(!vfs_mmap_ticket_valid(ticket)) {
+		vfs_set_error("Can't memory-map '%s': %s", path, vfs_get_error());
+		vfs_decref(node);
+		return NULL;
+	}
+
+	return ALLOC(VFSMapping, {
+		.node = node,
+		.ticket = ticket,
+	});
+}
+
+void vfs_munmap(VFSMapping *mapping) {
+	if(!mapping) {
+		return;
+	}
+
+	if(!vfs_node_munmap(mapping->node, mapping->ticket)) {
+		log_warn("Can't unmap file: %s", vfs_get_error());
+	}
+
+	vfs_decref(mapping->node);
+	mem_free(mapping);
+}
+
 VFSInfo vfs_query(const char *path) {
 	if(UNLIKELY(!vfs_initialized())) {
 		return VFSINFO_ERROR;
@@ -40,10 +40,18 @@ typedef enum VFSSyncMode {
 #define VFS_MODE_RWMASK (VFS_MODE_READ | VFS_MODE_WRITE)
 
 typedef struct VFSDir VFSDir;
+typedef struct VFSMapping VFSMapping;
 
 SDL_IOStream * vfs_open(const char *path, VFSOpenMode mode);
 VFSInfo vfs_query(const char *path);
 
+// Maps a whole file read-only into memory without copying it. This only works if the backing
+// node supports it, e.g. real files and uncompressed entries in ZIP archives; otherwise returns
+// NULL, and the caller is expected to fall back to vfs_open().
+VFSMapping *vfs_mmap(const char *path, const void **out_data, size_t *out_size)
+	attr_nonnull(1, 2, 3) attr_nodiscard;
+void vfs_munmap(VFSMapping *mapping);
+
 bool vfs_mkdir(const char *path);
 void vfs_mkdir_required(const char *path);
 bool vfs_mkparents(const char *path);
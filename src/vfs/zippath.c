@@ -136,6 +136,36 @@ static SDL_IOStream *vfs_zippath_open(VFSNode *node, VFSOpenMode mode) {
 	return NOT_NULL(io);
 }
 
+static const void *vfs_zippath_mmap(VFSNode *node, size_t *out_size) {
+	auto zpnode = VFS_NODE_CAST(VFSZipPathNode, node);
+	auto znode = zpnode->znode;
+	auto entry = zpnode->entry;
+
+	// Only stored entries can be handed out directly; they are just a slice of the archive,
+	// which is itself memory-mapped (or read into memory) for as long as the znode lives.
+	if(entry->is_dir || entry->compression != ZIP_COMPRESSION_NONE) {
+		vfs_set_error("%s: Can't memory-map %.*s: entry is compressed",
+			znode->ctx.log_prefix, entry->name_len, entry->name);
+		return NULL;
+	}
+
+	uint32_t ofs = zipfile_get_entry_data_offset(&znode->ctx, entry);
+
+	if(ofs == ZIP_INVALID_OFFSET) {
+		vfs_set_error("%s: Can't read %.*s",
+			znode->ctx.log_prefix, entry->name_len, entry->name);
+		return NULL;
+	}
+
+	*out_size = entry->comp_size;
+	return znode->ctx.mem + ofs;
+}
+
+static bool vfs_zippath_munmap(VFSNode *node, const void *data, size_t size) {
+	// Nothing to do, the archive mapping is owned by the znode.
+	return true;
+}
+
 VFS_NODE_FUNCS(VFSZipPathNode, {
 	.repr = vfs_zippath_repr,
 	.query = vfs_zippath_query,
@@ -147,6 +177,8 @@ VFS_NODE_FUNCS(VFSZipPathNode, {
 	.iter_stop = vfs_zippath_iter_stop,
 	//.mkdir = vfs_zippath_mkdir,
 	.open = vfs_zippath_open,
+	.mmap = vfs_zippath_mmap,
+	.munmap = vfs_zippath_munmap,
 });
 
 VFSNode *vfs_zippath_create(VFSZipNode *zipnode, const ZipEntry *entry) {
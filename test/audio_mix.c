@@ -0,0 +1,79 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "test_common.h"
+
+#include "audio/stream/mix.h"
+#include "random.h"
+
+// Checks that the vectorized mixing kernels agree with the scalar loops exactly.
+
+#define NUM_ROUNDS 500
+#define MAX_FRAMES 131  // deliberately not a multiple of any vector width
+
+static uint32_t rng_state = 0xa0d10;
+
+static float rand_sample(void) {
+	return (int32_t)splitmix32(&rng_state) * 0x1.0p-31f;
+}
+
+static void check(const char *what, int round, uint num_samples, const float *got, const float *expected) {
+	if(memcmp(got, expected, num_samples * sizeof(*got))) {
+		for(uint i = 0; i < num_samples; ++i) {
+			if(memcmp(got + i, expected + i, sizeof(*got))) {
+				log_fatal("%s mismatch in round %i, sample %u: got %a, expected %a",
+					what, round, i, got[i], expected[i]
+				);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+
+	// One extra float, so that the kernels are also run on misaligned pointers
+	float src[2 * MAX_FRAMES + 1], dst[2 * MAX_FRAMES + 1], expected[2 * MAX_FRAMES + 1];
+
+	for(int round = 0; round < NUM_ROUNDS; ++round) {
+		uint num_frames = splitmix32(&rng_state) % (MAX_FRAMES + 1);
+		uint num_samples = 2 * num_frames;
+		uint ofs = round & 1;
+
+		for(uint i = 0; i < ARRAY_SIZE(src); ++i) {
+			src[i] = rand_sample();
+			dst[i] = expected[i] = rand_sample();
+		}
+
+		float gain = (round % 7) ? rand_sample() * 2 : 1;
+		float step = rand_sample() / (num_frames + 1);
+
+		audio_mix_f32(num_samples, dst + ofs, src + ofs, gain);
+
+		for(uint i = 0; i < num_samples; ++i) {
+			expected[ofs + i] += src[ofs + i] * gain;
+		}
+
+		check("audio_mix_f32", round, ARRAY_SIZE(dst), dst, expected);
+
+		audio_fade_stereo_f32(num_frames, dst + ofs, gain, step);
+
+		for(uint i = 0; i < num_frames; ++i) {
+			float g = gain + step * i;
+			expected[ofs + 2 * i] *= g;
+			expected[ofs + 2 * i + 1] *= g;
+		}
+
+		check("audio_fade_stereo_f32", round, ARRAY_SIZE(dst), dst, expected);
+	}
+
+	log_info("All results identical");
+
+	test_shutdown_basic();
+	return 0;
+}
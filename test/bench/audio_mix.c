@@ -0,0 +1,101 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "bench_common.h"
+
+#include "audio/stream/mixer.h"
+#include "random.h"
+
+/*
+ * Feeds looping PCM sound effects through mixer_process() the same way the SDL audio callback
+ * does, and reports the cost per output frame.
+ */
+
+#define SAMPLE_RATE 48000
+#define SFX_FRAMES SAMPLE_RATE
+#define BUFFER_FRAMES 1024
+#define WARMUP_ITERATIONS 100
+#define BENCH_ITERATIONS 2000
+
+static Mixer mixer;
+static MixerSFXImpl *sfx;
+
+static MixerSFXImpl *make_sfx(const AudioStreamSpec *spec) {
+	size_t pcm_size = SFX_FRAMES * spec->frame_size;
+	auto s = ALLOC_FLEX(MixerSFXImpl, pcm_size);
+	s->gain = 1;
+	s->spec = *spec;
+	s->pcm_size = pcm_size;
+
+	float *samples = (float*)s->pcm;
+	uint32_t rng_state = 0x50d;
+
+	for(uint i = 0; i < SFX_FRAMES * spec->channels; ++i) {
+		samples[i] = (int32_t)splitmix32(&rng_state) * 0x1.0p-34f;
+	}
+
+	return s;
+}
+
+static void bench(const char *name, int num_sfx, float volume, double fadeout) {
+	mixer_group_set_volume(&mixer, CHANGROUP_SFX_GAME, volume);
+
+	for(int i = 0; i < num_sfx; ++i) {
+		AudioBackendChannel chan = mixer_sfx_play(
+			&mixer, sfx, CHANGROUP_SFX_GAME, AUDIO_BACKEND_CHANNEL_INVALID, true);
+		assert(chan != AUDIO_BACKEND_CHANNEL_INVALID);
+
+		if(fadeout > 0) {
+			mixer_chan_stop(&mixer, chan, fadeout);
+		}
+	}
+
+	static float buffer[BUFFER_FRAMES * 2];
+
+	for(int i = 0; i < WARMUP_ITERATIONS; ++i) {
+		memset(buffer, 0, sizeof(buffer));
+		mixer_process(&mixer, sizeof(buffer), buffer);
+	}
+
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < BENCH_ITERATIONS; ++i) {
+		memset(buffer, 0, sizeof(buffer));
+		mixer_process(&mixer, sizeof(buffer), buffer);
+	}
+
+	t = time_get() - t;
+	bench_report(name, t, BENCH_ITERATIONS, BUFFER_FRAMES, "frame");
+
+	mixer_group_stop(&mixer, CHANGROUP_SFX_GAME, 0);
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+
+	AudioStreamSpec spec = astream_spec(SDL_AUDIO_F32, 2, SAMPLE_RATE);
+
+	if(!mixer_init(&mixer, &spec)) {
+		log_fatal("mixer_init() failed");
+	}
+
+	sfx = make_sfx(&spec);
+
+	bench("sfx/1", 1, 1, 0);
+	bench("sfx/8", 8, 1, 0);
+	bench("sfx/28", MIXER_NUM_SFX_MAIN_CHANNELS, 1, 0);
+	// Long enough to not finish during the run
+	bench("sfx/28/fading", MIXER_NUM_SFX_MAIN_CHANNELS, 1, 600);
+	bench("sfx/28/muted", MIXER_NUM_SFX_MAIN_CHANNELS, 0, 0);
+
+	mixer_shutdown(&mixer);
+	mixersfx_unload(sfx);
+	test_shutdown_basic();
+
+	return 0;
+}
@@ -0,0 +1,31 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#pragma once
+#include "taisei.h"
+
+#include "test_common.h"
+
+#include "hirestime.h"
+#include "util/io.h"
+
+/*
+ * Results go to stdout, one line per measurement, so that runs are easy to diff:
+ *
+ *   <name>  <time per iteration>  <time per item>
+ */
+
+static void bench_report(const char *name, hrtime_t elapsed, uint64_t iterations, uint64_t items_per_iteration, const char *item_name) {
+	double ns_per_iter = (double)elapsed / iterations * (1e9 / HRTIME_RESOLUTION);
+	double ns_per_item = items_per_iteration ? ns_per_iter / items_per_iteration : 0;
+
+	tsfprintf(stdout, "%-48s %12.3f us/iter %10.3f ns/%s\n",
+		name, ns_per_iter * 1e-3, ns_per_item, item_name
+	);
+	fflush(stdout);
+}
@@ -0,0 +1,161 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "bench_common.h"
+
+#include "entity.h"
+#include "random.h"
+#include "renderer/api.h"
+#include "util/env.h"
+
+/*
+ * Measures the overhead of ent_draw() itself (ordering, state scopes, hooks) with the null
+ * renderer, so that the draw callbacks cost next to nothing. The "baseline" variant emulates
+ * the old approach for comparison: a full qsort and a state push/pop for every entity.
+ */
+
+#define NUM_ENTS 4000
+#define WARMUP_FRAMES 60
+#define BENCH_FRAMES 600
+
+static EntityInterface ents[NUM_ENTS];
+static bool registered[NUM_ENTS];
+static uint64_t num_draws;
+static uint32_t rng_state = 0x7a15e1;
+
+static void draw_ent(EntityInterface *ent) {
+	// Every so often, change some state, like real draw functions do.
+	if(ent->spawn_id % 16 == 0) {
+		r_blend(BLEND_MOD);
+	}
+
+	++num_draws;
+}
+
+static drawlayer_t random_layer(void) {
+	static const DrawLayer layers[] = { LAYER_PARTICLE_LOW, LAYER_BULLET, LAYER_PARTICLE_HIGH };
+	return layers[splitmix32(&rng_state) % ARRAY_SIZE(layers)] | (splitmix32(&rng_state) & 0xff);
+}
+
+static void spawn(int i) {
+	ents[i] = (EntityInterface) {
+		.draw_func = draw_ent,
+		.draw_layer = random_layer(),
+	};
+
+	ent_register(ents + i, ENT_TYPE_ID(Projectile));
+	registered[i] = true;
+}
+
+static void churn(int relayers, int respawns) {
+	for(int n = 0; n < relayers; ++n) {
+		int i = splitmix32(&rng_state) % NUM_ENTS;
+
+		if(registered[i]) {
+			ents[i].draw_layer = random_layer();
+		}
+	}
+
+	for(int n = 0; n < respawns; ++n) {
+		int i = splitmix32(&rng_state) % NUM_ENTS;
+
+		if(registered[i]) {
+			ent_unregister(ents + i);
+			registered[i] = false;
+		} else {
+			spawn(i);
+		}
+	}
+}
+
+static int baseline_cmp(const void *ptr1, const void *ptr2) {
+	const EntityInterface *ent1 = *(const EntityInterface**)ptr1;
+	const EntityInterface *ent2 = *(const EntityInterface**)ptr2;
+
+	int r = (int)ent1->draw_layer - (int)ent2->draw_layer;
+
+	if(r == 0) {
+		r = (int)ent1->spawn_id - (int)ent2->spawn_id;
+	}
+
+	return r;
+}
+
+static void baseline_draw(void) {
+	static EntityInterface *sorted[NUM_ENTS];
+	int n = 0;
+
+	for(int i = 0; i < NUM_ENTS; ++i) {
+		if(registered[i]) {
+			sorted[n++] = ents + i;
+		}
+	}
+
+	qsort(sorted, n, sizeof(*sorted), baseline_cmp);
+
+	for(int i = 0; i < n; ++i) {
+		r_state_push();
+		sorted[i]->draw_func(sorted[i]);
+		r_state_pop();
+	}
+}
+
+static void run(const char *scenario, int relayers, int respawns, bool baseline) {
+	for(int i = 0; i < WARMUP_FRAMES; ++i) {
+		churn(relayers, respawns);
+		baseline ? baseline_draw() : ent_draw(NULL);
+	}
+
+	num_draws = 0;
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < BENCH_FRAMES; ++i) {
+		churn(relayers, respawns);
+		baseline ? baseline_draw() : ent_draw(NULL);
+	}
+
+	t = time_get() - t;
+
+	char name[64];
+	snprintf(name, sizeof(name), "%s/%s", scenario, baseline ? "baseline" : "ent_draw");
+	bench_report(name, t, BENCH_FRAMES, num_draws / BENCH_FRAMES, "ent");
+}
+
+static void bench(const char *scenario, int relayers, int respawns) {
+	for(int baseline = 1; baseline >= 0; --baseline) {
+		for(int i = 0; i < NUM_ENTS; ++i) {
+			spawn(i);
+		}
+
+		run(scenario, relayers, respawns, baseline);
+
+		for(int i = 0; i < NUM_ENTS; ++i) {
+			if(registered[i]) {
+				ent_unregister(ents + i);
+				registered[i] = false;
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+	env_set("TAISEI_RENDERER", "null", true);
+	r_init();
+	ent_init();
+
+	bench("static", 0, 0);
+	bench("relayer", 16, 0);
+	bench("churn", 16, 64);
+
+	ent_shutdown();
+	r_shutdown();
+	test_shutdown_basic();
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "bench_common.h"
+
+#include "pixmap/pixmap.h"
+#include "taskmanager.h"
+
+/*
+ * Measures pixmap format conversion, swizzling and flipping on typical atlas sizes, first on the
+ * calling thread only, then split across the global task manager with taskmgr_parallel_for().
+ */
+
+static const uint tex_sizes[] = { 1024, 2048, 4096 };
+#define ITERATIONS 8
+
+typedef struct ConversionCase {
+	const char *name;
+	PixmapFormat src_format;
+	PixmapFormat dst_format;
+} ConversionCase;
+
+static const ConversionCase cases[] = {
+	{ "rgba8-rgba32f", PIXMAP_FORMAT_RGBA8,  PIXMAP_FORMAT_RGBA32F },
+	{ "rgb8-rgba8",    PIXMAP_FORMAT_RGB8,   PIXMAP_FORMAT_RGBA8   },
+	{ "rgba16-rgba8",  PIXMAP_FORMAT_RGBA16, PIXMAP_FORMAT_RGBA8   },
+	{ "rgba32f-rgba8", PIXMAP_FORMAT_RGBA32F, PIXMAP_FORMAT_RGBA8  },
+	{ "r8-rgba8",      PIXMAP_FORMAT_R8,     PIXMAP_FORMAT_RGBA8   },
+};
+
+static void fill_pixmap(Pixmap *px, PixmapFormat format, uint size) {
+	*px = (Pixmap) {
+		.format = format,
+		.width = size,
+		.height = size,
+	};
+
+	px->data.untyped = pixmap_alloc_buffer_for_copy(px, &px->data_size);
+
+	if(PIXMAP_FORMAT_IS_FLOAT(format)) {
+		float *f = px->data.untyped;
+		for(size_t i = 0; i < px->data_size / sizeof(*f); ++i) {
+			f[i] = (i % 251) / 250.0f;
+		}
+	} else {
+		uint8_t *b = px->data.untyped;
+		for(size_t i = 0; i < px->data_size; ++i) {
+			b[i] = i * 31;
+		}
+	}
+}
+
+static void bench_convert(const ConversionCase *c, uint size, const char *mode) {
+	Pixmap src, dst;
+	fill_pixmap(&src, c->src_format, size);
+	dst.data.untyped = pixmap_alloc_buffer_for_conversion(&src, c->dst_format, &dst.data_size);
+
+	// Warm up; also faults in the destination pages
+	pixmap_convert(&src, &dst, c->dst_format);
+
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < ITERATIONS; ++i) {
+		pixmap_convert(&src, &dst, c->dst_format);
+	}
+
+	t = time_get() - t;
+
+	char name[64];
+	snprintf(name, sizeof(name), "convert/%s/%u/%s", c->name, size, mode);
+	bench_report(name, t, ITERATIONS, size * size, "px");
+
+	mem_free(src.data.untyped);
+	mem_free(dst.data.untyped);
+}
+
+static void bench_swizzle(uint size, const char *mode) {
+	Pixmap px;
+	fill_pixmap(&px, PIXMAP_FORMAT_RGBA8, size);
+	pixmap_swizzle_inplace(&px, (SwizzleMask) { "bgra" });
+
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < ITERATIONS; ++i) {
+		pixmap_swizzle_inplace(&px, (SwizzleMask) { "bgra" });
+	}
+
+	t = time_get() - t;
+
+	char name[64];
+	snprintf(name, sizeof(name), "swizzle/rgba8-bgra/%u/%s", size, mode);
+	bench_report(name, t, ITERATIONS, size * size, "px");
+
+	mem_free(px.data.untyped);
+}
+
+static void bench_flip(uint size, const char *mode) {
+	Pixmap px;
+	fill_pixmap(&px, PIXMAP_FORMAT_RGBA8, size);
+	pixmap_flip_y_inplace(&px);
+
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < ITERATIONS; ++i) {
+		pixmap_flip_y_inplace(&px);
+	}
+
+	t = time_get() - t;
+
+	char name[64];
+	snprintf(name, sizeof(name), "flip_y/rgba8/%u/%s", size, mode);
+	bench_report(name, t, ITERATIONS, size * size, "px");
+
+	mem_free(px.data.untyped);
+}
+
+static void bench_all(const char *mode) {
+	for(uint s = 0; s < ARRAY_SIZE(tex_sizes); ++s) {
+		for(uint i = 0; i < ARRAY_SIZE(cases); ++i) {
+			bench_convert(cases + i, tex_sizes[s], mode);
+		}
+
+		bench_swizzle(tex_sizes[s], mode);
+		bench_flip(tex_sizes[s], mode);
+	}
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+
+	// Without a task manager, taskmgr_parallel_for() runs everything on the calling thread
+	bench_all("serial");
+
+	taskmgr_global_init();
+	bench_all("parallel");
+	taskmgr_global_shutdown();
+
+	test_shutdown_basic();
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "bench_common.h"
+
+#include "collision_grid.h"
+#include "enemy.h"
+#include "entity.h"
+#include "global.h"
+#include "projectile.h"
+#include "stageobjects.h"
+
+/*
+ * Measures process_projectiles() with and without batching on a large, stable population of
+ * projectiles. Everything is set up so that no collisions happen, so no resources are needed:
+ * the projectiles orbit fixed points, well away from the player and the enemies.
+ */
+
+#define WARMUP_FRAMES 60
+#define BENCH_FRAMES 600
+#define ORBIT_ATTRACTION 0.002
+
+static void spawn_orbiting(ProjectileList *dest, ProjType type, cmplx center, int count) {
+	for(int i = 0; i < count; ++i) {
+		// Golden angle spiral, so that the population is spread out evenly.
+		real r = 20 + 120 * sqrt((i + 0.5) / count);
+		cmplx dir = cdir(i * 2.39996322972865332);
+
+		create_projectile(&(ProjArgs) {
+			.dest = dest,
+			.type = type,
+			.pos = center + r * dir,
+			.size = 12+12*I,
+			.collision_size = 4+4*I,
+			.color = RGB(1, 1, 1),
+			.layer = (type == PROJ_PLAYER ? LAYER_PLAYER_SHOT : LAYER_BULLET) | 1,
+			.flags = PFLAG_NOSPAWNEFFECTS,
+			.move = {
+				.velocity = r * sqrt(ORBIT_ATTRACTION) * I * dir,
+				.retention = 1,
+				.attraction = ORBIT_ATTRACTION,
+				.attraction_point = center,
+				.attraction_exponent = 1,
+			},
+		});
+	}
+}
+
+static void run(const char *scenario, int num_projs, bool batching) {
+	projectiles_set_batching(batching);
+
+	for(int i = 0; i < WARMUP_FRAMES; ++i, ++global.frames) {
+		process_projectiles(&global.projs, true);
+	}
+
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < BENCH_FRAMES; ++i, ++global.frames) {
+		process_projectiles(&global.projs, true);
+	}
+
+	t = time_get() - t;
+
+	char name[64];
+	snprintf(name, sizeof(name), "%s/%i/%s", scenario, num_projs, batching ? "batched" : "scalar");
+	bench_report(name, t, BENCH_FRAMES, num_projs, "proj");
+}
+
+static void bench(const char *scenario, ProjType type, int num_projs) {
+	for(int batching = 0; batching < 2; ++batching) {
+		spawn_orbiting(&global.projs, type, CMPLX(VIEWPORT_W/2, 240), num_projs);
+		run(scenario, num_projs, batching);
+		delete_projectiles(&global.projs);
+	}
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+	ent_init();
+	stage_objpools_init();
+	collision_grid_init();
+
+	global.plr.pos = CMPLX(VIEWPORT_W/2, VIEWPORT_H - 20);
+
+	for(int i = 0; i < 16; ++i) {
+		create_enemy(CMPLX(15 + 30 * i, 30), 1000);
+	}
+
+	const int counts[] = { 500, 2000, 8000 };
+
+	for(uint i = 0; i < ARRAY_SIZE(counts); ++i) {
+		bench("enemy", PROJ_ENEMY, counts[i]);
+		bench("player", PROJ_PLAYER, counts[i]);
+	}
+
+	delete_enemies(&global.enemies);
+	collision_grid_shutdown();
+	stage_objpools_shutdown();
+	ent_shutdown();
+	test_shutdown_basic();
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "bench_common.h"
+
+#include "renderer/api.h"
+#include "util/env.h"
+
+/*
+ * Measures the frontend cost of setting uniforms by name. "string" hashes the name on every call,
+ * like the plain r_uniform_*("name", ...) calls do; "interned" goes through R_UNIFORM().
+ *
+ * Runs on the trace renderer, which resolves uniforms from the GLSL source it is given and only
+ * counts the uploads, so nearly all of the measured time is spent in the frontend. (The null
+ * renderer has no uniforms at all, and every call would return early.)
+ *
+ * The uniform set mimics a typical post-processing pass in the stage backgrounds.
+ */
+
+#define WARMUP_ITERATIONS 10000
+#define BENCH_ITERATIONS 1000000
+#define UNIFORMS_PER_ITERATION 8
+
+static void set_uniforms_string(float t) {
+	r_uniform_float("time", t);
+	r_uniform_float("strength", t * 0.5f);
+	r_uniform_vec2("blur_orig", 0.5f, 0.5f);
+	r_uniform_vec2("fix_orig", 0.25f, 0.75f);
+	r_uniform_vec4("fog_color", 0.78f, 0.8f, 0.85f, 1.0f);
+	r_uniform_float("start", 0.2f);
+	r_uniform_float("end", 0.8f);
+	r_uniform_int("frames", (int)t);
+}
+
+static void set_uniforms_interned(float t) {
+	r_uniform_float(R_UNIFORM("time"), t);
+	r_uniform_float(R_UNIFORM("strength"), t * 0.5f);
+	r_uniform_vec2(R_UNIFORM("blur_orig"), 0.5f, 0.5f);
+	r_uniform_vec2(R_UNIFORM("fix_orig"), 0.25f, 0.75f);
+	r_uniform_vec4(R_UNIFORM("fog_color"), 0.78f, 0.8f, 0.85f, 1.0f);
+	r_uniform_float(R_UNIFORM("start"), 0.2f);
+	r_uniform_float(R_UNIFORM("end"), 0.8f);
+	r_uniform_int(R_UNIFORM("frames"), (int)t);
+}
+
+static const char shader_source[] =
+	"#version 330 core\n"
+	"uniform float time;\n"
+	"uniform float strength;\n"
+	"uniform vec2 blur_orig;\n"
+	"uniform vec2 fix_orig;\n"
+	"uniform vec4 fog_color;\n"
+	"uniform float start;\n"
+	"uniform float end;\n"
+	"uniform int frames;\n"
+	"out vec4 fragColor;\n"
+	"void main(void) { fragColor = fog_color; }\n";
+
+static ShaderProgram *create_program(void) {
+	ShaderSource src = {
+		.content = shader_source,
+		.content_size = sizeof(shader_source),
+		.lang = {
+			.lang = SHLANG_GLSL,
+			.glsl.version = { 330, GLSL_PROFILE_CORE },
+		},
+		.stage = SHADER_STAGE_FRAGMENT,
+	};
+
+	ShaderObject *shobj = NOT_NULL(r_shader_object_compile(&src));
+	ShaderProgram *prog = NOT_NULL(r_shader_program_link(1, &shobj));
+	r_shader_object_destroy(shobj);
+
+	return prog;
+}
+
+static void run(const char *name, void (*set_uniforms)(float t)) {
+	for(int i = 0; i < WARMUP_ITERATIONS; ++i) {
+		set_uniforms(i);
+	}
+
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < BENCH_ITERATIONS; ++i) {
+		set_uniforms(i);
+	}
+
+	t = time_get() - t;
+	bench_report(name, t, BENCH_ITERATIONS, UNIFORMS_PER_ITERATION, "uniform");
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+	env_set("TAISEI_RENDERER", "trace", true);
+	r_init();
+
+	ShaderProgram *prog = create_program();
+	r_shader_ptr(prog);
+
+	if(!r_shader_current_uniform("time")) {
+		log_fatal("Uniforms are not resolved; is the trace renderer enabled in this build?");
+	}
+
+	run("uniforms/string", set_uniforms_string);
+	run("uniforms/interned", set_uniforms_interned);
+
+	r_shader_program_destroy(prog);
+	r_shutdown();
+	test_shutdown_basic();
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "bench_common.h"
+
+#include "random.h"
+#include "rwops/rwops_zstd.h"
+#include "taskmanager.h"
+#include "util/env.h"
+
+#include <zstd.h>
+
+/*
+ * Reads a large in-memory seekable-format zstd stream from start to end through
+ * SDL_RWWrapZstdReader(), with various TAISEI_ZSTD_PREFETCH_DEPTH settings and read sizes.
+ * Small reads are what audio streaming does; large ones are typical for asset loading.
+ */
+
+#define DATA_SIZE (64 << 20)
+#define FRAME_SIZE (256 << 10)
+#define NUM_FRAMES (DATA_SIZE / FRAME_SIZE)
+#define COMPRESSION_LEVEL 3
+#define BENCH_ITERATIONS 4
+
+static uint8_t *data;
+static uint8_t *compressed;
+static size_t compressed_size;
+static uint8_t *readback;
+
+static void put_u32le(uint8_t *p, uint32_t v) {
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static void make_data(void) {
+	// Something moderately compressible, rather than noise or zeros
+	uint32_t rng_state = 0x25d;
+	data = mem_alloc(DATA_SIZE);
+
+	for(size_t i = 0; i < DATA_SIZE;) {
+		uint32_t r = splitmix32(&rng_state);
+		size_t run = min((size_t)(r & 31) + 1, (size_t)DATA_SIZE - i);
+
+		if(r & 0x100 && i >= 4096) {
+			memcpy(data + i, data + i - 1 - ((r >> 12) & 4095), run);
+		} else {
+			for(size_t j = 0; j < run; ++j) {
+				data[i + j] = 'a' + splitmix32(&rng_state) % 26;
+			}
+		}
+
+		i += run;
+	}
+}
+
+static void make_seekable_stream(void) {
+	size_t seektable_size = 8 + NUM_FRAMES * 8 + 9;
+	size_t capacity = ZSTD_compressBound(FRAME_SIZE) * NUM_FRAMES + seektable_size;
+	compressed = mem_alloc(capacity);
+
+	uint32_t comp_sizes[NUM_FRAMES];
+	ZSTD_CCtx *cctx = NOT_NULL(ZSTD_createCCtx());
+
+	for(uint i = 0; i < NUM_FRAMES; ++i) {
+		size_t r = ZSTD_compressCCtx(cctx,
+			compressed + compressed_size, capacity - compressed_size,
+			data + i * FRAME_SIZE, FRAME_SIZE, COMPRESSION_LEVEL);
+
+		if(ZSTD_isError(r)) {
+			log_fatal("ZSTD_compressCCtx() failed: %s", ZSTD_getErrorName(r));
+		}
+
+		comp_sizes[i] = r;
+		compressed_size += r;
+	}
+
+	ZSTD_freeCCtx(cctx);
+
+	// Seek table: a skippable frame holding per-frame sizes, followed by the footer
+	uint8_t *p = compressed + compressed_size;
+	put_u32le(p, 0x184D2A5E);
+	put_u32le(p + 4, NUM_FRAMES * 8 + 9);
+	p += 8;
+
+	for(uint i = 0; i < NUM_FRAMES; ++i) {
+		put_u32le(p, comp_sizes[i]);
+		put_u32le(p + 4, FRAME_SIZE);
+		p += 8;
+	}
+
+	put_u32le(p, NUM_FRAMES);
+	p[4] = 0;
+	put_u32le(p + 5, 0x8F92EAB1);
+	compressed_size += seektable_size;
+
+	log_info("%i MiB in %i frames compressed to %zu KiB",
+		DATA_SIZE >> 20, NUM_FRAMES, compressed_size >> 10);
+}
+
+static void read_all(size_t read_size) {
+	SDL_IOStream *io = SDL_RWWrapZstdReader(
+		NOT_NULL(SDL_IOFromConstMem(compressed, compressed_size)), -1, true);
+
+	if(!io) {
+		log_fatal("SDL_RWWrapZstdReader() failed: %s", SDL_GetError());
+	}
+
+	for(size_t pos = 0; pos < DATA_SIZE;) {
+		size_t r = SDL_ReadIO(io, readback + pos, min(read_size, (size_t)DATA_SIZE - pos));
+
+		if(r == 0) {
+			log_fatal("SDL_ReadIO() failed at %zu: %s", pos, SDL_GetError());
+		}
+
+		pos += r;
+	}
+
+	SDL_CloseIO(io);
+}
+
+static void bench(int depth, size_t read_size) {
+	env_set("TAISEI_ZSTD_PREFETCH_DEPTH", depth, true);
+
+	read_all(read_size);
+
+	if(memcmp(readback, data, DATA_SIZE)) {
+		log_fatal("Decompressed data mismatch with prefetch depth %i", depth);
+	}
+
+	hrtime_t t = time_get();
+
+	for(int i = 0; i < BENCH_ITERATIONS; ++i) {
+		read_all(read_size);
+	}
+
+	t = time_get() - t;
+
+	char name[64];
+	snprintf(name, sizeof(name), "read%zuk/depth%i", read_size >> 10, depth);
+	bench_report(name, t, BENCH_ITERATIONS, DATA_SIZE >> 10, "KiB");
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+	taskmgr_global_init();
+
+	make_data();
+	make_seekable_stream();
+	readback = mem_alloc(DATA_SIZE);
+
+	static const int depths[] = { 0, 1, 2, 4, 8, 16 };
+	static const size_t read_sizes[] = { 4 << 10, 1 << 20 };
+
+	for(uint r = 0; r < ARRAY_SIZE(read_sizes); ++r) {
+		for(uint d = 0; d < ARRAY_SIZE(depths); ++d) {
+			bench(depths[d], read_sizes[r]);
+		}
+	}
+
+	mem_free(readback);
+	mem_free(compressed);
+	mem_free(data);
+
+	taskmgr_global_shutdown();
+	test_shutdown_basic();
+
+	return 0;
+}
@@ -0,0 +1,169 @@
+# Shared helpers for the whole-game tests: run the taisei executable with a controlled environment.
+
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import zlib
+
+# Exit status that tells meson the test was skipped.
+SKIP_STATUS = 77
+
+
+class TestFailure(Exception):
+    pass
+
+
+class TestSkipped(Exception):
+    pass
+
+
+def game_env(renderer='null', **extra):
+    env = dict(os.environ)
+
+    # No window or sound is needed; the dummy SDL drivers work everywhere.
+    env.update(
+        SDL_VIDEODRIVER='dummy',
+        SDL_VIDEO_DRIVER='dummy',
+        SDL_AUDIODRIVER='dummy',
+        SDL_AUDIO_DRIVER='dummy',
+        TAISEI_AUDIO_BACKEND='null',
+        TAISEI_RENDERER=renderer,
+    )
+
+    env.update({k: str(v) for k, v in extra.items()})
+    return env
+
+
+def run_game(taisei, *args, env):
+    cmd = [str(taisei)] + [str(a) for a in args]
+    print('>>>', ' '.join(cmd), flush=True)
+    p = subprocess.run(cmd, env=env)
+
+    if p.returncode != 0:
+        raise TestFailure(f'{cmd[0]} exited with status {p.returncode}')
+
+
+def dump_frames(taisei, *args, renderer, dump_dir, env):
+    """
+    Run a headless mode with a real renderer, and return the PNG files of every frame of the in-game viewport.
+    """
+
+    shutil.rmtree(dump_dir, ignore_errors=True)
+    dump_dir.mkdir(parents=True)
+
+    env = dict(env,
+        TAISEI_HEADLESS_RENDERER=renderer,
+        TAISEI_FRAMEDUMP=f'{dump_dir}{os.sep}',
+        TAISEI_FRAMEDUMP_SOURCE='viewport',
+        # Keep shaders translated for one configuration from being reused in another.
+        TAISEI_CACHE_PATH=str(dump_dir / 'cache'),
+    )
+
+    run_game(taisei, *args, env=env)
+    frames = sorted(dump_dir.glob('*.png'))
+
+    if not frames:
+        raise TestFailure(f'No frames were dumped into {dump_dir}')
+
+    return frames
+
+
+def read_png(path):
+    """
+    Decode an 8-bit, non-interlaced RGB or RGBA PNG (as written by the frame dumper) into (width, height, channels, rows).
+    """
+
+    data = path.read_bytes()
+
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise TestFailure(f'{path} is not a PNG file')
+
+    pos = 8
+    idat = []
+
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'IDAT':
+            idat.append(chunk)
+        elif kind == b'IEND':
+            break
+
+    if depth != 8 or color not in (2, 6) or interlace:
+        raise TestFailure(f'{path}: unsupported PNG format')
+
+    channels = 3 if color == 2 else 4
+    stride = width * channels
+    raw = zlib.decompress(b''.join(idat))
+    rows = []
+    prev = bytearray(stride)
+
+    for y in range(height):
+        ftype = raw[y * (stride + 1)]
+        row = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+
+        for x in range(stride):
+            a = row[x - channels] if x >= channels else 0
+            b = prev[x]
+            c = prev[x - channels] if x >= channels else 0
+
+            if ftype == 1:
+                row[x] = (row[x] + a) & 0xff
+            elif ftype == 2:
+                row[x] = (row[x] + b) & 0xff
+            elif ftype == 3:
+                row[x] = (row[x] + (a + b) // 2) & 0xff
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                row[x] = (row[x] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xff
+
+        rows.append(row)
+        prev = row
+
+    return width, height, channels, rows
+
+
+def compare_frames(frames_a, frames_b, tolerance=0):
+    """
+    Check that two frame dumps match. With a tolerance, every channel of every pixel may be off by that much.
+    """
+
+    # Frames are read back asynchronously, so the last couple may still be in flight on exit.
+    if abs(len(frames_a) - len(frames_b)) > 2:
+        raise TestFailure(f'Frame count mismatch: {len(frames_a)} != {len(frames_b)}')
+
+    for a, b in zip(frames_a, frames_b):
+        if a.read_bytes() == b.read_bytes():
+            continue
+
+        if tolerance == 0:
+            raise TestFailure(f'{a} and {b} differ')
+
+        wa, ha, ca, rows_a = read_png(a)
+        wb, hb, cb, rows_b = read_png(b)
+
+        if (wa, ha, ca) != (wb, hb, cb):
+            raise TestFailure(f'{a} and {b} have different dimensions')
+
+        for y, (ra, rb) in enumerate(zip(rows_a, rows_b)):
+            for x, (va, vb) in enumerate(zip(ra, rb)):
+                if abs(va - vb) > tolerance:
+                    raise TestFailure(f'{a} and {b} differ at {x // ca},{y}: {va} vs {vb}')
+
+
+def run_test(func):
+    try:
+        func(sys.argv)
+    except TestSkipped as e:
+        print('SKIP:', e, file=sys.stderr)
+        sys.exit(SKIP_STATUS)
+    except TestFailure as e:
+        print('FAIL:', e, file=sys.stderr)
+        sys.exit(1)
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+
+# Renders a stress stage with the gl33 backend twice: once setting uniforms with glUniform*, and
+# once through the uniform buffer path (TAISEI_GL33_UNIFORM_BUFFERS). The frames must match.
+# Needs an EGL implementation that works without a display, such as Mesa's llvmpipe.
+
+from gametest import (
+    TestFailure,
+    TestSkipped,
+    compare_frames,
+    dump_frames,
+    game_env,
+    run_test,
+)
+
+import argparse
+
+from pathlib import Path
+
+
+def main(args):
+    parser = argparse.ArgumentParser(description='Check that gl33 uniform buffers render the same as glUniform', prog=args[0])
+    parser.add_argument('taisei', type=Path, help='The Taisei executable')
+    parser.add_argument('stage', help='ID of the stage to render (hexadecimal, as for --benchmark-stage)')
+    parser.add_argument('workdir', type=Path, help='Where to put the frame dumps')
+    parser.add_argument('--frames', type=int, default=300, help='Number of frames to render')
+    parser.add_argument('--tolerance', type=int, default=2, help='Allowed per-channel difference')
+    args = parser.parse_args(args[1:])
+
+    game_args = [
+        '--benchmark-stage', args.stage,
+        '--benchmark-runs', 1,
+        '--benchmark-frames', args.frames,
+    ]
+
+    def render(name, use_ubo):
+        env = game_env(LIBGL_ALWAYS_SOFTWARE=1, TAISEI_GL33_UNIFORM_BUFFERS=int(use_ubo))
+        return dump_frames(args.taisei, *game_args, renderer='gl33', dump_dir=args.workdir / name, env=env)
+
+    # The glUniform path is the long-standing one; if it can't run, there's no usable GL here.
+    try:
+        reference = render('glUniform', False)
+    except TestFailure as e:
+        raise TestSkipped(f'OpenGL is not available ({e})')
+
+    # Shaders go through a SPIR-V round trip on this path, so the driver may compile them slightly
+    # differently; allow for rounding.
+    compare_frames(reference, render('ubo', True), tolerance=args.tolerance)
+
+
+if __name__ == '__main__':
+    run_test(main)
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+# Plays a replay with and without the threaded renderer frontend (TAISEI_RENDERER_THREADED), and
+# checks that the backend was asked to do exactly the same thing. With the trace renderer, the
+# recorded call streams must be identical; with gl33, the rendered frames must be.
+
+from gametest import (
+    TestFailure,
+    TestSkipped,
+    compare_frames,
+    dump_frames,
+    game_env,
+    run_game,
+    run_test,
+)
+
+import argparse
+
+from pathlib import Path
+
+
+def compare_traces(a, b):
+    with a.open('rb') as fa, b.open('rb') as fb:
+        offset = 0
+
+        while True:
+            ca = fa.read(1 << 20)
+            cb = fb.read(1 << 20)
+
+            if ca != cb:
+                for i, (x, y) in enumerate(zip(ca, cb)):
+                    if x != y:
+                        break
+                else:
+                    i = min(len(ca), len(cb))
+
+                raise TestFailure(f'{a} and {b} differ at offset {offset + i}')
+
+            if not ca:
+                return
+
+            offset += len(ca)
+
+
+def main(args):
+    parser = argparse.ArgumentParser(description='Check that the threaded renderer frontend is equivalent to the direct one', prog=args[0])
+    parser.add_argument('taisei', type=Path, help='The Taisei executable')
+    parser.add_argument('replay', type=Path, help='The replay to play')
+    parser.add_argument('renderer', choices=['trace', 'gl33'], help='The renderer backend to check')
+    parser.add_argument('workdir', type=Path, help='Where to put the traces or frame dumps')
+    parser.add_argument('--frames', type=int, default=600, help='Number of frames to play')
+    args = parser.parse_args(args[1:])
+
+    args.workdir.mkdir(parents=True, exist_ok=True)
+
+    game_args = [
+        '--benchmark-replay', args.replay,
+        '--benchmark-runs', 1,
+        '--benchmark-frames', args.frames,
+    ]
+
+    def make_env(threaded, **extra):
+        # Load resources in a fixed order, so that objects are created (and numbered) the same way
+        # every time. The glyph cache would also change when glyphs get uploaded between runs.
+        return game_env(
+            renderer=args.renderer,
+            TAISEI_RENDERER_THREADED=int(threaded),
+            TAISEI_NOASYNC=1,
+            TAISEI_FONT_GLYPH_CACHE=0,
+            **extra
+        )
+
+    if args.renderer == 'trace':
+        traces = []
+
+        for name, threaded in (('direct', False), ('threaded', True)):
+            trace = args.workdir / f'{name}.trace'
+            trace.unlink(missing_ok=True)
+            run_game(args.taisei, *game_args, env=make_env(threaded, TAISEI_RENDERER_TRACE=trace))
+
+            if not trace.is_file():
+                raise TestFailure(f'{trace} was not written')
+
+            traces.append(trace)
+
+        compare_traces(*traces)
+        return
+
+    def render(name, threaded):
+        env = make_env(threaded, LIBGL_ALWAYS_SOFTWARE=1)
+        return dump_frames(args.taisei, *game_args, renderer=args.renderer, dump_dir=args.workdir / name, env=env)
+
+    try:
+        reference = render('direct', False)
+    except TestFailure as e:
+        raise TestSkipped(f'OpenGL is not available ({e})')
+
+    compare_frames(reference, render('threaded', True))
+
+
+if __name__ == '__main__':
+    run_test(main)
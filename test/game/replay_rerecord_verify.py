@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+
+# Re-records a replay while rendering every frame, then verifies the result with --verify-replay,
+# which renders nothing at all. Any game logic that depends on rendering shows up as a desync.
+
+from gametest import (
+    TestFailure,
+    game_env,
+    run_game,
+    run_test,
+)
+
+import argparse
+
+from pathlib import Path
+
+
+def main(args):
+    parser = argparse.ArgumentParser(description='Check that replays verify the same with and without rendering', prog=args[0])
+    parser.add_argument('taisei', type=Path, help='The Taisei executable')
+    parser.add_argument('replay', type=Path, help='The replay to re-record')
+    parser.add_argument('workdir', type=Path, help='Where to put the re-recorded replay')
+    args = parser.parse_args(args[1:])
+
+    args.workdir.mkdir(parents=True, exist_ok=True)
+    rerecorded = args.workdir / f'{args.replay.stem}.rerecorded.tsr'
+    rerecorded.unlink(missing_ok=True)
+
+    # Keyframe every second, so that a mismatch is caught close to where it happens.
+    env = game_env(TAISEI_REPLAY_KEYFRAME_FREQUENCY=60)
+
+    # --frameskip=1 turns off the frame limiter, but still renders every frame.
+    run_game(args.taisei, '--replay', args.replay, '--rereplay', rerecorded, '--frameskip=1', env=env)
+
+    if not rerecorded.is_file():
+        raise TestFailure(f'{rerecorded} was not written')
+
+    # Exits with an error on the first desync, including keyframe mismatches.
+    run_game(args.taisei, '--verify-replay', rerecorded, env=env)
+
+
+if __name__ == '__main__':
+    run_test(main)
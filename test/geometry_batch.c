@@ -0,0 +1,98 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "test_common.h"
+
+#include "random.h"
+#include "util/geometry.h"
+
+// Checks that lineseg_ellipse_intersect_batch() agrees with lineseg_ellipse_intersect() exactly.
+
+#define NUM_ROUNDS 2000
+#define BATCH_SIZE 67  // deliberately not a multiple of any vector width
+
+static uint64_t rng_state = 0x5eed;
+
+static double rand_range(double lo, double hi) {
+	return lo + (hi - lo) * ((splitmix64(&rng_state) >> 11) * 0x1.0p-53);
+}
+
+static double rand_special(double lo, double hi) {
+	switch(splitmix64(&rng_state) % 16) {
+		case 0:  return 0;
+		case 1:  return -0.0;
+		case 2:  return lo;
+		case 3:  return hi;
+		default: return rand_range(lo, hi);
+	}
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+
+	double a_x[BATCH_SIZE], a_y[BATCH_SIZE], b_x[BATCH_SIZE], b_y[BATCH_SIZE];
+	double axes_x[BATCH_SIZE], axes_y[BATCH_SIZE], angle[BATCH_SIZE];
+	uint64_t mask[(BATCH_SIZE + 63) / 64];
+	uint64_t input_mask[ARRAY_SIZE(mask)];
+	uint num_hits = 0;
+
+	LineSegmentBatch segs = { a_x, a_y, b_x, b_y };
+	EllipseBatch ellipses = { axes_x, axes_y, angle };
+
+	for(int round = 0; round < NUM_ROUNDS; ++round) {
+		// Alternate between a tight and a wide spread, so that both the bbox rejection and the
+		// exact test get exercised.
+		double spread = (round & 1) ? 200 : 20;
+
+		for(uint i = 0; i < BATCH_SIZE; ++i) {
+			a_x[i] = rand_special(-spread, spread);
+			a_y[i] = rand_special(-spread, spread);
+			b_x[i] = (i % 7) ? rand_special(-spread, spread) : a_x[i];
+			b_y[i] = (i % 7) ? rand_special(-spread, spread) : a_y[i];
+			axes_x[i] = rand_range(0.5, 60);
+			axes_y[i] = (i % 5) ? rand_range(0.5, 60) : axes_x[i];
+			angle[i] = rand_special(-2 * M_PI, 2 * M_PI);
+		}
+
+		for(uint w = 0; w < ARRAY_SIZE(mask); ++w) {
+			input_mask[w] = mask[w] = splitmix64(&rng_state) | splitmix64(&rng_state);
+		}
+
+		lineseg_ellipse_intersect_batch(BATCH_SIZE, &segs, &ellipses, mask);
+
+		for(uint i = 0; i < BATCH_SIZE; ++i) {
+			uint64_t bit = UINT64_C(1) << (i % 64);
+			bool tested = input_mask[i / 64] & bit;
+			bool got = mask[i / 64] & bit;
+			bool expected = tested && lineseg_ellipse_intersect(
+				(LineSegment) { CMPLX(a_x[i], a_y[i]), CMPLX(b_x[i], b_y[i]) },
+				(Ellipse) { .axes = CMPLX(axes_x[i], axes_y[i]), .angle = angle[i] }
+			);
+
+			if(got != expected) {
+				log_fatal(
+					"Mismatch in round %i, lane %u: got %i, expected %i "
+					"(a = %a%+ai, b = %a%+ai, axes = %a%+ai, angle = %a)",
+					round, i, got, expected,
+					a_x[i], a_y[i], b_x[i], b_y[i], axes_x[i], axes_y[i], angle[i]
+				);
+			}
+
+			num_hits += got;
+		}
+	}
+
+	log_info("%u intersections, all results identical", num_hits);
+
+	if(num_hits == 0) {
+		log_fatal("No intersections; the test doesn't cover the exact path");
+	}
+
+	test_shutdown_basic();
+	return 0;
+}
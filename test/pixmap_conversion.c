@@ -0,0 +1,189 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "test_common.h"
+
+#include "pixmap/pixmap.h"
+#include "random.h"
+
+// Checks the specialized pixmap conversions against the formulas of the generic ones.
+
+#define WIDTH 37  // odd sizes, so that the vector loops have tails
+#define HEIGHT 11
+
+static uint32_t rng_state = 0x919a;
+
+static void alloc_pixmap(Pixmap *px, PixmapFormat format, uint32_t width, uint32_t height) {
+	*px = (Pixmap) { .format = format, .width = width, .height = height };
+	px->data.untyped = pixmap_alloc_buffer_for_copy(px, &px->data_size);
+}
+
+static void fill_random(Pixmap *px) {
+	uint8_t *b = px->data.untyped;
+
+	for(uint32_t i = 0; i < px->data_size; ++i) {
+		b[i] = splitmix32(&rng_state);
+	}
+}
+
+static uint8_t swizzle_value(char s, uint channels, const uint8_t *px) {
+	switch(s) {
+		case 'r': case 'g': case 'b': case 'a': {
+			// Missing channels read as 0, except alpha which is opaque
+			uint c = strchr("rgba", s) - "rgba";
+			return c < channels ? px[c] : (c == 3 ? UINT8_MAX : 0);
+		}
+		case '0': return 0;
+		case '1': return UINT8_MAX;
+		default: UNREACHABLE;
+	}
+}
+
+static void test_u8_to_rgba8(PixmapFormat src_format) {
+	uint channels = pixmap_format_layout(src_format);
+	Pixmap src, dst;
+	alloc_pixmap(&src, src_format, WIDTH, HEIGHT);
+	fill_random(&src);
+	pixmap_convert_alloc(&src, &dst, PIXMAP_FORMAT_RGBA8);
+
+	const uint8_t *src_bytes = src.data.untyped;
+
+	for(uint i = 0; i < WIDTH * HEIGHT; ++i) {
+		const uint8_t *in = src_bytes + i * channels;
+		const uint8_t *out = dst.data.rgba8[i].values;
+
+		for(uint c = 0; c < 4; ++c) {
+			uint8_t expected = swizzle_value("rgba"[c], channels, in);
+
+			if(out[c] != expected) {
+				log_fatal("%u channels -> RGBA8: pixel %u channel %u is %u, expected %u",
+					channels, i, c, out[c], expected);
+			}
+		}
+	}
+
+	mem_free(src.data.untyped);
+	mem_free(dst.data.untyped);
+}
+
+static void test_swizzle(const char *mask) {
+	Pixmap px, orig;
+	alloc_pixmap(&px, PIXMAP_FORMAT_RGBA8, WIDTH, HEIGHT);
+	fill_random(&px);
+	pixmap_copy_alloc(&px, &orig);
+	pixmap_swizzle_inplace(&px, (SwizzleMask) { { mask[0], mask[1], mask[2], mask[3] } });
+
+	for(uint i = 0; i < WIDTH * HEIGHT; ++i) {
+		for(uint c = 0; c < 4; ++c) {
+			uint8_t expected = swizzle_value(mask[c], 4, orig.data.rgba8[i].values);
+
+			if(px.data.rgba8[i].values[c] != expected) {
+				log_fatal("Swizzle %s: pixel %u channel %u is %u, expected %u",
+					mask, i, c, px.data.rgba8[i].values[c], expected);
+			}
+		}
+	}
+
+	mem_free(px.data.untyped);
+	mem_free(orig.data.untyped);
+}
+
+static void test_rgba8_to_rgba32f(void) {
+	Pixmap src, dst;
+	alloc_pixmap(&src, PIXMAP_FORMAT_RGBA8, WIDTH, HEIGHT);
+	fill_random(&src);
+	pixmap_convert_alloc(&src, &dst, PIXMAP_FORMAT_RGBA32F);
+
+	const uint8_t *in = src.data.untyped;
+	const float *out = dst.data.untyped;
+
+	for(uint i = 0; i < WIDTH * HEIGHT * 4; ++i) {
+		float expected = in[i] * (1.0f / (float)UINT8_MAX);
+
+		if(out[i] != expected) {
+			log_fatal("RGBA8 -> RGBA32F: element %u is %a, expected %a", i, out[i], expected);
+		}
+	}
+
+	mem_free(src.data.untyped);
+	mem_free(dst.data.untyped);
+}
+
+static void test_u16_to_u8(void) {
+	// Every possible input value
+	Pixmap src, dst;
+	alloc_pixmap(&src, PIXMAP_FORMAT_RGBA16, 128, 128);
+	uint16_t *in = src.data.untyped;
+
+	for(uint i = 0; i < 1 << 16; ++i) {
+		in[i] = i;
+	}
+
+	pixmap_convert_alloc(&src, &dst, PIXMAP_FORMAT_RGBA8);
+	const uint8_t *out = dst.data.untyped;
+
+	for(uint i = 0; i < 1 << 16; ++i) {
+		uint8_t expected = roundf(i * ((float)UINT8_MAX / (float)UINT16_MAX));
+
+		if(out[i] != expected) {
+			log_fatal("RGBA16 -> RGBA8: %u became %u, expected %u", i, out[i], expected);
+		}
+	}
+
+	mem_free(src.data.untyped);
+	mem_free(dst.data.untyped);
+}
+
+static void test_flip_y(void) {
+	Pixmap src, flipped;
+	alloc_pixmap(&src, PIXMAP_FORMAT_RGB8, WIDTH, HEIGHT);
+	fill_random(&src);
+	pixmap_flip_y_alloc(&src, &flipped);
+
+	size_t row_length = WIDTH * 3;
+	const uint8_t *src_bytes = src.data.untyped;
+	const uint8_t *flipped_bytes = flipped.data.untyped;
+
+	for(uint row = 0; row < HEIGHT; ++row) {
+		if(memcmp(
+			src_bytes + row * row_length,
+			flipped_bytes + (HEIGHT - row - 1) * row_length,
+			row_length
+		)) {
+			log_fatal("pixmap_flip_y: row %u mismatch", row);
+		}
+	}
+
+	pixmap_flip_y_inplace(&flipped);
+
+	if(memcmp(src.data.untyped, flipped.data.untyped, src.data_size)) {
+		log_fatal("pixmap_flip_y_inplace didn't undo pixmap_flip_y");
+	}
+
+	mem_free(src.data.untyped);
+	mem_free(flipped.data.untyped);
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+
+	test_u8_to_rgba8(PIXMAP_FORMAT_R8);
+	test_u8_to_rgba8(PIXMAP_FORMAT_RG8);
+	test_u8_to_rgba8(PIXMAP_FORMAT_RGB8);
+	test_swizzle("bgra");
+	test_swizzle("rrr1");
+	test_swizzle("a0g1");
+	test_rgba8_to_rgba32f();
+	test_u16_to_u8();
+	test_flip_y();
+
+	log_info("All conversions match");
+
+	test_shutdown_basic();
+	return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * This software is licensed under the terms of the MIT License.
+ * See COPYING for further information.
+ * ---
+ * Copyright (c) 2011-2026, Lukas Weber <laochailan@web.de>.
+ * Copyright (c) 2012-2026, Andrei Alexeyev <akari@taisei-project.org>.
+ */
+
+#include "test_common.h"
+
+#include "taskmanager.h"
+
+#include <SDL3/SDL_mutex.h>
+
+// Checks that tasks spread across the per-worker queues start in priority order, and in queue
+// order within each queue.
+
+#define NUM_TASKS 64
+
+typedef enum TaskClass {
+	CLASS_TOPMOST,
+	CLASS_NORMAL,
+	CLASS_LOW_PRIO,
+} TaskClass;
+
+static SDL_Semaphore *started;
+static SDL_Semaphore *gate;
+static SDL_Semaphore *done;
+static SDL_AtomicInt next_slot;
+static int run_order[NUM_TASKS];
+
+static void *blocker_task(void *arg) {
+	SDL_SignalSemaphore(started);
+	SDL_WaitSemaphore(gate);
+	return NULL;
+}
+
+static void *ordered_task(void *arg) {
+	int slot = SDL_AtomicAdd(&next_slot, 1);
+	run_order[slot] = (intptr_t)arg;
+	SDL_SignalSemaphore(done);
+	return NULL;
+}
+
+int main(int argc, char **argv) {
+	test_init_basic();
+
+	started = SDL_CreateSemaphore(0);
+	gate = SDL_CreateSemaphore(0);
+	done = SDL_CreateSemaphore(0);
+
+	TaskManager *mgr = taskmgr_create(0, SDL_THREAD_PRIORITY_NORMAL, "test");
+
+	if(!mgr) {
+		log_fatal("taskmgr_create() failed");
+	}
+
+	uint num_workers = taskmgr_num_threads(mgr);
+	log_info("Testing with %u workers", num_workers);
+
+	// Occupy every worker, so that nothing starts until the whole batch is queued.
+	Task *blockers[num_workers];
+
+	for(uint i = 0; i < num_workers; ++i) {
+		blockers[i] = taskmgr_submit(mgr, (TaskParams) { .callback = blocker_task });
+	}
+
+	for(uint i = 0; i < num_workers; ++i) {
+		SDL_WaitSemaphore(started);
+	}
+
+	// Submitted from a non-worker thread, these are spread round-robin over all queues, so tasks
+	// i and j end up in the same queue iff (j - i) % num_workers == 0.
+	// Every 4th task is topmost, every 8th has a lower priority.
+	Task *tasks[NUM_TASKS];
+	TaskClass classes[NUM_TASKS];
+
+	for(int i = 0; i < NUM_TASKS; ++i) {
+		TaskParams p = { .callback = ordered_task, .userdata = (void*)(intptr_t)i };
+
+		if(i % 8 == 7) {
+			p.prio = 1;
+			classes[i] = CLASS_LOW_PRIO;
+		} else if(i % 4 == 3) {
+			p.topmost = true;
+			classes[i] = CLASS_TOPMOST;
+		} else {
+			classes[i] = CLASS_NORMAL;
+		}
+
+		tasks[i] = taskmgr_submit(mgr, p);
+	}
+
+	// Free a single worker; it has to drain the other workers' queues.
+	// NOTE: don't task_wait() on pending tasks here, that would run them on this thread instead.
+	SDL_SignalSemaphore(gate);
+
+	for(int i = 0; i < NUM_TASKS; ++i) {
+		SDL_WaitSemaphore(done);
+	}
+
+	for(int i = 0; i < NUM_TASKS; ++i) {
+		task_finish(tasks[i], NULL);
+	}
+
+	for(uint i = 1; i < num_workers; ++i) {
+		SDL_SignalSemaphore(gate);
+	}
+
+	for(uint i = 0; i < num_workers; ++i) {
+		task_finish(blockers[i], NULL);
+	}
+
+	taskmgr_finish(mgr);
+	SDL_DestroySemaphore(done);
+	SDL_DestroySemaphore(gate);
+	SDL_DestroySemaphore(started);
+
+	int failed = 0;
+	int position[NUM_TASKS];
+
+	for(int i = 0; i < NUM_TASKS; ++i) {
+		position[i] = -1;
+	}
+
+	for(int i = 0; i < NUM_TASKS; ++i) {
+		int t = run_order[i];
+
+		if(position[t] >= 0) {
+			log_fatal("Task %i ran more than once", t);
+		}
+
+		position[t] = i;
+
+		if(i > 0 && classes[t] < classes[run_order[i - 1]]) {
+			log_error("Position %i: task %i ran after lower priority task %i", i, t, run_order[i - 1]);
+			++failed;
+		}
+	}
+
+	// Within a queue: topmost tasks newest first, the rest oldest first.
+	for(int i = 0; i < NUM_TASKS; ++i) {
+		for(int j = i + num_workers; j < NUM_TASKS; j += num_workers) {
+			if(classes[i] != classes[j]) {
+				continue;
+			}
+
+			int first = classes[i] == CLASS_TOPMOST ? j : i;
+			int second = classes[i] == CLASS_TOPMOST ? i : j;
+
+			if(position[first] > position[second]) {
+				log_error("Task %i ran before task %i from the same queue", second, first);
+				++failed;
+			}
+		}
+	}
+
+	if(failed) {
+		log_fatal("%i tasks ran out of order", failed);
+	}
+
+	log_info("All %i tasks ran in order", NUM_TASKS);
+	test_shutdown_basic();
+	return 0;
+}